@@ -0,0 +1,319 @@
+// Drives RequestAdmission with synthetic request storms against a model of
+// the AsyncTCP server: every request holds some heap until its response is
+// sent, streamed renders hold the most for the longest. Compares serving
+// everything (no admission) with the admission layer: heap low-water mark,
+// allocations that would have failed, and how the legitimate clients fared.
+
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+#include "Bench.h"
+#include "RequestAdmission.h"
+
+namespace
+{
+const unsigned long RUN_MS = 60000;
+const uint32_t WEB_HEAP = 48 * 1024; // Free heap left for the web server with the AP up
+
+// Heap held and time until the response is fully sent, per request class
+struct Cost
+{
+  uint32_t bytes;
+  unsigned long ms;
+};
+const Cost SERVE_COST[REQUEST_CLASS_COUNT] = {
+    {700, 5},    // Probe: canned redirect
+    {2600, 60},  // Static: gzip page out of flash
+    {2200, 15},  // API: status JSON
+    {7500, 450}, // Render: zone page / history stream over a slow AP link
+};
+const Cost REFUSE_COST = {500, 5}; // Fixed 429/503 answer
+
+enum ClientKind
+{
+  PHONE,     // Captive-portal probes in bursts, then opens the dashboard
+  DASHBOARD, // Polls /api/zones, now and then opens a zone page
+  ABUSER     // Auto-refresh gone wrong: /zone/1 as fast as it can
+};
+
+struct Client
+{
+  ClientKind kind;
+  uint32_t address;
+  unsigned long nextAt;
+  unsigned long sent;
+  unsigned long served;
+  unsigned long refused;
+  unsigned long failed; // Would have run out of heap
+};
+
+struct InFlight
+{
+  unsigned long doneAt;
+  uint32_t bytes;
+};
+
+uint32_t randomState = 11;
+unsigned long jitter(unsigned long range)
+{
+  randomState = randomState * 1664525u + 1013904223u;
+  return (randomState >> 8) % (range + 1);
+}
+
+uint32_t heapFree = WEB_HEAP;
+bool simulatedHeap(HalHeapStats &out)
+{
+  out.freeBytes = heapFree;
+  out.largestBlock = heapFree * 2 / 3; // Fragmentation after a while of web traffic
+  out.minFreeBytes = 0;
+  return true;
+}
+
+const char *pickPath(Client &client)
+{
+  switch (client.kind)
+  {
+  case PHONE:
+  {
+    static const char *const paths[] = {"/generate_204", "/hotspot-detect.html", "/connecttest.txt", "/", "/gen_204"};
+    return paths[jitter(4)];
+  }
+  case DASHBOARD:
+  {
+    unsigned long pick = jitter(19);
+    return pick == 0 ? "/zone/1" : pick == 1 ? "/api/zones/1/history" : "/api/zones";
+  }
+  case ABUSER:
+    return "/zone/1";
+  }
+  return "/";
+}
+
+unsigned long nextDelay(const Client &client)
+{
+  switch (client.kind)
+  {
+  case PHONE:
+    return 150 + jitter(2500); // Probes come in clumps
+  case DASHBOARD:
+    return 1000 + jitter(200);
+  case ABUSER:
+    return 40 + jitter(20);
+  }
+  return 1000;
+}
+
+struct Result
+{
+  uint32_t minFree;
+  unsigned long failed;
+  unsigned long peakRenders;
+  unsigned long refusedRate;
+  unsigned long refusedBusy;
+  unsigned long refusedHeap;
+};
+
+Result runStorm(int phones, int dashboards, int abusers, bool withAdmission)
+{
+  std::vector<Client> clients;
+  uint32_t address = 0xC0A80402; // 192.168.4.2
+  for (int i = 0; i < phones; i++)
+    clients.push_back({PHONE, address++, jitter(1000), 0, 0, 0, 0});
+  for (int i = 0; i < dashboards; i++)
+    clients.push_back({DASHBOARD, address++, jitter(1000), 0, 0, 0, 0});
+  for (int i = 0; i < abusers; i++)
+    clients.push_back({ABUSER, address++, jitter(100), 0, 0, 0, 0});
+
+  RequestAdmission admission;
+  admission.setHeapProbe(simulatedHeap);
+  heapFree = WEB_HEAP;
+  randomState = 11;
+
+  // RenderSlots are held by the in-flight responses, like the chunked fillers on the device
+  struct Response
+  {
+    InFlight flight;
+    std::shared_ptr<RenderSlot> slot;
+    bool render;
+  };
+  std::vector<Response> inFlight;
+  Result result = {WEB_HEAP, 0, 0, 0, 0, 0};
+  unsigned long renders = 0;
+
+  for (unsigned long now = 1; now <= RUN_MS; now++)
+  {
+    for (size_t i = 0; i < inFlight.size();)
+    {
+      if (inFlight[i].flight.doneAt <= now)
+      {
+        heapFree += inFlight[i].flight.bytes;
+        renders -= inFlight[i].render ? 1 : 0;
+        inFlight[i] = inFlight.back();
+        inFlight.pop_back();
+      }
+      else
+      {
+        i++;
+      }
+    }
+
+    for (Client &client : clients)
+    {
+      if (client.nextAt > now)
+      {
+        continue;
+      }
+      client.nextAt = now + nextDelay(client);
+      client.sent++;
+      RequestClass kind = classifyRequest(pickPath(client));
+
+      Cost cost = SERVE_COST[kind];
+      std::shared_ptr<RenderSlot> slot;
+      bool refused = false;
+      if (withAdmission)
+      {
+        AdmissionResult admitted = admission.admit(client.address, kind, now);
+        if (admitted == ADMIT && kind == REQUEST_RENDER)
+        {
+          slot = admission.acquireRender();
+        }
+        if (admitted != ADMIT)
+        {
+          cost = REFUSE_COST;
+          refused = true;
+          client.refused++;
+        }
+      }
+      if (cost.bytes > heapFree)
+      {
+        client.failed++; // On the device: a dropped connection at best, an abort at worst
+        continue;
+      }
+      if (!refused)
+      {
+        client.served++;
+      }
+      bool render = slot != nullptr || (!withAdmission && kind == REQUEST_RENDER);
+      heapFree -= cost.bytes;
+      renders += render ? 1 : 0;
+      inFlight.push_back({{now + cost.ms, cost.bytes}, slot, render});
+      if (renders > result.peakRenders)
+        result.peakRenders = renders;
+      if (heapFree < result.minFree)
+        result.minFree = heapFree;
+    }
+  }
+
+  printf("%s\n", withAdmission ? "with admission" : "no admission (serve everything)");
+  const char *names[] = {"phones", "dashboards", "abusers"};
+  for (int kind = PHONE; kind <= ABUSER; kind++)
+  {
+    unsigned long sent = 0, served = 0, refused = 0, failed = 0;
+    for (const Client &client : clients)
+    {
+      if (client.kind != kind)
+        continue;
+      sent += client.sent;
+      served += client.served;
+      refused += client.refused;
+      failed += client.failed;
+    }
+    if (sent == 0)
+      continue;
+    result.failed += failed;
+    printf("  %-11s %6lu requests, %5.1f%% served, %5lu refused, %5lu out of heap\n", names[kind], sent,
+           100.0 * served / sent, refused, failed);
+  }
+  result.refusedRate = admission.rejectedRate;
+  result.refusedBusy = admission.rejectedBusy;
+  result.refusedHeap = admission.rejectedHeap;
+  printf("  heap        %u B low-water of %u, %lu renders in flight at peak\n", (unsigned)result.minFree,
+         (unsigned)WEB_HEAP, result.peakRenders);
+  if (withAdmission)
+  {
+    printf("  refused     %lu rate (429), %lu busy (503), %lu low heap (503)\n", result.refusedRate,
+           result.refusedBusy, result.refusedHeap);
+  }
+  return result;
+}
+
+// The routes the web server registers (src/*Routes.cpp), as request->url()
+// hands them to classifyRequest()
+struct Route
+{
+  const char *path;
+  RequestClass expected;
+};
+const Route ROUTES[] = {
+    {"/generate_204", REQUEST_PROBE},
+    {"/hotspot-detect.html", REQUEST_PROBE},
+    {"/", REQUEST_STATIC},
+    {"/mesh", REQUEST_STATIC},
+    {"/update", REQUEST_STATIC},
+    {"/zone/1", REQUEST_RENDER},
+    {"/zone/12", REQUEST_RENDER},
+    {"/zone/1/config", REQUEST_API},
+    {"/zone/", REQUEST_STATIC},
+    {"/zone/abc", REQUEST_STATIC},
+    {"/api/zones", REQUEST_API},
+    {"/api/zones/info", REQUEST_API},
+    {"/api/zones/3/history", REQUEST_RENDER},
+    {"/api/zones/3/historyx", REQUEST_API},
+    {"/api/zones//history", REQUEST_API},
+    {"/api/power", REQUEST_API},
+    {"/api/config", REQUEST_API},
+    {"/api/trace", REQUEST_API},
+    {"/api/mesh", REQUEST_RENDER},
+    {"/api/log", REQUEST_RENDER},
+    {"/mesh/config", REQUEST_API},
+    {"/metrics", REQUEST_RENDER},
+};
+
+int checkRoutes()
+{
+  static const char *const names[REQUEST_CLASS_COUNT] = {"probe", "static", "api", "render"};
+  int failures = 0;
+  for (const Route &route : ROUTES)
+  {
+    RequestClass kind = classifyRequest(route.path);
+    if (kind != route.expected)
+    {
+      printf("  FAILED %-24s %s, expected %s\n", route.path, names[kind], names[route.expected]);
+      failures++;
+    }
+  }
+  printf("routes: %zu classified, %d wrong\n", sizeof(ROUTES) / sizeof(ROUTES[0]), failures);
+  return failures;
+}
+
+void measureAdmitCost()
+{
+  RequestAdmission admission;
+  admission.setHeapProbe(simulatedHeap);
+  heapFree = WEB_HEAP;
+  const int rounds = 1000000;
+  volatile int admitted = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < rounds; i++)
+  {
+    // More addresses than buckets, so lookups and evictions both show up
+    admitted += admission.admit(0xC0A80400 + (i % 24), (RequestClass)(i & 3), (unsigned long)i) == ADMIT;
+  }
+  double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+  printf("admit(): %.0f ns per call, 24 clients sharing %d buckets\n", ns / rounds, ADMISSION_CLIENTS);
+}
+} // namespace
+
+int runAdmissionBench()
+{
+  printf("== Request admission under synthetic load, %lu s ==\n", RUN_MS / 1000);
+  printf("-- 6 probing phones, 4 dashboards --\n");
+  runStorm(6, 4, 0, false);
+  runStorm(6, 4, 0, true);
+  printf("-- plus 2 clients hammering /zone/1 --\n");
+  runStorm(6, 4, 2, false);
+  runStorm(6, 4, 2, true);
+  measureAdmitCost();
+  return checkRoutes();
+}
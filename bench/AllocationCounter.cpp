@@ -0,0 +1,62 @@
+#include <cstdlib>
+#include <new>
+#include "Bench.h"
+
+// Every block carries its size in front of it so live and peak heap can be tracked
+static size_t liveBytes = 0;
+static size_t peakBytes = 0;
+static size_t allocations = 0;
+
+void *operator new(size_t size)
+{
+  size_t *block = static_cast<size_t *>(malloc(size + sizeof(size_t)));
+  if (!block)
+  {
+    throw std::bad_alloc();
+  }
+  *block = size;
+  liveBytes += size;
+  allocations++;
+  if (liveBytes > peakBytes)
+  {
+    peakBytes = liveBytes;
+  }
+  return block + 1;
+}
+
+void operator delete(void *ptr) noexcept
+{
+  if (!ptr)
+  {
+    return;
+  }
+  size_t *block = static_cast<size_t *>(ptr) - 1;
+  liveBytes -= *block;
+  free(block);
+}
+
+void operator delete(void *ptr, size_t) noexcept
+{
+  operator delete(ptr);
+}
+
+size_t benchAllocations()
+{
+  return allocations;
+}
+
+size_t benchLiveBytes()
+{
+  return liveBytes;
+}
+
+size_t benchPeakBytes()
+{
+  return peakBytes;
+}
+
+void benchResetCounters()
+{
+  allocations = 0;
+  peakBytes = liveBytes;
+}
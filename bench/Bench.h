@@ -0,0 +1,26 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <stddef.h>
+
+// Allocation tracking (AllocationCounter.cpp replaces global new/delete)
+size_t benchAllocations();
+size_t benchLiveBytes();
+size_t benchPeakBytes();
+void benchResetCounters();
+
+void runTemplateBench();
+void runSimulationBench(int zoneCount, double days, unsigned long tickMs, int maxPumps, bool dosing);
+void runFilterBench(const char *tracePath);
+void runZoneStoreBench();
+void runMeshBench(int nodeCount, int zonesPerNode);
+int runAdmissionBench(); // Returns the number of failed checks
+void runPlannerBench(int zoneCount, double days);
+int runUpdateBench(); // Returns the number of failed checks
+void runConfigBench();
+void runLogBench();
+int runReplayBench(const char *tracePath, int zoneCount, double days); // Returns the number of failed checks
+void runSensorBench(double days);
+int runCutoffBench(int zoneCount, double days); // Returns the number of failed checks
+
+#endif // BENCH_H
@@ -0,0 +1,125 @@
+// Host benchmarks, built by the native environment:
+//
+//   pio run -e native && .pio/build/native/program [template|sim|filter|zones|mesh|load|plan|update|config|log|replay|sensors|cutoff] [--zones N] [--nodes N] [--days D] [--tick MS] [--pumps N] [--dosing] [--trace FILE]
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include "Bench.h"
+#include "Hal.h"
+
+// The unit tests in test/ bring their own main()
+#ifndef PIO_UNIT_TESTING
+int main(int argc, char **argv)
+{
+  const char *suite = "all";
+  int zones = 100;
+  double days = 1.0;
+  unsigned long tickMs = 100;
+  int pumps = 4;
+  const char *trace = nullptr;
+  bool dosing = false;
+  int nodes = 32;
+
+  for (int i = 1; i < argc; i++)
+  {
+    if (strcmp(argv[i], "--zones") == 0 && i + 1 < argc)
+      zones = atoi(argv[++i]);
+    else if (strcmp(argv[i], "--days") == 0 && i + 1 < argc)
+      days = atof(argv[++i]);
+    else if (strcmp(argv[i], "--tick") == 0 && i + 1 < argc)
+      tickMs = strtoul(argv[++i], nullptr, 10);
+    else if (strcmp(argv[i], "--nodes") == 0 && i + 1 < argc)
+      nodes = atoi(argv[++i]);
+    else if (strcmp(argv[i], "--pumps") == 0 && i + 1 < argc)
+      pumps = atoi(argv[++i]);
+    else if (strcmp(argv[i], "--dosing") == 0)
+      dosing = true;
+    else if (strcmp(argv[i], "--trace") == 0 && i + 1 < argc)
+      trace = argv[++i];
+    else if (argv[i][0] != '-')
+      suite = argv[i];
+    else
+    {
+      fprintf(stderr, "usage: %s [template|sim|filter|zones|mesh|load|plan|update|config|log|replay|sensors|cutoff] [--zones N] [--nodes N] [--days D] [--tick MS] [--pumps N] [--dosing] [--trace FILE]\n", argv[0]);
+      return 1;
+    }
+  }
+
+  bool all = strcmp(suite, "all") == 0;
+  int failures = 0;
+  // Suites install HALs that live on their stack; each one starts from the native HAL again
+  const Hal native = hal();
+  auto selected = [&](const char *name)
+  {
+    if (!all && strcmp(suite, name) != 0)
+    {
+      return false;
+    }
+    installHal(native);
+    return true;
+  };
+  if (selected("template"))
+  {
+    runTemplateBench();
+  }
+  if (selected("sim"))
+  {
+    runSimulationBench(zones, days, tickMs, pumps, dosing);
+  }
+  if (selected("filter"))
+  {
+    runFilterBench(trace);
+  }
+  if (selected("zones"))
+  {
+    runZoneStoreBench();
+  }
+  if (selected("mesh"))
+  {
+    // --zones is per node here, capped at MAX_ZONES
+    runMeshBench(nodes, zones);
+  }
+  if (selected("load"))
+  {
+    failures += runAdmissionBench();
+  }
+  if (selected("plan"))
+  {
+    // --zones capped at MAX_ZONES, at least 3 --days
+    runPlannerBench(zones, days);
+  }
+  if (selected("update"))
+  {
+    failures += runUpdateBench();
+  }
+  if (selected("config"))
+  {
+    runConfigBench();
+  }
+  if (selected("log"))
+  {
+    runLogBench();
+  }
+  if (selected("replay"))
+  {
+    // Records a simulation first unless --trace is given; --zones capped at MAX_ZONES
+    failures += runReplayBench(all ? nullptr : trace, zones, days);
+  }
+  if (selected("sensors"))
+  {
+    runSensorBench(days);
+  }
+  if (selected("cutoff"))
+  {
+    // --zones capped at MAX_ZONES
+    failures += runCutoffBench(zones, days);
+  }
+  if (failures)
+  {
+    fprintf(stderr, "%d check(s) FAILED\n", failures);
+    return 1;
+  }
+  return 0;
+}
+#endif
@@ -0,0 +1,163 @@
+// Reconfigures every zone of a 16-zone controller twice: once the way the
+// zone pages do it (one /zone/N/config request per zone, a few seconds
+// apart) and once as a single /api/config document. Counts NVS namespace
+// opens and blob writes for both, times parsing, and checks that rejected
+// documents change nothing.
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+#include "Bench.h"
+#include "ConfigDocument.h"
+#include "SimulatedHal.h"
+#include "ZoneController.h"
+
+namespace
+{
+const int ZONES = MAX_ZONES;
+const unsigned long CLICK_MS = 4000; // Submit, page reload, next zone
+
+struct Rig
+{
+  SimClock clock;
+  SoilSimulation soil{ZONES};
+  MemoryKeyValueStore store;
+  ZoneController controller;
+  SystemSnapshot snapshot;
+
+  Rig()
+  {
+    installHal({&clock, &soil, &soil, &store, nullptr});
+    char name[ZONE_NAME_LEN];
+    for (int i = 0; i < ZONES; i++)
+    {
+      snprintf(name, sizeof(name), "Bed \"%d\"", i + 1); // Quotes go through the escaping
+      controller.addZone(WateringZone(i + 1, name, SoilSimulation::sensorPin(i), SoilSimulation::pumpPin(i)));
+    }
+    controller.init();
+    run(1000);
+  }
+
+  void run(unsigned long ms)
+  {
+    for (unsigned long end = clock.nowMs + ms; clock.nowMs < end; clock.nowMs += 100)
+    {
+      soil.advance(clock.nowMs);
+      controller.tick(clock.nowMs);
+    }
+    controller.readSnapshot(snapshot);
+  }
+};
+
+ZoneConfigRequest changedZone(int id, int round)
+{
+  ZoneConfigRequest request = {id, 70 + round, 35 + round, 3650, 3150, 1450, 20 + round, 600, 0};
+  return request;
+}
+
+void perZoneRequests(Rig &rig)
+{
+  unsigned long opens = rig.store.openCount, writes = rig.store.writeCount;
+  for (int i = 0; i < ZONES; i++)
+  {
+    rig.controller.submitConfig(changedZone(i + 1, 1));
+    rig.run(CLICK_MS);
+  }
+  rig.run(SETTINGS_DEBOUNCE_MS + 1000);
+  printf("  %2d x /zone/N/config       %3lu namespace opens, %3lu blob writes\n", ZONES,
+         rig.store.openCount - opens, rig.store.writeCount - writes);
+}
+
+void oneDocument(Rig &rig)
+{
+  ConfigDocument document = {};
+  for (int i = 0; i < ZONES; i++)
+  {
+    document.zones[i] = changedZone(i + 1, 2);
+  }
+  document.zoneCount = ZONES;
+  flatWeatherProfile(document.weather);
+  document.weather.etPercent[13] = 180;
+  document.hasWeather = true;
+
+  // Through the text format, as it arrives over HTTP
+  SystemSnapshot target = rig.snapshot;
+  for (int i = 0; i < ZONES; i++)
+  {
+    const ZoneConfigRequest &zone = document.zones[i];
+    target.zones[i].wetThreshold = zone.wetThreshold;
+    target.zones[i].dryThreshold = zone.dryThreshold;
+    target.zones[i].maxRuntimeSec = zone.maxRuntimeSec;
+  }
+  memcpy(target.weather, document.weather.etPercent, sizeof(target.weather));
+  static char text[CONFIG_JSON_MAX];
+  size_t length = writeConfigJson(target, text, sizeof(text));
+
+  const int rounds = 2000;
+  ConfigDocument parsed;
+  const char *error = nullptr;
+  auto start = std::chrono::steady_clock::now();
+  for (int r = 0; r < rounds; r++)
+  {
+    parseConfigJson(text, length, parsed, error);
+  }
+  double us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / rounds;
+  bool valid = !error && validateConfig(parsed, rig.snapshot, error);
+
+  unsigned long opens = rig.store.openCount, writes = rig.store.writeCount;
+  rig.controller.submitDocument(parsed);
+  rig.run(100);
+  printf("  1 x POST /api/config      %3lu namespace opens, %3lu blob writes (incl. weather), %s\n",
+         rig.store.openCount - opens, rig.store.writeCount - writes, valid ? "valid" : error);
+  printf("    %zu byte document, parsed in %.1f us\n", length, us);
+
+  static char exported[CONFIG_JSON_MAX];
+  size_t exportedLength = writeConfigJson(rig.snapshot, exported, sizeof(exported));
+  bool roundTrip = exportedLength == length && memcmp(exported, text, length) == 0;
+  printf("    export after apply %s the uploaded document\n", roundTrip ? "matches" : "DIFFERS FROM");
+}
+
+void rejections(Rig &rig)
+{
+  const char *const documents[] = {
+      "{\"version\":1,\"zones\":[{\"id\":1,\"wetThreshold\":30,\"dryThreshold\":40},{\"id\":2,\"wetThreshold\":90}]}",
+      "{\"version\":1,\"zones\":[{\"id\":2,\"wetThreshold\":90},{\"id\":3,\"airValue\":5000}]}",
+      "{\"version\":1,\"zones\":[{\"id\":2,\"wetThreshold\":90},{\"id\":99}]}",
+      "{\"version\":1,\"zones\":[{\"id\":2,\"wetThreshold\":90},{\"id\":2,\"dryThreshold\":10}]}",
+      "{\"version\":1,\"zones\":[{\"id\":2,\"wet\":90}]}",
+      "{\"version\":1,\"zones\":[{\"id\":2,\"wetThreshold\":90}],\"weather\":[100,100]}",
+      "{\"version\":2,\"zones\":[]}",
+      "{\"version\":1,\"zones\":[{\"id\":2,\"wetThreshold\":90}",
+  };
+  unsigned long writes = rig.store.writeCount;
+  SystemSnapshot before = rig.snapshot;
+  int rejected = 0;
+  for (const char *text : documents)
+  {
+    ConfigDocument document;
+    const char *error = nullptr;
+    if (!parseConfigJson(text, strlen(text), document, error) || !validateConfig(document, rig.snapshot, error))
+    {
+      rejected++;
+      printf("    rejected: %s\n", error);
+      continue;
+    }
+    rig.controller.submitDocument(document);
+  }
+  rig.run(SETTINGS_DEBOUNCE_MS + 1000);
+  bool unchanged = rig.store.writeCount == writes && rig.snapshot.zones[1].wetThreshold == before.zones[1].wetThreshold;
+  printf("  %d of %zu bad documents rejected, settings %s\n", rejected, sizeof(documents) / sizeof(documents[0]),
+         unchanged ? "unchanged" : "CHANGED");
+}
+} // namespace
+
+void runConfigBench()
+{
+  printf("== Configuring %d zones ==\n", ZONES);
+  Rig rig;
+  perZoneRequests(rig);
+  oneDocument(rig);
+  rejections(rig);
+}
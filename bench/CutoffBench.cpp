@@ -0,0 +1,227 @@
+// Pump over-run past the run limit while the control task stalls. Zones
+// water a SoilSimulation slowly enough that most runs end at the 30 s limit.
+// Now and then a wakeup of the control task is held up by up to
+// MAX_STALL_MS (WiFi setup, a blocking handler), once with only the control
+// task stopping pumps and once with PumpCutoff timers, which fire on time
+// plus a modelled dispatch latency. The relay's over-run is measured at the
+// GPIO, in microseconds.
+
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+
+#include "Bench.h"
+#include "SimulatedHal.h"
+#include "ZoneController.h"
+
+namespace
+{
+const double STALL_CHANCE = 0.01;           // Per control task wakeup
+const unsigned long MAX_STALL_MS = 20000;
+const uint32_t MAX_DISPATCH_US = 200;       // esp_timer task latency, assumed
+const uint64_t CUTOFF_BOUND_US = MAX_DISPATCH_US + 1000; // Plus millis() rounding of the deadline
+
+uint32_t randomState = 7;
+uint32_t nextRandom()
+{
+  randomState ^= randomState << 13;
+  randomState ^= randomState >> 17;
+  randomState ^= randomState << 5;
+  return randomState;
+}
+
+class MicroClock : public HalClock
+{
+public:
+  uint64_t nowUs = 0;
+
+  unsigned long millis() override { return (unsigned long)(nowUs / 1000); }
+  unsigned long micros() override { return (unsigned long)nowUs; }
+};
+
+// Fires when the bench's event loop reaches its due time, however stalled the control task is
+class SimulatedCutoffTimer : public CutoffTimer
+{
+public:
+  MicroClock *clock = nullptr;
+  CutoffTimerFn fn = nullptr;
+  void *context = nullptr;
+  bool running = false;
+  uint64_t dueUs = 0;
+
+  bool begin(CutoffTimerFn callback, void *callbackContext) override
+  {
+    fn = callback;
+    context = callbackContext;
+    return true;
+  }
+
+  void start(uint32_t delayUs) override
+  {
+    running = true;
+    dueUs = clock->nowUs + delayUs + nextRandom() % (MAX_DISPATCH_US + 1);
+  }
+
+  void stop() override { running = false; }
+};
+
+// Relay switching times of every pump, between the zones and the soil
+class RelayMonitor : public HalGpio
+{
+public:
+  RelayMonitor(SoilSimulation &soil, MicroClock &clock, uint64_t limitUs) : soil(soil), clock(clock), limitUs(limitUs)
+  {
+    onSinceUs.resize(soil.zoneCount() * 2, 0);
+  }
+
+  unsigned long runs = 0;
+  std::vector<uint64_t> overrunsUs; // Runs that reached the limit
+
+  void setInput(int pin) override { soil.setInput(pin); }
+  void setOutput(int pin) override { soil.setOutput(pin); }
+  void write(int pin, bool high) override
+  {
+    soil.write(pin, high);
+    uint64_t &since = onSinceUs[pin];
+    if (high && !since)
+    {
+      since = clock.nowUs ? clock.nowUs : 1;
+      runs++;
+    }
+    else if (!high && since)
+    {
+      uint64_t ranUs = clock.nowUs - since;
+      if (ranUs >= limitUs)
+      {
+        overrunsUs.push_back(ranUs - limitUs);
+      }
+      since = 0;
+    }
+  }
+
+private:
+  SoilSimulation &soil;
+  MicroClock &clock;
+  uint64_t limitUs;
+  std::vector<uint64_t> onSinceUs;
+};
+
+struct CutoffRun
+{
+  unsigned long runs;
+  unsigned long stalls;
+  std::vector<uint64_t> overrunsUs;
+  CutoffStats stats;
+};
+
+CutoffRun runZones(int zoneCount, double days, bool timers)
+{
+  MicroClock clock;
+  SoilSimulation soil(zoneCount);
+  for (int i = 0; i < zoneCount; i++)
+  {
+    soil.soil(i).pumpPerS *= 0.2; // Most runs end at the limit
+  }
+  RelayMonitor relays(soil, clock, MAX_PUMP_RUNTIME_SEC * 1000000ULL);
+  MemoryKeyValueStore store;
+  installHal({&clock, &soil, &relays, &store, nullptr});
+  WateringZone::resetSensors();
+  WateringZone::resetCutoff();
+
+  std::vector<SimulatedCutoffTimer> cutoffTimers(zoneCount);
+  ZoneController controller;
+  char name[ZONE_NAME_LEN];
+  for (int i = 0; i < zoneCount; i++)
+  {
+    cutoffTimers[i].clock = &clock;
+    if (timers)
+    {
+      WateringZone::attachCutoffTimer(i, &cutoffTimers[i]);
+    }
+    snprintf(name, sizeof(name), "Sim %d", i + 1);
+    controller.addZone(WateringZone(i + 1, name, SoilSimulation::sensorPin(i), SoilSimulation::pumpPin(i)));
+  }
+  controller.init();
+
+  randomState = 7;
+  CutoffRun run = {};
+  uint64_t endUs = (uint64_t)(days * 86400e6);
+  uint64_t controlAtUs = 0;
+  while (clock.nowUs < endUs)
+  {
+    // Timer callbacks preempt the control task
+    SimulatedCutoffTimer *due = nullptr;
+    for (SimulatedCutoffTimer &timer : cutoffTimers)
+    {
+      if (timer.running && timer.dueUs <= controlAtUs && (!due || timer.dueUs < due->dueUs))
+      {
+        due = &timer;
+      }
+    }
+    if (due)
+    {
+      clock.nowUs = std::max(clock.nowUs, due->dueUs);
+      soil.advance(clock.millis());
+      due->running = false;
+      due->fn(due->context);
+      continue;
+    }
+
+    clock.nowUs = controlAtUs;
+    unsigned long now = clock.millis();
+    soil.advance(now);
+    controller.tick(now);
+    unsigned long next = controller.nextWakeTime(now);
+    controlAtUs = (uint64_t)((long)(next - now) > 0 ? next : now + 1) * 1000;
+    if (nextRandom() % 10000 < STALL_CHANCE * 10000)
+    {
+      controlAtUs += (nextRandom() % MAX_STALL_MS) * 1000;
+      run.stalls++;
+    }
+  }
+
+  run.runs = relays.runs;
+  run.overrunsUs = relays.overrunsUs;
+  run.stats = WateringZone::cutoffStats();
+  WateringZone::resetCutoff();
+  return run;
+}
+
+uint64_t percentile(std::vector<uint64_t> values, double p)
+{
+  if (values.empty())
+  {
+    return 0;
+  }
+  std::sort(values.begin(), values.end());
+  return values[(size_t)(p * (values.size() - 1))];
+}
+
+void printRun(const char *label, const CutoffRun &run)
+{
+  uint64_t worst = run.overrunsUs.empty() ? 0 : *std::max_element(run.overrunsUs.begin(), run.overrunsUs.end());
+  printf("-- %s --\n", label);
+  printf("pump runs        %lu, %zu reached the limit, %lu control task stalls\n", run.runs, run.overrunsUs.size(),
+         run.stalls);
+  printf("relay over-run   median %.3f ms, p99 %.3f ms, worst %.3f ms\n", percentile(run.overrunsUs, 0.5) / 1000.0,
+         percentile(run.overrunsUs, 0.99) / 1000.0, worst / 1000.0);
+  printf("cutoff stats     %lu timer cutoffs, worst %lu us, control task alone worst %.1f ms late\n",
+         (unsigned long)run.stats.cutoffs, (unsigned long)run.stats.maxOverrunUs,
+         run.stats.maxControlLateUs / 1000.0);
+}
+} // namespace
+
+int runCutoffBench(int zoneCount, double days)
+{
+  zoneCount = zoneCount > MAX_ZONES ? MAX_ZONES : zoneCount;
+  printf("== Pump cutoff under control task stalls: %d zones, %.2f days, %.0f %% of wakeups stall up to %lu s ==\n",
+         zoneCount, days, STALL_CHANCE * 100, MAX_STALL_MS / 1000);
+  printRun("control task only", runZones(zoneCount, days, false));
+
+  CutoffRun guarded = runZones(zoneCount, days, true);
+  printRun("cutoff timers", guarded);
+  uint64_t worst = guarded.overrunsUs.empty() ? 0 : *std::max_element(guarded.overrunsUs.begin(), guarded.overrunsUs.end());
+  printf("worst cutoff     %.3f ms, bound %.3f ms: %s\n", worst / 1000.0, CUTOFF_BOUND_US / 1000.0,
+         worst <= CUTOFF_BOUND_US ? "ok" : "FAILED");
+  return worst <= CUTOFF_BOUND_US ? 0 : 1;
+}
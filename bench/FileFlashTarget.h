@@ -0,0 +1,117 @@
+#ifndef FILE_FLASH_TARGET_H
+#define FILE_FLASH_TARGET_H
+
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+#include "FlashTarget.h"
+
+const size_t FLASH_SECTOR_SIZE = 4096;
+
+// OTA slot backed by a file, with NOR flash rules: a sector is erased to
+// 0xFF before it is written, a write can only clear bits, and erases happen
+// sector by sector as the image grows (like OTA_WITH_SEQUENTIAL_WRITES).
+// Counts what the device would do and flags writes that do not start on a
+// sector boundary or that go to a sector written before.
+class FileFlashTarget : public FlashTarget
+{
+public:
+  unsigned long erases = 0;
+  unsigned long writes = 0;
+  unsigned long misaligned = 0;
+  unsigned long rewrites = 0; // Bits that would need an erase to be set again
+  bool committed = false;
+  size_t committedSize = 0;
+
+  FileFlashTarget(const char *path, size_t slotSize) : slotSize(slotSize), file(fopen(path, "w+b")), written(0)
+  {
+    std::vector<uint8_t> blank(slotSize, 0x00); // Whatever the previous image left
+    fwrite(blank.data(), 1, blank.size(), file);
+  }
+
+  ~FileFlashTarget() override
+  {
+    if (file)
+    {
+      fclose(file);
+    }
+  }
+
+  bool begin(size_t size) override
+  {
+    committed = false;
+    written = 0;
+    return file && size <= slotSize;
+  }
+
+  bool write(size_t offset, const uint8_t *data, size_t length) override
+  {
+    if (offset != written || offset + length > slotSize)
+    {
+      return false;
+    }
+    if (offset % FLASH_SECTOR_SIZE != 0)
+    {
+      misaligned++;
+    }
+    uint8_t sector[FLASH_SECTOR_SIZE];
+    size_t end = offset + length;
+    while (offset < end)
+    {
+      size_t start = offset - offset % FLASH_SECTOR_SIZE;
+      size_t take = start + FLASH_SECTOR_SIZE - offset;
+      if (take > end - offset)
+      {
+        take = end - offset;
+      }
+      fseek(file, (long)start, SEEK_SET);
+      fread(sector, 1, sizeof(sector), file);
+      if (offset == start)
+      {
+        memset(sector, 0xFF, sizeof(sector));
+        erases++;
+      }
+      for (size_t i = 0; i < take; i++)
+      {
+        uint8_t &cell = sector[offset - start + i];
+        if ((cell & *data) != *data)
+        {
+          rewrites++;
+        }
+        cell &= *data++;
+      }
+      fseek(file, (long)start, SEEK_SET);
+      fwrite(sector, 1, sizeof(sector), file);
+      offset += take;
+    }
+    written = end;
+    writes++;
+    return true;
+  }
+
+  bool commit() override
+  {
+    fflush(file);
+    committed = true;
+    committedSize = written;
+    return true;
+  }
+
+  void abort() override { written = 0; }
+
+  // Flash contents as the bootloader would see them
+  std::vector<uint8_t> contents(size_t length)
+  {
+    std::vector<uint8_t> data(length);
+    fseek(file, 0, SEEK_SET);
+    data.resize(fread(data.data(), 1, length, file));
+    return data;
+  }
+
+private:
+  size_t slotSize;
+  FILE *file;
+  size_t written;
+};
+
+#endif // FILE_FLASH_TARGET_H
@@ -0,0 +1,221 @@
+// Replays noisy moisture traces through the old mean-of-5 and the
+// MoistureFilter chain and compares false dry triggers, threshold chatter,
+// air detection delay and cost per sample.
+//
+// Without a trace file the traces are synthesized; with --trace FILE every
+// line is either one raw ADC value or a row of the history CSV
+// (time,min,avg,max), of which the avg column is used.
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "Bench.h"
+#include "MoistureFilter.h"
+#include "WateringZone.h"
+
+// What SensorSampler did before the filter chain
+struct MeanFilter
+{
+  int samples[5] = {};
+  int head = 0;
+  int count = 0;
+  long sum = 0;
+
+  int update(int raw)
+  {
+    if (count == 5)
+    {
+      sum -= samples[head];
+    }
+    else
+    {
+      count++;
+    }
+    samples[head] = raw;
+    sum += raw;
+    head = (head + 1) % 5;
+    return (int)(sum / count);
+  }
+};
+
+struct TraceStats
+{
+  int dryTriggers = 0; // Rising edges of "zone is dry"
+  int drySamples = 0;
+  int airDelay = -1;   // Samples from the air step until the output crossed airValue
+};
+
+static int toPercent(int raw)
+{
+  long percent = (long)(raw - DEFAULT_DRY_VALUE) * 100 / (DEFAULT_WATER_VALUE - DEFAULT_DRY_VALUE);
+  return percent < 0 ? 0 : (percent > 100 ? 100 : (int)percent);
+}
+
+// Deterministic noise so runs are comparable
+static uint32_t noiseState = 1;
+static int noise(int amplitude)
+{
+  noiseState = noiseState * 1664525u + 1013904223u;
+  return (int)((noiseState >> 8) % (2 * amplitude + 1)) - amplitude;
+}
+
+static int rawForPercent(int percent)
+{
+  return DEFAULT_DRY_VALUE + (DEFAULT_WATER_VALUE - DEFAULT_DRY_VALUE) * percent / 100;
+}
+
+// Moist soil with pump motor bursts: one or two samples off by several
+// hundred counts every half minute
+static std::vector<int> spikeTrace(int samples)
+{
+  std::vector<int> trace;
+  int base = rawForPercent(DEFAULT_DRY_THRESHOLD + 6);
+  for (int i = 0; i < samples; i++)
+  {
+    int value = base + noise(8);
+    if (i % 30 == 7 || i % 60 == 8)
+    {
+      value += 450 + noise(150);
+    }
+    trace.push_back(value);
+  }
+  return trace;
+}
+
+// Slowly drying soil that crosses the dry threshold once, with ADC noise
+static std::vector<int> dryingTrace(int samples)
+{
+  std::vector<int> trace;
+  int from = rawForPercent(DEFAULT_DRY_THRESHOLD + 5);
+  int to = rawForPercent(DEFAULT_DRY_THRESHOLD - 5);
+  for (int i = 0; i < samples; i++)
+  {
+    trace.push_back(from + (to - from) * i / samples + noise(25));
+  }
+  return trace;
+}
+
+// Sensor pulled out of the soil half way through
+static std::vector<int> airTrace(int samples)
+{
+  std::vector<int> trace;
+  for (int i = 0; i < samples; i++)
+  {
+    int base = i < samples / 2 ? rawForPercent(50) : DEFAULT_AIR_VALUE + 150;
+    trace.push_back(base + noise(8));
+  }
+  return trace;
+}
+
+static bool loadTrace(const char *path, std::vector<int> &trace)
+{
+  FILE *file = fopen(path, "r");
+  if (!file)
+  {
+    return false;
+  }
+  char line[128];
+  while (fgets(line, sizeof(line), file))
+  {
+    long columns[4];
+    int n = sscanf(line, "%ld,%ld,%ld,%ld", &columns[0], &columns[1], &columns[2], &columns[3]);
+    if (n == 1)
+    {
+      trace.push_back((int)columns[0]);
+    }
+    else if (n == 4)
+    {
+      trace.push_back((int)columns[2]);
+    }
+  }
+  fclose(file);
+  return true;
+}
+
+template <typename Filter>
+static TraceStats replay(Filter &filter, const std::vector<int> &trace, bool hysteresis)
+{
+  TraceStats stats;
+  ThresholdLatch latch;
+  bool wasDry = false;
+  int airStep = -1;
+  for (size_t i = 0; i < trace.size(); i++)
+  {
+    if (airStep < 0 && trace[i] >= DEFAULT_AIR_VALUE)
+    {
+      airStep = (int)i;
+    }
+    int raw = filter.update(trace[i]);
+    int percent = toPercent(raw);
+    bool dry = hysteresis ? latch.update(percent, DEFAULT_DRY_THRESHOLD, DEFAULT_FILTER.hysteresis)
+                          : percent <= DEFAULT_DRY_THRESHOLD;
+    if (dry && !wasDry)
+    {
+      stats.dryTriggers++;
+    }
+    stats.drySamples += dry ? 1 : 0;
+    wasDry = dry;
+    if (airStep >= 0 && stats.airDelay < 0 && raw >= DEFAULT_AIR_VALUE)
+    {
+      stats.airDelay = (int)i - airStep;
+    }
+  }
+  return stats;
+}
+
+static void compare(const char *name, const std::vector<int> &trace)
+{
+  MeanFilter mean;
+  MoistureFilter chain;
+  TraceStats before = replay(mean, trace, false);
+  TraceStats after = replay(chain, trace, true);
+  printf("%-10s %6zu samples | mean-of-5: %3d dry triggers, %5d dry samples, air delay %2d"
+         " | chain: %3d dry triggers, %5d dry samples, air delay %2d, %u rejected\n",
+         name, trace.size(), before.dryTriggers, before.drySamples, before.airDelay,
+         after.dryTriggers, after.drySamples, after.airDelay, chain.rejectedSamples());
+}
+
+void runFilterBench(const char *tracePath)
+{
+  printf("== Moisture filter: dry threshold %d%%, hysteresis %d%% ==\n",
+         DEFAULT_DRY_THRESHOLD, DEFAULT_FILTER.hysteresis);
+
+  if (tracePath)
+  {
+    std::vector<int> trace;
+    if (!loadTrace(tracePath, trace))
+    {
+      printf("cannot read %s\n", tracePath);
+      return;
+    }
+    compare("trace", trace);
+  }
+  else
+  {
+    compare("spikes", spikeTrace(86400));
+    compare("drying", dryingTrace(3600));
+    compare("air", airTrace(600));
+  }
+
+  // Cost per sample for a bank of channels
+  const int channels = 100;
+  const int rounds = 20000;
+  std::vector<MoistureFilter> bank(channels);
+  std::vector<int> input = spikeTrace(1024);
+  long long checksum = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (int r = 0; r < rounds; r++)
+  {
+    int raw = input[r % input.size()];
+    for (auto &filter : bank)
+    {
+      checksum += filter.update(raw);
+    }
+  }
+  double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+  printf("cost       %.1f ns per sample (%d channels, checksum %lld)\n",
+         ns / ((double)channels * rounds), channels, checksum);
+}
@@ -0,0 +1,176 @@
+// Cost of a log site on the control path: the old synchronous halLog()
+// into a 115200 baud UART (modelled: 128-byte FIFO, blocking once full)
+// against a LOG_INFO record. Then several threads flood the ring while one
+// drains it, checking that every record is either delivered intact and in
+// order or counted as dropped.
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+#include "Bench.h"
+#include "EventLog.h"
+#include "Hal.h"
+
+namespace
+{
+const double UART_US_PER_CHAR = 1e6 / 11520; // 115200 baud, 8N1
+const double UART_FIFO = 128;
+
+// Characters still in the FIFO and the time the writer spent blocked
+double uartQueued = 0;
+double uartBlockedUs = 0;
+size_t uartChars = 0;
+
+void uartSink(const char *message)
+{
+  size_t length = strlen(message);
+  uartChars += length;
+  uartQueued += length;
+  if (uartQueued > UART_FIFO)
+  {
+    uartBlockedUs += (uartQueued - UART_FIFO) * UART_US_PER_CHAR;
+    uartQueued = UART_FIFO;
+  }
+}
+
+void quietSink(const LogRecord &, const char *) {}
+
+double nowUs()
+{
+  return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// A burst like 16 zones switching their pumps in one tick, twice
+void compareBurst()
+{
+  const int zones = 16;
+  Hal saved = hal();
+  Hal uart = saved;
+  uart.log = uartSink;
+  installHal(uart);
+  uartQueued = 0;
+  uartBlockedUs = 0;
+  double start = nowUs();
+  for (int i = 0; i < zones; i++)
+  {
+    halLog("Zone %d pump ON - moisture: %d%%\n", i + 1, 29);
+    halLog("Zone %d pump OFF - moisture: %d%%\n", i + 1, 81);
+  }
+  double formatUs = nowUs() - start;
+  installHal(saved);
+
+  eventLog.drain(quietSink);
+  start = nowUs();
+  for (int i = 0; i < zones; i++)
+  {
+    LOG_INFO(LOG_PUMP_ON, i + 1, 29);
+    LOG_INFO(LOG_PUMP_OFF, i + 1, 81);
+  }
+  double recordUs = nowUs() - start;
+  eventLog.drain(quietSink);
+
+  printf("  %d-event burst, halLog to UART   %8.1f us (%zu chars, %.1f us formatting + %.0f us blocked)\n",
+         zones * 2, formatUs + uartBlockedUs, uartChars, formatUs, uartBlockedUs);
+  printf("  %d-event burst, LOG_INFO records %8.1f us, %.0f ns per site\n", zones * 2, recordUs,
+         recordUs * 1000 / (zones * 2));
+}
+
+int evaluated = 0;
+__attribute__((unused)) int sideEffect()
+{
+  return ++evaluated;
+}
+
+void checkStripping()
+{
+  uint32_t before = eventLog.nextSequence();
+  LOG_DEBUG(LOG_SENSOR_READING, sideEffect(), 2000, 50);
+  eventLog.drain(quietSink);
+  printf("  LOG_DEBUG at LOG_LEVEL %d: %s, arguments evaluated %d times\n", LOG_LEVEL,
+         eventLog.nextSequence() == before ? "compiled out" : "recorded", evaluated);
+}
+
+struct Delivered
+{
+  std::vector<long> lastSeen; // Per producer
+  unsigned long count = 0;
+  unsigned long outOfOrder = 0;
+};
+Delivered delivered;
+
+void checkingSink(const LogRecord &record, const char *)
+{
+  if (record.event != LOG_FIRST_TICK)
+  {
+    return; // LOG_DROPPED reports
+  }
+  int producer = record.args[0];
+  if (record.args[1] <= delivered.lastSeen[producer] || record.args[2] != record.args[1] * 3)
+  {
+    delivered.outOfOrder++;
+  }
+  delivered.lastSeen[producer] = record.args[1];
+  delivered.count++;
+}
+
+// Producers write bursts of 16 records with pauseUs between them
+void flood(int producers, int perProducer, int pauseUs, int drainEveryUs)
+{
+  delivered = Delivered();
+  delivered.lastSeen.assign(producers, -1);
+  uint32_t droppedBefore = eventLog.dropped();
+  std::atomic<int> running(producers);
+  std::atomic<unsigned long> accepted(0);
+
+  std::vector<std::thread> threads;
+  for (int p = 0; p < producers; p++)
+  {
+    threads.emplace_back([p, perProducer, pauseUs, &running, &accepted]() {
+      unsigned long ok = 0;
+      for (int i = 0; i < perProducer; i++)
+      {
+        if (i % 16 == 0)
+        {
+          std::this_thread::sleep_for(std::chrono::microseconds(pauseUs));
+        }
+        const int32_t args[] = {p, i, i * 3};
+        ok += eventLog.write(LOG_FIRST_TICK, LOG_LEVEL_INFO, args, 3);
+      }
+      accepted += ok;
+      running--;
+    });
+  }
+  double start = nowUs();
+  while (running > 0)
+  {
+    eventLog.drain(checkingSink);
+    std::this_thread::sleep_for(std::chrono::microseconds(drainEveryUs));
+  }
+  for (std::thread &thread : threads)
+  {
+    thread.join();
+  }
+  eventLog.drain(checkingSink);
+  double seconds = (nowUs() - start) / 1e6;
+
+  unsigned long dropped = eventLog.dropped() - droppedBefore;
+  unsigned long total = (unsigned long)producers * perProducer;
+  bool consistent = delivered.count == accepted && accepted + dropped == total && delivered.outOfOrder == 0;
+  printf("  %d producers, drain every %5d us: %6lu delivered, %6lu dropped (%5.1f%%), %4.0f k records/s, %s\n",
+         producers, drainEveryUs, delivered.count, dropped, 100.0 * dropped / total, total / seconds / 1e3,
+         consistent ? "consistent" : "INCONSISTENT");
+}
+} // namespace
+
+void runLogBench()
+{
+  printf("== Event log ==\n");
+  compareBurst();
+  checkStripping();
+  flood(1, 20000, 200, 100);
+  flood(3, 20000, 200, 100);
+  flood(3, 20000, 200, 5000); // Drain starved: the ring overflows
+}
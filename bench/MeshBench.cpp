@@ -0,0 +1,245 @@
+// Runs MeshNode and MeshAggregator over UDP on 127.0.0.1 for a simulated
+// hour: many nodes with drifting moisture, pump cycles and sensor noise,
+// plus config changes forwarded from the aggregator. Reports bytes on the
+// wire against sending a full frame every batch window, how often the
+// aggregator's view matches the nodes, and config delivery, without and
+// with frame loss.
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include "Bench.h"
+#include "MeshAggregator.h"
+#include "MeshNode.h"
+#include "UdpLoopbackTransport.h"
+
+namespace
+{
+const unsigned long STEP_MS = 100;
+const unsigned long RUN_MS = 3600000;
+const unsigned long CHECK_MS = 10000;
+const unsigned long CHECK_DELAY_MS = 300;
+const unsigned long CONFIG_EVERY_MS = 5000;
+
+struct SimZone
+{
+  double moisture; // %
+  unsigned long pumpUntil;
+  unsigned long cooldownUntil;
+};
+
+struct SimNode
+{
+  std::unique_ptr<UdpLoopbackTransport> transport;
+  std::unique_ptr<MeshNode> node;
+  SystemSnapshot snapshot;
+  SystemSnapshot checked; // As of the last checked frame
+  unsigned long framesBefore;
+  unsigned long nextCheck;
+  unsigned long checkAt; // 0: no check pending
+  std::vector<SimZone> zones;
+  unsigned long configsApplied;
+  unsigned long lastConfigAt;
+};
+
+uint32_t randomState = 7;
+int noise(int range)
+{
+  randomState = randomState * 1664525u + 1013904223u;
+  return (int)((randomState >> 8) % (uint32_t)(2 * range + 1)) - range;
+}
+
+// MeshNode's handler has no context pointer; the bench polls one node at a time
+SimNode *polling = nullptr;
+unsigned long pollingNow = 0;
+
+bool applyConfig(const ZoneConfigRequest &request)
+{
+  ZoneSnapshot *zone = const_cast<ZoneSnapshot *>(polling->snapshot.findZone(request.zoneId));
+  if (!zone)
+  {
+    return false;
+  }
+  if (request.wetThreshold >= 0)
+  {
+    zone->wetThreshold = request.wetThreshold;
+  }
+  polling->configsApplied++;
+  polling->lastConfigAt = pollingNow;
+  return true;
+}
+
+void stepZones(SimNode &sim, unsigned long now)
+{
+  SystemSnapshot &snapshot = sim.snapshot;
+  for (int i = 0; i < snapshot.zoneCount; i++)
+  {
+    SimZone &soil = sim.zones[i];
+    ZoneSnapshot &zone = snapshot.zones[i];
+    bool pumping = (long)(soil.pumpUntil - now) > 0;
+    soil.moisture += pumping ? 0.2 * STEP_MS / 100.0 : -0.00005 * STEP_MS * (1 + i % 4);
+    if (!pumping && zone.pumpState)
+    {
+      soil.cooldownUntil = now + 300000;
+    }
+    if (!pumping && soil.moisture < zone.dryThreshold && (long)(soil.cooldownUntil - now) <= 0)
+    {
+      soil.pumpUntil = now + 30000;
+      pumping = true;
+    }
+    zone.pumpState = pumping;
+    zone.inCooldown = !pumping && (long)(soil.cooldownUntil - now) > 0;
+    zone.cooldownRemainingSec = zone.inCooldown ? (soil.cooldownUntil - now) / 1000 : 0;
+    zone.moisturePercent = soil.moisture < 0 ? 0 : (soil.moisture > 100 ? 100 : (int)soil.moisture);
+    // Filtered readings still wander a few counts
+    zone.moistureRaw = 3200 - zone.moisturePercent * 17 + noise(3) + (noise(50) == 0 ? noise(40) : 0);
+  }
+}
+
+struct MeshResult
+{
+  unsigned long nodeBytes;
+  unsigned long nodeFrames;
+  unsigned long fullFrames;
+  unsigned long naiveBytes;
+  unsigned long checks;
+  unsigned long matching;
+  unsigned long configsForwarded;
+  unsigned long configsApplied;
+  double pollNsPerFrame;
+};
+
+MeshResult runMesh(int nodeCount, int zonesPerNode, double lossRate)
+{
+  MeshResult result = {};
+  UdpLoopbackTransport aggregatorTransport(0, lossRate, 99);
+  if (!aggregatorTransport.begin(0))
+  {
+    printf("cannot bind a UDP socket on 127.0.0.1\n");
+    return result;
+  }
+  MeshAggregator aggregator(aggregatorTransport);
+
+  std::vector<SimNode> sims(nodeCount);
+  for (int n = 0; n < nodeCount; n++)
+  {
+    SimNode &sim = sims[n];
+    sim.transport.reset(new UdpLoopbackTransport(aggregatorTransport.port(), lossRate, 1000 + n));
+    sim.transport->begin(0);
+    sim.node.reset(new MeshNode(*sim.transport, (uint16_t)(100 + n)));
+    sim.node->setConfigHandler(applyConfig);
+    sim.snapshot = SystemSnapshot();
+    sim.snapshot.zoneCount = zonesPerNode;
+    for (int i = 0; i < zonesPerNode; i++)
+    {
+      ZoneSnapshot &zone = sim.snapshot.zones[i];
+      zone.id = i + 1;
+      snprintf(zone.name, sizeof(zone.name), "Node %d bed %d", n, i + 1);
+      zone.wetThreshold = 80;
+      zone.dryThreshold = 30;
+      sim.zones.push_back({30.0 + (n * 7 + i * 13) % 50, 0, 0});
+    }
+    sim.framesBefore = 0;
+    sim.nextCheck = CHECK_MS;
+    sim.checkAt = 0;
+  }
+
+  size_t fullFrameBytes = MESH_HEADER_SIZE + 3 + zonesPerNode * MESH_ZONE_MAX_SIZE;
+  double pollNs = 0;
+  unsigned long nextConfig = CONFIG_EVERY_MS;
+  int configTarget = 0;
+
+  for (unsigned long now = STEP_MS; now <= RUN_MS; now += STEP_MS)
+  {
+    for (SimNode &sim : sims)
+    {
+      stepZones(sim, now);
+      polling = &sim;
+      pollingNow = now;
+      sim.node->poll(now, sim.snapshot);
+    }
+    auto start = std::chrono::steady_clock::now();
+    aggregator.poll(now);
+    pollNs += std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+    if (now >= nextConfig)
+    {
+      SimNode &sim = sims[configTarget++ % nodeCount];
+      ZoneConfigRequest request = {1, 70 + (int)(now / CONFIG_EVERY_MS) % 20, -1, -1, -1, -1, -1, -1, -1};
+      if (aggregator.forwardConfig(sim.node->id(), request, now))
+      {
+        result.configsForwarded++;
+      }
+      nextConfig += CONFIG_EVERY_MS;
+    }
+
+    // Every CHECK_MS, per node: what its latest frame carried, compared once
+    // SYNC and the full frame had time to arrive
+    for (SimNode &sim : sims)
+    {
+      if (sim.checkAt == 0 && now >= sim.nextCheck && sim.node->framesSent != sim.framesBefore)
+      {
+        sim.checked = sim.snapshot;
+        sim.checkAt = now + CHECK_DELAY_MS;
+        sim.nextCheck += CHECK_MS;
+      }
+      sim.framesBefore = sim.node->framesSent;
+      if (sim.checkAt != 0 && now >= sim.checkAt)
+      {
+        sim.checkAt = 0;
+        for (int i = 0; i < zonesPerNode; i++)
+        {
+          MeshZoneStatus seen;
+          MeshZoneStatus actual = meshZoneStatus(sim.checked.zones[i]);
+          bool found = aggregator.zoneStatus(sim.node->id(), actual.zoneId, seen);
+          result.checks++;
+          if (found && meshChanges(actual, seen) == 0)
+          {
+            result.matching++;
+          }
+        }
+      }
+    }
+  }
+
+  for (SimNode &sim : sims)
+  {
+    result.nodeBytes += sim.node->bytesSent;
+    result.nodeFrames += sim.node->framesSent;
+    result.fullFrames += sim.node->fullFrames;
+    result.configsApplied += sim.configsApplied;
+  }
+  result.naiveBytes = (unsigned long)(RUN_MS / MESH_BATCH_MS) * nodeCount * fullFrameBytes;
+  result.pollNsPerFrame = aggregator.framesReceived ? pollNs / aggregator.framesReceived : 0;
+
+  printf("loss %.0f%%: %lu frames from nodes (%lu full), %lu received, %lu syncs, %lu rejected\n",
+         lossRate * 100, result.nodeFrames, result.fullFrames, aggregator.framesReceived, aggregator.syncsSent,
+         aggregator.framesRejected);
+  printf("  bytes         %lu sent, %.1f B/s per node, %.1f%% of a full frame every %lums\n", result.nodeBytes,
+         result.nodeBytes * 1000.0 / RUN_MS / nodeCount, 100.0 * result.nodeBytes / result.naiveBytes, MESH_BATCH_MS);
+  printf("  view          %.2f%% of zones match the node %lums after it sent\n", 100.0 * result.matching / result.checks, CHECK_DELAY_MS);
+  printf("  config        %lu forwarded, %lu applied, %lu acked, %lu dropped, %lu frames incl. retries\n",
+         result.configsForwarded, result.configsApplied, aggregator.configsAcked, aggregator.configsDropped,
+         aggregator.configsSent);
+  printf("  aggregator    %.0f ns per received frame (poll incl. empty reads)\n", result.pollNsPerFrame);
+  return result;
+}
+} // namespace
+
+void runMeshBench(int nodeCount, int zonesPerNode)
+{
+  if (zonesPerNode > MAX_ZONES)
+  {
+    zonesPerNode = MAX_ZONES;
+  }
+  printf("== Mesh aggregation over UDP loopback: %d nodes x %d zones, %lu min ==\n", nodeCount, zonesPerNode,
+         RUN_MS / 60000);
+  Hal quiet = hal();
+  quiet.log = nullptr; // Join messages
+  installHal(quiet);
+  runMesh(nodeCount, zonesPerNode, 0.0);
+  runMesh(nodeCount, zonesPerNode, 0.1);
+}
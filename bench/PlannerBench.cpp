@@ -0,0 +1,174 @@
+// Runs the ZoneController against SoilSimulation with a day/night
+// evaporation cycle, once on thresholds only and once with the
+// WateringPlanner (with a flat and with a matching weather profile).
+// Reports when pumps start, water used and the driest zone, plus the cost
+// of a control tick with the planner forecasting every evaluated zone.
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+#include "Bench.h"
+#include "SimulatedHal.h"
+#include "ZoneController.h"
+
+namespace
+{
+const uint32_t SIM_WALL_START = 1780272000; // 2026-06-01 00:00 local
+const unsigned long STEP_MS = 1000;
+
+SimClock *simClock = nullptr;
+
+uint32_t simWallClock()
+{
+  return SIM_WALL_START + simClock->nowMs / 1000;
+}
+
+// Evaporation relative to the daily mean: low at night, peak early afternoon
+double evaporationAt(double hour)
+{
+  double day = sin(M_PI * (hour - 6.0) / 14.0);
+  return 0.35 + 1.9 * (hour >= 6.0 && hour <= 20.0 ? day : 0.0);
+}
+
+double meanEvaporation()
+{
+  double sum = 0;
+  for (int minute = 0; minute < 1440; minute++)
+  {
+    sum += evaporationAt(minute / 60.0);
+  }
+  return sum / 1440;
+}
+
+bool inWindow(int hour)
+{
+  for (const PlanWindow &window : PLAN_WINDOWS)
+  {
+    if (hour * 60 >= window.startMin && hour * 60 < window.endMin)
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
+void runPlanned(int zoneCount, double days, bool planner, bool weather)
+{
+  SimClock clock;
+  simClock = &clock;
+  SoilSimulation soil(zoneCount);
+  MemoryKeyValueStore store;
+  installHal({&clock, &soil, &soil, &store, nullptr});
+
+  ZoneController controller;
+  char name[ZONE_NAME_LEN];
+  for (int i = 0; i < zoneCount; i++)
+  {
+    snprintf(name, sizeof(name), "Sim %d", i + 1);
+    controller.addZone(WateringZone(i + 1, name, SoilSimulation::sensorPin(i), SoilSimulation::pumpPin(i)));
+  }
+  controller.init();
+  if (planner)
+  {
+    controller.setWallClock(simWallClock);
+  }
+  if (weather)
+  {
+    WeatherProfile profile;
+    double mean = meanEvaporation();
+    for (int hour = 0; hour < 24; hour++)
+    {
+      profile.etPercent[hour] = (uint8_t)lround(evaporationAt(hour + 0.5) / mean * 100.0);
+    }
+    controller.submitWeather(profile);
+  }
+
+  double mean = meanEvaporation();
+  unsigned long startsByHour[24] = {};
+  std::vector<unsigned long> lastStarts(zoneCount, 0);
+  double driest = 1.0;
+  double tickNs = 0;
+  unsigned long ticks = 0;
+  unsigned long endMs = (unsigned long)(days * 86400000.0);
+  // The first day learns drying rates, statistics start after it
+  unsigned long measureFrom = 86400000UL;
+  double waterBefore = 0;
+
+  for (unsigned long now = 0; now < endMs; now += STEP_MS)
+  {
+    clock.nowMs = now;
+    int hour = (int)((now / 3600000UL) % 24);
+    soil.evaporationScale = evaporationAt((now % 86400000UL) / 3600000.0) / mean;
+    soil.advance(now);
+
+    auto start = std::chrono::steady_clock::now();
+    controller.tick(now);
+    tickNs += std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    ticks++;
+
+    if (now == measureFrom)
+    {
+      for (int i = 0; i < zoneCount; i++)
+      {
+        waterBefore += soil.soil(i).pumpSeconds * soil.soil(i).pumpPerS;
+      }
+    }
+    for (int i = 0; i < zoneCount; i++)
+    {
+      if (soil.soil(i).pumpStarts != lastStarts[i])
+      {
+        lastStarts[i] = soil.soil(i).pumpStarts;
+        if (now >= measureFrom)
+        {
+          startsByHour[hour]++;
+        }
+      }
+      if (now >= measureFrom && soil.soil(i).moisture < driest)
+      {
+        driest = soil.soil(i).moisture;
+      }
+    }
+  }
+
+  unsigned long starts = 0, midday = 0, windows = 0;
+  for (int hour = 0; hour < 24; hour++)
+  {
+    starts += startsByHour[hour];
+    midday += hour >= 10 && hour < 17 ? startsByHour[hour] : 0;
+    windows += inWindow(hour) ? startsByHour[hour] : 0;
+  }
+  double water = -waterBefore;
+  for (int i = 0; i < zoneCount; i++)
+  {
+    water += soil.soil(i).pumpSeconds * soil.soil(i).pumpPerS;
+  }
+  double measuredDays = days - 1.0;
+
+  printf("%s\n", !planner ? "thresholds only" : (weather ? "planner, weather profile" : "planner, flat profile"));
+  printf("  pump starts   %lu (%.1f per zone per day), %.0f%% in 10-17h, %.0f%% in windows\n", starts,
+         starts / (double)zoneCount / measuredDays, starts ? 100.0 * midday / starts : 0.0,
+         starts ? 100.0 * windows / starts : 0.0);
+  printf("  water used    %.3f field capacities per zone per day\n", water / zoneCount / measuredDays);
+  printf("  driest zone   %.0f%% of field capacity (dry threshold %d%%)\n", driest * 100.0, DEFAULT_DRY_THRESHOLD);
+  printf("  max pumps on  %d at once\n", soil.maxPumpsOn);
+  printf("  tick cost     %.0f ns mean\n", tickNs / ticks);
+}
+} // namespace
+
+void runPlannerBench(int zoneCount, double days)
+{
+  if (zoneCount > MAX_ZONES)
+  {
+    zoneCount = MAX_ZONES;
+  }
+  if (days < 3)
+  {
+    days = 3; // One day to learn, then at least two measured
+  }
+  printf("== Watering planner: %d zones, %.0f days, day/night evaporation ==\n", zoneCount, days);
+  runPlanned(zoneCount, days, false, false);
+  runPlanned(zoneCount, days, true, false);
+  runPlanned(zoneCount, days, true, true);
+}
@@ -0,0 +1,188 @@
+// Replays sensor traces (SensorTrace.h) through the real ZoneController.
+// With --trace FILE a trace downloaded from a device (GET /api/trace) is
+// replayed once as recorded. Without one, a SoilSimulation run is recorded
+// the way the firmware does it (sample observer, pump GPIO wrapper, buffer
+// drained every few seconds, control task waking a little late), then
+// replayed as recorded, with the sensors moved to a backend's addresses,
+// and with the wet threshold lowered, to show that a changed decision
+// shows up as a mismatch.
+
+#include <cstdio>
+#include <vector>
+
+#include "Bench.h"
+#include "SimulatedHal.h"
+#include "TraceReplay.h"
+#include "ZoneController.h"
+
+namespace
+{
+const unsigned long DRAIN_MS = 5000; // Loop task cadence on the device
+const int MAX_WAKE_DELAY_MS = 3;     // Control task wakeups are this late at most
+
+TraceRecorder recorder;
+
+void recordSample(int pin, int raw, unsigned long now)
+{
+  recorder.sample(pin, raw, now);
+}
+
+uint32_t jitterState = 11;
+unsigned long wakeDelay()
+{
+  jitterState = jitterState * 1664525u + 1013904223u;
+  return (jitterState >> 8) % (MAX_WAKE_DELAY_MS + 1);
+}
+
+bool anyPumpOn(const SystemSnapshot &snapshot)
+{
+  for (int i = 0; i < snapshot.zoneCount; i++)
+  {
+    if (snapshot.zones[i].pumpState)
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
+std::vector<uint8_t> recordSimulation(int zoneCount, double days)
+{
+  SimClock clock;
+  SoilSimulation soil(zoneCount);
+  MemoryKeyValueStore store;
+  recorder.wrap(&soil);
+  installHal({&clock, &soil, &recorder, &store, nullptr});
+  WateringZone::resetSensors();
+  WateringZone::setSampleObserver(recordSample);
+
+  ZoneController controller;
+  char name[ZONE_NAME_LEN];
+  for (int i = 0; i < zoneCount; i++)
+  {
+    snprintf(name, sizeof(name), "Sim %d", i + 1);
+    controller.addZone(WateringZone(i + 1, name, SoilSimulation::sensorPin(i), SoilSimulation::pumpPin(i)));
+  }
+  controller.init();
+
+  // Started at the first snapshot without a running pump, like drainTrace() in TraceRoutes.cpp
+  static SystemSnapshot snapshot;
+  std::vector<uint8_t> trace;
+  uint8_t chunk[TRACE_BUFFER_SIZE];
+  unsigned long endMs = (unsigned long)(days * 86400000.0);
+  unsigned long now = 0;
+  unsigned long lastDrain = 0;
+  while (now < endMs)
+  {
+    clock.nowMs = now;
+    soil.advance(now);
+    controller.tick(now);
+    if (!recorder.recording() && controller.readSnapshot(snapshot) && !anyPumpOn(snapshot))
+    {
+      TraceZone zones[MAX_ZONES];
+      for (int i = 0; i < snapshot.zoneCount; i++)
+      {
+        zones[i] = traceZone(snapshot.zones[i], SoilSimulation::sensorPin(i), SoilSimulation::pumpPin(i), DEFAULT_FILTER);
+      }
+      TraceHeader header = {TRACE_MAGIC, TRACE_VERSION, (uint8_t)snapshot.zoneCount,
+                            (uint16_t)SENSOR_SAMPLE_INTERVAL_MS, (uint32_t)snapshot.takenAtMs, 0};
+      recorder.start(header, zones, snapshot.zoneCount);
+    }
+    if (now - lastDrain >= DRAIN_MS)
+    {
+      size_t length = recorder.drain(chunk, sizeof(chunk));
+      trace.insert(trace.end(), chunk, chunk + length);
+      lastDrain = now;
+    }
+    unsigned long next = controller.nextWakeTime(now) + wakeDelay();
+    now = (long)(next - now) > 0 ? next : now + 1;
+  }
+  recorder.stop();
+  size_t length = recorder.drain(chunk, sizeof(chunk));
+  trace.insert(trace.end(), chunk, chunk + length);
+
+  WateringZone::setSampleObserver(nullptr);
+  if (recorder.lostRecords())
+  {
+    printf("recording lost %lu records\n", (unsigned long)recorder.lostRecords());
+  }
+  return trace;
+}
+
+void lowerWetThreshold(TraceZone &zone)
+{
+  zone.settings.wetThreshold -= 10;
+}
+
+// As if the sensors had been read through the second multiplexer or bus ADC
+void moveSensorToBackend(TraceZone &zone)
+{
+  zone.sensorPin = (uint8_t)sensorAddress(1, (zone.id - 1) % SENSOR_BACKEND_CHANNELS);
+}
+
+bool loadTrace(const char *path, std::vector<uint8_t> &out)
+{
+  FILE *file = fopen(path, "rb");
+  if (!file)
+  {
+    return false;
+  }
+  uint8_t chunk[4096];
+  size_t length;
+  while ((length = fread(chunk, 1, sizeof(chunk), file)) > 0)
+  {
+    out.insert(out.end(), chunk, chunk + length);
+  }
+  fclose(file);
+  return true;
+}
+
+// Returns 1 unless the replay made exactly the recorded decisions (or, for
+// changed settings, at least one different one)
+int checkReplay(const ReplayReport &report, bool expectMatch)
+{
+  bool matches = !report.error && report.firstMismatchMs < 0 && report.matched == report.recorded &&
+                 report.matched == report.replayed;
+  bool pass = !report.error && matches == expectMatch;
+  printf("check            %s: %s\n", expectMatch ? "all decisions match" : "decisions change",
+         pass ? "ok" : "FAILED");
+  return pass ? 0 : 1;
+}
+} // namespace
+
+int runReplayBench(const char *tracePath, int zoneCount, double days)
+{
+  if (tracePath)
+  {
+    printf("== Sensor trace replay: %s ==\n", tracePath);
+    std::vector<uint8_t> trace;
+    if (!loadTrace(tracePath, trace))
+    {
+      printf("cannot read %s\n", tracePath);
+      return 1;
+    }
+    ReplayReport report = replayTrace(trace.data(), trace.size());
+    printReplayReport("as recorded", report);
+    return checkReplay(report, true);
+  }
+
+  zoneCount = zoneCount > MAX_ZONES ? MAX_ZONES : zoneCount;
+  printf("== Sensor trace record and replay: %d simulated zones, %.2f days ==\n", zoneCount, days);
+  std::vector<uint8_t> trace = recordSimulation(zoneCount, days);
+
+  ReplayReport report = replayTrace(trace.data(), trace.size());
+  // Fixed-size records: u32 time, u8 zone, u8 type, u16 raw
+  size_t records = report.samples + report.recorded;
+  printf("trace size       %zu bytes, %.2f bytes per record (fixed records: 8, CSV lines: ~16)\n",
+         trace.size(), (double)trace.size() / records);
+  printf("flash rate       %.0f bytes per zone per hour\n",
+         trace.size() / (double)zoneCount / (report.durationMs / 3600000.0));
+  printReplayReport("as recorded", report);
+  int failures = checkReplay(report, true);
+  ReplayReport external = replayTrace(trace.data(), trace.size(), moveSensorToBackend);
+  printReplayReport("sensors on a backend", external);
+  failures += checkReplay(external, true);
+  ReplayReport lowered = replayTrace(trace.data(), trace.size(), lowerWetThreshold);
+  printReplayReport("wet threshold -10%", lowered);
+  return failures + checkReplay(lowered, false);
+}
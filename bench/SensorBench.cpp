@@ -0,0 +1,285 @@
+// Scan rate of external sensor backends for 16 zones: channels converted
+// one at a time (select, settle, read per zone; start, wait, read per zone)
+// against the batched and pipelined scheduling of the backends. The mux is
+// two 74HC4051 in front of a SoilSimulation with its settling and ADC times
+// modelled; the ADCs are four simulated ADS1115 on a 400 kHz I2C bus with
+// modelled transfer and conversion times, the oscillator 8 % slow so early
+// reads show up as stale. Then 16 zones run a simulated day on the ADS1115s
+// through the real ZoneController.
+
+#include <chrono>
+#include <cstdio>
+
+#include "Ads1115Backend.h"
+#include "Bench.h"
+#include "MuxSensorBackend.h"
+#include "SimulatedHal.h"
+#include "SimulatedI2c.h"
+#include "ZoneController.h"
+
+namespace
+{
+const int ZONES = 16;
+const double MODEL_ADC_READ_US = 40; // analogRead() on the C3, assumed
+const int MUX_SCANS = 20000;
+const int ADS_SCANS = 200;
+const int SELECT_PINS[MUX_SELECT_BITS] = {100, 101, 102};
+const int MUX_ADC_PINS[] = {110, 111};
+const uint8_t ADS_ADDRESSES[] = {0x48, 0x49, 0x4A, 0x4B};
+
+// Two multiplexers: select lines and ADC pins in, the selected zone's sensor out
+class SimulatedMux : public HalAdc, public HalGpio
+{
+public:
+  explicit SimulatedMux(SoilSimulation &soil) : soil(soil) {}
+
+  int read(int pin) override
+  {
+    int chip = pin == MUX_ADC_PINS[0] ? 0 : 1;
+    return soil.read(SoilSimulation::sensorPin(chip * MUX_INPUTS + selected));
+  }
+
+  void setInput(int) override {}
+  void setOutput(int) override {}
+  void write(int pin, bool high) override
+  {
+    for (int bit = 0; bit < MUX_SELECT_BITS; bit++)
+    {
+      if (pin == SELECT_PINS[bit])
+      {
+        selected = high ? selected | 1 << bit : selected & ~(1 << bit);
+        return;
+      }
+    }
+    soil.write(pin, high);
+  }
+
+private:
+  SoilSimulation &soil;
+  int selected = 0;
+};
+
+// Results of a scan, checked against the soil each channel belongs to
+struct Collected
+{
+  SoilSimulation *soil;
+  int count;
+  int wrong;
+  int failed;
+};
+
+void collect(void *context, int channel, int raw)
+{
+  Collected &out = *static_cast<Collected *>(context);
+  out.count++;
+  if (raw == SENSOR_READ_FAILED)
+  {
+    out.failed++;
+  }
+  else if (raw != out.soil->read(SoilSimulation::sensorPin(channel)))
+  {
+    out.wrong++;
+  }
+}
+
+void printMuxScan(const char *label, MuxSensorBackend &mux, bool batched, Collected &out)
+{
+  uint32_t settles = mux.settles();
+  uint32_t writes = mux.selectWrites();
+  auto start = std::chrono::steady_clock::now();
+  for (int scan = 0; scan < MUX_SCANS; scan++)
+  {
+    for (int channel = 0; channel < ZONES; channel++)
+    {
+      mux.request(channel);
+      if (!batched)
+      {
+        mux.poll(0, collect, &out);
+      }
+    }
+    mux.poll(0, collect, &out);
+  }
+  double wallNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+  double settlesPerScan = (double)(mux.settles() - settles) / MUX_SCANS;
+  double scanUs = settlesPerScan * MUX_SETTLE_US + ZONES * MODEL_ADC_READ_US;
+  printf("%-22s %5.1f settles %5.1f select writes  %6.0f us/scan  %6.0f samples/s per zone  %4.0f ns CPU per channel\n",
+         label, settlesPerScan, (double)(mux.selectWrites() - writes) / MUX_SCANS, scanUs, 1e6 / scanUs,
+         wallNs / MUX_SCANS / ZONES);
+}
+
+void runMuxScans()
+{
+  SimClock clock;
+  SoilSimulation soil(ZONES);
+  soil.noiseCounts = 0;
+  SimulatedMux io(soil);
+  MemoryKeyValueStore store;
+  installHal({&clock, &io, &io, &store, nullptr});
+
+  MuxSensorBackend mux(SELECT_PINS, MUX_ADC_PINS, 2);
+  mux.begin();
+  printf("-- 2x 74HC4051, %u us settling, %.0f us per conversion --\n", (unsigned)MUX_SETTLE_US, MODEL_ADC_READ_US);
+  Collected out = {&soil, 0, 0, 0};
+  printMuxScan("one channel at a time", mux, false, out);
+  printMuxScan("batched", mux, true, out);
+  printf("results                %d, %d wrong\n", out.count, out.wrong);
+}
+
+// One scan of all channels, requested one at a time or all at once
+void adsScan(SimClock &clock, Ads1115Backend &ads, bool pipelined, Collected &out)
+{
+  int target = out.count + ZONES;
+  for (int channel = 0; channel < ZONES; channel++)
+  {
+    ads.request(channel);
+    if (!pipelined || channel == ZONES - 1)
+    {
+      int until = pipelined ? target : out.count + 1;
+      while (out.count < until)
+      {
+        ads.poll(clock.nowMs, collect, &out);
+        unsigned long at;
+        if (out.count >= until || !ads.nextPollTime(clock.nowMs, at))
+        {
+          break;
+        }
+        clock.nowMs = (long)(at - clock.nowMs) > 0 ? at : clock.nowMs;
+      }
+    }
+  }
+}
+
+void runAdsScans(uint8_t dataRate, unsigned sps)
+{
+  SimClock clock;
+  SoilSimulation soil(ZONES);
+  soil.noiseCounts = 0;
+  MemoryKeyValueStore store;
+  installHal({&clock, &soil, &soil, &store, nullptr});
+
+  SimulatedI2cBus bus(clock);
+  std::vector<SimulatedAds1115 *> devices;
+  for (int i = 0; i < ADS_MAX_DEVICES; i++)
+  {
+    int pins[ADS_INPUTS];
+    for (int input = 0; input < ADS_INPUTS; input++)
+    {
+      pins[input] = SoilSimulation::sensorPin(i * ADS_INPUTS + input);
+    }
+    devices.push_back(new SimulatedAds1115(ADS_ADDRESSES[i], &soil, pins));
+    bus.attach(devices.back());
+  }
+  Ads1115Backend ads(bus, ADS_ADDRESSES, ADS_MAX_DEVICES, dataRate);
+  ads.begin();
+  printf("-- 4x ADS1115 at %u SPS (%lu ms per conversion with margin), I2C 400 kHz --\n", sps, ads.conversionMs());
+
+  Collected out = {&soil, 0, 0, 0};
+  for (int pipelined = 0; pipelined < 2; pipelined++)
+  {
+    unsigned long startMs = clock.nowMs;
+    double busUs = bus.busyUs;
+    unsigned long transactions = bus.transactions;
+    for (int scan = 0; scan < ADS_SCANS; scan++)
+    {
+      adsScan(clock, ads, pipelined, out);
+      clock.nowMs++; // The next scan starts on a later tick
+    }
+    double scanMs = (double)(clock.nowMs - startMs) / ADS_SCANS - 1;
+    double scanBusUs = (bus.busyUs - busUs) / ADS_SCANS;
+    printf("%-22s %6.1f ms/scan  %6.1f samples/s per zone  %5.0f us bus/scan (%4.1f %%)  %4.1f transfers/scan\n",
+           pipelined ? "pipelined" : "one channel at a time", scanMs, 1000.0 / scanMs, scanBusUs,
+           scanBusUs / (scanMs * 10), (double)(bus.transactions - transactions) / ADS_SCANS);
+  }
+  unsigned long stale = 0;
+  for (SimulatedAds1115 *device : devices)
+  {
+    stale += device->staleReads;
+    delete device;
+  }
+  printf("results                %d, %d wrong, %d failed, %lu stale reads\n", out.count, out.wrong, out.failed, stale);
+}
+
+unsigned long samplesSeen = 0;
+void countSample(int, int, unsigned long)
+{
+  samplesSeen++;
+}
+
+void runAdsZones(double days)
+{
+  SimClock clock;
+  SoilSimulation soil(ZONES);
+  MemoryKeyValueStore store;
+  installHal({&clock, &soil, &soil, &store, nullptr});
+
+  SimulatedI2cBus bus(clock);
+  std::vector<SimulatedAds1115 *> devices;
+  for (int i = 0; i < ADS_MAX_DEVICES; i++)
+  {
+    int pins[ADS_INPUTS];
+    for (int input = 0; input < ADS_INPUTS; input++)
+    {
+      pins[input] = SoilSimulation::sensorPin(i * ADS_INPUTS + input);
+    }
+    devices.push_back(new SimulatedAds1115(ADS_ADDRESSES[i], &soil, pins));
+    bus.attach(devices.back());
+  }
+  Ads1115Backend ads(bus, ADS_ADDRESSES, ADS_MAX_DEVICES);
+  ads.begin();
+
+  WateringZone::resetSensors();
+  int backend = WateringZone::addSensorBackend(&ads);
+  samplesSeen = 0;
+  WateringZone::setSampleObserver(countSample);
+  ZoneController controller;
+  char name[ZONE_NAME_LEN];
+  for (int i = 0; i < ZONES; i++)
+  {
+    snprintf(name, sizeof(name), "ADS %d", i + 1);
+    controller.addZone(WateringZone(i + 1, name, sensorAddress(backend, i), SoilSimulation::pumpPin(i)));
+  }
+  controller.init();
+
+  unsigned long ticks = 0;
+  unsigned long endMs = (unsigned long)(days * 86400000.0);
+  unsigned long now = 0;
+  while (now < endMs)
+  {
+    clock.nowMs = now;
+    soil.advance(now);
+    controller.tick(now);
+    ticks++;
+    unsigned long next = controller.nextWakeTime(now);
+    now = (long)(next - now) > 0 ? next : now + 1;
+  }
+  WateringZone::setSampleObserver(nullptr);
+
+  unsigned long starts = 0;
+  for (int i = 0; i < ZONES; i++)
+  {
+    starts += soil.soil(i).pumpStarts;
+  }
+  unsigned long stale = 0;
+  for (SimulatedAds1115 *device : devices)
+  {
+    stale += device->staleReads;
+    delete device;
+  }
+  double hours = days * 24;
+  printf("-- %d zones on 4x ADS1115 through ZoneController, %.1f days --\n", ZONES, days);
+  printf("samples                %.0f per zone per hour (interval %d ms), %lu stale reads\n",
+         samplesSeen / (double)ZONES / hours, SENSOR_SAMPLE_INTERVAL_MS, stale);
+  printf("control task           %.0f wakeups per hour, %lu pump starts\n", ticks / hours, starts);
+  WateringZone::resetSensors();
+}
+} // namespace
+
+void runSensorBench(double days)
+{
+  printf("== External sensor scan, %d zones ==\n", ZONES);
+  runMuxScans();
+  runAdsScans(ADS_RATE_860, 860);
+  runAdsScans(ADS_RATE_128, 128);
+  runAdsZones(days);
+}
@@ -0,0 +1,91 @@
+#include "SimulatedHal.h"
+#include <math.h>
+
+SoilSimulation::SoilSimulation(int zoneCount, uint32_t seed) : lastMs(0), random(seed)
+{
+  soils.resize(zoneCount);
+  for (auto &soil : soils)
+  {
+    soil = Soil();
+    soil.moisture = 0.3 + 0.5 * nextUniform();
+    // Drying from 80% to 30% takes roughly one to three days
+    soil.evaporationPerS = (0.3 + 0.7 * nextUniform()) / 86400.0;
+    soil.pumpPerS = 0.01 + 0.02 * nextUniform();
+    soil.diffusionS = 30.0 + 90.0 * nextUniform();
+  }
+}
+
+double SoilSimulation::nextUniform()
+{
+  // xorshift32, deterministic for reproducible runs
+  random ^= random << 13;
+  random ^= random >> 17;
+  random ^= random << 5;
+  return (random & 0xFFFFFF) / (double)0x1000000;
+}
+
+void SoilSimulation::advance(unsigned long nowMs)
+{
+  double dt = (nowMs - lastMs) / 1000.0;
+  lastMs = nowMs;
+  if (dt <= 0)
+  {
+    return;
+  }
+
+  for (auto &soil : soils)
+  {
+    if (soil.pumpOn)
+    {
+      soil.pendingWater += soil.pumpPerS * dt;
+      soil.pumpSeconds += dt;
+    }
+    double arrived = soil.pendingWater * (1.0 - exp(-dt / soil.diffusionS));
+    soil.pendingWater -= arrived;
+    soil.moisture += arrived - soil.moisture * soil.evaporationPerS * evaporationScale * dt;
+    if (soil.moisture > 1.0)
+    {
+      soil.moisture = 1.0; // Excess drains away
+    }
+    if (soil.moisture > soil.peakMoisture)
+    {
+      soil.peakMoisture = soil.moisture;
+    }
+  }
+}
+
+int SoilSimulation::read(int pin)
+{
+  int zone = pin / 2;
+  if (pin % 2 != 0 || zone >= (int)soils.size())
+  {
+    return 4095;
+  }
+  double raw = dryRaw - soils[zone].moisture * (dryRaw - waterRaw);
+  raw += (nextUniform() * 2.0 - 1.0) * noiseCounts;
+  return raw < 0 ? 0 : (raw > 4095 ? 4095 : (int)raw);
+}
+
+void SoilSimulation::write(int pin, bool high)
+{
+  int zone = pin / 2;
+  if (pin % 2 != 1 || zone >= (int)soils.size())
+  {
+    return;
+  }
+  Soil &soil = soils[zone];
+  if (high && !soil.pumpOn)
+  {
+    soil.pumpStarts++;
+    pumpsOn++;
+    if (pumpsOn > maxPumpsOn)
+    {
+      maxPumpsOn = pumpsOn;
+    }
+  }
+  else if (!high && soil.pumpOn)
+  {
+    pumpsOn--;
+  }
+  soil.pumpOn = high;
+}
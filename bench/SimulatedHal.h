@@ -0,0 +1,76 @@
+#ifndef SIMULATED_HAL_H
+#define SIMULATED_HAL_H
+
+#include <stdint.h>
+#include <vector>
+#include "Hal.h"
+
+// Manually advanced clock so simulations run faster than real time
+class SimClock : public HalClock
+{
+public:
+  unsigned long nowMs = 0;
+
+  unsigned long millis() override { return nowMs; }
+  unsigned long micros() override { return nowMs * 1000UL; }
+};
+
+// Simple soil and pump physics for many zones.
+// Zone i uses sensor pin 2*i and pump pin 2*i+1. Moisture is a fraction of
+// field capacity that evaporates proportionally to itself; pumped water
+// first collects in a buffer and diffuses into the sensor's volume with a
+// first-order lag, so readings keep rising after the pump stops.
+class SoilSimulation : public HalAdc, public HalGpio
+{
+public:
+  struct Soil
+  {
+    double moisture;        // 0..1 of field capacity
+    double pendingWater;    // Pumped but not yet at the sensor
+    double evaporationPerS; // Fraction of current moisture lost per second
+    double pumpPerS;        // Moisture added per second of pumping
+    double diffusionS;      // Time constant of the diffusion lag
+    bool pumpOn;
+
+    // Statistics
+    unsigned long pumpStarts;
+    double pumpSeconds;
+    double peakMoisture;
+  };
+
+  // Raw ADC values matching the WateringZone defaults
+  int dryRaw = 3200;
+  int waterRaw = 1500;
+  int noiseCounts = 8;
+  // Multiplies every zone's evaporation, e.g. for a day/night cycle
+  double evaporationScale = 1.0;
+
+  // Pumps running right now and the most that ever ran together
+  int pumpsOn = 0;
+  int maxPumpsOn = 0;
+
+  explicit SoilSimulation(int zoneCount, uint32_t seed = 1);
+
+  void advance(unsigned long nowMs);
+  Soil &soil(int zone) { return soils[zone]; }
+  int zoneCount() const { return (int)soils.size(); }
+  static int sensorPin(int zone) { return zone * 2; }
+  static int pumpPin(int zone) { return zone * 2 + 1; }
+
+  // HalAdc
+  int read(int pin) override;
+
+  // HalGpio
+  void setInput(int) override {}
+  void setOutput(int) override {}
+  void write(int pin, bool high) override;
+
+private:
+  std::vector<Soil> soils;
+  unsigned long lastMs;
+  uint32_t random;
+
+  double nextUniform();
+};
+
+#endif // SIMULATED_HAL_H
@@ -0,0 +1,164 @@
+#ifndef SIMULATED_I2C_H
+#define SIMULATED_I2C_H
+
+#include <stdint.h>
+#include <vector>
+#include "I2cBus.h"
+#include "SimulatedHal.h"
+
+// A device on SimulatedI2cBus. atUs is the bus time at which a write
+// completes or a read samples its data.
+class SimulatedI2cDevice
+{
+public:
+  virtual ~SimulatedI2cDevice() {}
+  virtual uint8_t address() const = 0;
+  virtual bool write(const uint8_t *data, size_t length, uint64_t atUs) = 0;
+  virtual bool read(uint8_t *data, size_t length, uint64_t atUs) = 0;
+};
+
+// I2C master with modelled timing: start, address byte, payload, stop, at
+// 9 clocks per byte. Keeps its own microsecond timeline that never falls
+// behind the SimClock and moves forward with every transfer, so the time a
+// poll() spends on the bus shows up in when the devices see it.
+class SimulatedI2cBus : public I2cBus
+{
+public:
+  SimulatedI2cBus(SimClock &clock, uint32_t frequency = 400000) : clock(clock), frequency(frequency) {}
+
+  void attach(SimulatedI2cDevice *device) { devices.push_back(device); }
+
+  bool write(uint8_t address, const uint8_t *data, size_t length) override
+  {
+    SimulatedI2cDevice *device = transfer(address, length);
+    return device && device->write(data, length, timeUs);
+  }
+
+  bool read(uint8_t address, uint8_t *data, size_t length) override
+  {
+    uint64_t startUs = timeUs > clock.nowMs * 1000ULL ? timeUs : clock.nowMs * 1000ULL;
+    SimulatedI2cDevice *device = transfer(address, length);
+    return device && device->read(data, length, startUs);
+  }
+
+  uint64_t nowUs() const { return timeUs; }
+  double busyUs = 0;
+  unsigned long transactions = 0;
+
+private:
+  SimClock &clock;
+  uint32_t frequency;
+  uint64_t timeUs = 0;
+  std::vector<SimulatedI2cDevice *> devices;
+
+  SimulatedI2cDevice *transfer(uint8_t address, size_t length)
+  {
+    uint64_t clockUs = clock.nowMs * 1000ULL;
+    if (timeUs < clockUs)
+    {
+      timeUs = clockUs;
+    }
+    // Start and stop take about one clock each
+    double us = ((1 + length) * 9 + 2) * 1e6 / frequency;
+    timeUs += (uint64_t)(us + 0.5);
+    busyUs += us;
+    transactions++;
+    for (SimulatedI2cDevice *device : devices)
+    {
+      if (device->address() == address)
+      {
+        return device;
+      }
+    }
+    return nullptr; // NACK
+  }
+};
+
+// ADS1115 in single-shot mode: pointer, config and conversion registers.
+// AINx converts the 12-bit value source->read(pins[x]) scaled to the
+// 1 mV-per-8-codes of PGA +-4.096 V, so the backend gets the same number
+// back. The internal oscillator runs slowErrorPercent slow. Reading the
+// conversion register before it is done returns the previous result and
+// counts as a stale read, like on the chip.
+class SimulatedAds1115 : public SimulatedI2cDevice
+{
+public:
+  SimulatedAds1115(uint8_t address, HalAdc *source, const int *pins, double slowErrorPercent = 8)
+      : addr(address), source(source), slow(1 + slowErrorPercent / 100)
+  {
+    for (int i = 0; i < 4; i++)
+    {
+      this->pins[i] = pins[i];
+    }
+  }
+
+  unsigned long conversions = 0;
+  unsigned long staleReads = 0;
+
+  uint8_t address() const override { return addr; }
+
+  bool write(const uint8_t *data, size_t length, uint64_t atUs) override
+  {
+    if (length == 0 || data[0] > 3)
+    {
+      return false;
+    }
+    pointer = data[0];
+    if (length == 3 && pointer == 1)
+    {
+      config = (uint16_t)(data[1] << 8 | data[2]);
+      int mux = (config >> 12) & 0x7;
+      if ((config & 0x8000) && mux >= 4)
+      {
+        static const int SPS[8] = {8, 16, 32, 64, 128, 250, 475, 860};
+        input = mux - 4;
+        doneUs = atUs + (uint64_t)(1e6 / SPS[(config >> 5) & 0x7] * slow);
+        converting = true;
+      }
+    }
+    return true;
+  }
+
+  bool read(uint8_t *data, size_t length, uint64_t atUs) override
+  {
+    if (length != 2)
+    {
+      return false;
+    }
+    if (pointer == 0)
+    {
+      if (converting && atUs >= doneUs)
+      {
+        result = (int16_t)(source->read(pins[input]) * 8);
+        converting = false;
+        conversions++;
+      }
+      else if (converting)
+      {
+        staleReads++;
+      }
+      data[0] = (uint8_t)((uint16_t)result >> 8);
+      data[1] = (uint8_t)result;
+    }
+    else
+    {
+      data[0] = (uint8_t)(config >> 8);
+      data[1] = (uint8_t)config;
+    }
+    return true;
+  }
+
+private:
+  uint8_t addr;
+  HalAdc *source;
+  int pins[4];
+  double slow;
+  uint8_t pointer = 0;
+  uint16_t config = 0x8583; // Power-on default
+  int input = 0;
+  bool converting = false;
+  uint64_t doneUs = 0;
+  int16_t result = 0;
+};
+
+#endif // SIMULATED_I2C_H
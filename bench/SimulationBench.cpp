@@ -0,0 +1,153 @@
+// Runs the real ZoneController against SoilSimulation for simulated days
+// and reports control-loop latency, CPU time per tick and allocations.
+// A tick of 0 runs event-driven, jumping straight to nextWakeTime() the way
+// the firmware's control task sleeps. --dosing switches every zone to the
+// learned pulse mode.
+
+#include <chrono>
+#include <cstdio>
+#include <ctime>
+
+#include "Bench.h"
+#include "SimulatedHal.h"
+#include "ZoneController.h"
+
+// Log2 histogram of tick latencies in nanoseconds
+struct LatencyHistogram
+{
+  static const int BUCKETS = 40;
+  unsigned long counts[BUCKETS] = {};
+  unsigned long total = 0;
+  long long maxNs = 0;
+  double sumNs = 0;
+
+  void add(long long ns)
+  {
+    int bucket = 0;
+    while (bucket < BUCKETS - 1 && (1LL << (bucket + 1)) <= ns)
+    {
+      bucket++;
+    }
+    counts[bucket]++;
+    total++;
+    sumNs += ns;
+    if (ns > maxNs)
+    {
+      maxNs = ns;
+    }
+  }
+
+  // Upper bound of the bucket containing the given percentile
+  long long percentile(double p) const
+  {
+    unsigned long target = (unsigned long)(total * p);
+    unsigned long seen = 0;
+    for (int i = 0; i < BUCKETS; i++)
+    {
+      seen += counts[i];
+      if (seen > target)
+      {
+        return 1LL << (i + 1);
+      }
+    }
+    return maxNs;
+  }
+};
+
+void runSimulationBench(int zoneCount, double days, unsigned long tickMs, int maxPumps, bool dosing)
+{
+  if (tickMs > 0)
+  {
+    printf("== Control loop simulation: %d zones, %.2f days, %lu ms ticks, %d pump(s) at once, %s mode ==\n",
+           zoneCount, days, tickMs, maxPumps, dosing ? "dosing" : "threshold");
+  }
+  else
+  {
+    printf("== Control loop simulation: %d zones, %.2f days, event-driven, %d pump(s) at once, %s mode ==\n",
+           zoneCount, days, maxPumps, dosing ? "dosing" : "threshold");
+  }
+
+  SimClock clock;
+  SoilSimulation soil(zoneCount);
+  MemoryKeyValueStore store;
+  installHal({&clock, &soil, &soil, &store, nullptr}); // nullptr: no log output
+
+  ZoneController controller;
+  char name[ZONE_NAME_LEN];
+  for (int i = 0; i < zoneCount; i++)
+  {
+    snprintf(name, sizeof(name), "Sim %d", i + 1);
+    controller.addZone(WateringZone(i + 1, name, SoilSimulation::sensorPin(i), SoilSimulation::pumpPin(i)));
+  }
+  controller.init();
+  controller.setMaxConcurrentPumps(maxPumps);
+
+  // Same path as the config page; the queue holds CONFIG_QUEUE_SIZE requests
+  for (int i = 0; dosing && i < zoneCount; i++)
+  {
+    ZoneConfigRequest request = {i + 1, -1, -1, -1, -1, -1, -1, -1, ZONE_MODE_DOSING};
+    while (!controller.submitConfig(request))
+    {
+      controller.tick(0);
+  WateringZone::flushSettings(true); // Keep the store's allocations out of the run
+    }
+  }
+  controller.tick(0);
+  WateringZone::flushSettings(true); // Keep the store's allocations out of the run
+
+  LatencyHistogram latency;
+  unsigned long endMs = (unsigned long)(days * 86400000.0);
+  benchResetCounters();
+  std::clock_t cpuStart = std::clock();
+  auto wallStart = std::chrono::steady_clock::now();
+
+  unsigned long now = 0;
+  while (now < endMs)
+  {
+    clock.nowMs = now;
+    soil.advance(now);
+
+    auto tickStart = std::chrono::steady_clock::now();
+    controller.tick(now);
+    latency.add(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - tickStart).count());
+
+    unsigned long next = tickMs > 0 ? now + tickMs : controller.nextWakeTime(now);
+    now = (long)(next - now) > 0 ? next : now + 1;
+  }
+
+  double wallS = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+  double cpuS = (double)(std::clock() - cpuStart) / CLOCKS_PER_SEC;
+
+  unsigned long pumpStarts = 0;
+  double pumpSeconds = 0;
+  double minMoisture = 1.0;
+  double water = 0;
+  double peakSum = 0;
+  for (int i = 0; i < soil.zoneCount(); i++)
+  {
+    pumpStarts += soil.soil(i).pumpStarts;
+    pumpSeconds += soil.soil(i).pumpSeconds;
+    water += soil.soil(i).pumpSeconds * soil.soil(i).pumpPerS;
+    peakSum += soil.soil(i).peakMoisture;
+    if (soil.soil(i).moisture < minMoisture)
+    {
+      minMoisture = soil.soil(i).moisture;
+    }
+  }
+
+  printf("ticks            %lu\n", latency.total);
+  printf("wakeups          %.0f per day\n", latency.total / days);
+  printf("speedup          %.0fx real time\n", days * 86400.0 / wallS);
+  printf("tick latency     mean %.0f ns, p50 <%lld ns, p99 <%lld ns, max %lld ns\n",
+         latency.sumNs / latency.total, latency.percentile(0.5), latency.percentile(0.99), latency.maxNs);
+  printf("cpu per step     %.0f ns incl. soil model (%.1f ns per zone)\n",
+         cpuS * 1e9 / latency.total, cpuS * 1e9 / latency.total / zoneCount);
+  printf("allocations      %zu during run, peak heap %zu bytes\n", benchAllocations(), benchPeakBytes());
+  printf("pump starts      %lu (%.1f per zone per day), %.0f pump seconds\n",
+         pumpStarts, pumpStarts / (double)zoneCount / days, pumpSeconds);
+  printf("water used       %.2f field capacities per zone per day\n", water / zoneCount / days);
+  printf("mean peak        %.0f%% of field capacity (wet threshold %d%%)\n",
+         peakSum / zoneCount * 100.0, DEFAULT_WET_THRESHOLD);
+  printf("max pumps on     %d at once\n", soil.maxPumpsOn);
+  printf("driest zone      %.0f%% of field capacity\n", minMoisture * 100.0);
+}
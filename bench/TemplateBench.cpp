@@ -0,0 +1,109 @@
+// Streaming TemplateRenderer vs. the previous String::replace rendering of
+// the zone config page. Reports time per render, allocations and peak heap.
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+#include "Bench.h"
+
+#include "html_content.h"
+#include "TemplateRenderer.h"
+#include "ZonePage.h"
+
+static void replaceAll(std::string &html, const std::string &from, const std::string &to)
+{
+  // Same cost model as Arduino String::replace: one full scan and one
+  // page-sized buffer per placeholder
+  std::string result;
+  result.reserve(html.size() + 64);
+  size_t start = 0;
+  size_t found;
+  while ((found = html.find(from, start)) != std::string::npos)
+  {
+    result.append(html, start, found - start);
+    result += to;
+    start = found + from.size();
+  }
+  result.append(html, start, std::string::npos);
+  html.swap(result);
+}
+
+static size_t renderWithReplace(const ZoneSnapshot &zone)
+{
+  std::string html(zone_config_html);
+  replaceAll(html, "%ZONE_ID%", std::to_string(zone.id));
+  replaceAll(html, "%ZONE_NAME%", zone.name);
+  replaceAll(html, "%WET_THRESHOLD%", std::to_string(zone.wetThreshold));
+  replaceAll(html, "%DRY_THRESHOLD%", std::to_string(zone.dryThreshold));
+  replaceAll(html, "%MOISTURE_RAW%", std::to_string(zone.moistureRaw));
+  replaceAll(html, "%MOISTURE_PERCENT%", std::to_string(zone.moisturePercent));
+  replaceAll(html, "%PUMP_STATUS%", zone.pumpState ? "ON" : "OFF");
+  replaceAll(html, "%PUMP_CLASS%", zone.pumpState ? "on" : "off");
+  replaceAll(html, "%AIR_VALUE%", std::to_string(zone.airValue));
+  replaceAll(html, "%DRY_VALUE%", std::to_string(zone.dryValue));
+  replaceAll(html, "%WATER_VALUE%", std::to_string(zone.waterValue));
+  replaceAll(html, "%MAX_RUNTIME_SEC%", std::to_string(zone.maxRuntimeSec));
+  replaceAll(html, "%COOLDOWN_SEC%", std::to_string(zone.cooldownSec));
+  replaceAll(html, "%AIR_HIDDEN%", zone.sensorInAir ? "" : "hidden");
+  replaceAll(html, "%COOLDOWN_HIDDEN%", zone.inCooldown ? "" : "hidden");
+  replaceAll(html, "%COOLDOWN_SEC_LEFT%", std::to_string(zone.cooldownRemainingSec));
+  return html.size();
+}
+
+static size_t renderStreaming(const ZoneSnapshot &zone)
+{
+  // 1436 bytes is a typical TCP payload handed to the chunked filler
+  static char chunk[1436];
+  ZoneSnapshot copy = zone;
+  TemplateRenderer renderer(zone_config_html, resolveZonePlaceholder, &copy);
+  size_t total = 0;
+  size_t length;
+  while ((length = renderer.fill(chunk, sizeof(chunk))) > 0)
+  {
+    total += length;
+  }
+  return total;
+}
+
+static void run(const char *label, size_t (*render)(const ZoneSnapshot &), const ZoneSnapshot &zone)
+{
+  const int iterations = 20000;
+  size_t baseline = benchLiveBytes();
+  benchResetCounters();
+  size_t bytes = 0;
+
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < iterations; i++)
+  {
+    bytes += render(zone);
+  }
+  auto elapsed = std::chrono::steady_clock::now() - start;
+  double nsPerRender = std::chrono::duration<double, std::nano>(elapsed).count() / iterations;
+
+  printf("%-10s %8zu bytes/page %10.0f ns/render %8.2f allocs/render %8zu peak heap bytes\n",
+         label, bytes / iterations, nsPerRender, (double)benchAllocations() / iterations, benchPeakBytes() - baseline);
+}
+
+void runTemplateBench()
+{
+  printf("== Zone page rendering ==\n");
+  ZoneSnapshot zone = {};
+  zone.id = 1;
+  strcpy(zone.name, "Garden Bed 1");
+  zone.moistureRaw = 2710;
+  zone.moisturePercent = 37;
+  zone.inCooldown = true;
+  zone.cooldownRemainingSec = 120;
+  zone.wetThreshold = 80;
+  zone.dryThreshold = 30;
+  zone.airValue = 3700;
+  zone.dryValue = 3200;
+  zone.waterValue = 1500;
+  zone.maxRuntimeSec = 30;
+  zone.cooldownSec = 300;
+
+  run("replace", renderWithReplace, zone);
+  run("streaming", renderStreaming, zone);
+}
@@ -0,0 +1,368 @@
+#include "TraceReplay.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "SimulatedHal.h"
+#include "ZoneController.h"
+
+namespace
+{
+struct Decision
+{
+  uint32_t timeMs;
+  bool on;
+};
+
+// Recorded samples in, replayed pump writes out
+class ReplayIo : public HalAdc, public HalGpio
+{
+public:
+  struct Zone
+  {
+    int sensorPin;
+    int pumpPin;
+    std::vector<uint32_t> sampleTimes;
+    std::vector<int> sampleRaw;
+    size_t next = 0;
+    int last = 0;
+    std::vector<Decision> recorded;
+    std::vector<Decision> replayed;
+  };
+
+  std::vector<Zone> zones;
+  SimClock *clock = nullptr;
+  unsigned long slackMs = 0; // A sample this early still counts as the recorded one
+  unsigned long taken = 0;
+
+  // Earliest sample not taken yet
+  bool nextSampleTime(uint32_t &out) const
+  {
+    bool found = false;
+    for (const Zone &zone : zones)
+    {
+      if (zone.next < zone.sampleTimes.size() && (!found || (int32_t)(zone.sampleTimes[zone.next] - out) < 0))
+      {
+        out = zone.sampleTimes[zone.next];
+        found = true;
+      }
+    }
+    return found;
+  }
+
+  int read(int pin) override
+  {
+    for (Zone &zone : zones)
+    {
+      if (zone.sensorPin != pin)
+      {
+        continue;
+      }
+      if (zone.next >= zone.sampleTimes.size())
+      {
+        return zone.last;
+      }
+      // Earlier reads (the priming one in init()) see the value but leave it
+      int value = zone.sampleRaw[zone.next];
+      if ((long)(zone.sampleTimes[zone.next] - clock->nowMs) <= (long)slackMs)
+      {
+        zone.next++;
+        zone.last = value;
+        taken++;
+      }
+      return value;
+    }
+    return 0;
+  }
+
+  void setInput(int) override {}
+  void setOutput(int) override {}
+  void write(int pin, bool high) override
+  {
+    for (Zone &zone : zones)
+    {
+      if (zone.pumpPin == pin)
+      {
+        zone.replayed.push_back({(uint32_t)clock->nowMs, high});
+      }
+    }
+  }
+};
+
+// Stands in for a multiplexer or bus ADC of the recording device: queued
+// channels convert in the next poll(), into the recorded samples of their
+// address
+class ReplayBackend : public SensorBackend
+{
+public:
+  ReplayIo *io = nullptr;
+  int firstAddress = 0; // sensorAddress(backend, 0)
+  uint32_t pending = 0;  // Bit per channel
+
+  int channelCount() const override { return SENSOR_BACKEND_CHANNELS; }
+  void request(int channel) override { pending |= 1u << channel; }
+
+  void poll(unsigned long, SensorResultFn done, void *context) override
+  {
+    for (int channel = 0; pending; channel++)
+    {
+      if (pending & (1u << channel))
+      {
+        pending &= ~(1u << channel);
+        done(context, channel, io->read(firstAddress + channel));
+      }
+    }
+  }
+
+  bool nextPollTime(unsigned long now, unsigned long &at) const override
+  {
+    at = now;
+    return pending != 0;
+  }
+};
+
+// The sampler keeps them registered until the next resetSensors()
+ReplayBackend replayBackends[SENSOR_MAX_BACKENDS];
+
+SimClock *wallClockSource = nullptr;
+uint32_t wallClockStart = 0;
+uint32_t wallClockStartMs = 0;
+
+uint32_t replayWallClock()
+{
+  return wallClockStart + (uint32_t)(wallClockSource->nowMs - wallClockStartMs) / 1000;
+}
+
+unsigned long absDiff(uint32_t a, uint32_t b)
+{
+  return (int32_t)(a - b) < 0 ? b - a : a - b;
+}
+
+// In-order match per zone: same state and at most REPLAY_MATCH_MS apart
+void compareZone(const ReplayIo::Zone &zone, int zoneId, uint32_t startMs, ReplayReport &report)
+{
+  size_t i = 0;
+  size_t j = 0;
+  while (i < zone.recorded.size() || j < zone.replayed.size())
+  {
+    const Decision *recorded = i < zone.recorded.size() ? &zone.recorded[i] : nullptr;
+    const Decision *replayed = j < zone.replayed.size() ? &zone.replayed[j] : nullptr;
+    if (recorded && replayed && recorded->on == replayed->on &&
+        absDiff(recorded->timeMs, replayed->timeMs) <= REPLAY_MATCH_MS)
+    {
+      unsigned long skew = absDiff(recorded->timeMs, replayed->timeMs);
+      report.maxSkewMs = skew > report.maxSkewMs ? skew : report.maxSkewMs;
+      report.matched++;
+      i++;
+      j++;
+      continue;
+    }
+
+    // The earlier of the two has no partner
+    const Decision *unmatched = recorded;
+    if (!recorded || (replayed && (int32_t)(replayed->timeMs - recorded->timeMs) < 0))
+    {
+      unmatched = replayed;
+      j++;
+    }
+    else
+    {
+      i++;
+    }
+    long at = (int32_t)(unmatched->timeMs - startMs);
+    if (report.firstMismatchMs < 0 || at < report.firstMismatchMs)
+    {
+      report.firstMismatchMs = at;
+      report.firstMismatchZone = zoneId;
+    }
+  }
+}
+} // namespace
+
+ReplayReport replayTrace(const uint8_t *data, size_t length, TraceZoneAdjust adjust)
+{
+  ReplayReport report = {};
+  report.firstMismatchMs = -1;
+
+  TraceHeader header;
+  TraceZone traceZones[MAX_ZONES];
+  TraceReader reader(data, length);
+  if (!reader.header(header, traceZones))
+  {
+    report.error = "not a sensor trace";
+    return report;
+  }
+  report.zones = header.zoneCount;
+  if (adjust)
+  {
+    for (int i = 0; i < header.zoneCount; i++)
+    {
+      adjust(traceZones[i]);
+      traceZones[i].settings.crc = SettingsStore::checksum(traceZones[i].settings);
+    }
+  }
+
+  SimClock clock;
+  ReplayIo io;
+  io.clock = &clock;
+  io.slackMs = header.sampleIntervalMs / 2;
+  io.zones.resize(header.zoneCount);
+  for (int i = 0; i < header.zoneCount; i++)
+  {
+    io.zones[i].sensorPin = traceZones[i].sensorPin;
+    io.zones[i].pumpPin = traceZones[i].pumpPin;
+  }
+
+  TraceEvent event;
+  uint32_t endMs = header.startMs;
+  while (reader.next(event))
+  {
+    endMs = event.timeMs;
+    if (event.type == TRACE_GAP)
+    {
+      report.lostRecords += event.value;
+    }
+    else if (event.type == TRACE_SAMPLE)
+    {
+      io.zones[event.zone].sampleTimes.push_back(event.timeMs);
+      io.zones[event.zone].sampleRaw.push_back(event.value);
+      report.samples++;
+    }
+    else
+    {
+      io.zones[event.zone].recorded.push_back({event.timeMs, event.type == TRACE_PUMP_ON});
+    }
+  }
+  if (!reader.ok())
+  {
+    // A cut-off last record: replay what came before it
+    fprintf(stderr, "trace damaged at byte %zu, replaying the part before\n", reader.position());
+  }
+  report.durationMs = endMs - header.startMs;
+
+  // The zones load their recorded settings like from NVS
+  MemoryKeyValueStore store;
+  store.begin(SETTINGS_NAMESPACE, false);
+  for (int i = 0; i < header.zoneCount; i++)
+  {
+    store.putBytes(settingsKeyFor(traceZones[i].id).text, &traceZones[i].settings, sizeof(ZoneSettings));
+  }
+  store.end();
+
+  clock.nowMs = header.startMs;
+  installHal({&clock, &io, &io, &store, nullptr});
+  WateringZone::resetSensors();
+
+  // Sensors the device read through backends get replay backends at the
+  // same numbers, so their addresses stay valid
+  int backendCount = 0;
+  for (int i = 0; i < header.zoneCount; i++)
+  {
+    int pin = traceZones[i].sensorPin;
+    if (isExternalSensor(pin) && pin < SENSOR_ADDRESS_END)
+    {
+      int backend = (pin - SENSOR_EXTERNAL) / SENSOR_BACKEND_CHANNELS;
+      backendCount = backend >= backendCount ? backend + 1 : backendCount;
+    }
+  }
+  for (int i = 0; i < backendCount; i++)
+  {
+    replayBackends[i] = ReplayBackend();
+    replayBackends[i].io = &io;
+    replayBackends[i].firstAddress = sensorAddress(i, 0);
+    WateringZone::addSensorBackend(&replayBackends[i]);
+  }
+
+  // Cooldowns running at startMs come back like after a warm reset
+  memset(halRetainedMemory(HAL_RETAINED_BYTES), 0, HAL_RETAINED_BYTES);
+  RuntimeState seed(&store);
+  seed.begin();
+  for (int i = 0; i < header.zoneCount; i++)
+  {
+    if (traceZones[i].state & TRACE_ZONE_COOLDOWN)
+    {
+      seed.save(traceZones[i].id, false, (traceZones[i].state & TRACE_ZONE_TIMEOUT) != 0, true,
+                header.startMs + traceZones[i].cooldownLeftMs);
+    }
+  }
+  seed.touch(header.startMs);
+
+  ZoneController controller;
+  char name[ZONE_NAME_LEN];
+  for (int i = 0; i < header.zoneCount; i++)
+  {
+    snprintf(name, sizeof(name), "Trace %u", (unsigned)traceZones[i].id);
+    WateringZone zone(traceZones[i].id, name, traceZones[i].sensorPin, traceZones[i].pumpPin);
+    zone.filterConfig = traceFilter(traceZones[i]);
+    controller.addZone(zone);
+  }
+  controller.init();
+  if (header.wallClock)
+  {
+    wallClockSource = &clock;
+    wallClockStart = header.wallClock;
+    wallClockStartMs = header.startMs;
+    controller.setWallClock(replayWallClock);
+  }
+  for (ReplayIo::Zone &zone : io.zones)
+  {
+    zone.replayed.clear(); // init() switching the pumps off is not in the trace
+  }
+
+  auto wallStart = std::chrono::steady_clock::now();
+  unsigned long now = header.startMs;
+  while ((long)(now - endMs) <= 0)
+  {
+    clock.nowMs = now;
+    controller.tick(now);
+    report.ticks++;
+
+    unsigned long next = controller.nextWakeTime(now);
+    uint32_t sampleAt = 0;
+    if ((long)(WateringZone::nextSampleTime(now) - next) <= 0 && io.nextSampleTime(sampleAt) &&
+        (long)(sampleAt - next) > 0 && sampleAt - next < header.sampleIntervalMs)
+    {
+      next = sampleAt;
+    }
+    now = (long)(next - now) > 0 ? next : now + 1;
+  }
+  report.wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+  report.samplesTaken = io.taken;
+
+  for (int i = 0; i < header.zoneCount; i++)
+  {
+    report.recorded += io.zones[i].recorded.size();
+    report.replayed += io.zones[i].replayed.size();
+    compareZone(io.zones[i], traceZones[i].id, header.startMs, report);
+  }
+  return report;
+}
+
+void printReplayReport(const char *label, const ReplayReport &report)
+{
+  printf("-- %s --\n", label);
+  if (report.error)
+  {
+    printf("error            %s\n", report.error);
+    return;
+  }
+  double hours = report.durationMs / 3600000.0;
+  printf("trace            %d zone(s), %.1f h, %lu samples, %lu lost records\n",
+         report.zones, hours, report.samples, report.lostRecords);
+  printf("samples taken    %lu of %lu\n", report.samplesTaken, report.samples);
+  printf("pump decisions   %lu recorded, %lu replayed, %lu matched (max skew %lu ms)\n",
+         report.recorded, report.replayed, report.matched, report.maxSkewMs);
+  if (report.firstMismatchMs >= 0)
+  {
+    printf("first mismatch   zone %d at %.1f h\n", report.firstMismatchZone, report.firstMismatchMs / 3600000.0);
+  }
+  else
+  {
+    printf("first mismatch   none\n");
+  }
+  printf("throughput       %.0f samples/s, %.0fx real time, %lu ticks in %.3f s\n",
+         report.samples / report.wallSeconds, report.durationMs / 1000.0 / report.wallSeconds,
+         report.ticks, report.wallSeconds);
+}
@@ -0,0 +1,50 @@
+#ifndef TRACE_REPLAY_H
+#define TRACE_REPLAY_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "SensorTrace.h"
+
+// Feeds a SensorTrace recording through an unmodified ZoneController as
+// fast as the CPU allows and compares its pump decisions with the recorded
+// ones. Zones start with the recorded settings, filters and cooldowns, but
+// with empty filter windows, history and dosing model, and a zone whose
+// last run timed out only remembers that while its cooldown lasts. So
+// decisions right after the start of a trace may differ from the device's.
+//
+// Each zone's sampler gets the recorded raw values in order; sensors the
+// device read through a multiplexer or bus ADC get them from a replay
+// backend at the same sensorAddress(). The replay wakes when the
+// controller asks to, except that a wakeup that would take a sample waits
+// for the recorded one (the device's control task wakes a little late and
+// its sample grid drifts with that).
+
+const unsigned long REPLAY_MATCH_MS = 1000; // Largest time difference of a matching decision
+
+struct ReplayReport
+{
+  const char *error; // nullptr: replayed
+  int zones;
+  uint32_t durationMs; // Trace time covered
+  unsigned long samples;      // Recorded
+  unsigned long samplesTaken; // By the replayed sampler
+  unsigned long lostRecords;  // GAP records of the trace
+  unsigned long recorded;     // Pump decisions in the trace
+  unsigned long replayed;     // Pump decisions of the replay
+  unsigned long matched;
+  unsigned long maxSkewMs; // Of the matched decisions
+  long firstMismatchMs;    // Since startMs, -1: none
+  int firstMismatchZone;   // Zone id
+  unsigned long ticks;
+  double wallSeconds;
+};
+
+// Edits a zone's recorded configuration before the replay, e.g. to see
+// what a different threshold would have done with the same soil, or to
+// read a sensor through a replay backend
+typedef void (*TraceZoneAdjust)(TraceZone &zone);
+
+ReplayReport replayTrace(const uint8_t *data, size_t length, TraceZoneAdjust adjust = nullptr);
+void printReplayReport(const char *label, const ReplayReport &report);
+
+#endif // TRACE_REPLAY_H
@@ -0,0 +1,109 @@
+#ifndef UDP_LOOPBACK_TRANSPORT_H
+#define UDP_LOOPBACK_TRANSPORT_H
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include "MeshTransport.h"
+
+// MeshTransport over real UDP sockets on 127.0.0.1, so the mesh protocol
+// runs through the kernel on Linux. Loopback has no broadcast: broadcasts
+// go to a fixed port (the aggregator's). lossRate drops that fraction of
+// outgoing frames to exercise the recovery paths.
+class UdpLoopbackTransport : public MeshTransport
+{
+public:
+  UdpLoopbackTransport(uint16_t broadcastPort, double lossRate = 0, uint32_t seed = 1)
+      : broadcastPort(broadcastPort), lossRate(lossRate), random(seed), fd(-1), boundPort(0)
+  {
+  }
+
+  ~UdpLoopbackTransport() override
+  {
+    if (fd >= 0)
+    {
+      close(fd);
+    }
+  }
+
+  // Port 0 picks a free one
+  bool begin(uint16_t port)
+  {
+    fd = socket(AF_INET, SOCK_DGRAM, 0);
+    if (fd < 0)
+    {
+      return false;
+    }
+    sockaddr_in local = address(port);
+    socklen_t length = sizeof(local);
+    if (bind(fd, reinterpret_cast<sockaddr *>(&local), sizeof(local)) != 0 ||
+        getsockname(fd, reinterpret_cast<sockaddr *>(&local), &length) != 0)
+    {
+      return false;
+    }
+    boundPort = ntohs(local.sin_port);
+    return true;
+  }
+
+  uint16_t port() const { return boundPort; }
+
+  bool send(const MeshAddress &to, const uint8_t *data, size_t length) override
+  {
+    return sendTo((uint16_t)(to.bytes[4] | (to.bytes[5] << 8)), data, length);
+  }
+
+  bool broadcast(const uint8_t *data, size_t length) override
+  {
+    return sendTo(broadcastPort, data, length);
+  }
+
+  size_t receive(uint8_t *buffer, size_t size, MeshAddress &from) override
+  {
+    sockaddr_in remote = {};
+    socklen_t length = sizeof(remote);
+    ssize_t received = recvfrom(fd, buffer, size, MSG_DONTWAIT, reinterpret_cast<sockaddr *>(&remote), &length);
+    if (received <= 0)
+    {
+      return 0;
+    }
+    uint32_t ip = ntohl(remote.sin_addr.s_addr);
+    uint16_t port = ntohs(remote.sin_port);
+    uint8_t bytes[6] = {(uint8_t)(ip >> 24), (uint8_t)(ip >> 16), (uint8_t)(ip >> 8), (uint8_t)ip,
+                        (uint8_t)(port & 0xFF), (uint8_t)(port >> 8)};
+    memcpy(from.bytes, bytes, sizeof(bytes));
+    return (size_t)received;
+  }
+
+  unsigned long dropped = 0;
+
+private:
+  uint16_t broadcastPort;
+  double lossRate;
+  uint32_t random;
+  int fd;
+  uint16_t boundPort;
+
+  static sockaddr_in address(uint16_t port)
+  {
+    sockaddr_in result = {};
+    result.sin_family = AF_INET;
+    result.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    result.sin_port = htons(port);
+    return result;
+  }
+
+  bool sendTo(uint16_t port, const uint8_t *data, size_t length)
+  {
+    random = random * 1664525u + 1013904223u;
+    if ((random >> 8) * (1.0 / 16777216.0) < lossRate)
+    {
+      dropped++;
+      return true; // Lost on the air, the sender cannot tell
+    }
+    sockaddr_in remote = address(port);
+    return sendto(fd, data, length, 0, reinterpret_cast<sockaddr *>(&remote), sizeof(remote)) == (ssize_t)length;
+  }
+};
+
+#endif // UDP_LOOPBACK_TRANSPORT_H
@@ -0,0 +1,188 @@
+// Streams firmware images through UpdateWriter into a file-backed flash
+// slot (FileFlashTarget) in TCP-sized pieces, the way the web server hands
+// over a POST body. Checks that good images land intact and that bad ones
+// (wrong CRC, short, too large, concurrent, pages that are not gzip) never
+// get committed, and compares the flash traffic with writing every piece
+// straight through.
+
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+#include "Bench.h"
+#include "FileFlashTarget.h"
+#include "SettingsStore.h"
+#include "UpdateWriter.h"
+
+namespace
+{
+const size_t SLOT_SIZE = 0x140000;  // app0/app1 of the default 4 MB partition table
+const size_t IMAGE_SIZE = 1180000;  // A typical build of this firmware
+const size_t MAX_PIECE = 1436;      // TCP payload of one full segment
+const char *const SLOT_PATH = "/tmp/update_bench_slot.bin";
+
+uint32_t randomState = 7;
+uint32_t nextRandom()
+{
+  randomState = randomState * 1664525u + 1013904223u;
+  return randomState >> 8;
+}
+
+std::vector<uint8_t> makeImage(size_t size)
+{
+  std::vector<uint8_t> image(size);
+  for (uint8_t &byte : image)
+  {
+    byte = (uint8_t)nextRandom();
+  }
+  return image;
+}
+
+UpdateWriter writer; // 4 KB chunk buffer, static on the device as well
+
+struct Outcome
+{
+  bool finished;
+  UpdateError error;
+  double seconds;
+  double maxWriteUs;
+};
+
+// Feeds image[0..sent) in random pieces, like onBody callbacks
+Outcome stream(FlashTarget &target, const std::vector<uint8_t> &image, size_t sent, size_t announced,
+               uint32_t crc, bool haveCrc, bool gzip = false)
+{
+  Outcome outcome = {false, UPDATE_OK, 0, 0};
+  auto start = std::chrono::steady_clock::now();
+  if (!writer.begin(target, announced, crc, haveCrc, gzip))
+  {
+    outcome.error = writer.error();
+    return outcome;
+  }
+  size_t offset = 0;
+  while (offset < sent && writer.active())
+  {
+    size_t piece = 1 + nextRandom() % MAX_PIECE;
+    if (piece > sent - offset)
+    {
+      piece = sent - offset;
+    }
+    auto before = std::chrono::steady_clock::now();
+    writer.write(image.data() + offset, piece);
+    double us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - before).count();
+    if (us > outcome.maxWriteUs)
+    {
+      outcome.maxWriteUs = us;
+    }
+    offset += piece;
+  }
+  outcome.finished = writer.finish();
+  outcome.error = writer.error();
+  outcome.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  return outcome;
+}
+
+// Returns 1 if the outcome is not the expected one
+int report(const char *name, const Outcome &outcome, const FileFlashTarget &slot, bool expectCommit)
+{
+  bool pass = outcome.finished == expectCommit && slot.committed == expectCommit;
+  printf("  %-24s %-26s committed=%-3s %s\n", name, UpdateWriter::errorText(outcome.error),
+         slot.committed ? "yes" : "no", pass ? "ok" : "FAIL");
+  return pass ? 0 : 1;
+}
+
+// Baseline: every received piece goes to flash as it is
+void streamUnbuffered(FileFlashTarget &slot, const std::vector<uint8_t> &image)
+{
+  slot.begin(image.size());
+  size_t offset = 0;
+  while (offset < image.size())
+  {
+    size_t piece = 1 + nextRandom() % MAX_PIECE;
+    if (piece > image.size() - offset)
+    {
+      piece = image.size() - offset;
+    }
+    slot.write(offset, image.data() + offset, piece);
+    offset += piece;
+  }
+  slot.commit();
+}
+} // namespace
+
+int runUpdateBench()
+{
+  printf("== Streamed updates, %zu byte image into a %zu byte slot ==\n", IMAGE_SIZE, (size_t)SLOT_SIZE);
+  std::vector<uint8_t> image = makeImage(IMAGE_SIZE);
+  uint32_t crc = crc32(image.data(), image.size());
+  int failures = 0;
+
+  {
+    FileFlashTarget slot(SLOT_PATH, SLOT_SIZE);
+    benchResetCounters();
+    Outcome outcome = stream(slot, image, image.size(), image.size(), crc, true);
+    size_t allocations = benchAllocations();
+    failures += report("good image", outcome, slot, true);
+    bool intact = slot.contents(image.size()) == image;
+    failures += intact ? 0 : 1;
+    printf("    read back %s, %lu writes, %lu erases, %lu misaligned, %lu bit conflicts\n",
+           intact ? "identical" : "DIFFERENT", slot.writes, slot.erases, slot.misaligned, slot.rewrites);
+    printf("    %.1f MB/s through the file, slowest write() %.0f us, %zu heap allocations while streaming\n",
+           image.size() / outcome.seconds / 1e6, outcome.maxWriteUs, allocations);
+  }
+  {
+    FileFlashTarget slot(SLOT_PATH, SLOT_SIZE);
+    failures += report("wrong CRC", stream(slot, image, image.size(), image.size(), crc ^ 1, true), slot, false);
+  }
+  {
+    FileFlashTarget slot(SLOT_PATH, SLOT_SIZE);
+    failures += report("connection cut at 60%", stream(slot, image, image.size() * 6 / 10, image.size(), crc, true),
+                       slot, false);
+  }
+  {
+    FileFlashTarget slot(SLOT_PATH, SLOT_SIZE);
+    std::vector<uint8_t> large = makeImage(SLOT_SIZE + 4096);
+    failures += report("announced too large", stream(slot, large, large.size(), large.size(), 0, false), slot, false);
+    failures += report("too large, no length", stream(slot, large, large.size(), 0, 0, false), slot, false);
+  }
+  {
+    FileFlashTarget slot(SLOT_PATH, SLOT_SIZE);
+    FileFlashTarget other(SLOT_PATH, SLOT_SIZE);
+    writer.begin(other, image.size(), crc, true);
+    failures += report("while another runs", stream(slot, image, image.size(), image.size(), crc, true), slot, false);
+    writer.abort();
+  }
+  {
+    // A page upload (target=index): gzip data, or an HTML file sent by mistake
+    std::vector<uint8_t> page = makeImage(24000);
+    page[0] = GZIP_MAGIC[0];
+    page[1] = GZIP_MAGIC[1];
+    uint32_t pageCrc = crc32(page.data(), page.size());
+    FileFlashTarget slot(SLOT_PATH, SLOT_SIZE);
+    failures += report("gzip page", stream(slot, page, page.size(), page.size(), pageCrc, true, true), slot, true);
+    page[0] = '<';
+    pageCrc = crc32(page.data(), page.size());
+    FileFlashTarget plain(SLOT_PATH, SLOT_SIZE);
+    failures += report("page not gzip", stream(plain, page, page.size(), page.size(), pageCrc, true, true), plain,
+                       false);
+    // The magic split across two pieces, then cut after its first byte
+    FileFlashTarget split(SLOT_PATH, SLOT_SIZE);
+    writer.begin(split, 3, 0, false, true);
+    writer.write(GZIP_MAGIC, 1);
+    writer.write(GZIP_MAGIC + 1, 1);
+    writer.write(GZIP_MAGIC, 1);
+    failures += report("gzip magic split", {writer.finish(), writer.error(), 0, 0}, split, true);
+    FileFlashTarget cut(SLOT_PATH, SLOT_SIZE);
+    writer.begin(cut, 0, 0, false, true);
+    writer.write(GZIP_MAGIC, 1);
+    failures += report("page of one byte", {writer.finish(), writer.error(), 0, 0}, cut, false);
+  }
+  {
+    FileFlashTarget slot(SLOT_PATH, SLOT_SIZE);
+    streamUnbuffered(slot, image);
+    printf("  unbuffered baseline      %lu writes, %lu erases, %lu misaligned\n", slot.writes, slot.erases,
+           slot.misaligned);
+  }
+  remove(SLOT_PATH);
+  return failures;
+}
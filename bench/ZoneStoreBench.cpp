@@ -0,0 +1,196 @@
+// Compares the per-zone loops of the old object-per-zone layout with the
+// ZoneRegistry's hot arrays: the threshold evaluation and deadline scan the
+// control task runs on every wakeup, and zone lookup by id.
+
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+#include "Bench.h"
+#include "ZoneRegistry.h"
+
+// Field layout of WateringZone before the registry: runtime state sits
+// between the settings and a 4 KB history, so every zone is its own
+// cache-line island.
+struct LegacyZone
+{
+  char name[ZONE_NAME_LEN];
+  int id;
+  int moisturePin;
+  int pumpPin;
+  int sensorChannel;
+  FilterConfig filterConfig;
+  int moistureThresholdWet;
+  int moistureThresholdDry;
+  int airValue;
+  int dryValue;
+  int waterValue;
+  unsigned long maxPumpRuntimeMs;
+  unsigned long pumpCooldownMs;
+  int soilMoistureRaw;
+  int soilMoisturePercent;
+  bool pumpState;
+  unsigned long pumpStartTime;
+  unsigned long pumpStopTime;
+  bool pumpStoppedByTimeout;
+  ThresholdLatch dryLatch;
+  MoistureHistory history;
+
+  bool isPumpInCooldown(unsigned long now) const
+  {
+    return pumpStopTime != 0 && (now - pumpStopTime) < pumpCooldownMs;
+  }
+
+  // The old WateringZone::readSensor() after the sampler read, without the filter
+  void evaluate(int raw)
+  {
+    soilMoistureRaw = raw;
+    int span = waterValue - dryValue;
+    int percent = span == 0 ? 0 : (raw - dryValue) * 100 / span;
+    soilMoisturePercent = percent < 0 ? 0 : (percent > 100 ? 100 : percent);
+    dryLatch.update(soilMoisturePercent, moistureThresholdDry, filterConfig.hysteresis);
+    inAir = raw >= airValue;
+  }
+  bool inAir;
+
+  // The old WateringZone::nextDeadline(), with the clock passed in
+  bool nextDeadline(unsigned long now, unsigned long &deadline) const
+  {
+    if (pumpState)
+    {
+      deadline = pumpStartTime + maxPumpRuntimeMs + 1;
+      return true;
+    }
+    if (isPumpInCooldown(now) && (pumpStoppedByTimeout || dryLatch.isActive()))
+    {
+      deadline = pumpStopTime + pumpCooldownMs;
+      return true;
+    }
+    return false;
+  }
+};
+
+template <typename Fn>
+static double nsPer(int rounds, size_t items, Fn fn)
+{
+  auto start = std::chrono::steady_clock::now();
+  for (int r = 0; r < rounds; r++)
+  {
+    fn(r);
+  }
+  double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+  return ns / ((double)rounds * items);
+}
+
+static void compareZones(int count)
+{
+  unsigned long now = 100000;
+
+  std::vector<LegacyZone> legacy(count);
+  ZoneRegistry registry;
+  registry.reserve(count);
+  for (int i = 0; i < count; i++)
+  {
+    LegacyZone &old = legacy[i];
+    old.id = i * 2 + 1; // Sparse ids, like a hand-written zone table
+    old.maxPumpRuntimeMs = 30000;
+    old.pumpCooldownMs = 300000;
+    old.pumpState = i % 37 == 0;
+    old.pumpStartTime = now - 1000;
+    old.pumpStopTime = i % 11 == 0 ? now - 5000 : 0;
+    old.pumpStoppedByTimeout = i % 22 == 0;
+    old.filterConfig = DEFAULT_FILTER;
+    old.moistureThresholdDry = DEFAULT_DRY_THRESHOLD;
+    old.airValue = DEFAULT_AIR_VALUE;
+    old.dryValue = DEFAULT_DRY_VALUE;
+    old.waterValue = DEFAULT_WATER_VALUE;
+
+    registry.add(WateringZone(old.id, "Bench", i * 2, i * 2 + 1));
+    ZoneHotState &hot = registry.hot();
+    hot.set(i, ZONE_PUMP_ON, old.pumpState);
+    hot.pumpStart[i] = old.pumpStartTime;
+    hot.pumpStop[i] = old.pumpStopTime;
+    hot.set(i, ZONE_STOPPED_BY_TIMEOUT, old.pumpStoppedByTimeout);
+    unsigned long deadline = 0;
+    hot.set(i, ZONE_HAS_DEADLINE, old.nextDeadline(now, deadline));
+    hot.deadline[i] = deadline;
+    hot.set(i, ZONE_HAS_READING, true);
+    hot.dryThreshold[i] = (uint8_t)old.moistureThresholdDry;
+    hot.hysteresis[i] = old.filterConfig.hysteresis;
+    hot.airValue[i] = (int16_t)old.airValue;
+    hot.dryValue[i] = (int16_t)old.dryValue;
+    hot.waterValue[i] = (int16_t)old.waterValue;
+  }
+
+  const int rounds = 2000000 / count + 1;
+  unsigned long sink = 0;
+
+  // Readings around the dry threshold, so the latch switches now and then
+  auto rawFor = [](int zone, int round) { return 2600 + (zone * 37 + round * 11) % 200; };
+  double legacyEvaluate = nsPer(rounds, count, [&](int r)
+                                {
+    int i = 0;
+    for (auto &zone : legacy)
+    {
+      zone.evaluate(rawFor(i++, r));
+    }
+    sink += legacy[r % count].soilMoisturePercent; });
+  double registryEvaluate = nsPer(rounds, count, [&](int r)
+                                  {
+    int *raw = registry.hot().raw.data();
+    for (int i = 0; i < count; i++)
+    {
+      raw[i] = rawFor(i, r);
+    }
+    registry.evaluateThresholds();
+    sink += registry.hot().percent[r % count]; });
+
+  double legacyScan = nsPer(rounds, count, [&](int r)
+                            {
+    unsigned long earliest = 0;
+    bool found = false;
+    for (const auto &zone : legacy)
+    {
+      unsigned long due;
+      if (zone.nextDeadline(now + r, due) && (!found || (long)(due - earliest) < 0))
+      {
+        earliest = due;
+        found = true;
+      }
+    }
+    sink += earliest; });
+  double registryScan = nsPer(rounds, count, [&](int)
+                              {
+    unsigned long earliest = 0;
+    registry.nextDeadline(earliest);
+    sink += earliest; });
+
+  double legacyLookup = nsPer(rounds, count, [&](int r)
+                              {
+    int id = (r * 7 % count) * 2 + 1;
+    for (auto &zone : legacy)
+    {
+      if (zone.id == id)
+      {
+        sink += zone.pumpPin;
+        break;
+      }
+    } });
+  double registryLookup = nsPer(rounds, count, [&](int r)
+                                {
+    int id = (r * 7 % count) * 2 + 1;
+    sink += registry.find(id)->pumpPin; });
+
+  printf("%5d zones  thresholds %5.2f -> %5.2f ns per zone | deadline scan %5.2f -> %5.2f ns per zone | "
+         "id lookup %6.1f -> %4.1f ns (sink %lu)\n",
+         count, legacyEvaluate, registryEvaluate, legacyScan, registryScan, legacyLookup * count,
+         registryLookup * count, sink % 10);
+}
+
+void runZoneStoreBench()
+{
+  printf("== Zone store: object per zone (%zu bytes) vs hot arrays ==\n", sizeof(LegacyZone));
+  compareZones(16);
+  compareZones(100);
+  compareZones(500);
+}
@@ -0,0 +1,144 @@
+#include "Ads1115Backend.h"
+#include "Hal.h"
+
+static const uint8_t REG_CONVERSION = 0x00;
+static const uint8_t REG_CONFIG = 0x01;
+static const uint16_t SAMPLES_PER_SECOND[8] = {8, 16, 32, 64, 128, 250, 475, 860};
+
+// OS: start, MUX: AINx against GND, PGA +-4.096 V, single-shot, comparator off
+static uint16_t configWord(int input, uint8_t dataRate)
+{
+  return (uint16_t)(0x8000 | ((0x4 | input) << 12) | (0x1 << 9) | 0x0100 | ((dataRate & 0x7) << 5) | 0x0003);
+}
+
+Ads1115Backend::Ads1115Backend(I2cBus &bus, const uint8_t *addresses, int devices, uint8_t dataRate)
+    : bus(bus), deviceCount(devices < ADS_MAX_DEVICES ? devices : ADS_MAX_DEVICES), dataRate(dataRate & 0x7),
+      transactionCount(0), byteCount(0), errorCount(0)
+{
+  for (int i = 0; i < deviceCount; i++)
+  {
+    this->devices[i] = {addresses[i], 0, -1, 0};
+  }
+  unsigned long conversionUs = 1100000UL / SAMPLES_PER_SECOND[this->dataRate];
+  waitMs = (conversionUs + 999) / 1000 + 1;
+}
+
+bool Ads1115Backend::begin()
+{
+  bool found = true;
+  for (int i = 0; i < deviceCount; i++)
+  {
+    found = write(devices[i], &REG_CONVERSION, 1) && found;
+    devices[i].converting = -1;
+  }
+  return found;
+}
+
+void Ads1115Backend::request(int channel)
+{
+  if (channel >= 0 && channel < channelCount())
+  {
+    devices[channel / ADS_INPUTS].pending |= (uint8_t)(1u << (channel % ADS_INPUTS));
+  }
+}
+
+bool Ads1115Backend::write(const Device &device, const uint8_t *data, size_t length)
+{
+  transactionCount++;
+  byteCount += length;
+  if (!bus.write(device.address, data, length))
+  {
+    errorCount++;
+    return false;
+  }
+  return true;
+}
+
+bool Ads1115Backend::read(const Device &device, uint8_t *data, size_t length)
+{
+  transactionCount++;
+  byteCount += length;
+  if (!bus.read(device.address, data, length))
+  {
+    errorCount++;
+    return false;
+  }
+  return true;
+}
+
+// Config write starts the conversion, the pointer write saves it on the result read
+bool Ads1115Backend::start(Device &device, int input)
+{
+  uint16_t config = configWord(input, dataRate);
+  uint8_t command[3] = {REG_CONFIG, (uint8_t)(config >> 8), (uint8_t)config};
+  if (!write(device, command, sizeof(command)) || !write(device, &REG_CONVERSION, 1))
+  {
+    return false;
+  }
+  device.converting = (int8_t)input;
+  // After the bus time of this round, not at the round's start
+  device.readyAt = halMillis() + waitMs;
+  return true;
+}
+
+void Ads1115Backend::poll(unsigned long now, SensorResultFn done, void *context)
+{
+  for (int i = 0; i < deviceCount; i++)
+  {
+    Device &device = devices[i];
+    if (device.converting >= 0 && (long)(now - device.readyAt) >= 0)
+    {
+      int channel = i * ADS_INPUTS + device.converting;
+      uint8_t result[2];
+      int raw = SENSOR_READ_FAILED;
+      if (read(device, result, sizeof(result)))
+      {
+        int16_t code = (int16_t)(result[0] << 8 | result[1]);
+        raw = code < 0 ? 0 : code >> 3;
+      }
+      device.converting = -1;
+      done(context, channel, raw);
+    }
+    if (device.converting < 0 && device.pending)
+    {
+      int input = 0;
+      while (!(device.pending & (1u << input)))
+      {
+        input++;
+      }
+      device.pending &= (uint8_t)~(1u << input);
+      if (!start(device, input))
+      {
+        done(context, i * ADS_INPUTS + input, SENSOR_READ_FAILED);
+      }
+    }
+  }
+}
+
+bool Ads1115Backend::nextPollTime(unsigned long now, unsigned long &at) const
+{
+  bool found = false;
+  for (int i = 0; i < deviceCount; i++)
+  {
+    const Device &device = devices[i];
+    unsigned long due;
+    if (device.converting >= 0)
+    {
+      due = device.readyAt;
+    }
+    else if (device.pending)
+    {
+      due = now;
+    }
+    else
+    {
+      continue;
+    }
+    if (!found || (long)(due - at) < 0)
+    {
+      at = due;
+      found = true;
+    }
+  }
+  return found;
+}
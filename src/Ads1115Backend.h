@@ -0,0 +1,65 @@
+#ifndef ADS1115_BACKEND_H
+#define ADS1115_BACKEND_H
+
+#include <stdint.h>
+#include "I2cBus.h"
+#include "SensorBackend.h"
+
+const int ADS_MAX_DEVICES = 4; // ADDR pin to GND, VDD, SDA or SCL: 0x48..0x4B
+const int ADS_INPUTS = 4;      // Single-ended AIN0..AIN3 against GND
+// Data rate field of the config register, 8 to 860 samples per second
+const uint8_t ADS_RATE_128 = 4;
+const uint8_t ADS_RATE_860 = 7;
+
+// ADS1115-style 16-bit I2C ADCs, channel = device * ADS_INPUTS + input.
+// Every device converts one queued input at a time in single-shot mode, and
+// all devices convert at once: a poll() reads each finished result, starts
+// the device's next input and points it at the result register, so the next
+// round is a single 2-byte read per device. Readiness comes from the data
+// rate (plus the oscillator's 10 % tolerance and a millisecond for millis()
+// rounding), which saves polling the ready bit over the bus.
+// Results use PGA +-4.096 V and are shifted to 12 bits, 1 mV per count.
+class Ads1115Backend : public SensorBackend
+{
+public:
+  Ads1115Backend(I2cBus &bus, const uint8_t *addresses, int devices, uint8_t dataRate = ADS_RATE_860);
+
+  // false if a device does not answer; its channels then report SENSOR_READ_FAILED
+  bool begin();
+
+  int channelCount() const override { return deviceCount * ADS_INPUTS; }
+  void request(int channel) override;
+  void poll(unsigned long now, SensorResultFn done, void *context) override;
+  bool nextPollTime(unsigned long now, unsigned long &at) const override;
+
+  unsigned long conversionMs() const { return waitMs; }
+
+  // Statistics
+  uint32_t transactions() const { return transactionCount; }
+  uint32_t busBytes() const { return byteCount; } // Payload, without address bytes
+  uint32_t busErrors() const { return errorCount; }
+
+private:
+  struct Device
+  {
+    uint8_t address;
+    uint8_t pending;   // Bit per input
+    int8_t converting; // Input, -1: idle
+    unsigned long readyAt;
+  };
+
+  I2cBus &bus;
+  Device devices[ADS_MAX_DEVICES];
+  int deviceCount;
+  uint8_t dataRate;
+  unsigned long waitMs;
+  uint32_t transactionCount;
+  uint32_t byteCount;
+  uint32_t errorCount;
+
+  bool write(const Device &device, const uint8_t *data, size_t length);
+  bool read(const Device &device, uint8_t *data, size_t length);
+  bool start(Device &device, int input);
+};
+
+#endif // ADS1115_BACKEND_H
@@ -0,0 +1,325 @@
+#include "ConfigDocument.h"
+#include <stdlib.h>
+#include <string.h>
+
+namespace
+{
+// Just enough JSON for the document format: objects, arrays, integers and
+// strings. Keeps the first error.
+class JsonCursor
+{
+public:
+  JsonCursor(const char *text, size_t length) : error(nullptr), text(text), end(text + length) {}
+
+  const char *error;
+
+  bool fail(const char *message)
+  {
+    if (!error)
+    {
+      error = message;
+    }
+    return false;
+  }
+
+  bool peek(char c)
+  {
+    skipSpace();
+    return text < end && *text == c;
+  }
+
+  bool expect(char c)
+  {
+    if (!peek(c))
+    {
+      return fail("malformed JSON");
+    }
+    text++;
+    return true;
+  }
+
+  // Separator between members/elements, false at the closing bracket
+  bool more(char close, bool first)
+  {
+    if (peek(close))
+    {
+      text++;
+      return false;
+    }
+    return first || expect(',');
+  }
+
+  bool string(char *out, size_t size)
+  {
+    if (!expect('"'))
+    {
+      return false;
+    }
+    size_t length = 0;
+    while (text < end && *text != '"')
+    {
+      if (length + 1 >= size)
+      {
+        return fail("string too long");
+      }
+      if (*text == '\\' && text + 1 < end)
+      {
+        text++; // Only names carry escapes, and those are not used
+      }
+      out[length++] = *text++;
+    }
+    out[length] = '\0';
+    return expect('"');
+  }
+
+  bool integer(long &out)
+  {
+    skipSpace();
+    char digits[12];
+    size_t length = 0;
+    while (text < end && length + 1 < sizeof(digits) && (*text == '-' || (*text >= '0' && *text <= '9')))
+    {
+      digits[length++] = *text++;
+    }
+    digits[length] = '\0';
+    char *parsed;
+    out = strtol(digits, &parsed, 10);
+    if (length == 0 || *parsed != '\0')
+    {
+      return fail("expected an integer");
+    }
+    return true;
+  }
+
+  bool atEnd()
+  {
+    skipSpace();
+    return text == end;
+  }
+
+private:
+  const char *text;
+  const char *end;
+
+  void skipSpace()
+  {
+    while (text < end && (*text == ' ' || *text == '\t' || *text == '\r' || *text == '\n'))
+    {
+      text++;
+    }
+  }
+};
+
+struct ZoneField
+{
+  const char *name;
+  int ZoneConfigRequest::*field;
+  long low;
+  long high;
+};
+
+const ZoneField ZONE_FIELDS[] = {
+    {"wetThreshold", &ZoneConfigRequest::wetThreshold, 0, 100},
+    {"dryThreshold", &ZoneConfigRequest::dryThreshold, 0, 100},
+    {"airValue", &ZoneConfigRequest::airValue, 0, CONFIG_ADC_MAX},
+    {"dryValue", &ZoneConfigRequest::dryValue, 0, CONFIG_ADC_MAX},
+    {"waterValue", &ZoneConfigRequest::waterValue, 0, CONFIG_ADC_MAX},
+    {"maxRuntime", &ZoneConfigRequest::maxRuntimeSec, 1, CONFIG_RUNTIME_SEC_MAX},
+    {"cooldown", &ZoneConfigRequest::cooldownSec, 1, CONFIG_COOLDOWN_SEC_MAX},
+    {"mode", &ZoneConfigRequest::mode, ZONE_MODE_THRESHOLD, ZONE_MODE_DOSING},
+};
+
+bool parseZone(JsonCursor &json, ZoneConfigRequest &zone)
+{
+  zone = {-1, -1, -1, -1, -1, -1, -1, -1, -1};
+  if (!json.expect('{'))
+  {
+    return false;
+  }
+  char key[16];
+  for (bool first = true; json.more('}', first); first = false)
+  {
+    if (!json.string(key, sizeof(key)) || !json.expect(':'))
+    {
+      return false;
+    }
+    if (strcmp(key, "name") == 0)
+    {
+      char ignored[ZONE_NAME_LEN * 6]; // Escaped on export
+      if (!json.string(ignored, sizeof(ignored)))
+      {
+        return false;
+      }
+      continue;
+    }
+    long value;
+    if (!json.integer(value))
+    {
+      return false;
+    }
+    if (strcmp(key, "id") == 0)
+    {
+      if (value < 0 || value > MAX_ZONE_ID)
+      {
+        return json.fail("zone id out of range");
+      }
+      zone.zoneId = (int)value;
+      continue;
+    }
+    const ZoneField *match = nullptr;
+    for (const ZoneField &field : ZONE_FIELDS)
+    {
+      if (strcmp(key, field.name) == 0)
+      {
+        match = &field;
+      }
+    }
+    if (!match)
+    {
+      return json.fail("unknown zone field");
+    }
+    if (value < match->low || value > match->high)
+    {
+      return json.fail("zone field out of range");
+    }
+    zone.*(match->field) = (int)value;
+  }
+  if (json.error)
+  {
+    return false;
+  }
+  return zone.zoneId >= 0 || json.fail("zone without id");
+}
+
+bool parseWeather(JsonCursor &json, WeatherProfile &weather)
+{
+  if (!json.expect('['))
+  {
+    return false;
+  }
+  int hour = 0;
+  for (bool first = true; json.more(']', first); first = false)
+  {
+    long value;
+    if (!json.integer(value))
+    {
+      return false;
+    }
+    if (hour >= 24 || value < 0 || value > 255)
+    {
+      return json.fail("weather needs 24 values of 0..255");
+    }
+    weather.etPercent[hour++] = (uint8_t)value;
+  }
+  return !json.error && (hour == 24 || json.fail("weather needs 24 values of 0..255"));
+}
+} // namespace
+
+bool parseConfigJson(const char *text, size_t length, ConfigDocument &out, const char *&error)
+{
+  JsonCursor json(text, length);
+  out.zoneCount = 0;
+  out.hasWeather = false;
+  flatWeatherProfile(out.weather);
+
+  bool sawVersion = false;
+  char key[16];
+  if (json.expect('{'))
+  {
+    for (bool first = true; json.more('}', first); first = false)
+    {
+      if (!json.string(key, sizeof(key)) || !json.expect(':'))
+      {
+        break;
+      }
+      if (strcmp(key, "version") == 0)
+      {
+        long version;
+        if (json.integer(version) && version != CONFIG_JSON_VERSION)
+        {
+          json.fail("unsupported version");
+        }
+        sawVersion = true;
+      }
+      else if (strcmp(key, "zones") == 0)
+      {
+        if (!json.expect('['))
+        {
+          break;
+        }
+        for (bool firstZone = true; json.more(']', firstZone); firstZone = false)
+        {
+          if (out.zoneCount == MAX_ZONES)
+          {
+            json.fail("too many zones");
+            break;
+          }
+          if (!parseZone(json, out.zones[out.zoneCount++]))
+          {
+            break;
+          }
+        }
+      }
+      else if (strcmp(key, "weather") == 0)
+      {
+        out.hasWeather = parseWeather(json, out.weather);
+      }
+      else
+      {
+        json.fail("unknown field");
+      }
+      if (json.error)
+      {
+        break;
+      }
+    }
+  }
+  if (!json.error && !json.atEnd())
+  {
+    json.fail("trailing data");
+  }
+  if (!json.error && !sawVersion)
+  {
+    json.fail("version missing");
+  }
+  error = json.error;
+  return error == nullptr;
+}
+
+bool validateConfig(const ConfigDocument &document, const SystemSnapshot &current, const char *&error)
+{
+  for (int i = 0; i < document.zoneCount; i++)
+  {
+    const ZoneConfigRequest &request = document.zones[i];
+    const ZoneSnapshot *zone = nullptr;
+    for (int z = 0; z < current.zoneCount; z++)
+    {
+      if (current.zones[z].id == request.zoneId)
+      {
+        zone = &current.zones[z];
+      }
+    }
+    if (!zone)
+    {
+      error = "unknown zone id";
+      return false;
+    }
+    for (int j = 0; j < i; j++)
+    {
+      if (document.zones[j].zoneId == request.zoneId)
+      {
+        error = "zone listed twice";
+        return false;
+      }
+    }
+    int wet = request.wetThreshold >= 0 ? request.wetThreshold : zone->wetThreshold;
+    int dry = request.dryThreshold >= 0 ? request.dryThreshold : zone->dryThreshold;
+    if (wet <= dry)
+    {
+      error = "wet threshold must be above dry threshold";
+      return false;
+    }
+  }
+  error = nullptr;
+  return true;
+}
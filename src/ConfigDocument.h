@@ -0,0 +1,37 @@
+#ifndef CONFIG_DOCUMENT_H
+#define CONFIG_DOCUMENT_H
+
+#include <stddef.h>
+#include "StatusApi.h"
+#include "WateringPlanner.h"
+#include "WateringZone.h"
+#include "ZoneSnapshot.h"
+
+// Complete configuration of a device as one JSON document, for /api/config
+// and fleet provisioning. Export and import use the same format:
+//
+//   {"version":1,"zones":[{"id":1,"name":"Bed","wetThreshold":80,"dryThreshold":30,
+//     "airValue":3700,"dryValue":3200,"waterValue":1500,"maxRuntime":30,
+//     "cooldown":300,"mode":0}],"weather":[100,...24 values]}
+//
+// Zone fields have the names of the /zone/N/config parameters. On import
+// every field but id is optional (left unchanged), "name" is ignored (names
+// come from the zone table) and "weather" may be left out.
+
+struct ConfigDocument
+{
+  ZoneConfigRequest zones[MAX_ZONES];
+  int zoneCount;
+  WeatherProfile weather;
+  bool hasWeather;
+};
+
+// Syntax and field ranges; error points to a static message on failure
+bool parseConfigJson(const char *text, size_t length, ConfigDocument &out, const char *&error);
+
+// Whole-document checks against the running configuration: every zone
+// exists and appears once, and wet > dry once merged with the current
+// values. Nothing may be applied unless this passes.
+bool validateConfig(const ConfigDocument &document, const SystemSnapshot &current, const char *&error);
+
+#endif // CONFIG_DOCUMENT_H
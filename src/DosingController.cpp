@@ -0,0 +1,128 @@
+#include "DosingController.h"
+
+DosingController::DosingController()
+    : phase(IDLE), learned(false), gain(0), soakMs(DOSE_INITIAL_SOAK_MS), startPercent(0), peakPercent(0),
+      currentPulseMs(0), pulseStart(0), pulseEnd(0), peakTime(0), pulseCount(0)
+{
+}
+
+unsigned long DosingController::pulseLength(int percent, int target, unsigned long maxPulseMs) const
+{
+  unsigned long length = DOSE_LEARN_PULSE_MS;
+  if (learned && gain > 0)
+  {
+    long distance = target > percent ? target - percent : 0;
+    length = (unsigned long)(distance * 1000000L / gain);
+  }
+  if (length < DOSE_MIN_PULSE_MS)
+  {
+    length = DOSE_MIN_PULSE_MS;
+  }
+  return length > maxPulseMs ? maxPulseMs : length;
+}
+
+void DosingController::pulseStarted(int percent, unsigned long now, unsigned long pulseMs)
+{
+  phase = PULSING;
+  startPercent = percent;
+  peakPercent = percent;
+  currentPulseMs = pulseMs;
+  pulseStart = now;
+  pulseCount++;
+}
+
+void DosingController::pulseStopped(unsigned long now)
+{
+  if (phase != PULSING)
+  {
+    return;
+  }
+  // The pulse may have been cut short by the wet threshold
+  currentPulseMs = now - pulseStart > 0 ? now - pulseStart : 1;
+  pulseEnd = now;
+  peakTime = now;
+  phase = SOAKING;
+}
+
+bool DosingController::observe(int percent, int target, unsigned long now)
+{
+  if (phase != SOAKING)
+  {
+    return false;
+  }
+  if (percent > peakPercent)
+  {
+    peakPercent = percent;
+    peakTime = now;
+  }
+  if ((long)(now - soakEndTime()) < 0)
+  {
+    return true;
+  }
+
+  // Still rising in the last quarter: the water has not fully arrived yet
+  bool rising = peakPercent > startPercent && (long)(peakTime - (pulseEnd + soakMs * 3 / 4)) > 0;
+  if (rising && soakMs < DOSE_MAX_SOAK_MS)
+  {
+    soakMs = soakMs * 3 / 2 > DOSE_MAX_SOAK_MS ? DOSE_MAX_SOAK_MS : soakMs * 3 / 2;
+    return true;
+  }
+
+  learn();
+  if (phase == SOAKING)
+  {
+    phase = percent < target - DOSE_TOLERANCE_PCT ? DOSING : IDLE;
+  }
+  return false;
+}
+
+void DosingController::learn()
+{
+  int rise = peakPercent - startPercent;
+  if (rise <= 0)
+  {
+    // No response at all (empty tank, blocked line): stop this dose
+    phase = IDLE;
+    return;
+  }
+
+  long measured = rise * 1000000L / (long)currentPulseMs;
+  gain = learned ? (3 * gain + measured) / 4 : measured;
+  learned = true;
+
+  unsigned long delay = peakTime - pulseEnd;
+  unsigned long target = delay * 3 / 2;
+  if (target < DOSE_MIN_SOAK_MS)
+  {
+    target = DOSE_MIN_SOAK_MS;
+  }
+  if (target > DOSE_MAX_SOAK_MS)
+  {
+    target = DOSE_MAX_SOAK_MS;
+  }
+  soakMs = (soakMs + target) / 2;
+}
+
+void DosingController::abort()
+{
+  phase = IDLE;
+}
+
+void DosingController::restore(long savedGain, unsigned long savedSoakMs)
+{
+  if (savedGain <= 0)
+  {
+    return;
+  }
+  gain = savedGain;
+  soakMs = savedSoakMs;
+  if (soakMs < DOSE_MIN_SOAK_MS)
+  {
+    soakMs = DOSE_MIN_SOAK_MS;
+  }
+  if (soakMs > DOSE_MAX_SOAK_MS)
+  {
+    soakMs = DOSE_MAX_SOAK_MS;
+  }
+  learned = true;
+}
@@ -0,0 +1,74 @@
+#ifndef DOSING_CONTROLLER_H
+#define DOSING_CONTROLLER_H
+
+// Dosing mode constants
+const unsigned long DOSE_LEARN_PULSE_MS = 4000;   // First pulse, before anything is learned
+const unsigned long DOSE_MIN_PULSE_MS = 1000;
+const unsigned long DOSE_INITIAL_SOAK_MS = 180000; // Wait after a pulse until the response is known
+const unsigned long DOSE_MIN_SOAK_MS = 30000;
+const unsigned long DOSE_MAX_SOAK_MS = 900000;
+const int DOSE_TOLERANCE_PCT = 3;                   // A dose is done within this of the target
+
+// Learns how a zone responds to water and sizes pump pulses from it.
+//
+// A dose is a series of pulses, each followed by a soak. During the soak the
+// zone's readings are observed; at its end the rise since the pulse gives
+// the gain (milli-percent per pump second) and the time of the peak gives
+// the diffusion delay, which becomes the next soak length. If the reading
+// is still climbing near the end of the soak, the soak is extended instead.
+// The next pulse is then sized to cover the remaining distance to the target.
+//
+// Integer math only. All times are millis() values passed in by the caller.
+class DosingController
+{
+public:
+  DosingController();
+
+  // Length of the next pulse from percent towards target, at most maxPulseMs
+  unsigned long pulseLength(int percent, int target, unsigned long maxPulseMs) const;
+  void pulseStarted(int percent, unsigned long now, unsigned long pulseMs);
+  void pulseStopped(unsigned long now);
+  // Feeds a reading; returns true while still soaking
+  bool observe(int percent, int target, unsigned long now);
+  // Drops the current dose (sensor in air, mode switched off)
+  void abort();
+  // A model learned before a restart (SettingsStore::loadModel())
+  void restore(long savedGain, unsigned long savedSoakMs);
+
+  unsigned long pulseMs() const { return currentPulseMs; }
+  bool isSoaking() const { return phase == SOAKING; }
+  unsigned long soakEndTime() const { return pulseEnd + soakMs; }
+  // The last soak ended below target - tolerance: pulse again
+  bool wantsMore() const { return phase == DOSING; }
+
+  bool hasModel() const { return learned; }
+  long gainMilliPercentPerSec() const { return gain; }
+  unsigned long soakTimeMs() const { return soakMs; }
+  unsigned long pulses() const { return pulseCount; }
+
+private:
+  enum Phase
+  {
+    IDLE,
+    PULSING,
+    SOAKING,
+    DOSING // Between soak end and the next pulse
+  };
+
+  Phase phase;
+  bool learned;
+  long gain;            // Milli-percent per pump second
+  unsigned long soakMs; // Learned delay until the response peaks, with margin
+
+  int startPercent;
+  int peakPercent;
+  unsigned long currentPulseMs;
+  unsigned long pulseStart;
+  unsigned long pulseEnd;
+  unsigned long peakTime;
+  unsigned long pulseCount;
+
+  void learn();
+};
+
+#endif // DOSING_CONTROLLER_H
@@ -0,0 +1,294 @@
+#include "EventLog.h"
+#include <stdio.h>
+#include <string.h>
+#include "Hal.h"
+
+static const char *const EVENT_FORMATS[LOG_EVENT_COUNT] = {
+    "%ld log records dropped",
+    "Zone %ld: Invalid pin configuration - Sensor: GPIO%ld, Pump: GPIO%ld",
+    "Zone %ld initialized - Sensor: GPIO%ld, Pump: GPIO%ld",
+    "Zone %ld: id invalid or already in use, skipped",
+    "Zone %ld: Invalid thresholds, now wet=%ld%%, dry=%ld%%",
+    "Zone %ld settings loaded: Wet=%ld%%, Dry=%ld%%, Runtime=%lds, Cooldown=%lds, Dosing=%ld",
+    "Settings saved for %ld zone(s)",
+    "Zone %ld settings updated via web interface",
+    "Zone %ld: cooldown restored after reset, %lds left (timed out: %ld)",
+    "Zone %ld: raw %ld, moisture %ld%%",
+    "Zone %ld pump ON - moisture: %ld%%",
+    "Zone %ld pump OFF - moisture: %ld%%",
+    "Zone %ld: Pump stopped - sensor in air (raw: %ld >= air: %ld)",
+    "Zone %ld: Pump stopped - sensor %ld stopped reading",
+    "Zone %ld dosing pulse %ldms (gain %ld m%%/s, soak %lds)",
+    "First control tick %ld us after boot",
+    "Weather profile loaded",
+    "Weather profile updated via web interface",
+    "Configuration document applied: %ld of %ld zone(s) changed, weather: %ld",
+    "Mesh: node %ld joined",
+    "Mesh: node %ld did not confirm config for zone %ld",
+};
+
+static const char LEVEL_LETTERS[] = "DIWE";
+
+EventLog eventLog;
+
+EventLog::EventLog() : writePosition(0), readPosition(0), droppedCount(0), droppedReported(0), historyNext(0)
+{
+  for (size_t i = 0; i < LOG_RING_SIZE; i++)
+  {
+    cells[i].sequence.store((uint32_t)i, std::memory_order_relaxed);
+  }
+  memset(history, 0, sizeof(history));
+}
+
+bool EventLog::write(LogEvent event, uint8_t level, const int32_t *args, uint8_t count)
+{
+  uint32_t position = writePosition.load(std::memory_order_relaxed);
+  Cell *cell;
+  while (true)
+  {
+    cell = &cells[position & (LOG_RING_SIZE - 1)];
+    int32_t lag = (int32_t)(cell->sequence.load(std::memory_order_acquire) - position);
+    if (lag == 0)
+    {
+      if (writePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+      {
+        break;
+      }
+    }
+    else if (lag < 0)
+    {
+      // The drain has not freed this cell yet: the ring is full
+      droppedCount.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+    else
+    {
+      position = writePosition.load(std::memory_order_relaxed);
+    }
+  }
+
+  LogRecord &record = cell->record;
+  record.timeMs = (uint32_t)halMillis();
+  record.event = event;
+  record.level = level;
+  record.argCount = count;
+  memcpy(record.args, args, count * sizeof(int32_t));
+  cell->sequence.store(position + 1, std::memory_order_release);
+  return true;
+}
+
+bool EventLog::read(LogRecord &out)
+{
+  Cell &cell = cells[readPosition & (LOG_RING_SIZE - 1)];
+  if (cell.sequence.load(std::memory_order_acquire) != readPosition + 1)
+  {
+    return false; // Empty, or the next writer has claimed but not filled it yet
+  }
+  out = cell.record;
+  cell.sequence.store(readPosition + LOG_RING_SIZE, std::memory_order_release);
+  readPosition++;
+  return true;
+}
+
+void EventLog::keep(const LogRecord &record)
+{
+  std::lock_guard<std::mutex> lock(historyMutex);
+  history[historyNext % LOG_HISTORY_SIZE] = record;
+  historyNext++;
+}
+
+size_t EventLog::drain(LineSink sink)
+{
+  char line[LOG_LINE_MAX];
+  LogRecord record;
+  size_t drained = 0;
+
+  uint32_t dropped = droppedCount.load(std::memory_order_relaxed);
+  if (dropped != droppedReported)
+  {
+    record = {};
+    record.timeMs = (uint32_t)halMillis();
+    record.event = LOG_DROPPED;
+    record.level = LOG_LEVEL_WARN;
+    record.argCount = 1;
+    record.args[0] = (int32_t)(dropped - droppedReported);
+    droppedReported = dropped;
+    format(record, line, sizeof(line));
+    sink(record, line);
+    keep(record);
+    drained++;
+  }
+
+  while (read(record))
+  {
+    format(record, line, sizeof(line));
+    sink(record, line);
+    keep(record);
+    drained++;
+  }
+  return drained;
+}
+
+size_t EventLog::readHistory(uint32_t &since, LogRecord *out, size_t max)
+{
+  std::lock_guard<std::mutex> lock(historyMutex);
+  uint32_t oldest = historyNext > LOG_HISTORY_SIZE ? historyNext - LOG_HISTORY_SIZE : 0;
+  if (since < oldest)
+  {
+    since = oldest;
+  }
+  size_t copied = 0;
+  while (since < historyNext && copied < max)
+  {
+    out[copied++] = history[since % LOG_HISTORY_SIZE];
+    since++;
+  }
+  return copied;
+}
+
+uint32_t EventLog::nextSequence() const
+{
+  std::lock_guard<std::mutex> lock(historyMutex);
+  return historyNext;
+}
+
+size_t EventLog::format(const LogRecord &record, char *buffer, size_t size)
+{
+  int32_t a[LOG_MAX_ARGS] = {};
+  memcpy(a, record.args, record.argCount * sizeof(int32_t));
+  int prefix = snprintf(buffer, size, "[%6lu.%03lu] %c ", (unsigned long)(record.timeMs / 1000),
+                        (unsigned long)(record.timeMs % 1000), LEVEL_LETTERS[record.level & 3]);
+  if (prefix < 0 || (size_t)prefix >= size)
+  {
+    return 0;
+  }
+  const char *text = record.event < LOG_EVENT_COUNT ? EVENT_FORMATS[record.event] : "Unknown event %ld";
+  // Surplus arguments are ignored by printf, so every format gets all six
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wformat-nonliteral"
+  int body = snprintf(buffer + prefix, size - prefix, text, (long)a[0], (long)a[1], (long)a[2], (long)a[3],
+                      (long)a[4], (long)a[5]);
+#pragma GCC diagnostic pop
+  if (body < 0)
+  {
+    return 0;
+  }
+  size_t length = (size_t)prefix + (size_t)body;
+  return length < size ? length : size - 1;
+}
+
+LogHistoryWriter::LogHistoryWriter(EventLog &log, uint32_t since, uint32_t until)
+    : log(log), next(since), until(until), lineLength(0), lineOffset(0)
+{
+}
+
+bool LogHistoryWriter::renderRecord()
+{
+  LogRecord record;
+  // Records older than the history are skipped, next moves up to the oldest kept
+  if (next >= until || log.readHistory(next, &record, 1) == 0)
+  {
+    return false;
+  }
+  int prefix = snprintf(line, sizeof(line), "%lu ", (unsigned long)(next - 1));
+  size_t length = EventLog::format(record, line + prefix, sizeof(line) - prefix - 1);
+  lineLength = prefix + length;
+  line[lineLength++] = '\n';
+  lineOffset = 0;
+  return true;
+}
+
+size_t LogHistoryWriter::fill(char *buffer, size_t size)
+{
+  size_t written = 0;
+  while (written < size)
+  {
+    if (lineOffset == lineLength && !renderRecord())
+    {
+      break;
+    }
+    size_t chunk = lineLength - lineOffset;
+    if (chunk > size - written)
+    {
+      chunk = size - written;
+    }
+    memcpy(buffer + written, line + lineOffset, chunk);
+    lineOffset += chunk;
+    written += chunk;
+  }
+  return written;
+}
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#include <LittleFS.h>
+
+static const char *const LOG_FILE = "/log.txt";
+static const char *const LOG_FILE_OLD = "/log.old.txt"; // Previous LOG_FILE_MAX bytes
+static const size_t LOG_FILE_MAX = 65536;
+static const unsigned long LOG_FILE_FLUSH_MS = 10000; // Flash is written at most this often
+
+// Log lines for LOG_FILE, written in batches by drainLog()
+static char logFileBuffer[1024];
+static size_t logFileFill = 0;
+static bool logFileReady = false;
+
+bool beginLogFile()
+{
+  logFileReady = LittleFS.begin(true);
+  return logFileReady;
+}
+
+static void flushLogFile()
+{
+  if (logFileFill == 0 || !logFileReady)
+  {
+    logFileFill = 0;
+    return;
+  }
+  File file = LittleFS.open(LOG_FILE, "a");
+  if (file && file.size() + logFileFill > LOG_FILE_MAX)
+  {
+    file.close();
+    LittleFS.remove(LOG_FILE_OLD);
+    LittleFS.rename(LOG_FILE, LOG_FILE_OLD);
+    file = LittleFS.open(LOG_FILE, "a");
+  }
+  if (file)
+  {
+    file.write(reinterpret_cast<const uint8_t *>(logFileBuffer), logFileFill);
+    file.close();
+  }
+  logFileFill = 0;
+}
+
+static void writeLogLine(const LogRecord &record, const char *line)
+{
+  Serial.println(line);
+  if (record.level < LOG_LEVEL_INFO)
+  {
+    return; // Debug lines stay off the flash
+  }
+  size_t length = strlen(line);
+  if (logFileFill + length + 1 > sizeof(logFileBuffer))
+  {
+    flushLogFile();
+  }
+  memcpy(logFileBuffer + logFileFill, line, length);
+  logFileFill += length;
+  logFileBuffer[logFileFill++] = '\n';
+}
+
+// The control task only stores binary records and never waits for the
+// UART or the filesystem
+void drainLog()
+{
+  static unsigned long lastFileFlush = 0;
+  eventLog.drain(writeLogLine);
+  if (millis() - lastFileFlush >= LOG_FILE_FLUSH_MS)
+  {
+    flushLogFile();
+    lastFileFlush = millis();
+  }
+}
+#endif
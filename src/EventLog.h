@@ -0,0 +1,181 @@
+#ifndef EVENT_LOG_H
+#define EVENT_LOG_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+#include <mutex>
+
+// Binary event log for the control paths.
+//
+// A log site stores a fixed 32-byte record (time, event id, up to six
+// integer arguments) into a lock-free ring and returns; it never formats
+// text or waits for the UART. One drain task turns records into text lines
+// for Serial, the log file and /api/log, and keeps the latest of them for
+// the web page. A full ring drops the new record and counts it; the drain
+// reports the count as a LOG_DROPPED line.
+//
+// Sites below LOG_LEVEL (build flag, default LOG_LEVEL_INFO) expand to
+// nothing, arguments included.
+
+#define LOG_LEVEL_DEBUG 0
+#define LOG_LEVEL_INFO 1
+#define LOG_LEVEL_WARN 2
+#define LOG_LEVEL_ERROR 3
+#define LOG_LEVEL_NONE 4
+
+#ifndef LOG_LEVEL
+#define LOG_LEVEL LOG_LEVEL_INFO
+#endif
+
+// Format strings in EventLog.cpp; every argument is printed with %ld
+enum LogEvent : uint16_t
+{
+  LOG_DROPPED,             // Written by the drain itself
+  LOG_ZONE_INVALID_PINS,   // zone, sensor pin, pump pin
+  LOG_ZONE_INITIALIZED,    // zone, sensor pin, pump pin
+  LOG_ZONE_SKIPPED,        // zone
+  LOG_THRESHOLDS_FIXED,    // zone, wet, dry
+  LOG_SETTINGS_LOADED,     // zone, wet, dry, runtime s, cooldown s, dosing
+  LOG_SETTINGS_SAVED,      // zone count
+  LOG_SETTINGS_UPDATED,    // zone
+  LOG_COOLDOWN_RESTORED,   // zone, seconds left, last run timed out
+  LOG_SENSOR_READING,      // zone, raw, percent
+  LOG_PUMP_ON,             // zone, moisture %
+  LOG_PUMP_OFF,            // zone, moisture %
+  LOG_PUMP_AIR_STOP,       // zone, raw, air value
+  LOG_PUMP_STALE_STOP,     // zone, sensor address
+  LOG_DOSING_PULSE,        // zone, ms, gain m%/s, soak s
+  LOG_FIRST_TICK,          // us after boot
+  LOG_WEATHER_LOADED,
+  LOG_WEATHER_UPDATED,
+  LOG_DOCUMENT_APPLIED,    // zones changed, zones in the document, with weather
+  LOG_MESH_NODE_JOINED,    // node
+  LOG_MESH_CONFIG_LOST,    // node, zone
+  LOG_EVENT_COUNT
+};
+
+const int LOG_MAX_ARGS = 6;
+const size_t LOG_RING_SIZE = 128;    // Records between two drains, power of two
+const size_t LOG_HISTORY_SIZE = 128; // Drained records kept for /api/log
+const size_t LOG_LINE_MAX = 128;
+
+struct LogRecord
+{
+  uint32_t timeMs;
+  uint16_t event;
+  uint8_t level;
+  uint8_t argCount;
+  int32_t args[LOG_MAX_ARGS];
+};
+
+static_assert(sizeof(LogRecord) == 32, "records are meant to stay compact");
+static_assert((LOG_RING_SIZE & (LOG_RING_SIZE - 1)) == 0, "ring index is masked");
+
+class EventLog
+{
+public:
+  EventLog();
+
+  // Any task; false if the ring was full (the record is counted as dropped)
+  bool write(LogEvent event, uint8_t level, const int32_t *args, uint8_t count);
+
+  // Drain task only: formats every pending record and passes it to sink,
+  // then keeps it in the history. Returns the number of records drained.
+  typedef void (*LineSink)(const LogRecord &record, const char *line);
+  size_t drain(LineSink sink);
+
+  // Any task: history records with a sequence number >= since, oldest
+  // first; since is advanced past the last one copied
+  size_t readHistory(uint32_t &since, LogRecord *out, size_t max);
+  // Sequence number the next drained record will get
+  uint32_t nextSequence() const;
+  uint32_t dropped() const { return droppedCount.load(std::memory_order_relaxed); }
+
+  // "[   12.345] I Zone 1 pump ON - moisture: 23%" without a newline
+  static size_t format(const LogRecord &record, char *buffer, size_t size);
+
+private:
+  // Bounded MPSC queue (per-cell sequence numbers): producers claim a slot
+  // with one compare-and-swap, the single consumer needs no atomics on its
+  // read position
+  struct Cell
+  {
+    std::atomic<uint32_t> sequence;
+    LogRecord record;
+  };
+
+  Cell cells[LOG_RING_SIZE];
+  std::atomic<uint32_t> writePosition;
+  uint32_t readPosition;
+  std::atomic<uint32_t> droppedCount;
+  uint32_t droppedReported;
+
+  mutable std::mutex historyMutex; // Drain task against web readers, never taken by writers
+  LogRecord history[LOG_HISTORY_SIZE];
+  uint32_t historyNext; // Sequence number of the next history record
+
+  bool read(LogRecord &out);
+  void keep(const LogRecord &record);
+};
+
+extern EventLog eventLog;
+
+// Streams history records [since, until) as "<sequence> <line>\n" text in
+// chunks, like MetricsWriter
+class LogHistoryWriter
+{
+public:
+  LogHistoryWriter(EventLog &log, uint32_t since, uint32_t until);
+  // Fills up to size bytes, returns 0 when everything was written
+  size_t fill(char *buffer, size_t size);
+
+private:
+  EventLog &log;
+  uint32_t next;
+  uint32_t until;
+  char line[LOG_LINE_MAX + 12];
+  size_t lineLength;
+  size_t lineOffset;
+
+  bool renderRecord();
+};
+
+#ifdef ARDUINO
+// Device side of the drain task, run from the loop task: lines go to
+// Serial, and from LOG_LEVEL_INFO up in batches to /log.txt in LittleFS,
+// which is rotated to /log.old.txt at 64 KiB
+bool beginLogFile(); // false without LittleFS, lines then only go to Serial
+void drainLog();
+#endif
+
+template <typename... Args>
+inline void logEvent(uint8_t level, LogEvent event, Args... args)
+{
+  static_assert(sizeof...(Args) <= LOG_MAX_ARGS, "too many log arguments");
+  const int32_t values[] = {0, (int32_t)args...}; // Leading 0: no zero-length array
+  eventLog.write(event, level, values + 1, (uint8_t)sizeof...(Args));
+}
+
+#if LOG_LEVEL <= LOG_LEVEL_DEBUG
+#define LOG_DEBUG(event, ...) logEvent(LOG_LEVEL_DEBUG, event, ##__VA_ARGS__)
+#else
+#define LOG_DEBUG(event, ...) ((void)0)
+#endif
+#if LOG_LEVEL <= LOG_LEVEL_INFO
+#define LOG_INFO(event, ...) logEvent(LOG_LEVEL_INFO, event, ##__VA_ARGS__)
+#else
+#define LOG_INFO(event, ...) ((void)0)
+#endif
+#if LOG_LEVEL <= LOG_LEVEL_WARN
+#define LOG_WARN(event, ...) logEvent(LOG_LEVEL_WARN, event, ##__VA_ARGS__)
+#else
+#define LOG_WARN(event, ...) ((void)0)
+#endif
+#if LOG_LEVEL <= LOG_LEVEL_ERROR
+#define LOG_ERROR(event, ...) logEvent(LOG_LEVEL_ERROR, event, ##__VA_ARGS__)
+#else
+#define LOG_ERROR(event, ...) ((void)0)
+#endif
+
+#endif // EVENT_LOG_H
@@ -0,0 +1,120 @@
+#ifndef FLASH_TARGET_H
+#define FLASH_TARGET_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Destination of a streamed update (UpdateWriter): the inactive OTA app
+// partition or a web asset on the device, a file on the host.
+class FlashTarget
+{
+public:
+  virtual ~FlashTarget() {}
+
+  // Prepares for an image of size bytes (0: not known in advance); false if
+  // it cannot fit. Must not erase everything up front, that would stall the
+  // flash cache (and with it the control task) for seconds.
+  virtual bool begin(size_t size) = 0;
+  // Sequential: offset is the sum of all previous lengths
+  virtual bool write(size_t offset, const uint8_t *data, size_t length) = 0;
+  // The complete image was written and checked: make it the active one
+  virtual bool commit() = 0;
+  // Drops a partial image, the active one stays untouched
+  virtual void abort() = 0;
+};
+
+#ifdef ARDUINO
+#include <esp_ota_ops.h>
+
+// Inactive app slot. esp_ota_end() checks the image header and its appended
+// SHA-256; the new slot only becomes the boot partition in commit().
+class OtaFlashTarget : public FlashTarget
+{
+public:
+  bool begin(size_t size) override
+  {
+    partition = esp_ota_get_next_update_partition(nullptr);
+    if (!partition || (size > 0 && size > partition->size))
+    {
+      return false;
+    }
+    // Sequential writes erase sector by sector instead of the whole slot at once
+    return esp_ota_begin(partition, OTA_WITH_SEQUENTIAL_WRITES, &handle) == ESP_OK;
+  }
+
+  bool write(size_t, const uint8_t *data, size_t length) override
+  {
+    return esp_ota_write(handle, data, length) == ESP_OK;
+  }
+
+  bool commit() override
+  {
+    bool valid = esp_ota_end(handle) == ESP_OK;
+    handle = 0;
+    return valid && esp_ota_set_boot_partition(partition) == ESP_OK;
+  }
+
+  void abort() override
+  {
+    if (handle)
+    {
+      esp_ota_abort(handle);
+      handle = 0;
+    }
+  }
+
+private:
+  const esp_partition_t *partition = nullptr;
+  esp_ota_handle_t handle = 0;
+};
+
+#include <LittleFS.h>
+
+// A gzip page in LittleFS that replaces the embedded copy. Written to a
+// temporary file and renamed on commit, so a failed upload leaves the
+// previous page in place.
+class AssetFlashTarget : public FlashTarget
+{
+public:
+  explicit AssetFlashTarget(const char *path) : path(path) {}
+
+  bool begin(size_t size) override
+  {
+    if (!LittleFS.begin(true) || (size > 0 && size > LittleFS.totalBytes() - LittleFS.usedBytes()))
+    {
+      return false;
+    }
+    file = LittleFS.open(temporaryPath(), "w");
+    return (bool)file;
+  }
+
+  bool write(size_t, const uint8_t *data, size_t length) override
+  {
+    return file.write(data, length) == length;
+  }
+
+  bool commit() override
+  {
+    file.close();
+    LittleFS.remove(path);
+    return LittleFS.rename(temporaryPath(), path);
+  }
+
+  void abort() override
+  {
+    if (file)
+    {
+      file.close();
+    }
+    LittleFS.remove(temporaryPath());
+  }
+
+private:
+  const char *path;
+  File file;
+
+  String temporaryPath() const { return String(path) + ".tmp"; }
+};
+#endif
+
+#endif // FLASH_TARGET_H
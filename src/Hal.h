@@ -0,0 +1,86 @@
+#ifndef HAL_H
+#define HAL_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "KeyValueStore.h"
+
+// Thin hardware abstraction so zone logic runs on the device and on the host.
+// The device installs Arduino-backed implementations (HalArduino.cpp); host
+// builds start with HalNative.cpp and simulations install their own.
+
+class HalClock
+{
+public:
+  virtual ~HalClock() {}
+  virtual unsigned long millis() = 0;
+  virtual unsigned long micros() = 0;
+};
+
+class HalAdc
+{
+public:
+  virtual ~HalAdc() {}
+  virtual int read(int pin) = 0;
+};
+
+class HalGpio
+{
+public:
+  virtual ~HalGpio() {}
+  virtual void setInput(int pin) = 0;
+  virtual void setOutput(int pin) = 0;
+  virtual void write(int pin, bool high) = 0;
+};
+
+typedef void (*HalLogFn)(const char *message);
+
+struct Hal
+{
+  HalClock *clock;
+  HalAdc *adc;
+  HalGpio *gpio;
+  KeyValueStore *store;
+  HalLogFn log;
+};
+
+Hal &hal();
+void installHal(const Hal &replacement);
+
+inline unsigned long halMillis()
+{
+  return hal().clock->millis();
+}
+
+inline unsigned long halMicros()
+{
+  return hal().clock->micros();
+}
+
+// Free-running CPU cycle counter (wraps). Nanoseconds on the host.
+uint32_t halCycles();
+
+// Busy wait of a few microseconds, e.g. for an analog input to settle.
+// Returns at once on the host; simulations count the waits instead.
+void halDelayMicros(uint32_t us);
+
+struct HalHeapStats
+{
+  uint32_t freeBytes;
+  uint32_t largestBlock; // Largest single allocation that would succeed
+  uint32_t minFreeBytes; // Low-water mark since boot
+};
+
+// Returns false where the platform has no heap statistics
+bool halHeapStats(HalHeapStats &out);
+
+// Memory that survives software, watchdog and brownout resets (RTC RAM on
+// the device, a static buffer on the host). Contents are undefined after
+// power-on, callers validate them. nullptr if size exceeds HAL_RETAINED_BYTES.
+const size_t HAL_RETAINED_BYTES = 256;
+void *halRetainedMemory(size_t size);
+
+// printf-style logging through the installed log sink
+void halLog(const char *format, ...) __attribute__((format(printf, 1, 2)));
+
+#endif // HAL_H
@@ -0,0 +1,87 @@
+#ifdef ARDUINO
+#include <Arduino.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include "Hal.h"
+
+class ArduinoClock : public HalClock
+{
+public:
+  unsigned long millis() override { return ::millis(); }
+  unsigned long micros() override { return ::micros(); }
+};
+
+class ArduinoAdc : public HalAdc
+{
+public:
+  int read(int pin) override { return analogRead(pin); }
+};
+
+class ArduinoGpio : public HalGpio
+{
+public:
+  void setInput(int pin) override { pinMode(pin, INPUT); }
+  void setOutput(int pin) override { pinMode(pin, OUTPUT); }
+  void write(int pin, bool high) override { digitalWrite(pin, high ? HIGH : LOW); }
+};
+
+static void serialLog(const char *message)
+{
+  Serial.print(message);
+}
+
+static ArduinoClock arduinoClock;
+static ArduinoAdc arduinoAdc;
+static ArduinoGpio arduinoGpio;
+static PreferencesStore preferencesStore;
+static Hal current = {&arduinoClock, &arduinoAdc, &arduinoGpio, &preferencesStore, serialLog};
+
+Hal &hal()
+{
+  return current;
+}
+
+void installHal(const Hal &replacement)
+{
+  current = replacement;
+}
+
+RTC_NOINIT_ATTR static uint8_t retainedMemory[HAL_RETAINED_BYTES];
+
+void *halRetainedMemory(size_t size)
+{
+  return size <= sizeof(retainedMemory) ? retainedMemory : nullptr;
+}
+
+uint32_t halCycles()
+{
+  return ESP.getCycleCount();
+}
+
+void halDelayMicros(uint32_t us)
+{
+  delayMicroseconds(us);
+}
+
+bool halHeapStats(HalHeapStats &out)
+{
+  out.freeBytes = ESP.getFreeHeap();
+  out.largestBlock = ESP.getMaxAllocHeap();
+  out.minFreeBytes = ESP.getMinFreeHeap();
+  return true;
+}
+
+void halLog(const char *format, ...)
+{
+  if (!current.log)
+  {
+    return;
+  }
+  char message[192];
+  va_list args;
+  va_start(args, format);
+  vsnprintf(message, sizeof(message), format, args);
+  va_end(args);
+  current.log(message);
+}
+#endif // ARDUINO
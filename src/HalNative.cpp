@@ -0,0 +1,95 @@
+#ifndef ARDUINO
+#include <stdarg.h>
+#include <stdio.h>
+#include <chrono>
+#include "Hal.h"
+
+// Host defaults: wall clock, floating ADC, no-op GPIO, in-memory NVS
+
+class NativeClock : public HalClock
+{
+public:
+  unsigned long millis() override { return (unsigned long)(elapsedUs() / 1000); }
+  unsigned long micros() override { return (unsigned long)elapsedUs(); }
+
+private:
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+  long long elapsedUs()
+  {
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+  }
+};
+
+class NativeAdc : public HalAdc
+{
+public:
+  int read(int) override { return 4095; } // Unconnected input reads like a sensor in air
+};
+
+class NativeGpio : public HalGpio
+{
+public:
+  void setInput(int) override {}
+  void setOutput(int) override {}
+  void write(int, bool) override {}
+};
+
+static void stdoutLog(const char *message)
+{
+  fputs(message, stdout);
+}
+
+static NativeClock nativeClock;
+static NativeAdc nativeAdc;
+static NativeGpio nativeGpio;
+static MemoryKeyValueStore memoryStore;
+static Hal current = {&nativeClock, &nativeAdc, &nativeGpio, &memoryStore, stdoutLog};
+
+Hal &hal()
+{
+  return current;
+}
+
+void installHal(const Hal &replacement)
+{
+  current = replacement;
+}
+
+static uint8_t retainedMemory[HAL_RETAINED_BYTES];
+
+void *halRetainedMemory(size_t size)
+{
+  return size <= sizeof(retainedMemory) ? retainedMemory : nullptr;
+}
+
+uint32_t halCycles()
+{
+  return (uint32_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+void halDelayMicros(uint32_t)
+{
+}
+
+bool halHeapStats(HalHeapStats &)
+{
+  return false;
+}
+
+void halLog(const char *format, ...)
+{
+  if (!current.log)
+  {
+    return;
+  }
+  char message[192];
+  va_list args;
+  va_start(args, format);
+  vsnprintf(message, sizeof(message), format, args);
+  va_end(args);
+  current.log(message);
+}
+#endif // ARDUINO
@@ -0,0 +1,48 @@
+#ifndef I2C_BUS_H
+#define I2C_BUS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Blocking I2C master transfers, one transaction per call. 7-bit addresses.
+class I2cBus
+{
+public:
+  virtual ~I2cBus() {}
+
+  // false on NACK or bus error
+  virtual bool write(uint8_t address, const uint8_t *data, size_t length) = 0;
+  virtual bool read(uint8_t address, uint8_t *data, size_t length) = 0;
+};
+
+#ifdef ARDUINO
+#include <Wire.h>
+
+class WireI2cBus : public I2cBus
+{
+public:
+  bool begin(int sdaPin, int sclPin, uint32_t frequency) { return Wire.begin(sdaPin, sclPin, frequency); }
+
+  bool write(uint8_t address, const uint8_t *data, size_t length) override
+  {
+    Wire.beginTransmission(address);
+    Wire.write(data, length);
+    return Wire.endTransmission() == 0;
+  }
+
+  bool read(uint8_t address, uint8_t *data, size_t length) override
+  {
+    if (Wire.requestFrom(address, length) != length)
+    {
+      return false;
+    }
+    for (size_t i = 0; i < length; i++)
+    {
+      data[i] = (uint8_t)Wire.read();
+    }
+    return true;
+  }
+};
+#endif
+
+#endif // I2C_BUS_H
@@ -0,0 +1,99 @@
+#ifndef KEY_VALUE_STORE_H
+#define KEY_VALUE_STORE_H
+
+#include <stddef.h>
+#include <string.h>
+#include <map>
+#include <string>
+#include <vector>
+
+// Minimal view of the NVS Preferences API used for settings persistence
+class KeyValueStore
+{
+public:
+  virtual ~KeyValueStore() {}
+
+  virtual bool begin(const char *space, bool readOnly) = 0;
+  virtual void end() = 0;
+  virtual int getInt(const char *key, int defaultValue) = 0;
+  virtual size_t getBytes(const char *key, void *buffer, size_t size) = 0;
+  virtual size_t putBytes(const char *key, const void *data, size_t size) = 0;
+};
+
+// In-memory stand-in for host builds; counts writes so flash wear can be measured
+class MemoryKeyValueStore : public KeyValueStore
+{
+public:
+  unsigned long writeCount = 0;
+  unsigned long openCount = 0;
+
+  bool begin(const char *space, bool) override
+  {
+    current = space;
+    openCount++;
+    return true;
+  }
+
+  void end() override {}
+
+  int getInt(const char *key, int defaultValue) override
+  {
+    auto it = ints.find(current + "/" + key);
+    return it == ints.end() ? defaultValue : it->second;
+  }
+
+  void putInt(const char *key, int value) { ints[current + "/" + key] = value; }
+
+  size_t getBytes(const char *key, void *buffer, size_t size) override
+  {
+    auto it = blobs.find(current + "/" + key);
+    if (it == blobs.end() || it->second.size() > size)
+    {
+      return 0;
+    }
+    memcpy(buffer, it->second.data(), it->second.size());
+    return it->second.size();
+  }
+
+  size_t putBytes(const char *key, const void *data, size_t size) override
+  {
+    const unsigned char *bytes = static_cast<const unsigned char *>(data);
+    blobs[current + "/" + key].assign(bytes, bytes + size);
+    writeCount++;
+    return size;
+  }
+
+private:
+  std::string current;
+  std::map<std::string, int> ints;
+  std::map<std::string, std::vector<unsigned char>> blobs;
+};
+
+#ifdef ARDUINO
+#include <Preferences.h>
+
+class PreferencesStore : public KeyValueStore
+{
+public:
+  bool begin(const char *space, bool readOnly) override { return preferences.begin(space, readOnly); }
+  void end() override { preferences.end(); }
+  int getInt(const char *key, int defaultValue) override
+  {
+    // Avoid the NVS "not found" error log for keys that were never written
+    return preferences.isKey(key) ? preferences.getInt(key, defaultValue) : defaultValue;
+  }
+  size_t getBytes(const char *key, void *buffer, size_t size) override
+  {
+    return preferences.isKey(key) ? preferences.getBytes(key, buffer, size) : 0;
+  }
+  size_t putBytes(const char *key, const void *data, size_t size) override
+  {
+    return preferences.putBytes(key, data, size);
+  }
+
+private:
+  Preferences preferences;
+};
+#endif
+
+#endif // KEY_VALUE_STORE_H
@@ -0,0 +1,392 @@
+#include "MeshAggregator.h"
+#include <stdio.h>
+#include <string.h>
+#include "EventLog.h"
+#include "Hal.h"
+
+MeshAggregator::MeshAggregator(MeshTransport &transport)
+    : framesReceived(0), bytesReceived(0), framesRejected(0), syncsSent(0), configsSent(0), configsAcked(0),
+      configsDropped(0), transport(transport), nodes(), count(0)
+{
+}
+
+MeshAggregator::Node *MeshAggregator::findNode(uint16_t nodeId)
+{
+  for (int i = 0; i < count; i++)
+  {
+    if (nodes[i].id == nodeId)
+    {
+      return &nodes[i];
+    }
+  }
+  return nullptr;
+}
+
+const MeshAggregator::Node *MeshAggregator::findNode(uint16_t nodeId) const
+{
+  return const_cast<MeshAggregator *>(this)->findNode(nodeId);
+}
+
+MeshAggregator::Node *MeshAggregator::nodeFor(uint16_t nodeId, const MeshAddress &from, unsigned long now)
+{
+  Node *node = findNode(nodeId);
+  if (!node)
+  {
+    if (count == MESH_MAX_NODES)
+    {
+      return nullptr;
+    }
+    node = &nodes[count++];
+    *node = Node();
+    node->id = nodeId;
+    node->lastSync = now - MESH_SYNC_INTERVAL_MS;
+    LOG_INFO(LOG_MESH_NODE_JOINED, nodeId);
+  }
+  node->address = from; // Follows DHCP changes
+  node->lastSeen = now;
+  return node;
+}
+
+MeshZoneView *MeshAggregator::zoneFor(Node &node, uint16_t zoneId)
+{
+  for (int i = 0; i < node.zoneCount; i++)
+  {
+    if (node.zones[i].status.zoneId == zoneId)
+    {
+      return &node.zones[i];
+    }
+  }
+  if (node.zoneCount == MAX_ZONES)
+  {
+    return nullptr;
+  }
+  MeshZoneView &zone = node.zones[node.zoneCount++];
+  zone = MeshZoneView();
+  zone.status.zoneId = zoneId;
+  return &zone;
+}
+
+void MeshAggregator::poll(unsigned long now)
+{
+  uint8_t frame[MESH_MAX_FRAME];
+  MeshAddress from;
+  size_t length;
+  while ((length = transport.receive(frame, sizeof(frame), from)) > 0)
+  {
+    MeshFrameReader reader(frame, length);
+    MeshHeader header;
+    if (!reader.header(header) || (header.type != MESH_STATUS && header.type != MESH_INFO))
+    {
+      framesRejected++;
+      continue;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    Node *node = nodeFor(header.nodeId, from, now);
+    if (!node)
+    {
+      framesRejected++;
+      continue;
+    }
+    framesReceived++;
+    bytesReceived += length;
+    if (header.type == MESH_STATUS)
+    {
+      handleStatus(*node, header, reader, now);
+    }
+    else
+    {
+      handleInfo(*node, reader);
+    }
+  }
+
+  std::lock_guard<std::mutex> lock(mutex);
+  for (int i = 0; i < count; i++)
+  {
+    Node &node = nodes[i];
+    if (node.queueCount > 0 && now - node.queue[0].sentAt >= MESH_RETRY_MS)
+    {
+      if (node.queue[0].attempts >= MESH_MAX_RETRIES)
+      {
+        LOG_WARN(LOG_MESH_CONFIG_LOST, node.id, node.queue[0].request.zoneId);
+        memmove(&node.queue[0], &node.queue[1], (node.queueCount - 1) * sizeof(PendingConfig));
+        node.queueCount--;
+        configsDropped++;
+        if (node.queueCount == 0)
+        {
+          continue;
+        }
+      }
+      sendConfig(node, node.queue[0], now);
+    }
+  }
+}
+
+void MeshAggregator::handleStatus(Node &node, const MeshHeader &header, MeshFrameReader &reader, unsigned long now)
+{
+  uint16_t configAck = reader.u16();
+  int zones = reader.u8();
+  if (!reader.ok())
+  {
+    framesRejected++;
+    return;
+  }
+
+  // Acks count whatever happens to the zone data below
+  if (node.queueCount > 0 && node.queue[0].seq == configAck)
+  {
+    memmove(&node.queue[0], &node.queue[1], (node.queueCount - 1) * sizeof(PendingConfig));
+    node.queueCount--;
+    configsAcked++;
+    if (node.queueCount > 0)
+    {
+      sendConfig(node, node.queue[0], now);
+    }
+  }
+  node.hasStatus = true;
+  if (node.queueCount == 0)
+  {
+    node.nextConfigSeq = configAck; // The next change must differ from the last one applied
+  }
+
+  bool full = (header.flags & MESH_FRAME_FULL) != 0;
+  if (!full)
+  {
+    // Missed, duplicated or reordered frames and node restarts all end in a full frame
+    if ((uint16_t)(header.seq - node.lastSeq) != 1)
+    {
+      node.synced = false;
+    }
+    if (!node.synced)
+    {
+      requestSync(node, now);
+    }
+  }
+  else
+  {
+    node.synced = true;
+  }
+  node.lastSeq = header.seq;
+
+  for (int i = 0; i < zones; i++)
+  {
+    uint16_t zoneId = reader.u16();
+    uint8_t mask = reader.u8();
+    MeshZoneView *zone = zoneFor(node, zoneId);
+    MeshZoneStatus decoded = zone ? zone->status : MeshZoneStatus();
+    reader.fields(mask, decoded);
+    if (!node.synced)
+    {
+      mask &= ~MESH_F_RAW_DELTA; // After a gap the absolute fields are still right, a raw delta is not
+    }
+    if (zone)
+    {
+      meshMerge(zone->status, decoded, mask);
+      if (mask & MESH_F_COOLDOWN)
+      {
+        zone->cooldownSetAt = now;
+      }
+    }
+  }
+  if (!reader.ok())
+  {
+    framesRejected++;
+    node.synced = false;
+    requestSync(node, now);
+  }
+}
+
+void MeshAggregator::handleInfo(Node &node, MeshFrameReader &reader)
+{
+  int zones = reader.u8();
+  for (int i = 0; i < zones && reader.ok(); i++)
+  {
+    uint16_t zoneId = reader.u16();
+    MeshZoneView *zone = zoneFor(node, zoneId);
+    char name[MESH_NAME_LEN + 1];
+    reader.name(name, sizeof(name));
+    if (zone)
+    {
+      memcpy(zone->name, name, sizeof(name));
+    }
+  }
+}
+
+void MeshAggregator::requestSync(Node &node, unsigned long now)
+{
+  if (now - node.lastSync < MESH_SYNC_INTERVAL_MS)
+  {
+    return; // The last request may still be answered
+  }
+  uint8_t frame[MESH_HEADER_SIZE];
+  MeshFrameWriter writer(frame, sizeof(frame));
+  MeshHeader header = {MESH_SYNC, 0, node.id, 0};
+  writer.header(header);
+  if (transport.send(node.address, frame, writer.used()))
+  {
+    node.lastSync = now;
+    syncsSent++;
+  }
+}
+
+void MeshAggregator::sendConfig(Node &node, PendingConfig &config, unsigned long now)
+{
+  uint8_t frame[MESH_MAX_FRAME];
+  MeshFrameWriter writer(frame, sizeof(frame));
+  MeshHeader header = {MESH_CONFIG, 0, node.id, 0};
+  writer.header(header);
+  writer.config(config.seq, config.request);
+  transport.send(node.address, frame, writer.used());
+  config.sentAt = now;
+  config.attempts++;
+  configsSent++;
+}
+
+bool MeshAggregator::forwardConfig(uint16_t nodeId, const ZoneConfigRequest &request, unsigned long now)
+{
+  std::lock_guard<std::mutex> lock(mutex);
+  Node *node = findNode(nodeId);
+  if (!node || !node->hasStatus || node->queueCount == MESH_CONFIG_QUEUE)
+  {
+    return false;
+  }
+  PendingConfig &config = node->queue[node->queueCount++];
+  config.seq = ++node->nextConfigSeq;
+  config.request = request;
+  config.attempts = 0;
+  if (node->queueCount == 1)
+  {
+    sendConfig(*node, config, now);
+  }
+  else
+  {
+    config.sentAt = now; // Sent once the ones before it are confirmed
+  }
+  return true;
+}
+
+int MeshAggregator::nodeCount() const
+{
+  std::lock_guard<std::mutex> lock(mutex);
+  return count;
+}
+
+bool MeshAggregator::zoneStatus(uint16_t nodeId, uint16_t zoneId, MeshZoneStatus &out) const
+{
+  std::lock_guard<std::mutex> lock(mutex);
+  const Node *node = findNode(nodeId);
+  if (!node)
+  {
+    return false;
+  }
+  for (int i = 0; i < node->zoneCount; i++)
+  {
+    if (node->zones[i].status.zoneId == zoneId)
+    {
+      out = node->zones[i].status;
+      return true;
+    }
+  }
+  return false;
+}
+
+size_t MeshAggregator::fillJson(MeshJsonReader &reader, char *buffer, size_t size, unsigned long now) const
+{
+  std::lock_guard<std::mutex> lock(mutex);
+  size_t length = 0;
+  while (length < size)
+  {
+    if (reader.pendingOffset < reader.pendingLength)
+    {
+      size_t chunk = reader.pendingLength - reader.pendingOffset;
+      if (chunk > size - length)
+      {
+        chunk = size - length;
+      }
+      memcpy(buffer + length, reader.pending + reader.pendingOffset, chunk);
+      reader.pendingOffset += chunk;
+      length += chunk;
+      continue;
+    }
+    if (!renderRecord(reader, now))
+    {
+      break;
+    }
+  }
+  return length;
+}
+
+// JSON string body: quotes and backslashes escaped, control characters dropped
+static void escapeName(char *out, size_t size, const char *name)
+{
+  size_t length = 0;
+  for (; *name && length + 2 < size; name++)
+  {
+    if (*name == '"' || *name == '\\')
+    {
+      out[length++] = '\\';
+    }
+    if ((unsigned char)*name >= 0x20)
+    {
+      out[length++] = *name;
+    }
+  }
+  out[length] = '\0';
+}
+
+bool MeshAggregator::renderRecord(MeshJsonReader &reader, unsigned long now) const
+{
+  int written = 0;
+  const Node *node = reader.node < count ? &nodes[reader.node] : nullptr;
+  switch (reader.stage)
+  {
+  case 0:
+    written = snprintf(reader.pending, sizeof(reader.pending), "{\"nodes\":[");
+    reader.stage = node ? 1 : 3;
+    break;
+  case 1:
+    written = snprintf(reader.pending, sizeof(reader.pending),
+                       "%s{\"id\":%u,\"online\":%d,\"age\":%lu,\"pending\":%d,\"zones\":[",
+                       reader.node ? "," : "", (unsigned)node->id, now - node->lastSeen < MESH_OFFLINE_MS ? 1 : 0,
+                       (now - node->lastSeen) / 1000, node->queueCount);
+    reader.zone = 0;
+    reader.stage = 2;
+    break;
+  case 2:
+  {
+    if (reader.zone >= node->zoneCount)
+    {
+      written = snprintf(reader.pending, sizeof(reader.pending), "]}");
+      reader.node++;
+      reader.stage = reader.node < count ? 1 : 3;
+      break;
+    }
+    const MeshZoneView &zone = node->zones[reader.zone];
+    const MeshZoneStatus &status = zone.status;
+    unsigned long cooldown = 0;
+    if (status.state & MESH_STATE_COOLDOWN)
+    {
+      unsigned long elapsed = (now - zone.cooldownSetAt) / 1000;
+      cooldown = elapsed < status.cooldownSec ? status.cooldownSec - elapsed : 0;
+    }
+    char name[MESH_NAME_LEN * 2 + 1];
+    escapeName(name, sizeof(name), zone.name);
+    written = snprintf(reader.pending, sizeof(reader.pending),
+                       "%s{\"id\":%u,\"name\":\"%s\",\"m\":%u,\"r\":%u,\"p\":%d,\"c\":%lu,\"a\":%d,\"s\":%d,\"w\":%u,\"d\":%u,\"dose\":%d}",
+                       reader.zone ? "," : "", (unsigned)status.zoneId, name, status.percent, status.raw,
+                       (status.state & MESH_STATE_PUMP) ? 1 : 0, cooldown, (status.state & MESH_STATE_AIR) ? 1 : 0,
+                       (status.state & MESH_STATE_STALE) ? 1 : 0, status.wetThreshold, status.dryThreshold, (status.state & MESH_STATE_DOSING) ? 1 : 0);
+    reader.zone++;
+    break;
+  }
+  case 3:
+    written = snprintf(reader.pending, sizeof(reader.pending), "]}");
+    reader.stage = 4;
+    break;
+  default:
+    return false;
+  }
+  reader.pendingLength = written > 0 ? (size_t)written : 0;
+  reader.pendingOffset = 0;
+  return true;
+}
@@ -0,0 +1,109 @@
+#ifndef MESH_AGGREGATOR_H
+#define MESH_AGGREGATOR_H
+
+#include <stdint.h>
+#include <mutex>
+#include "MeshProtocol.h"
+#include "MeshTransport.h"
+
+const int MESH_MAX_NODES = 32;
+const int MESH_CONFIG_QUEUE = 4;                          // Outstanding config changes per node
+const unsigned long MESH_RETRY_MS = 1000;                 // Config retransmission interval
+const int MESH_MAX_RETRIES = 5;
+const unsigned long MESH_OFFLINE_MS = 3 * 60000;          // Three missed heartbeats
+const unsigned long MESH_SYNC_INTERVAL_MS = 2000;         // Limits SYNC requests to one node
+
+// One remote zone as the aggregator sees it
+struct MeshZoneView
+{
+  MeshZoneStatus status;
+  char name[MESH_NAME_LEN + 1];
+  unsigned long cooldownSetAt; // millis() when status.cooldownSec was received
+};
+
+// Streams /api/mesh one record at a time, like HistoryReader
+class MeshJsonReader
+{
+public:
+  MeshJsonReader() : stage(0), node(0), zone(0), pendingLength(0), pendingOffset(0) {}
+
+private:
+  friend class MeshAggregator;
+  int stage; // 0: head, 1: node head, 2: zones, 3: node tail, 4: done
+  int node;
+  int zone;
+  char pending[192];
+  size_t pendingLength;
+  size_t pendingOffset;
+};
+
+// Collects STATUS/INFO frames from many nodes into one table and forwards
+// config changes to them. poll() runs on the loop task, the web handlers
+// read through the thread-safe calls below.
+class MeshAggregator
+{
+public:
+  explicit MeshAggregator(MeshTransport &transport);
+
+  // Handles every pending frame and retransmits unacknowledged configs
+  void poll(unsigned long now);
+  // Queues a change for a remote zone, false if the node is unknown or busy
+  bool forwardConfig(uint16_t nodeId, const ZoneConfigRequest &request, unsigned long now);
+
+  // Thread-safe
+  int nodeCount() const;
+  bool zoneStatus(uint16_t nodeId, uint16_t zoneId, MeshZoneStatus &out) const;
+  // {"nodes":[{"id":7,"online":1,"age":3,"pending":0,"zones":[{"id":1,"name":"Bed","m":40,...}]}]}
+  size_t fillJson(MeshJsonReader &reader, char *buffer, size_t size, unsigned long now) const;
+
+  // Protocol statistics
+  unsigned long framesReceived;
+  unsigned long bytesReceived;
+  unsigned long framesRejected; // Bad header, unknown type, truncated
+  unsigned long syncsSent;
+  unsigned long configsSent;    // Including retransmissions
+  unsigned long configsAcked;
+  unsigned long configsDropped; // Gave up after MESH_MAX_RETRIES
+
+private:
+  struct PendingConfig
+  {
+    uint16_t seq;
+    ZoneConfigRequest request;
+    unsigned long sentAt;
+    int attempts;
+  };
+
+  struct Node
+  {
+    uint16_t id;
+    MeshAddress address;
+    unsigned long lastSeen;
+    unsigned long lastSync;
+    uint16_t lastSeq;
+    bool synced;    // Received a full frame and no gap since
+    bool hasStatus; // nextConfigSeq is only valid after the first STATUS
+    int zoneCount;
+    MeshZoneView zones[MAX_ZONES];
+    uint16_t nextConfigSeq;
+    PendingConfig queue[MESH_CONFIG_QUEUE];
+    int queueCount;
+  };
+
+  MeshTransport &transport;
+  Node nodes[MESH_MAX_NODES];
+  int count;
+  mutable std::mutex mutex;
+
+  Node *findNode(uint16_t nodeId);
+  const Node *findNode(uint16_t nodeId) const;
+  Node *nodeFor(uint16_t nodeId, const MeshAddress &from, unsigned long now);
+  MeshZoneView *zoneFor(Node &node, uint16_t zoneId);
+  void handleStatus(Node &node, const MeshHeader &header, MeshFrameReader &reader, unsigned long now);
+  void handleInfo(Node &node, MeshFrameReader &reader);
+  void requestSync(Node &node, unsigned long now);
+  void sendConfig(Node &node, PendingConfig &config, unsigned long now);
+  bool renderRecord(MeshJsonReader &reader, unsigned long now) const;
+};
+
+#endif // MESH_AGGREGATOR_H
@@ -0,0 +1,166 @@
+#include "MeshNode.h"
+
+MeshNode::MeshNode(MeshTransport &transport, uint16_t nodeId)
+    : framesSent(0), bytesSent(0), fullFrames(0), transport(transport), nodeId(nodeId), seq(0),
+      configHandler(nullptr), aggregator(), aggregatorKnown(false), sent(), sentCount(0), fullPending(true),
+      infoPending(true), ackPending(false), tailPending(false), configSeen(false), configAck(0), lastSend(0), lastFull(0)
+{
+}
+
+void MeshNode::poll(unsigned long now, const SystemSnapshot &snapshot)
+{
+  receive();
+
+  if (snapshot.zoneCount != sentCount || now - lastFull >= MESH_FULL_INTERVAL_MS)
+  {
+    fullPending = true;
+  }
+  if (infoPending)
+  {
+    sendInfo(snapshot);
+  }
+  // Acks and requested full frames go out at once, plain changes are batched
+  if (ackPending || fullPending || now - lastSend >= MESH_BATCH_MS)
+  {
+    sendStatus(now, snapshot);
+  }
+}
+
+void MeshNode::receive()
+{
+  uint8_t frame[MESH_MAX_FRAME];
+  MeshAddress from;
+  size_t length;
+  while ((length = transport.receive(frame, sizeof(frame), from)) > 0)
+  {
+    MeshFrameReader reader(frame, length);
+    MeshHeader header;
+    // Other nodes' (or our own) broadcasts are STATUS and INFO frames
+    if (!reader.header(header) || header.nodeId != nodeId ||
+        (header.type != MESH_SYNC && header.type != MESH_CONFIG))
+    {
+      continue;
+    }
+    aggregator = from;
+    aggregatorKnown = true;
+
+    if (header.type == MESH_SYNC)
+    {
+      fullPending = true;
+      infoPending = true;
+    }
+    else if (header.type == MESH_CONFIG)
+    {
+      handleConfig(reader);
+    }
+  }
+}
+
+void MeshNode::handleConfig(MeshFrameReader &reader)
+{
+  uint16_t configSeq;
+  ZoneConfigRequest request;
+  if (!reader.config(configSeq, request))
+  {
+    return;
+  }
+  // Retransmissions of an applied change only need another ack
+  if (!configSeen || configSeq != configAck)
+  {
+    if (!configHandler || !configHandler(request))
+    {
+      return; // No ack, the aggregator retries
+    }
+    configSeen = true;
+    configAck = configSeq;
+  }
+  ackPending = true;
+}
+
+void MeshNode::sendStatus(unsigned long now, const SystemSnapshot &snapshot)
+{
+  bool full = fullPending;
+  uint8_t frame[MESH_MAX_FRAME];
+  MeshFrameWriter writer(frame, sizeof(frame));
+  MeshHeader header = {MESH_STATUS, (uint8_t)(full ? MESH_FRAME_FULL : 0), nodeId, (uint16_t)(seq + 1)};
+  writer.header(header);
+  writer.u16(configAck);
+
+  // Count first so the zones can be written straight after
+  uint8_t masks[MAX_ZONES];
+  MeshZoneStatus current[MAX_ZONES];
+  int count = snapshot.zoneCount < MAX_ZONES ? snapshot.zoneCount : MAX_ZONES;
+  int changed = 0;
+  for (int i = 0; i < count; i++)
+  {
+    current[i] = meshZoneStatus(snapshot.zones[i]);
+    masks[i] = full ? MESH_F_ALL : meshChanges(current[i], sent[i]);
+    changed += masks[i] ? 1 : 0;
+  }
+  if (changed == 0 && !full && !ackPending && !tailPending)
+  {
+    lastSend = now; // Nothing new, check again after the next batch window
+    return;
+  }
+
+  writer.u8((uint8_t)changed);
+  for (int i = 0; i < count; i++)
+  {
+    if (masks[i])
+    {
+      writer.zone(current[i], masks[i], sent[i].raw);
+    }
+  }
+  if (!writer.ok())
+  {
+    return;
+  }
+
+  transmit(frame, writer.used());
+  for (int i = 0; i < count; i++)
+  {
+    meshMerge(sent[i], current[i], masks[i]);
+  }
+  seq++;
+  sentCount = snapshot.zoneCount;
+  lastSend = now;
+  ackPending = false;
+  tailPending = changed > 0 && !full;
+  if (full)
+  {
+    fullPending = false;
+    lastFull = now;
+    fullFrames++;
+  }
+}
+
+void MeshNode::sendInfo(const SystemSnapshot &snapshot)
+{
+  uint8_t frame[MESH_MAX_FRAME];
+  MeshFrameWriter writer(frame, sizeof(frame));
+  // INFO does not take part in the STATUS sequence
+  MeshHeader header = {MESH_INFO, 0, nodeId, seq};
+  writer.header(header);
+  int count = snapshot.zoneCount < MAX_ZONES ? snapshot.zoneCount : MAX_ZONES;
+  writer.u8((uint8_t)count);
+  for (int i = 0; i < count; i++)
+  {
+    writer.u16((uint16_t)snapshot.zones[i].id);
+    writer.name(snapshot.zones[i].name);
+  }
+  if (writer.ok())
+  {
+    transmit(frame, writer.used());
+    infoPending = false;
+  }
+}
+
+void MeshNode::transmit(const uint8_t *frame, size_t length)
+{
+  bool ok = aggregatorKnown ? transport.send(aggregator, frame, length) : transport.broadcast(frame, length);
+  if (ok)
+  {
+    framesSent++;
+    bytesSent += length;
+  }
+}
@@ -0,0 +1,58 @@
+#ifndef MESH_NODE_H
+#define MESH_NODE_H
+
+#include <stdint.h>
+#include "MeshProtocol.h"
+#include "MeshTransport.h"
+#include "ZoneSnapshot.h"
+
+const unsigned long MESH_BATCH_MS = 1000;         // Changes within this window share one frame
+const unsigned long MESH_FULL_INTERVAL_MS = 60000; // Full frame, also the heartbeat
+
+// Reports this node's zones to the aggregator and applies the config
+// changes it forwards. Runs on the loop task; poll() never blocks.
+class MeshNode
+{
+public:
+  MeshNode(MeshTransport &transport, uint16_t nodeId);
+
+  // Forwarded config requests go here (ZoneController::submitConfig on the device)
+  void setConfigHandler(bool (*handler)(const ZoneConfigRequest &)) { configHandler = handler; }
+  // Handles incoming frames and sends a status frame when one is due
+  void poll(unsigned long now, const SystemSnapshot &snapshot);
+
+  uint16_t id() const { return nodeId; }
+  bool hasAggregator() const { return aggregatorKnown; }
+
+  // Traffic since boot
+  unsigned long framesSent;
+  unsigned long bytesSent;
+  unsigned long fullFrames;
+
+private:
+  MeshTransport &transport;
+  uint16_t nodeId;
+  uint16_t seq;
+  bool (*configHandler)(const ZoneConfigRequest &);
+
+  MeshAddress aggregator;
+  bool aggregatorKnown;
+  MeshZoneStatus sent[MAX_ZONES]; // What the aggregator has, as far as we know
+  int sentCount;
+  bool fullPending;
+  bool infoPending;
+  bool ackPending;
+  bool tailPending; // An empty frame after a delta, so a lost delta shows up as a gap
+  bool configSeen;
+  uint16_t configAck; // Last config frame applied
+  unsigned long lastSend;
+  unsigned long lastFull;
+
+  void receive();
+  void handleConfig(MeshFrameReader &reader);
+  void sendStatus(unsigned long now, const SystemSnapshot &snapshot);
+  void sendInfo(const SystemSnapshot &snapshot);
+  void transmit(const uint8_t *frame, size_t length);
+};
+
+#endif // MESH_NODE_H
@@ -0,0 +1,236 @@
+#include "MeshProtocol.h"
+#include <string.h>
+
+MeshZoneStatus meshZoneStatus(const ZoneSnapshot &zone)
+{
+  MeshZoneStatus status = {};
+  status.zoneId = (uint16_t)zone.id;
+  status.percent = (uint8_t)zone.moisturePercent;
+  status.raw = (uint16_t)zone.moistureRaw;
+  status.state = (zone.pumpState ? MESH_STATE_PUMP : 0) | (zone.sensorInAir ? MESH_STATE_AIR : 0) |
+                 (zone.inCooldown ? MESH_STATE_COOLDOWN : 0) | (zone.dosingMode ? MESH_STATE_DOSING : 0) |
+                 (zone.sensorStale ? MESH_STATE_STALE : 0);
+  unsigned long cooldown = zone.inCooldown ? zone.cooldownRemainingSec : 0;
+  status.cooldownSec = (uint16_t)(cooldown > 0xFFFF ? 0xFFFF : cooldown);
+  status.wetThreshold = (uint8_t)zone.wetThreshold;
+  status.dryThreshold = (uint8_t)zone.dryThreshold;
+  return status;
+}
+
+uint8_t meshChanges(const MeshZoneStatus &now, const MeshZoneStatus &sent)
+{
+  uint8_t mask = 0;
+  if (now.percent != sent.percent)
+  {
+    mask |= MESH_F_PERCENT;
+  }
+  int rawStep = (int)now.raw - (int)sent.raw;
+  if (rawStep >= MESH_RAW_DEADBAND || rawStep <= -MESH_RAW_DEADBAND)
+  {
+    mask |= rawStep >= -128 && rawStep <= 127 ? MESH_F_RAW_DELTA : MESH_F_RAW;
+  }
+  // The countdown itself runs on the receiver, only its start is news
+  if (now.state != sent.state)
+  {
+    mask |= MESH_F_STATE | MESH_F_COOLDOWN;
+  }
+  if (now.wetThreshold != sent.wetThreshold || now.dryThreshold != sent.dryThreshold)
+  {
+    mask |= MESH_F_THRESHOLDS;
+  }
+  return mask;
+}
+
+void meshMerge(MeshZoneStatus &target, const MeshZoneStatus &source, uint8_t mask)
+{
+  target.zoneId = source.zoneId;
+  if (mask & MESH_F_PERCENT)
+  {
+    target.percent = source.percent;
+  }
+  if (mask & (MESH_F_RAW | MESH_F_RAW_DELTA))
+  {
+    target.raw = source.raw;
+  }
+  if (mask & MESH_F_STATE)
+  {
+    target.state = source.state;
+  }
+  if (mask & MESH_F_COOLDOWN)
+  {
+    target.cooldownSec = source.cooldownSec;
+  }
+  if (mask & MESH_F_THRESHOLDS)
+  {
+    target.wetThreshold = source.wetThreshold;
+    target.dryThreshold = source.dryThreshold;
+  }
+}
+
+void MeshFrameWriter::u8(uint8_t value)
+{
+  if (length >= size)
+  {
+    overflow = true;
+    return;
+  }
+  buffer[length++] = value;
+}
+
+void MeshFrameWriter::u16(uint16_t value)
+{
+  u8((uint8_t)(value & 0xFF));
+  u8((uint8_t)(value >> 8));
+}
+
+void MeshFrameWriter::header(const MeshHeader &header)
+{
+  u8(MESH_MAGIC);
+  u8(MESH_VERSION);
+  u8(header.type);
+  u8(header.flags);
+  u16(header.nodeId);
+  u16(header.seq);
+}
+
+void MeshFrameWriter::zone(const MeshZoneStatus &zone, uint8_t mask, uint16_t previousRaw)
+{
+  u16(zone.zoneId);
+  u8(mask);
+  if (mask & MESH_F_PERCENT)
+  {
+    u8(zone.percent);
+  }
+  if (mask & MESH_F_RAW)
+  {
+    u16(zone.raw);
+  }
+  if (mask & MESH_F_RAW_DELTA)
+  {
+    u8((uint8_t)(int8_t)((int)zone.raw - (int)previousRaw));
+  }
+  if (mask & MESH_F_STATE)
+  {
+    u8(zone.state);
+  }
+  if (mask & MESH_F_COOLDOWN)
+  {
+    u16(zone.cooldownSec);
+  }
+  if (mask & MESH_F_THRESHOLDS)
+  {
+    u8(zone.wetThreshold);
+    u8(zone.dryThreshold);
+  }
+}
+
+void MeshFrameWriter::config(uint16_t configSeq, const ZoneConfigRequest &request)
+{
+  u16(configSeq);
+  u16((uint16_t)request.zoneId);
+  const int values[] = {request.wetThreshold, request.dryThreshold, request.airValue, request.dryValue,
+                        request.waterValue, request.maxRuntimeSec, request.cooldownSec, request.mode};
+  for (int value : values)
+  {
+    u16((uint16_t)(int16_t)(value < 0 ? -1 : (value > 32767 ? 32767 : value)));
+  }
+}
+
+void MeshFrameWriter::name(const char *text)
+{
+  size_t count = strnlen(text, MESH_NAME_LEN);
+  u8((uint8_t)count);
+  for (size_t i = 0; i < count; i++)
+  {
+    u8((uint8_t)text[i]);
+  }
+}
+
+uint8_t MeshFrameReader::u8()
+{
+  if (offset >= length)
+  {
+    underflow = true;
+    return 0;
+  }
+  return data[offset++];
+}
+
+uint16_t MeshFrameReader::u16()
+{
+  uint16_t low = u8();
+  return (uint16_t)(low | (u8() << 8));
+}
+
+bool MeshFrameReader::header(MeshHeader &header)
+{
+  if (u8() != MESH_MAGIC || u8() != MESH_VERSION)
+  {
+    return false;
+  }
+  header.type = u8();
+  header.flags = u8();
+  header.nodeId = u16();
+  header.seq = u16();
+  return ok();
+}
+
+void MeshFrameReader::fields(uint8_t mask, MeshZoneStatus &target)
+{
+  if (mask & MESH_F_PERCENT)
+  {
+    target.percent = u8();
+  }
+  if (mask & MESH_F_RAW)
+  {
+    target.raw = u16();
+  }
+  if (mask & MESH_F_RAW_DELTA)
+  {
+    target.raw = (uint16_t)(target.raw + (int8_t)u8());
+  }
+  if (mask & MESH_F_STATE)
+  {
+    target.state = u8();
+  }
+  if (mask & MESH_F_COOLDOWN)
+  {
+    target.cooldownSec = u16();
+  }
+  if (mask & MESH_F_THRESHOLDS)
+  {
+    target.wetThreshold = u8();
+    target.dryThreshold = u8();
+  }
+}
+
+bool MeshFrameReader::config(uint16_t &configSeq, ZoneConfigRequest &request)
+{
+  configSeq = u16();
+  request.zoneId = u16();
+  int *values[] = {&request.wetThreshold, &request.dryThreshold, &request.airValue, &request.dryValue,
+                   &request.waterValue, &request.maxRuntimeSec, &request.cooldownSec, &request.mode};
+  for (int *value : values)
+  {
+    *value = (int16_t)u16();
+  }
+  return ok();
+}
+
+void MeshFrameReader::name(char *out, size_t size)
+{
+  size_t count = u8();
+  size_t kept = 0;
+  for (size_t i = 0; i < count; i++)
+  {
+    char c = (char)u8();
+    if (kept + 1 < size)
+    {
+      out[kept++] = c;
+    }
+  }
+  if (size > 0)
+  {
+    out[kept] = '\0';
+  }
+}
@@ -0,0 +1,142 @@
+#ifndef MESH_PROTOCOL_H
+#define MESH_PROTOCOL_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "WateringZone.h"
+#include "ZoneSnapshot.h"
+
+// Binary frames between watering nodes and one aggregator (MeshNode,
+// MeshAggregator). All integers are little-endian, a frame never exceeds
+// MESH_MAX_FRAME so it also fits an ESP-NOW payload.
+//
+//   header   magic, version, type, flags, nodeId:u16, seq:u16
+//   STATUS   configAck:u16, count:u8, count x zone
+//            zone = zoneId:u16, mask:u8, then the fields in mask order
+//   INFO     count:u8, count x (zoneId:u16, length:u8, name bytes)
+//   CONFIG   configSeq:u16, zoneId:u16, 8 x i16 (ZoneConfigRequest, -1 unset)
+//   SYNC     empty: the aggregator wants a full STATUS and the INFO
+//
+// STATUS frames are deltas against the previous frame of the same node
+// (only changed fields of changed zones) unless MESH_FRAME_FULL is set.
+// A gap in seq makes the aggregator ask for a full frame.
+
+const uint8_t MESH_MAGIC = 0xA7;
+const uint8_t MESH_VERSION = 1;
+const size_t MESH_MAX_FRAME = 250;
+const uint16_t MESH_PORT = 4210;
+const int MESH_NAME_LEN = 12; // Zone names are truncated on the wire
+
+enum MeshFrameType
+{
+  MESH_STATUS = 1,
+  MESH_INFO = 2,
+  MESH_CONFIG = 3,
+  MESH_SYNC = 4
+};
+
+// Header flags
+const uint8_t MESH_FRAME_FULL = 0x01;
+
+// Zone field mask, fields follow in this order
+const uint8_t MESH_F_PERCENT = 0x01;    // u8
+const uint8_t MESH_F_RAW = 0x02;        // u16
+const uint8_t MESH_F_RAW_DELTA = 0x04;  // i8, added to the last raw value
+const uint8_t MESH_F_STATE = 0x08;      // u8 MESH_STATE_*
+const uint8_t MESH_F_COOLDOWN = 0x10;   // u16 seconds left when sent
+const uint8_t MESH_F_THRESHOLDS = 0x20; // u8 wet, u8 dry
+const uint8_t MESH_F_ALL = MESH_F_PERCENT | MESH_F_RAW | MESH_F_STATE | MESH_F_COOLDOWN | MESH_F_THRESHOLDS;
+
+const uint8_t MESH_STATE_PUMP = 0x01;
+const uint8_t MESH_STATE_AIR = 0x02;
+const uint8_t MESH_STATE_COOLDOWN = 0x04;
+const uint8_t MESH_STATE_DOSING = 0x08;
+const uint8_t MESH_STATE_STALE = 0x10; // Sensor stopped reading
+
+// Raw ADC changes smaller than this are not worth a frame
+const int MESH_RAW_DEADBAND = 4;
+
+const size_t MESH_HEADER_SIZE = 8;
+const size_t MESH_ZONE_MAX_SIZE = 3 + 1 + 2 + 1 + 2 + 2;
+static_assert(MESH_HEADER_SIZE + 3 + MAX_ZONES * MESH_ZONE_MAX_SIZE <= MESH_MAX_FRAME,
+              "a full STATUS frame must fit one datagram");
+static_assert(MESH_HEADER_SIZE + 1 + MAX_ZONES * (3 + MESH_NAME_LEN) <= MESH_MAX_FRAME,
+              "the INFO frame must fit one datagram");
+
+struct MeshHeader
+{
+  uint8_t type;
+  uint8_t flags;
+  uint16_t nodeId;
+  uint16_t seq;
+};
+
+// What the aggregator knows about one remote zone
+struct MeshZoneStatus
+{
+  uint16_t zoneId;
+  uint8_t percent;
+  uint8_t state;
+  uint16_t raw;
+  uint16_t cooldownSec;
+  uint8_t wetThreshold;
+  uint8_t dryThreshold;
+};
+
+MeshZoneStatus meshZoneStatus(const ZoneSnapshot &zone);
+// Fields of now that differ from sent, as a MESH_F_* mask (0: nothing to send)
+uint8_t meshChanges(const MeshZoneStatus &now, const MeshZoneStatus &sent);
+// Copies the fields in mask from source (what a receiver ends up with)
+void meshMerge(MeshZoneStatus &target, const MeshZoneStatus &source, uint8_t mask);
+
+// Bounds-checked frame builder; ok() turns false once anything did not fit
+class MeshFrameWriter
+{
+public:
+  MeshFrameWriter(uint8_t *buffer, size_t size) : buffer(buffer), size(size), length(0), overflow(false) {}
+
+  void header(const MeshHeader &header);
+  void u8(uint8_t value);
+  void u16(uint16_t value);
+  // Writes the fields in mask; previousRaw is the base for MESH_F_RAW_DELTA
+  void zone(const MeshZoneStatus &zone, uint8_t mask, uint16_t previousRaw);
+  void config(uint16_t configSeq, const ZoneConfigRequest &request);
+  // Length byte plus at most MESH_NAME_LEN bytes
+  void name(const char *text);
+
+  bool ok() const { return !overflow; }
+  size_t used() const { return overflow ? 0 : length; }
+
+private:
+  uint8_t *buffer;
+  size_t size;
+  size_t length;
+  bool overflow;
+};
+
+class MeshFrameReader
+{
+public:
+  MeshFrameReader(const uint8_t *data, size_t length) : data(data), length(length), offset(0), underflow(false) {}
+
+  // Checks magic and version
+  bool header(MeshHeader &header);
+  uint8_t u8();
+  uint16_t u16();
+  // Applies the fields of one zone entry (after its zoneId and mask) to target
+  void fields(uint8_t mask, MeshZoneStatus &target);
+  bool config(uint16_t &configSeq, ZoneConfigRequest &request);
+  // Null-terminated, truncated to size
+  void name(char *out, size_t size);
+
+  bool ok() const { return !underflow; }
+  bool atEnd() const { return offset >= length; }
+
+private:
+  const uint8_t *data;
+  size_t length;
+  size_t offset;
+  bool underflow;
+};
+
+#endif // MESH_PROTOCOL_H
@@ -0,0 +1,109 @@
+#if defined(ARDUINO) && (defined(MESH_NODE) || defined(MESH_AGGREGATOR))
+#include "WebRoutes.h"
+
+#include <WiFi.h>
+
+#include "MeshTransport.h"
+#ifdef MESH_NODE
+#include "MeshNode.h"
+#endif
+#ifdef MESH_AGGREGATOR
+#include "MeshAggregator.h"
+#endif
+
+static WifiUdpTransport meshTransport;
+#ifdef MESH_NODE
+static MeshNode *meshNode = nullptr; // Created once WiFi is up, its id comes from the MAC
+#endif
+#ifdef MESH_AGGREGATOR
+static MeshAggregator meshAggregator(meshTransport);
+#endif
+
+#ifdef MESH_NODE
+// Forwarded changes go through the same queue as the node's own config page.
+// Unknown zones are acknowledged too, retrying them would not help.
+static bool submitMeshConfig(const ZoneConfigRequest &request)
+{
+  return !controller.hasZone(request.zoneId) || controller.submitConfig(request);
+}
+
+static void pollMeshNode()
+{
+  static SystemSnapshot meshSnapshot;
+  if (controller.snapshotVersion() != meshSnapshot.version && !controller.readSnapshot(meshSnapshot))
+  {
+    return;
+  }
+  meshNode->poll(millis(), meshSnapshot);
+}
+#endif
+
+void setupMesh()
+{
+  if (!meshTransport.begin(MESH_PORT))
+  {
+    Serial.println("Mesh: UDP port not available");
+  }
+#ifdef MESH_NODE
+  uint8_t mac[6];
+  WiFi.macAddress(mac);
+  meshNode = new MeshNode(meshTransport, (uint16_t)(mac[4] << 8 | mac[5]));
+  meshNode->setConfigHandler(submitMeshConfig);
+  Serial.printf("Mesh node %u reporting on UDP port %u\n", (unsigned)meshNode->id(), (unsigned)MESH_PORT);
+#else
+  Serial.printf("Mesh aggregator listening on UDP port %u, dashboard at /mesh\n", (unsigned)MESH_PORT);
+#endif
+}
+
+void pollMesh()
+{
+#ifdef MESH_NODE
+  pollMeshNode();
+#else
+  meshAggregator.poll(millis());
+#endif
+}
+
+#ifdef MESH_AGGREGATOR
+void setupMeshRoutes(AsyncWebServer &server)
+{
+  // /mesh/config?node=7&zone=1&wetThreshold=70, same parameters as /zone/N/config.
+  // Registered before /mesh, which would otherwise match this path as a prefix
+  server.on("/mesh/config", HTTP_GET, [](AsyncWebServerRequest *request)
+            {
+    int nodeId = paramOrUnset(request, "node");
+    ZoneConfigRequest config;
+    config.zoneId = paramOrUnset(request, "zone");
+    readConfigParams(request, config);
+    if (nodeId < 0 || config.zoneId < 0) {
+      request->send(400, "text/plain", "node and zone are required");
+      return;
+    }
+    
+    // Delivered and confirmed by the loop task's meshAggregator.poll()
+    if (!meshAggregator.forwardConfig((uint16_t)nodeId, config, millis())) {
+      request->send(503, "text/plain", "Node unknown or busy, try again");
+      return;
+    }
+    request->send(202, "text/plain", "Forwarded"); });
+
+  // Combined dashboard of all nodes, rendered in the browser from /api/mesh
+  server.on("/mesh", HTTP_GET, [](AsyncWebServerRequest *request)
+            { sendPage(request, "mesh"); });
+
+  server.on("/api/mesh", HTTP_GET, [](AsyncWebServerRequest *request)
+            {
+    std::shared_ptr<RenderSlot> slot = renderSlot(request);
+    if (!slot) {
+      return;
+    }
+    std::shared_ptr<MeshJsonReader> reader = std::make_shared<MeshJsonReader>();
+    AsyncWebServerResponse* response = request->beginChunkedResponse("application/json",
+        [reader, slot](uint8_t *buffer, size_t maxLen, size_t index) -> size_t {
+          return meshAggregator.fillJson(*reader, reinterpret_cast<char*>(buffer), maxLen, millis());
+        });
+    response->addHeader("Cache-Control", "no-cache");
+    request->send(response); });
+}
+#endif
+#endif
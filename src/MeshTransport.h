@@ -0,0 +1,82 @@
+#ifndef MESH_TRANSPORT_H
+#define MESH_TRANSPORT_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+// Opaque peer address: IPv4 + port for UDP, or a MAC for ESP-NOW
+struct MeshAddress
+{
+  uint8_t bytes[6];
+
+  bool operator==(const MeshAddress &other) const { return memcmp(bytes, other.bytes, sizeof(bytes)) == 0; }
+};
+
+// Unreliable datagram link used by MeshNode and MeshAggregator. Frames may
+// be lost, duplicated or reordered; the protocol copes with all three.
+class MeshTransport
+{
+public:
+  virtual ~MeshTransport() {}
+
+  virtual bool send(const MeshAddress &to, const uint8_t *data, size_t length) = 0;
+  // To whoever may be the aggregator, before its address is known
+  virtual bool broadcast(const uint8_t *data, size_t length) = 0;
+  // Non-blocking, returns 0 when nothing is pending
+  virtual size_t receive(uint8_t *buffer, size_t size, MeshAddress &from) = 0;
+};
+
+#ifdef ARDUINO
+#include <WiFiUdp.h>
+
+// UDP over whatever WiFi interface is up (nodes join the aggregator's AP)
+class WifiUdpTransport : public MeshTransport
+{
+public:
+  // Nodes and the aggregator listen on the same port, broadcasts go there too
+  bool begin(uint16_t port)
+  {
+    localPort = port;
+    return udp.begin(port) == 1;
+  }
+
+  bool send(const MeshAddress &to, const uint8_t *data, size_t length) override
+  {
+    IPAddress ip(to.bytes[0], to.bytes[1], to.bytes[2], to.bytes[3]);
+    return sendTo(ip, (uint16_t)(to.bytes[4] | (to.bytes[5] << 8)), data, length);
+  }
+
+  bool broadcast(const uint8_t *data, size_t length) override
+  {
+    return sendTo(IPAddress(255, 255, 255, 255), localPort, data, length);
+  }
+
+  size_t receive(uint8_t *buffer, size_t size, MeshAddress &from) override
+  {
+    int length = udp.parsePacket();
+    if (length <= 0)
+    {
+      return 0;
+    }
+    IPAddress ip = udp.remoteIP();
+    uint16_t remotePort = udp.remotePort();
+    uint8_t address[6] = {ip[0], ip[1], ip[2], ip[3], (uint8_t)(remotePort & 0xFF), (uint8_t)(remotePort >> 8)};
+    memcpy(from.bytes, address, sizeof(address));
+    int read = udp.read(buffer, size);
+    udp.flush(); // Drop whatever did not fit
+    return read > 0 ? (size_t)read : 0;
+  }
+
+private:
+  WiFiUDP udp;
+  uint16_t localPort = 0;
+
+  bool sendTo(const IPAddress &ip, uint16_t remotePort, const uint8_t *data, size_t length)
+  {
+    return udp.beginPacket(ip, remotePort) == 1 && udp.write(data, length) == length && udp.endPacket() == 1;
+  }
+};
+#endif
+
+#endif // MESH_TRANSPORT_H
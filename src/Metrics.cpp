@@ -0,0 +1,177 @@
+#ifdef ENABLE_METRICS
+#include "Metrics.h"
+#include <stdio.h>
+#include <string.h>
+#include "Hal.h"
+
+static const char *const SECTION_NAMES[SECTION_COUNT] = {
+    "control_tick", "zone_update", "settings_flush", "status_json", "zone_page", "history"};
+
+static const char *const COUNTER_NAMES[COUNTER_COUNT] = {
+    "watering_pump_starts_total", "watering_pump_timeouts_total",
+    "watering_air_detections_total", "watering_settings_writes_total"};
+
+struct Histogram
+{
+  uint32_t buckets[METRIC_BUCKETS + 1]; // Not cumulative, last one is +Inf
+  uint32_t count;
+  uint64_t sum;
+};
+
+static Histogram histograms[SECTION_COUNT];
+static uint32_t counters[COUNTER_COUNT];
+static HalHeapStats heap;
+static uint32_t minLargestBlock = UINT32_MAX;
+static bool heapValid = false;
+
+static const uint32_t FIRST_BUCKET_CYCLES = 1024;
+
+void metricsRecord(MetricSection section, uint32_t cycles)
+{
+  int bucket = 0;
+  uint32_t limit = FIRST_BUCKET_CYCLES;
+  while (bucket < METRIC_BUCKETS && cycles > limit)
+  {
+    limit <<= 2;
+    bucket++;
+  }
+  Histogram &h = histograms[section];
+  h.buckets[bucket]++;
+  h.sum += cycles;
+  h.count++;
+}
+
+void metricsCount(MetricCounter counter)
+{
+  counters[counter]++;
+}
+
+void metricsSampleHeap()
+{
+  HalHeapStats now;
+  if (!halHeapStats(now))
+  {
+    return;
+  }
+  heap = now;
+  if (now.largestBlock < minLargestBlock)
+  {
+    minLargestBlock = now.largestBlock;
+  }
+  heapValid = true;
+}
+
+MetricTimer::MetricTimer(MetricSection section) : section(section), start(halCycles())
+{
+}
+
+MetricTimer::~MetricTimer()
+{
+  metricsRecord(section, halCycles() - start);
+}
+
+// Record layout: counters, heap gauges, then per section its buckets
+// (+Inf last), sum and count
+static const int HEAP_RECORDS = 4;
+static const int SECTION_RECORDS = METRIC_BUCKETS + 1 + 2;
+static const int TOTAL_RECORDS = COUNTER_COUNT + HEAP_RECORDS + SECTION_COUNT * SECTION_RECORDS;
+
+MetricsWriter::MetricsWriter() : record(0), lineLength(0), lineOffset(0)
+{
+}
+
+size_t MetricsWriter::fill(char *buffer, size_t size)
+{
+  size_t written = 0;
+  while (written < size)
+  {
+    if (lineOffset == lineLength && !renderRecord())
+    {
+      break;
+    }
+    size_t chunk = lineLength - lineOffset;
+    if (chunk > size - written)
+    {
+      chunk = size - written;
+    }
+    memcpy(buffer + written, line + lineOffset, chunk);
+    lineOffset += chunk;
+    written += chunk;
+  }
+  return written;
+}
+
+bool MetricsWriter::renderRecord()
+{
+  if (record >= TOTAL_RECORDS)
+  {
+    return false;
+  }
+  int index = record++;
+  int length = 0;
+
+  if (index < COUNTER_COUNT)
+  {
+    length = snprintf(line, sizeof(line), "# TYPE %s counter\n%s %lu\n",
+                      COUNTER_NAMES[index], COUNTER_NAMES[index], (unsigned long)counters[index]);
+  }
+  else if ((index -= COUNTER_COUNT) < HEAP_RECORDS)
+  {
+    static const char *const names[HEAP_RECORDS] = {
+        "watering_heap_free_bytes", "watering_heap_largest_block_bytes",
+        "watering_heap_min_free_bytes", "watering_heap_min_largest_block_bytes"};
+    uint32_t values[HEAP_RECORDS] = {heap.freeBytes, heap.largestBlock, heap.minFreeBytes, minLargestBlock};
+    if (heapValid)
+    {
+      length = snprintf(line, sizeof(line), "# TYPE %s gauge\n%s %lu\n",
+                        names[index], names[index], (unsigned long)values[index]);
+    }
+  }
+  else
+  {
+    index -= HEAP_RECORDS;
+    int section = index / SECTION_RECORDS;
+    int item = index % SECTION_RECORDS;
+    const Histogram &h = histograms[section];
+    const char *name = SECTION_NAMES[section];
+    const char *family = "watering_section_cycles";
+
+    if (item == 0 && section == 0)
+    {
+      length = snprintf(line, sizeof(line), "# TYPE %s histogram\n", family);
+    }
+    if (item <= METRIC_BUCKETS)
+    {
+      uint32_t cumulative = 0;
+      for (int b = 0; b <= item; b++)
+      {
+        cumulative += h.buckets[b];
+      }
+      if (item < METRIC_BUCKETS)
+      {
+        length += snprintf(line + length, sizeof(line) - length, "%s_bucket{section=\"%s\",le=\"%lu\"} %lu\n",
+                           family, name, (unsigned long)(FIRST_BUCKET_CYCLES << (2 * item)), (unsigned long)cumulative);
+      }
+      else
+      {
+        length += snprintf(line + length, sizeof(line) - length, "%s_bucket{section=\"%s\",le=\"+Inf\"} %lu\n",
+                           family, name, (unsigned long)cumulative);
+      }
+    }
+    else if (item == METRIC_BUCKETS + 1)
+    {
+      length = snprintf(line, sizeof(line), "%s_sum{section=\"%s\"} %llu\n",
+                        family, name, (unsigned long long)h.sum);
+    }
+    else
+    {
+      length = snprintf(line, sizeof(line), "%s_count{section=\"%s\"} %lu\n",
+                        family, name, (unsigned long)h.count);
+    }
+  }
+
+  lineLength = length < 0 ? 0 : ((size_t)length < sizeof(line) ? (size_t)length : sizeof(line) - 1);
+  lineOffset = 0;
+  return true;
+}
+#endif // ENABLE_METRICS
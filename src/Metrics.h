@@ -0,0 +1,97 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Optional instrumentation, build with -DENABLE_METRICS.
+//
+// Sections are timed with the CPU cycle counter into fixed histograms
+// (powers of 4 from 1k to 64M cycles). With frequency scaling enabled a
+// cycle count is CPU work, not wall time. Counters and heap watermarks sit
+// next to them, and everything is served as Prometheus text on /metrics.
+//
+// Without ENABLE_METRICS the METRIC_* macros expand to nothing and none of
+// this is compiled in.
+//
+// Each section and counter has a single writer task and 32-bit stores are
+// atomic, so recording takes no lock. A scrape may see a histogram whose
+// count is one ahead of its buckets, which Prometheus tolerates. The 64-bit
+// cycle sum is two stores on the C3, so a scrape that races a record can
+// read a torn _sum (off by up to 2^32 cycles) for that one sample; a 32-bit
+// sum would wrap after about 27 s of CPU time instead.
+
+enum MetricSection
+{
+  SECTION_CONTROL_TICK,   // ZoneController::tick()
+  SECTION_ZONE_UPDATE,    // One zone evaluation (updateSoilMoisture and pump grant)
+  SECTION_SETTINGS_FLUSH, // NVS writes of staged settings
+  SECTION_STATUS_JSON,    // /api/zones
+  SECTION_ZONE_PAGE,      // One chunk of /zone/N
+  SECTION_HISTORY,        // One chunk of /api/zones/N/history
+  SECTION_COUNT
+};
+
+enum MetricCounter
+{
+  COUNTER_PUMP_STARTS,
+  COUNTER_PUMP_TIMEOUTS,
+  COUNTER_AIR_DETECTIONS,
+  COUNTER_SETTINGS_WRITES,
+  COUNTER_COUNT
+};
+
+const int METRIC_BUCKETS = 9; // le 1k, 4k, ... 64M cycles, then +Inf
+
+#ifdef ENABLE_METRICS
+
+void metricsRecord(MetricSection section, uint32_t cycles);
+void metricsCount(MetricCounter counter);
+// Updates the heap gauges and watermarks; call about once a second, from
+// the loop task only (the watermarks are read-modify-write)
+void metricsSampleHeap();
+
+// Streams the Prometheus text exposition in chunks, like TemplateRenderer
+class MetricsWriter
+{
+public:
+  MetricsWriter();
+  // Fills up to size bytes, returns 0 when everything was written
+  size_t fill(char *buffer, size_t size);
+
+private:
+  int record;
+  char line[192];
+  size_t lineLength;
+  size_t lineOffset;
+
+  bool renderRecord();
+};
+
+// Times the enclosing scope
+class MetricTimer
+{
+public:
+  explicit MetricTimer(MetricSection section);
+  ~MetricTimer();
+
+private:
+  MetricSection section;
+  uint32_t start;
+};
+
+#define METRIC_CONCAT_(a, b) a##b
+#define METRIC_CONCAT(a, b) METRIC_CONCAT_(a, b)
+#define METRIC_TIME(section) MetricTimer METRIC_CONCAT(metricTimer, __LINE__)(section)
+#define METRIC_COUNT(counter) metricsCount(counter)
+#define METRIC_SAMPLE_HEAP() metricsSampleHeap()
+
+#else
+
+#define METRIC_TIME(section) ((void)0)
+#define METRIC_COUNT(counter) ((void)0)
+#define METRIC_SAMPLE_HEAP() ((void)0)
+
+#endif // ENABLE_METRICS
+
+#endif // METRICS_H
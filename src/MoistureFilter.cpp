@@ -0,0 +1,100 @@
+#include "MoistureFilter.h"
+
+MoistureFilter::MoistureFilter(const FilterConfig &config)
+{
+  configure(config);
+}
+
+void MoistureFilter::configure(const FilterConfig &config)
+{
+  cfg = config;
+  if (cfg.medianWindow < 1)
+  {
+    cfg.medianWindow = 1;
+  }
+  if (cfg.medianWindow > FILTER_MAX_MEDIAN)
+  {
+    cfg.medianWindow = FILTER_MAX_MEDIAN;
+  }
+  if (cfg.emaShift > 6)
+  {
+    cfg.emaShift = 6;
+  }
+  reset();
+}
+
+void MoistureFilter::reset()
+{
+  head = 0;
+  count = 0;
+  rejectedRun = 0;
+  lastAccepted = 0;
+  ema = 0;
+  rejectedTotal = 0;
+}
+
+int MoistureFilter::update(int raw)
+{
+  // Stage 1: rate-of-change outlier rejection
+  if (count > 0 && cfg.maxStep > 0)
+  {
+    int step = raw - lastAccepted;
+    if (step < 0)
+    {
+      step = -step;
+    }
+    if (step > cfg.maxStep)
+    {
+      if (rejectedRun < MAX_REJECTED_SAMPLES)
+      {
+        rejectedRun++;
+        rejectedTotal++;
+        return value();
+      }
+      // The jump persisted, restart median and EMA at the new level
+      head = 0;
+      count = 0;
+    }
+  }
+  rejectedRun = 0;
+  lastAccepted = raw;
+
+  // Stage 2: median of the last medianWindow accepted samples
+  window[head] = raw;
+  head = (head + 1) % cfg.medianWindow;
+  if (count < cfg.medianWindow)
+  {
+    count++;
+  }
+  int filtered = median();
+
+  // Stage 3: exponential moving average, seeded with the first value
+  int32_t target = (int32_t)filtered << 8;
+  if (count == 1)
+  {
+    ema = target;
+  }
+  else
+  {
+    ema += (target - ema) >> cfg.emaShift;
+  }
+  return value();
+}
+
+int MoistureFilter::median() const
+{
+  // At most five values: insertion sort on a copy beats anything clever
+  int sorted[FILTER_MAX_MEDIAN];
+  for (int i = 0; i < count; i++)
+  {
+    int v = window[i];
+    int j = i;
+    while (j > 0 && sorted[j - 1] > v)
+    {
+      sorted[j] = sorted[j - 1];
+      j--;
+    }
+    sorted[j] = v;
+  }
+  return sorted[count / 2];
+}
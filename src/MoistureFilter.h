@@ -0,0 +1,95 @@
+#ifndef MOISTURE_FILTER_H
+#define MOISTURE_FILTER_H
+
+#include <stdint.h>
+
+// Per-zone filter chain for raw moisture readings, integer math only:
+//
+//   raw -> outlier rejection -> median of N -> EMA -> filtered raw
+//
+// Outlier rejection drops a sample that moves more than maxStep ADC counts
+// away from the last accepted one. After MAX_REJECTED_SAMPLES rejections in
+// a row the new level is accepted and the later stages restart from it, so
+// a real jump (sensor pulled out of the soil) gets through a few samples late.
+// The EMA keeps its state in Q8 fixed point; alpha is 1 / 2^emaShift.
+const int FILTER_MAX_MEDIAN = 5;
+const int MAX_REJECTED_SAMPLES = 3;
+
+struct FilterConfig
+{
+  uint8_t medianWindow; // 1 (off), 3 or 5
+  uint8_t emaShift;     // 0 (off) .. 6
+  uint16_t maxStep;     // ADC counts per sample, 0 disables outlier rejection
+  uint8_t hysteresis;   // Percent band above the dry threshold (see ThresholdLatch)
+};
+
+// Defaults: pump motor spikes are a few hundred counts for one or two samples
+const FilterConfig DEFAULT_FILTER = {5, 2, 300, 3};
+
+class MoistureFilter
+{
+public:
+  MoistureFilter() : MoistureFilter(DEFAULT_FILTER) {}
+  explicit MoistureFilter(const FilterConfig &config);
+
+  void configure(const FilterConfig &config);
+  void reset();
+
+  // Feeds one raw reading and returns the filtered value
+  int update(int raw);
+
+  bool hasValue() const { return count > 0; }
+  int value() const { return (int)((ema + 128) >> 8); }
+  const FilterConfig &config() const { return cfg; }
+  uint32_t rejectedSamples() const { return rejectedTotal; }
+
+private:
+  FilterConfig cfg;
+  int window[FILTER_MAX_MEDIAN];
+  uint8_t head;
+  uint8_t count;
+  uint8_t rejectedRun; // Consecutive rejected samples
+  int lastAccepted;
+  int32_t ema; // Q8
+  uint32_t rejectedTotal;
+
+  int median() const;
+};
+
+// Schmitt trigger around a percent threshold: becomes active at or below
+// the threshold and only releases once the value has risen past
+// threshold + band. Keeps a reading that hovers at the threshold from
+// toggling the zone between dry and not dry.
+class ThresholdLatch
+{
+public:
+  ThresholdLatch() : active(false) {}
+
+  bool update(int percent, int threshold, int band)
+  {
+    active = next(active, percent, threshold, band);
+    return active;
+  }
+
+  // Same transition for callers that keep the state bit themselves
+  static bool next(bool active, int percent, int threshold, int band)
+  {
+    if (percent <= threshold)
+    {
+      return true;
+    }
+    if (percent > threshold + band)
+    {
+      return false;
+    }
+    return active;
+  }
+
+  bool isActive() const { return active; }
+  void clear() { active = false; }
+
+private:
+  bool active;
+};
+
+#endif // MOISTURE_FILTER_H
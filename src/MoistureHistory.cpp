@@ -0,0 +1,309 @@
+#include "MoistureHistory.h"
+#include <stdio.h>
+#include <string.h>
+
+uint32_t MoistureHistory::clockOffset = 0;
+
+static size_t putVarint(uint8_t *out, uint32_t value)
+{
+  size_t length = 0;
+  while (value >= 0x80)
+  {
+    out[length++] = (uint8_t)(value | 0x80);
+    value >>= 7;
+  }
+  out[length++] = (uint8_t)value;
+  return length;
+}
+
+static uint32_t getVarint(const uint8_t *data, uint16_t &offset)
+{
+  uint32_t value = 0;
+  int shift = 0;
+  uint8_t byte;
+  do
+  {
+    byte = data[offset++];
+    value |= (uint32_t)(byte & 0x7F) << shift;
+    shift += 7;
+  } while (byte & 0x80);
+  return value;
+}
+
+static uint32_t zigzag(int32_t value)
+{
+  return ((uint32_t)value << 1) ^ (uint32_t)(value >> 31);
+}
+
+static int32_t unzigzag(uint32_t value)
+{
+  return (int32_t)(value >> 1) ^ -(int32_t)(value & 1);
+}
+
+template <int BLOCKS>
+void HistoryTier<BLOCKS>::append(const HistoryRecord &record)
+{
+  uint8_t encoded[20];
+  size_t length = 0;
+  Block *block = nextSequence > 1 ? &blocks[(nextSequence - 1) % BLOCKS] : nullptr;
+
+  // Time going backwards (clock reset) also starts a new absolute block
+  if (block && record.time >= last.time)
+  {
+    length += putVarint(encoded + length, record.time - last.time);
+    length += putVarint(encoded + length, zigzag((int32_t)record.avg - last.avg));
+    if (spread)
+    {
+      length += putVarint(encoded + length, record.avg - record.min);
+      length += putVarint(encoded + length, record.max - record.avg);
+    }
+  }
+
+  if (block && length > 0 && block->length + length <= HISTORY_BLOCK_BYTES)
+  {
+    memcpy(block->data + block->length, encoded, length);
+    block->length += length;
+  }
+  else
+  {
+    // Start a new block, overwriting the oldest one once the ring is full
+    block = &blocks[nextSequence % BLOCKS];
+    block->sequence = nextSequence++;
+    block->first = record;
+    block->length = 0;
+  }
+  last = record;
+}
+
+template <int BLOCKS>
+void HistoryTier<BLOCKS>::seek(HistoryCursor &cursor, uint32_t from) const
+{
+  cursor = HistoryCursor();
+  cursor.sequence = oldestSequence();
+  // Skip whole blocks that end before `from`
+  while (cursor.sequence + 1 < nextSequence && blocks[(cursor.sequence + 1) % BLOCKS].first.time <= from)
+  {
+    cursor.sequence++;
+  }
+}
+
+template <int BLOCKS>
+bool HistoryTier<BLOCKS>::next(HistoryCursor &cursor, HistoryRecord &out) const
+{
+  if (cursor.sequence < oldestSequence())
+  {
+    // The block being read was overwritten, continue with the oldest one left
+    cursor.sequence = oldestSequence();
+    cursor.started = false;
+  }
+
+  while (cursor.sequence < nextSequence)
+  {
+    const Block &block = blocks[cursor.sequence % BLOCKS];
+    if (!cursor.started)
+    {
+      cursor.started = true;
+      cursor.offset = 0;
+      cursor.last = block.first;
+      out = block.first;
+      return true;
+    }
+
+    if (cursor.offset < block.length)
+    {
+      out.time = cursor.last.time + getVarint(block.data, cursor.offset);
+      out.avg = (uint16_t)(cursor.last.avg + unzigzag(getVarint(block.data, cursor.offset)));
+      out.min = out.avg;
+      out.max = out.avg;
+      if (spread)
+      {
+        out.min = (uint16_t)(out.avg - getVarint(block.data, cursor.offset));
+        out.max = (uint16_t)(out.avg + getVarint(block.data, cursor.offset));
+      }
+      cursor.last = out;
+      return true;
+    }
+
+    if (cursor.sequence + 1 >= nextSequence)
+    {
+      return false; // Caught up with the writer
+    }
+    cursor.sequence++;
+    cursor.started = false;
+  }
+  return false;
+}
+
+MoistureHistory::MoistureHistory() : raw(false), minutes(true), hours(true), minuteBucket(), hourBucket(), lastTime(0)
+{
+}
+
+template <int BLOCKS>
+void MoistureHistory::accumulate(Accumulator &bucket, HistoryTier<BLOCKS> &tier, uint32_t seconds,
+                                 uint32_t time, uint16_t value)
+{
+  uint32_t index = time / seconds + 1; // +1 so that 0 can mean "empty"
+  if (bucket.bucket != index && bucket.count > 0)
+  {
+    HistoryRecord aggregate;
+    aggregate.time = (bucket.bucket - 1) * seconds;
+    aggregate.min = bucket.min;
+    aggregate.avg = (uint16_t)(bucket.sum / bucket.count);
+    aggregate.max = bucket.max;
+    tier.append(aggregate);
+    bucket.count = 0;
+  }
+
+  if (bucket.count == 0)
+  {
+    bucket.bucket = index;
+    bucket.min = value;
+    bucket.max = value;
+    bucket.sum = 0;
+  }
+  bucket.min = value < bucket.min ? value : bucket.min;
+  bucket.max = value > bucket.max ? value : bucket.max;
+  bucket.sum += value;
+  bucket.count++;
+}
+
+void MoistureHistory::record(uint32_t time, int value)
+{
+  uint16_t sample = (uint16_t)(value < 0 ? 0 : (value > 0xFFFF ? 0xFFFF : value));
+  HistoryRecord record = {time, sample, sample, sample};
+  raw.append(record);
+  lastTime = time;
+  accumulate(minuteBucket, minutes, 60, time, sample);
+  accumulate(hourBucket, hours, 3600, time, sample);
+}
+
+void MoistureHistory::seek(HistoryResolution resolution, HistoryCursor &cursor, uint32_t from) const
+{
+  switch (resolution)
+  {
+  case HISTORY_RAW:
+    raw.seek(cursor, from);
+    break;
+  case HISTORY_MINUTE:
+    minutes.seek(cursor, from);
+    break;
+  case HISTORY_HOUR:
+    hours.seek(cursor, from);
+    break;
+  }
+}
+
+bool MoistureHistory::next(HistoryResolution resolution, HistoryCursor &cursor, HistoryRecord &out) const
+{
+  switch (resolution)
+  {
+  case HISTORY_RAW:
+    return raw.next(cursor, out);
+  case HISTORY_MINUTE:
+    return minutes.next(cursor, out);
+  case HISTORY_HOUR:
+    return hours.next(cursor, out);
+  }
+  return false;
+}
+
+HistoryReader::HistoryReader(HistoryResolution resolution, uint32_t from)
+    : resolution(resolution), from(from), cursor(), headerSent(false), finished(false),
+      pendingLength(0), pendingOffset(0)
+{
+}
+
+size_t HistoryReader::fill(const MoistureHistory &history, char *buffer, size_t size)
+{
+  size_t length = 0;
+  while (length < size)
+  {
+    if (pendingOffset < pendingLength)
+    {
+      size_t count = pendingLength - pendingOffset;
+      if (count > size - length)
+      {
+        count = size - length;
+      }
+      memcpy(buffer + length, pending + pendingOffset, count);
+      pendingOffset += count;
+      length += count;
+      continue;
+    }
+
+    if (finished)
+    {
+      break;
+    }
+
+    int written;
+    if (!headerSent)
+    {
+      headerSent = true;
+      history.seek(resolution, cursor, from);
+      written = snprintf(pending, sizeof(pending), "time,min,avg,max\n");
+    }
+    else
+    {
+      HistoryRecord record;
+      if (!history.next(resolution, cursor, record))
+      {
+        finished = true;
+        continue;
+      }
+      if (record.time < from)
+      {
+        continue;
+      }
+      written = snprintf(pending, sizeof(pending), "%lu,%u,%u,%u\n", (unsigned long)record.time,
+                         record.min, record.avg, record.max);
+    }
+    pendingLength = written > 0 ? (size_t)written : 0;
+    pendingOffset = 0;
+  }
+  return length;
+}
+
+#ifdef ARDUINO
+#include <LittleFS.h>
+
+static const uint32_t HISTORY_FILE_MAGIC = 0x4D484931; // "MHI1"
+
+static void historyPath(int zoneId, char *path, size_t size)
+{
+  snprintf(path, size, "/history/zone%d.bin", zoneId);
+}
+
+bool saveHistoryFile(int zoneId, const MoistureHistory &history)
+{
+  char path[32];
+  historyPath(zoneId, path, sizeof(path));
+  File file = LittleFS.open(path, "w", true);
+  if (!file)
+  {
+    return false;
+  }
+  uint32_t header[2] = {HISTORY_FILE_MAGIC, sizeof(MoistureHistory)};
+  bool written = file.write(reinterpret_cast<const uint8_t *>(header), sizeof(header)) == sizeof(header) &&
+                 file.write(reinterpret_cast<const uint8_t *>(&history), sizeof(history)) == sizeof(history);
+  file.close();
+  return written;
+}
+
+bool loadHistoryFile(int zoneId, MoistureHistory &history)
+{
+  char path[32];
+  historyPath(zoneId, path, sizeof(path));
+  File file = LittleFS.open(path, "r");
+  if (!file)
+  {
+    return false;
+  }
+  uint32_t header[2];
+  bool valid = file.read(reinterpret_cast<uint8_t *>(header), sizeof(header)) == sizeof(header) &&
+               header[0] == HISTORY_FILE_MAGIC && header[1] == sizeof(MoistureHistory) &&
+               file.read(reinterpret_cast<uint8_t *>(&history), sizeof(history)) == sizeof(history);
+  file.close();
+  return valid;
+}
+#endif
@@ -0,0 +1,141 @@
+#ifndef MOISTURE_HISTORY_H
+#define MOISTURE_HISTORY_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Fixed-memory moisture history, one per zone.
+//
+// Three tiers: every raw reading, 1-minute and 1-hour aggregates (min/avg/max
+// of the raw ADC value). Each tier is a ring of small blocks. A block starts
+// with one absolute record followed by varint-encoded deltas, so a raw sample
+// costs about 2 bytes and an aggregate about 4-5 bytes. When a tier is full
+// its oldest block is dropped as a whole.
+//
+// Memory per zone is sizeof(MoistureHistory), about 4 KB with the defaults:
+//   raw     8 blocks  ~ 45 minutes at one reading per 10 s
+//   minute 24 blocks  ~ 6 hours
+//   hour   16 blocks  ~ 8 days
+const int HISTORY_BLOCK_BYTES = 64;
+const int HISTORY_RAW_BLOCKS = 8;
+const int HISTORY_MINUTE_BLOCKS = 24;
+const int HISTORY_HOUR_BLOCKS = 16;
+
+enum HistoryResolution
+{
+  HISTORY_RAW,
+  HISTORY_MINUTE,
+  HISTORY_HOUR
+};
+
+struct HistoryRecord
+{
+  uint32_t time; // Seconds on the history clock (see MoistureHistory::now)
+  uint16_t min;
+  uint16_t avg;
+  uint16_t max;
+};
+
+// Read position inside one tier, survives concurrent appends
+struct HistoryCursor
+{
+  uint32_t sequence;
+  uint16_t offset;
+  bool started;
+  HistoryRecord last;
+};
+
+template <int BLOCKS>
+class HistoryTier
+{
+public:
+  explicit HistoryTier(bool withSpread) : blocks(), nextSequence(1), last(), spread(withSpread) {}
+
+  void append(const HistoryRecord &record);
+  void seek(HistoryCursor &cursor, uint32_t from) const;
+  bool next(HistoryCursor &cursor, HistoryRecord &out) const;
+
+private:
+  struct Block
+  {
+    uint32_t sequence; // 0 = never used
+    HistoryRecord first;
+    uint16_t length;
+    uint8_t data[HISTORY_BLOCK_BYTES];
+  };
+
+  Block blocks[BLOCKS];
+  uint32_t nextSequence;
+  HistoryRecord last;
+  bool spread; // Aggregates also store min and max
+
+  uint32_t oldestSequence() const { return nextSequence > BLOCKS ? nextSequence - BLOCKS : 1; }
+};
+
+class MoistureHistory
+{
+public:
+  MoistureHistory();
+
+  void record(uint32_t time, int value);
+  void seek(HistoryResolution resolution, HistoryCursor &cursor, uint32_t from) const;
+  bool next(HistoryResolution resolution, HistoryCursor &cursor, HistoryRecord &out) const;
+  uint32_t latestTime() const { return lastTime; }
+
+  // History clock: seconds since boot, shifted so that restored history
+  // from a previous boot stays in the past
+  static uint32_t now(unsigned long millis) { return millis / 1000 + clockOffset; }
+  static uint32_t clockOffset;
+
+private:
+  struct Accumulator
+  {
+    uint32_t bucket; // time / bucket length, 0 = empty
+    uint16_t min;
+    uint16_t max;
+    uint32_t sum;
+    uint32_t count;
+  };
+
+  HistoryTier<HISTORY_RAW_BLOCKS> raw;
+  HistoryTier<HISTORY_MINUTE_BLOCKS> minutes;
+  HistoryTier<HISTORY_HOUR_BLOCKS> hours;
+  Accumulator minuteBucket;
+  Accumulator hourBucket;
+  uint32_t lastTime;
+
+  template <int BLOCKS>
+  static void accumulate(Accumulator &bucket, HistoryTier<BLOCKS> &tier, uint32_t seconds,
+                         uint32_t time, uint16_t value);
+};
+
+// Streams one tier of a history as CSV ("time,min,avg,max") in chunks,
+// the same way TemplateRenderer feeds a chunked response
+class HistoryReader
+{
+public:
+  HistoryReader(HistoryResolution resolution, uint32_t from);
+
+  // Returns 0 once all records up to the newest one were written
+  size_t fill(const MoistureHistory &history, char *buffer, size_t size);
+
+private:
+  HistoryResolution resolution;
+  uint32_t from;
+  HistoryCursor cursor;
+  bool headerSent;
+  bool finished;
+  char pending[48];
+  size_t pendingLength;
+  size_t pendingOffset;
+};
+
+#ifdef ARDUINO
+// Optional persistence (build with -DHISTORY_LITTLEFS): one file per zone
+// in LittleFS, /history/zone<id>.bin, a raw copy behind a magic number and
+// the struct size, so a file from a different build is ignored
+bool saveHistoryFile(int zoneId, const MoistureHistory &history);
+bool loadHistoryFile(int zoneId, MoistureHistory &history);
+#endif
+
+#endif // MOISTURE_HISTORY_H
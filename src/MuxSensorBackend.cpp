@@ -0,0 +1,107 @@
+#include "MuxSensorBackend.h"
+#include "Hal.h"
+
+// Neighbours differ in one bit
+static const uint8_t GRAY_ORDER[MUX_INPUTS] = {0, 1, 3, 2, 6, 7, 5, 4};
+
+static int grayPosition(int input)
+{
+  for (int i = 0; i < MUX_INPUTS; i++)
+  {
+    if (GRAY_ORDER[i] == input)
+    {
+      return i;
+    }
+  }
+  return 0;
+}
+
+MuxSensorBackend::MuxSensorBackend(const int *selectPins, const int *adcPins, int chips, uint32_t settleUs)
+    : chips(chips < MUX_MAX_CHIPS ? chips : MUX_MAX_CHIPS), settleUs(settleUs), pending(0), selected(-1),
+      settleCount(0), selectWriteCount(0), conversionCount(0)
+{
+  for (int i = 0; i < MUX_SELECT_BITS; i++)
+  {
+    this->selectPins[i] = selectPins[i];
+  }
+  for (int i = 0; i < this->chips; i++)
+  {
+    this->adcPins[i] = adcPins[i];
+  }
+}
+
+void MuxSensorBackend::begin()
+{
+  for (int i = 0; i < MUX_SELECT_BITS; i++)
+  {
+    hal().gpio->setOutput(selectPins[i]);
+  }
+  for (int i = 0; i < chips; i++)
+  {
+    hal().gpio->setInput(adcPins[i]);
+  }
+  selected = -1;
+}
+
+void MuxSensorBackend::request(int channel)
+{
+  if (channel >= 0 && channel < channelCount())
+  {
+    pending |= (uint16_t)(1u << channel);
+  }
+}
+
+void MuxSensorBackend::select(int input)
+{
+  for (int bit = 0; bit < MUX_SELECT_BITS; bit++)
+  {
+    int mask = 1 << bit;
+    if (selected < 0 || ((input ^ selected) & mask))
+    {
+      hal().gpio->write(selectPins[bit], (input & mask) != 0);
+      selectWriteCount++;
+    }
+  }
+  selected = input;
+  halDelayMicros(settleUs);
+  settleCount++;
+}
+
+void MuxSensorBackend::poll(unsigned long, SensorResultFn done, void *context)
+{
+  int start = selected < 0 ? 0 : grayPosition(selected);
+  for (int step = 0; step < MUX_INPUTS && pending; step++)
+  {
+    int input = GRAY_ORDER[(start + step) % MUX_INPUTS];
+    uint16_t due = 0;
+    for (int chip = 0; chip < chips; chip++)
+    {
+      due |= pending & (uint16_t)(1u << (chip * MUX_INPUTS + input));
+    }
+    if (!due)
+    {
+      continue;
+    }
+    // The current selection has long settled
+    if (input != selected)
+    {
+      select(input);
+    }
+    for (int chip = 0; chip < chips; chip++)
+    {
+      int channel = chip * MUX_INPUTS + input;
+      if (due & (1u << channel))
+      {
+        pending &= (uint16_t)~(1u << channel);
+        conversionCount++;
+        done(context, channel, hal().adc->read(adcPins[chip]));
+      }
+    }
+  }
+}
+
+bool MuxSensorBackend::nextPollTime(unsigned long now, unsigned long &at) const
+{
+  at = now;
+  return pending != 0;
+}
@@ -0,0 +1,51 @@
+#ifndef MUX_SENSOR_BACKEND_H
+#define MUX_SENSOR_BACKEND_H
+
+#include <stdint.h>
+#include "SensorBackend.h"
+
+const int MUX_SELECT_BITS = 3;
+const int MUX_INPUTS = 8;          // 74HC4051
+const int MUX_MAX_CHIPS = 2;       // 16 channels fill a backend's address space
+const uint32_t MUX_SETTLE_US = 20; // Cable and switch resistance charging the ADC's sample capacitor
+
+// 74HC4051-style analog multiplexers on the native ADC. All chips share the
+// three select lines and each has its common output on its own ADC pin;
+// channel = chip * MUX_INPUTS + input. One select and one settling wait
+// serve that input on every chip, and the inputs are visited in Gray code
+// order starting at the current selection, so each step flips one select
+// line. A full scan costs at most MUX_INPUTS settles however many chips.
+// Conversions finish inside poll(), the ADC itself is fast.
+class MuxSensorBackend : public SensorBackend
+{
+public:
+  MuxSensorBackend(const int *selectPins, const int *adcPins, int chips, uint32_t settleUs = MUX_SETTLE_US);
+
+  // Configures the pins through the installed HAL
+  void begin();
+
+  int channelCount() const override { return chips * MUX_INPUTS; }
+  void request(int channel) override;
+  void poll(unsigned long now, SensorResultFn done, void *context) override;
+  bool nextPollTime(unsigned long now, unsigned long &at) const override;
+
+  // Statistics
+  uint32_t settles() const { return settleCount; }
+  uint32_t selectWrites() const { return selectWriteCount; }
+  uint32_t conversions() const { return conversionCount; }
+
+private:
+  int selectPins[MUX_SELECT_BITS];
+  int adcPins[MUX_MAX_CHIPS];
+  int chips;
+  uint32_t settleUs;
+  uint16_t pending; // Bit per channel
+  int selected;     // Input the select lines point at, -1: unknown
+  uint32_t settleCount;
+  uint32_t selectWriteCount;
+  uint32_t conversionCount;
+
+  void select(int input);
+};
+
+#endif // MUX_SENSOR_BACKEND_H
@@ -0,0 +1,128 @@
+#include "PumpCutoff.h"
+#include "Hal.h"
+
+PumpCutoff::PumpCutoff() : totals()
+{
+  for (Guard &guard : guards)
+  {
+    guard = {this, nullptr, -1, false, false, 0, 0, 0};
+  }
+}
+
+bool PumpCutoff::attach(int slot, CutoffTimer *timer)
+{
+  if (slot < 0 || slot >= MAX_ZONES)
+  {
+    return false;
+  }
+  std::lock_guard<std::mutex> lock(mutex);
+  Guard &guard = guards[slot];
+  if (guard.timer)
+  {
+    guard.timer->stop();
+  }
+  guard.timer = timer && timer->begin(expired, &guard) ? timer : nullptr;
+  return guard.timer == timer;
+}
+
+void PumpCutoff::arm(int slot, int pin, unsigned long deadlineMs)
+{
+  if (slot < 0 || slot >= MAX_ZONES)
+  {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(mutex);
+  Guard &guard = guards[slot];
+  if (guard.armed && guard.pin == pin && guard.deadlineMs == deadlineMs)
+  {
+    return;
+  }
+  long remainingMs = (long)(deadlineMs - halMillis());
+  uint32_t delayUs = remainingMs > 0 ? (uint32_t)remainingMs * 1000 : 0;
+  guard.pin = pin;
+  guard.armed = true;
+  guard.tripped = false;
+  guard.deadlineMs = deadlineMs;
+  guard.deadlineUs = (uint32_t)halMicros() + delayUs;
+  if (guard.timer)
+  {
+    guard.timer->start(delayUs);
+  }
+}
+
+bool PumpCutoff::disarm(int slot, unsigned long &cutAtMs)
+{
+  if (slot < 0 || slot >= MAX_ZONES)
+  {
+    return false;
+  }
+  std::lock_guard<std::mutex> lock(mutex);
+  Guard &guard = guards[slot];
+  if (guard.armed || guard.tripped)
+  {
+    // What the relay's over-run would have been without the timer
+    int32_t lateUs = (int32_t)((uint32_t)halMicros() - guard.deadlineUs);
+    if (lateUs > 0 && (uint32_t)lateUs > totals.maxControlLateUs)
+    {
+      totals.maxControlLateUs = (uint32_t)lateUs;
+    }
+  }
+  if (guard.armed && guard.timer)
+  {
+    guard.timer->stop();
+  }
+  bool tripped = guard.tripped;
+  cutAtMs = guard.cutAtMs;
+  guard.armed = false;
+  guard.tripped = false;
+  return tripped;
+}
+
+// Timer context: holds the lock for one GPIO write
+void PumpCutoff::expired(void *context)
+{
+  Guard &guard = *static_cast<Guard *>(context);
+  PumpCutoff &owner = *guard.owner;
+  std::lock_guard<std::mutex> lock(owner.mutex);
+  if (!guard.armed)
+  {
+    return; // Stopped in time by the control task
+  }
+  int32_t overrunUs = (int32_t)((uint32_t)halMicros() - guard.deadlineUs);
+  if (overrunUs < 0)
+  {
+    // An expiry of a deadline that was moved later since
+    guard.timer->start((uint32_t)-overrunUs);
+    return;
+  }
+  hal().gpio->write(guard.pin, false);
+  guard.armed = false;
+  guard.tripped = true;
+  guard.cutAtMs = halMillis();
+  owner.totals.cutoffs++;
+  owner.totals.lastOverrunUs = (uint32_t)overrunUs;
+  if ((uint32_t)overrunUs > owner.totals.maxOverrunUs)
+  {
+    owner.totals.maxOverrunUs = (uint32_t)overrunUs;
+  }
+}
+
+CutoffStats PumpCutoff::stats() const
+{
+  std::lock_guard<std::mutex> lock(mutex);
+  return totals;
+}
+
+void PumpCutoff::reset()
+{
+  std::lock_guard<std::mutex> lock(mutex);
+  for (Guard &guard : guards)
+  {
+    if (guard.timer)
+    {
+      guard.timer->stop();
+    }
+    guard = {this, nullptr, -1, false, false, 0, 0, 0};
+  }
+  totals = CutoffStats();
+}
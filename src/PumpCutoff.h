@@ -0,0 +1,101 @@
+#ifndef PUMP_CUTOFF_H
+#define PUMP_CUTOFF_H
+
+#include <stdint.h>
+#include <mutex>
+#include "ZoneSnapshot.h"
+
+typedef void (*CutoffTimerFn)(void *context);
+
+// One-shot timer whose callback runs outside the control task
+class CutoffTimer
+{
+public:
+  virtual ~CutoffTimer() {}
+
+  virtual bool begin(CutoffTimerFn fn, void *context) = 0;
+  // Replaces an expiry that is still pending
+  virtual void start(uint32_t delayUs) = 0;
+  virtual void stop() = 0;
+};
+
+#ifdef ARDUINO
+#include <esp_timer.h>
+
+// Callbacks run in the esp_timer task, which preempts the control and loop tasks
+class EspCutoffTimer : public CutoffTimer
+{
+public:
+  bool begin(CutoffTimerFn fn, void *context) override
+  {
+    esp_timer_create_args_t args = {};
+    args.callback = fn;
+    args.arg = context;
+    args.dispatch_method = ESP_TIMER_TASK;
+    args.name = "pump_cutoff";
+    return esp_timer_create(&args, &handle) == ESP_OK;
+  }
+
+  void start(uint32_t delayUs) override
+  {
+    esp_timer_stop(handle); // Fails harmlessly when nothing is pending
+    esp_timer_start_once(handle, delayUs);
+  }
+
+  void stop() override { esp_timer_stop(handle); }
+
+private:
+  esp_timer_handle_t handle = nullptr;
+};
+#endif
+
+struct CutoffStats
+{
+  uint32_t cutoffs;          // Relays the timer opened
+  uint32_t maxOverrunUs;     // Of those, the latest past the run limit
+  uint32_t lastOverrunUs;
+  uint32_t maxControlLateUs; // Latest the control task itself stopped a pump past its limit
+};
+
+// Backstop for pump run limits. A running pump's one-shot timer expires at
+// its limit and opens the relay however late the control task gets there
+// (blocking WiFi setup, a slow handler, flash writes). The zone logic still
+// stops the pump itself and, if the relay is already open, only books the
+// stop at the time the timer cut it. Slots without a timer rely on the
+// control task alone but still measure how late it was.
+class PumpCutoff
+{
+public:
+  PumpCutoff();
+
+  // For a zone slot (ZoneRegistry index), before the zones run; nullptr detaches
+  bool attach(int slot, CutoffTimer *timer);
+  // The relay on pin must open at deadlineMs (millis()); re-arming with the same deadline does nothing
+  void arm(int slot, int pin, unsigned long deadlineMs);
+  // true if the timer opened the relay, at cutAtMs
+  bool disarm(int slot, unsigned long &cutAtMs);
+  CutoffStats stats() const;
+  // Detaches all timers and clears the statistics (host runs)
+  void reset();
+
+private:
+  struct Guard
+  {
+    PumpCutoff *owner;
+    CutoffTimer *timer;
+    int pin;
+    bool armed;
+    bool tripped;
+    unsigned long deadlineMs;
+    uint32_t deadlineUs; // halMicros(), wraps
+    unsigned long cutAtMs;
+  };
+
+  mutable std::mutex mutex;
+  Guard guards[MAX_ZONES];
+  CutoffStats totals;
+
+  static void expired(void *context);
+};
+
+#endif // PUMP_CUTOFF_H
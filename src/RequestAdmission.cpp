@@ -0,0 +1,181 @@
+#include "RequestAdmission.h"
+#include <string.h>
+
+// Tokens (in thousandths) a request of each class costs
+static const int32_t REQUEST_COST[REQUEST_CLASS_COUNT] = {1000, 1000, 2000, 5000};
+
+static const char *const CAPTIVE_PROBES[] = {
+    "/generate_204",              // Android, Chrome
+    "/gen_204",                   // Android
+    "/hotspot-detect.html",       // Apple
+    "/library/test/success.html", // Apple (older)
+    "/connecttest.txt",           // Windows 10+
+    "/ncsi.txt",                  // Windows
+    "/redirect",                  // Windows
+    "/canonical.html",            // Firefox
+    "/success.txt",               // Firefox
+};
+
+bool isCaptiveProbe(const char *path)
+{
+  for (const char *probe : CAPTIVE_PROBES)
+  {
+    if (strcmp(path, probe) == 0)
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
+static bool startsWith(const char *text, const char *prefix)
+{
+  return strncmp(text, prefix, strlen(prefix)) == 0;
+}
+
+// prefix, a zone id, then exactly suffix: the ^prefix([0-9]+)suffix$ routes
+static bool matchesZoneRoute(const char *path, const char *prefix, const char *suffix)
+{
+  if (!startsWith(path, prefix))
+  {
+    return false;
+  }
+  const char *id = path + strlen(prefix);
+  const char *end = id;
+  while (*end >= '0' && *end <= '9')
+  {
+    end++;
+  }
+  return end != id && strcmp(end, suffix) == 0;
+}
+
+RequestClass classifyRequest(const char *path)
+{
+  if (isCaptiveProbe(path))
+  {
+    return REQUEST_PROBE;
+  }
+  // /zone/N/config only queues the change and redirects, so it stays an API request
+  if (matchesZoneRoute(path, "/zone/", "") || matchesZoneRoute(path, "/api/zones/", "/history") ||
+      strcmp(path, "/metrics") == 0 || strcmp(path, "/api/mesh") == 0 || strcmp(path, "/api/log") == 0)
+  {
+    return REQUEST_RENDER;
+  }
+  if (startsWith(path, "/api/") || startsWith(path, "/mesh/") || matchesZoneRoute(path, "/zone/", "/config"))
+  {
+    return REQUEST_API;
+  }
+  return REQUEST_STATIC;
+}
+
+RequestAdmission::RequestAdmission() : rejectedRate(0), rejectedBusy(0), rejectedHeap(0), renders(0), heapProbe(halHeapStats)
+{
+  memset(admitted, 0, sizeof(admitted));
+  memset(buckets, 0, sizeof(buckets));
+}
+
+void RequestAdmission::refill(Bucket &bucket, unsigned long now)
+{
+  unsigned long elapsed = now - bucket.updatedAt;
+  bucket.updatedAt = now;
+  // Clamp first so a long idle client cannot overflow the product
+  if (elapsed >= (unsigned long)ADMISSION_BURST * 1000 / ADMISSION_REFILL_PER_SEC)
+  {
+    bucket.milliTokens = ADMISSION_BURST * 1000;
+    return;
+  }
+  bucket.milliTokens += (int32_t)(elapsed * ADMISSION_REFILL_PER_SEC);
+  if (bucket.milliTokens > ADMISSION_BURST * 1000)
+  {
+    bucket.milliTokens = ADMISSION_BURST * 1000;
+  }
+}
+
+RequestAdmission::Bucket &RequestAdmission::bucketFor(uint32_t client, unsigned long now)
+{
+  Bucket *oldest = &buckets[0];
+  for (Bucket &bucket : buckets)
+  {
+    if (bucket.used && bucket.client == client)
+    {
+      refill(bucket, now);
+      return bucket;
+    }
+    if (!bucket.used)
+    {
+      oldest = &bucket;
+    }
+    else if (oldest->used && now - bucket.updatedAt > now - oldest->updatedAt)
+    {
+      oldest = &bucket;
+    }
+  }
+  // An evicted client comes back with a full bucket, which only matters
+  // with more than ADMISSION_CLIENTS active clients
+  oldest->used = true;
+  oldest->client = client;
+  oldest->milliTokens = ADMISSION_BURST * 1000;
+  oldest->updatedAt = now;
+  return *oldest;
+}
+
+AdmissionResult RequestAdmission::admit(uint32_t client, RequestClass kind, unsigned long now)
+{
+  Bucket &bucket = bucketFor(client, now);
+  int32_t cost = REQUEST_COST[kind];
+  if (bucket.milliTokens < cost)
+  {
+    rejectedRate++;
+    return REJECT_RATE;
+  }
+
+  // Probes and static assets are answered from flash without building
+  // anything, so they stay available when heap is short
+  if (kind == REQUEST_API || kind == REQUEST_RENDER)
+  {
+    HalHeapStats heap;
+    if (heapProbe && heapProbe(heap) &&
+        (heap.freeBytes < ADMISSION_MIN_FREE_HEAP || heap.largestBlock < ADMISSION_MIN_BLOCK))
+    {
+      rejectedHeap++;
+      return REJECT_LOW_HEAP;
+    }
+  }
+  if (kind == REQUEST_RENDER && renders >= ADMISSION_MAX_RENDERS)
+  {
+    rejectedBusy++;
+    return REJECT_BUSY;
+  }
+
+  bucket.milliTokens -= cost;
+  admitted[kind]++;
+  return ADMIT;
+}
+
+std::shared_ptr<RenderSlot> RequestAdmission::acquireRender()
+{
+  if (renders >= ADMISSION_MAX_RENDERS)
+  {
+    return nullptr;
+  }
+  return std::make_shared<RenderSlot>(*this);
+}
+
+unsigned long RequestAdmission::retryAfterSec(uint32_t client, RequestClass kind, unsigned long now) const
+{
+  for (const Bucket &bucket : buckets)
+  {
+    if (bucket.used && bucket.client == client)
+    {
+      Bucket current = bucket;
+      refill(current, now);
+      int32_t missing = REQUEST_COST[kind] - current.milliTokens;
+      if (missing <= 0)
+      {
+        return 1;
+      }
+      return (unsigned long)missing / (ADMISSION_REFILL_PER_SEC * 1000) + 1;
+    }
+  }
+  return 1;
+}
@@ -0,0 +1,95 @@
+#ifndef REQUEST_ADMISSION_H
+#define REQUEST_ADMISSION_H
+
+#include <stdint.h>
+#include <memory>
+#include "Hal.h"
+
+// What a request costs the device, decided from its path alone
+enum RequestClass
+{
+  REQUEST_PROBE,  // Captive-portal connectivity check, answered with a canned redirect
+  REQUEST_STATIC, // Embedded gzip assets and redirects
+  REQUEST_API,    // Small JSON built from the snapshot, config submissions
+  REQUEST_RENDER, // Streamed responses that hold state until sent (zone page, history, metrics, mesh, log)
+  REQUEST_CLASS_COUNT
+};
+
+enum AdmissionResult
+{
+  ADMIT,
+  REJECT_RATE,     // 429: this client is over its budget
+  REJECT_BUSY,     // 503: too many renders in flight
+  REJECT_LOW_HEAP  // 503: not enough heap left to answer safely
+};
+
+const int ADMISSION_CLIENTS = 16;               // Buckets kept, least recently seen is reused
+const int ADMISSION_BURST = 20;                 // Tokens a client can spend at once
+const int ADMISSION_REFILL_PER_SEC = 5;
+const int ADMISSION_MAX_RENDERS = 2;            // Streamed responses in flight
+const uint32_t ADMISSION_MIN_FREE_HEAP = 24576; // Below this only probes and static assets are served
+const uint32_t ADMISSION_MIN_BLOCK = 8192;      // Largest free block needed for a response
+
+RequestClass classifyRequest(const char *path);
+// Well-known connectivity check URLs of Android, Apple, Windows and Firefox
+bool isCaptiveProbe(const char *path);
+
+// Held by a streamed response for as long as it exists (captured in the
+// filler lambda), frees the in-flight slot when the response is destroyed
+class RenderSlot;
+
+// Admission control in front of the web handlers: a token bucket per client
+// address plus a cap on streamed responses and a heap floor. All web
+// handlers run on the AsyncTCP task, so no locking.
+class RequestAdmission
+{
+public:
+  RequestAdmission();
+
+  AdmissionResult admit(uint32_t client, RequestClass kind, unsigned long now);
+  // nullptr when ADMISSION_MAX_RENDERS responses are already streaming
+  std::shared_ptr<RenderSlot> acquireRender();
+  // Seconds until the client has enough tokens again (Retry-After)
+  unsigned long retryAfterSec(uint32_t client, RequestClass kind, unsigned long now) const;
+
+  // Host tests replace the heap source
+  void setHeapProbe(bool (*probe)(HalHeapStats &)) { heapProbe = probe; }
+  int rendersInFlight() const { return renders; }
+
+  unsigned long admitted[REQUEST_CLASS_COUNT];
+  unsigned long rejectedRate;
+  unsigned long rejectedBusy;
+  unsigned long rejectedHeap;
+
+private:
+  friend class RenderSlot;
+
+  struct Bucket
+  {
+    uint32_t client;
+    int32_t milliTokens;
+    unsigned long updatedAt;
+    bool used;
+  };
+
+  Bucket buckets[ADMISSION_CLIENTS];
+  int renders;
+  bool (*heapProbe)(HalHeapStats &);
+
+  Bucket &bucketFor(uint32_t client, unsigned long now);
+  static void refill(Bucket &bucket, unsigned long now);
+};
+
+class RenderSlot
+{
+public:
+  explicit RenderSlot(RequestAdmission &owner) : owner(owner) { owner.renders++; }
+  ~RenderSlot() { owner.renders--; }
+  RenderSlot(const RenderSlot &) = delete;
+  RenderSlot &operator=(const RenderSlot &) = delete;
+
+private:
+  RequestAdmission &owner;
+};
+
+#endif // REQUEST_ADMISSION_H
@@ -0,0 +1,200 @@
+#include "RuntimeState.h"
+#include <stddef.h>
+#include <string.h>
+#include "SettingsStore.h"
+
+static const uint32_t RUNTIME_MAGIC = 0x52545331; // "RTS1"
+
+// Record::flags, also the NVS byte
+static const uint8_t RUNTIME_PUMP_ON = 0x01;  // Reset hit a running pump
+static const uint8_t RUNTIME_TIMEOUT = 0x02;  // Last run stopped by maxPumpRuntime
+static const uint8_t RUNTIME_COOLDOWN = 0x04; // cooldownEnd is valid
+static const uint8_t RUNTIME_UNKNOWN = 0xFF;
+
+RuntimeState::RuntimeState(KeyValueStore *store)
+    : explicitStore(store), retained(nullptr), fallback(), previous(), previousUptimeMs(0), previousValid(false)
+{
+}
+
+void RuntimeState::begin()
+{
+  retained = static_cast<Retained *>(halRetainedMemory(sizeof(Retained)));
+  if (!retained)
+  {
+    retained = &fallback;
+  }
+
+  previousValid = retained->magic == RUNTIME_MAGIC && retained->uptimeCheck == ~retained->uptimeMs &&
+                  retained->crc == crc32(retained->records, sizeof(retained->records));
+  if (previousValid)
+  {
+    memcpy(previous, retained->records, sizeof(previous));
+    previousUptimeMs = retained->uptimeMs;
+  }
+
+  // This boot's copy starts empty, restored zones save themselves again
+  memset(retained, 0, sizeof(Retained));
+  for (Record &record : retained->records)
+  {
+    record.zoneId = -1;
+    record.stored = RUNTIME_UNKNOWN;
+  }
+  retained->magic = RUNTIME_MAGIC;
+  retained->crc = crc32(retained->records, sizeof(retained->records));
+  touch(0);
+}
+
+void RuntimeState::touch(unsigned long now)
+{
+  if (retained)
+  {
+    retained->uptimeMs = now;
+    retained->uptimeCheck = ~(uint32_t)now;
+  }
+}
+
+RuntimeState::Record *RuntimeState::recordFor(int zoneId, bool create)
+{
+  for (Record &record : retained->records)
+  {
+    if (record.zoneId == zoneId)
+    {
+      return &record;
+    }
+  }
+  if (!create)
+  {
+    return nullptr;
+  }
+  for (Record &record : retained->records)
+  {
+    if (record.zoneId < 0)
+    {
+      record.zoneId = (int16_t)zoneId;
+      return &record;
+    }
+  }
+  return nullptr;
+}
+
+const RuntimeState::Record *RuntimeState::previousRecord(int zoneId) const
+{
+  for (const Record &record : previous)
+  {
+    if (previousValid && record.zoneId == zoneId)
+    {
+      return &record;
+    }
+  }
+  return nullptr;
+}
+
+uint8_t RuntimeState::loadStored(int zoneId)
+{
+  const SettingsKey key = settingsKeyFor(zoneId, 'r');
+  uint8_t flags = 0;
+  store().begin(RUNTIME_NAMESPACE, true);
+  size_t length = store().getBytes(key.text, &flags, sizeof(flags));
+  store().end();
+  return length == sizeof(flags) ? flags : 0;
+}
+
+bool RuntimeState::restore(int zoneId, unsigned long cooldownMs, unsigned long now,
+                           unsigned long &remainingMs, bool &stoppedByTimeout)
+{
+  if (!retained)
+  {
+    return false;
+  }
+  Record *record = recordFor(zoneId, true);
+  if (!record)
+  {
+    return false;
+  }
+
+  // NVS has to be read anyway to know whether it needs a write later
+  uint8_t stored = loadStored(zoneId);
+  record->stored = stored;
+
+  const Record *last = previousRecord(zoneId);
+  uint8_t flags = last ? last->flags : stored;
+  bool cooling = true;
+  if (flags & RUNTIME_PUMP_ON)
+  {
+    // Unknown how long it ran: treat it as a full run that timed out
+    remainingMs = cooldownMs;
+    stoppedByTimeout = true;
+  }
+  else if (!(flags & RUNTIME_COOLDOWN))
+  {
+    cooling = false;
+  }
+  else if (last)
+  {
+    int32_t left = (int32_t)(last->cooldownEnd - previousUptimeMs);
+    cooling = left > 0;
+    remainingMs = cooling && (unsigned long)left < cooldownMs ? (unsigned long)left : cooldownMs;
+    stoppedByTimeout = (flags & RUNTIME_TIMEOUT) != 0;
+  }
+  else
+  {
+    remainingMs = cooldownMs;
+    stoppedByTimeout = (flags & RUNTIME_TIMEOUT) != 0;
+  }
+
+  // Also without a cooldown: the new record needs its CRC, and an NVS byte
+  // left over from a cooldown the RTC copy saw end must not grant another
+  if (!cooling)
+  {
+    save(zoneId, false, false, false, 0);
+    return false;
+  }
+  save(zoneId, false, stoppedByTimeout, true, now + remainingMs);
+  return true;
+}
+
+bool RuntimeState::savedCooldown(int zoneId) const
+{
+  if (!retained)
+  {
+    return false;
+  }
+  for (const Record &record : retained->records)
+  {
+    if (record.zoneId == zoneId)
+    {
+      return (record.flags & RUNTIME_COOLDOWN) != 0;
+    }
+  }
+  return false;
+}
+
+void RuntimeState::save(int zoneId, bool pumpOn, bool stoppedByTimeout, bool inCooldown, unsigned long cooldownEnd)
+{
+  if (!retained)
+  {
+    return;
+  }
+  Record *record = recordFor(zoneId, true);
+  if (!record)
+  {
+    return;
+  }
+
+  record->flags = (pumpOn ? RUNTIME_PUMP_ON : 0) | (stoppedByTimeout ? RUNTIME_TIMEOUT : 0) |
+                  (inCooldown ? RUNTIME_COOLDOWN : 0);
+  record->cooldownEnd = inCooldown ? (uint32_t)cooldownEnd : 0;
+
+  // The NVS byte only needs the flags, so a pump run costs two writes
+  if (record->flags != record->stored)
+  {
+    const SettingsKey key = settingsKeyFor(zoneId, 'r');
+    store().begin(RUNTIME_NAMESPACE, false);
+    if (store().putBytes(key.text, &record->flags, sizeof(record->flags)) == sizeof(record->flags))
+    {
+      record->stored = record->flags;
+    }
+    store().end();
+  }
+  retained->crc = crc32(retained->records, sizeof(retained->records));
+}
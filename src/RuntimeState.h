@@ -0,0 +1,77 @@
+#ifndef RUNTIME_STATE_H
+#define RUNTIME_STATE_H
+
+#include <stdint.h>
+#include "Hal.h"
+#include "ZoneSnapshot.h"
+
+const char *const RUNTIME_NAMESPACE = "runtime";
+
+// Pump state of a zone that has to survive a reset, so a brownout in the
+// middle of a run does not hand out a fresh pump budget right away.
+//
+// Primary copy: retained RTC memory, rewritten on every pump change, with
+// the uptime refreshed by every control tick. It survives software,
+// watchdog and most brownout resets and costs no flash writes. Cooldown
+// ends are in the previous boot's millis(); the time spent in reset is
+// unknown and counted as zero, which can only make a cooldown longer.
+//
+// Fallback: one byte per zone in NVS ("r<id>"), written only when it
+// changes: pump on, pump off and the end of the cooldown. It cannot tell
+// how much of a cooldown was left, so after a power-on a zone that was
+// running or cooling down starts a full cooldown.
+//
+// Only the first MAX_ZONES zones are kept.
+class RuntimeState
+{
+public:
+  // Without an explicit store the one installed in the HAL is used
+  explicit RuntimeState(KeyValueStore *store = nullptr);
+
+  // Takes over the previous boot's retained copy; call once before any
+  // zone restores or saves
+  void begin();
+  // Cooldown left for a zone at boot (now), false if it may start at once
+  bool restore(int zoneId, unsigned long cooldownMs, unsigned long now,
+               unsigned long &remainingMs, bool &stoppedByTimeout);
+  // Records a zone's state after its pump changed or its cooldown ended
+  void save(int zoneId, bool pumpOn, bool stoppedByTimeout, bool inCooldown, unsigned long cooldownEnd);
+  // The last save() had the zone cooling down
+  bool savedCooldown(int zoneId) const;
+  // Keeps the retained uptime current, once per control tick
+  void touch(unsigned long now);
+
+  bool retainedValid() const { return previousValid; }
+
+private:
+  struct Record
+  {
+    int16_t zoneId; // -1: unused
+    uint8_t flags;  // RUNTIME_* in RuntimeState.cpp
+    uint8_t stored; // Last flags written to NVS (0xFF: unknown)
+    uint32_t cooldownEnd;
+  };
+
+  struct Retained
+  {
+    uint32_t magic;
+    uint32_t uptimeMs;
+    uint32_t uptimeCheck; // ~uptimeMs, touch() does not redo the CRC
+    Record records[MAX_ZONES];
+    uint32_t crc; // CRC32 of records
+  };
+
+  KeyValueStore *explicitStore;
+  Retained *retained;     // Lives in halRetainedMemory()
+  Retained fallback;      // If the HAL has no retained memory
+  Record previous[MAX_ZONES];
+  uint32_t previousUptimeMs;
+  bool previousValid;
+
+  KeyValueStore &store() { return explicitStore ? *explicitStore : *hal().store; }
+  Record *recordFor(int zoneId, bool create);
+  const Record *previousRecord(int zoneId) const;
+  uint8_t loadStored(int zoneId);
+};
+
+#endif // RUNTIME_STATE_H
@@ -0,0 +1,46 @@
+#ifndef SENSOR_BACKEND_H
+#define SENSOR_BACKEND_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Sensor addresses, as used for WateringZone::moisturePin and
+// ZoneDefinition::sensorPin: below SENSOR_EXTERNAL a native ADC pin read
+// through the HAL, from there on a channel of a registered SensorBackend.
+const int SENSOR_EXTERNAL = 64;
+const int SENSOR_BACKEND_CHANNELS = 16; // Address space per backend
+const int SENSOR_MAX_BACKENDS = 4;
+const int SENSOR_ADDRESS_END = SENSOR_EXTERNAL + SENSOR_MAX_BACKENDS * SENSOR_BACKEND_CHANNELS;
+const int SENSOR_READ_FAILED = -1; // Raw value of a conversion lost to a bus error
+
+// Channel of the backend registered backend-th (WateringZone::addSensorBackend)
+constexpr int sensorAddress(int backend, int channel)
+{
+  return SENSOR_EXTERNAL + backend * SENSOR_BACKEND_CHANNELS + channel;
+}
+
+constexpr bool isExternalSensor(int address)
+{
+  return address >= SENSOR_EXTERNAL;
+}
+
+typedef void (*SensorResultFn)(void *context, int channel, int raw);
+
+// Sensors behind a multiplexer or a bus. The sampler queues every channel
+// that is due with request(); the backend converts the queued channels in
+// as few settling times and bus rounds as its hardware allows and hands
+// the results back from poll(), which never waits for a conversion.
+// Results are 12-bit like the native ADC so calibration values carry over.
+class SensorBackend
+{
+public:
+  virtual ~SensorBackend() {}
+
+  virtual int channelCount() const = 0;
+  virtual void request(int channel) = 0;
+  virtual void poll(unsigned long now, SensorResultFn done, void *context) = 0;
+  // millis() at which poll() has work, false while nothing is queued
+  virtual bool nextPollTime(unsigned long now, unsigned long &at) const = 0;
+};
+
+#endif // SENSOR_BACKEND_H
@@ -0,0 +1,208 @@
+#include "SensorSampler.h"
+
+SensorSampler::SensorSampler(AdcReadFn readFn, unsigned long intervalMs)
+    : readFn(readFn), observer(nullptr), intervalMs(intervalMs), sampleCount(0), failedCount(0), backendCount(0)
+{
+}
+
+int SensorSampler::addChannel(int pin, const FilterConfig &filter)
+{
+  // readFn of an address would sample whatever that pin happens to be
+  if (isExternalSensor(pin) && !backendFor(pin))
+  {
+    return -1;
+  }
+  Channel channel;
+  channel.pin = pin;
+  channel.filter.configure(filter);
+  channel.latestRaw = 0;
+  channel.lastSampleMs = 0;
+  channel.lastGoodMs = 0;
+  channel.failures = 0;
+  channel.requested = false;
+  channels.push_back(channel);
+  return (int)channels.size() - 1;
+}
+
+int SensorSampler::addBackend(SensorBackend *backend)
+{
+  if (backendCount >= SENSOR_MAX_BACKENDS)
+  {
+    return -1;
+  }
+  backends[backendCount] = backend;
+  return backendCount++;
+}
+
+SensorBackend *SensorSampler::backendFor(int pin) const
+{
+  if (!isExternalSensor(pin) || pin >= SENSOR_ADDRESS_END)
+  {
+    return nullptr;
+  }
+  int backend = (pin - SENSOR_EXTERNAL) / SENSOR_BACKEND_CHANNELS;
+  return backend < backendCount ? backends[backend] : nullptr;
+}
+
+void SensorSampler::prime(int channel, unsigned long now)
+{
+  if (channel < 0 || channel >= (int)channels.size())
+  {
+    return;
+  }
+  if (!channels[channel].filter.hasValue())
+  {
+    channels[channel].lastGoodMs = now; // The stale limit runs from here
+  }
+  takeSample(channels[channel], now);
+  pollBackends(now);
+}
+
+void SensorSampler::tick(unsigned long now)
+{
+  for (auto &channel : channels)
+  {
+    // Unsigned subtraction keeps this correct across millis() rollover
+    if (!channel.requested && (!channel.filter.hasValue() || (now - channel.lastSampleMs) >= intervalMs))
+    {
+      takeSample(channel, now);
+    }
+  }
+  pollBackends(now);
+}
+
+void SensorSampler::takeSample(Channel &channel, unsigned long now)
+{
+  channel.lastSampleMs = now;
+  SensorBackend *backend = backendFor(channel.pin);
+  if (backend)
+  {
+    backend->request((channel.pin - SENSOR_EXTERNAL) % SENSOR_BACKEND_CHANNELS);
+    channel.requested = true;
+    return;
+  }
+  record(channel, readFn(channel.pin), now);
+}
+
+void SensorSampler::record(Channel &channel, int raw, unsigned long now)
+{
+  channel.latestRaw = raw;
+  channel.lastGoodMs = now;
+  channel.failures = 0;
+  if (observer)
+  {
+    observer(channel.pin, raw, now);
+  }
+  channel.filter.update(raw);
+  sampleCount++;
+}
+
+// All queued channels of a backend are converted in the same poll() rounds
+void SensorSampler::pollBackends(unsigned long now)
+{
+  for (int i = 0; i < backendCount; i++)
+  {
+    PollContext context = {this, i, now};
+    backends[i]->poll(now, onResult, &context);
+  }
+}
+
+void SensorSampler::onResult(void *context, int channel, int raw)
+{
+  PollContext &poll = *static_cast<PollContext *>(context);
+  int pin = sensorAddress(poll.backend, channel);
+  for (auto &entry : poll.sampler->channels)
+  {
+    if (entry.pin != pin || !entry.requested)
+    {
+      continue;
+    }
+    entry.requested = false;
+    if (raw == SENSOR_READ_FAILED)
+    {
+      // Due again at the next interval; the filter keeps its last value
+      poll.sampler->failedCount++;
+      if (entry.failures < UINT16_MAX)
+      {
+        entry.failures++;
+      }
+    }
+    else
+    {
+      poll.sampler->record(entry, raw, poll.now);
+    }
+  }
+}
+
+unsigned long SensorSampler::nextDueTime(unsigned long now) const
+{
+  unsigned long earliest = now + intervalMs;
+  for (const auto &channel : channels)
+  {
+    unsigned long due = channel.lastSampleMs + intervalMs;
+    if (!channel.requested && (long)(due - earliest) < 0)
+    {
+      earliest = due;
+    }
+  }
+  for (int i = 0; i < backendCount; i++)
+  {
+    unsigned long at;
+    if (backends[i]->nextPollTime(now, at) && (long)(at - earliest) < 0)
+    {
+      earliest = at;
+    }
+  }
+  return earliest;
+}
+
+bool SensorSampler::hasSamples(int channel) const
+{
+  return channel >= 0 && channel < (int)channels.size() && channels[channel].filter.hasValue();
+}
+
+int SensorSampler::filtered(int channel) const
+{
+  if (!hasSamples(channel))
+  {
+    return 0;
+  }
+  return channels[channel].filter.value();
+}
+
+int SensorSampler::latest(int channel) const
+{
+  if (!hasSamples(channel))
+  {
+    return 0;
+  }
+  return channels[channel].latestRaw;
+}
+
+unsigned long SensorSampler::rejectedSamples(int channel) const
+{
+  if (!hasSamples(channel))
+  {
+    return 0;
+  }
+  return channels[channel].filter.rejectedSamples();
+}
+
+bool SensorSampler::isStale(int channel, unsigned long now) const
+{
+  if (channel < 0 || channel >= (int)channels.size())
+  {
+    return false;
+  }
+  const Channel &entry = channels[channel];
+  return entry.failures >= SENSOR_STALE_FAILURES || (now - entry.lastGoodMs) >= SENSOR_STALE_MS;
+}
+
+unsigned long SensorSampler::lastSampleTime(int channel) const
+{
+  if (!hasSamples(channel))
+  {
+    return 0;
+  }
+  return channels[channel].lastSampleMs;
+}
@@ -0,0 +1,101 @@
+#ifndef SENSOR_SAMPLER_H
+#define SENSOR_SAMPLER_H
+
+#include <stddef.h>
+#include <vector>
+#include "MoistureFilter.h"
+#include "SensorBackend.h"
+
+// Sensor reading constants
+const int SENSOR_SAMPLE_INTERVAL_MS = 1000;   // Spacing between two samples of the same channel
+const int SENSOR_STALE_FAILURES = 5;          // Failed reads in a row before a channel is stale
+const unsigned long SENSOR_STALE_MS = 60000;  // Or this long without a good reading
+
+// Reads one raw ADC conversion. analogRead() on the device, a stand-in on the host.
+typedef int (*AdcReadFn)(int pin);
+// Sees every conversion with the time the sampler used (see SensorTrace.h)
+typedef void (*SampleObserver)(int pin, int raw, unsigned long now);
+
+// Background sampler for all moisture sensors.
+// tick() takes at most one conversion per channel per SENSOR_SAMPLE_INTERVAL_MS,
+// so nobody ever waits for the averaging window. nextDueTime() tells the
+// control task when to wake up for the next conversion.
+// Every conversion goes through the channel's MoistureFilter; readers get
+// the filtered value.
+// Channels at external addresses (SensorBackend.h) are queued on their
+// backend when due and filtered when poll() hands the result back; their
+// sample time is the request's, so the grid does not drift by the
+// conversion time. addChannel() refuses addresses whose backend is not
+// registered.
+// A failed conversion leaves the filter at its last value; after
+// SENSOR_STALE_FAILURES of them in a row, or SENSOR_STALE_MS without a
+// good one, the channel is stale and its value must not drive a pump.
+class SensorSampler
+{
+public:
+  explicit SensorSampler(AdcReadFn readFn, unsigned long intervalMs = SENSOR_SAMPLE_INTERVAL_MS);
+
+  // -1 for an external address without a registered backend
+  int addChannel(int pin, const FilterConfig &filter = DEFAULT_FILTER);
+  // Returns the backend number for sensorAddress(), -1 when all are taken
+  int addBackend(SensorBackend *backend);
+  // Drops all channels and backends (host runs that set up zones more than once)
+  void clear()
+  {
+    channels.clear();
+    backendCount = 0;
+    sampleCount = 0;
+    failedCount = 0;
+  }
+  void prime(int channel, unsigned long now);
+  void tick(unsigned long now);
+  void setObserver(SampleObserver fn) { observer = fn; }
+
+  bool hasSamples(int channel) const;
+  int filtered(int channel) const;
+  int latest(int channel) const;
+  unsigned long lastSampleTime(int channel) const;
+  unsigned long nextDueTime(unsigned long now) const;
+  size_t channelCount() const { return channels.size(); }
+  unsigned long totalSamples() const { return sampleCount; }
+  unsigned long rejectedSamples(int channel) const;
+  bool isStale(int channel, unsigned long now) const;
+  unsigned long failedReads() const { return failedCount; } // Bus errors of external channels
+
+private:
+  struct Channel
+  {
+    int pin;
+    MoistureFilter filter;
+    int latestRaw;
+    unsigned long lastSampleMs;
+    unsigned long lastGoodMs; // Last recorded conversion, or prime() before the first
+    uint16_t failures;        // Failed reads since then
+    bool requested;           // Queued on its backend, result not back yet
+  };
+
+  // Where poll() results go
+  struct PollContext
+  {
+    SensorSampler *sampler;
+    int backend;
+    unsigned long now;
+  };
+
+  AdcReadFn readFn;
+  SampleObserver observer;
+  unsigned long intervalMs;
+  unsigned long sampleCount;
+  unsigned long failedCount;
+  std::vector<Channel> channels;
+  SensorBackend *backends[SENSOR_MAX_BACKENDS];
+  int backendCount;
+
+  SensorBackend *backendFor(int pin) const;
+  void takeSample(Channel &channel, unsigned long now);
+  void record(Channel &channel, int raw, unsigned long now);
+  void pollBackends(unsigned long now);
+  static void onResult(void *context, int channel, int raw);
+};
+
+#endif // SENSOR_SAMPLER_H
@@ -0,0 +1,283 @@
+#include "SensorTrace.h"
+#include <string.h>
+
+static size_t putVarint(uint8_t *out, uint32_t value)
+{
+  size_t length = 0;
+  while (value >= 0x80)
+  {
+    out[length++] = (uint8_t)(value | 0x80);
+    value >>= 7;
+  }
+  out[length++] = (uint8_t)value;
+  return length;
+}
+
+static uint32_t zigzag(int32_t value)
+{
+  return ((uint32_t)value << 1) ^ (uint32_t)(value >> 31);
+}
+
+static int32_t unzigzag(uint32_t value)
+{
+  return (int32_t)(value >> 1) ^ -(int32_t)(value & 1);
+}
+
+TraceZone traceZone(const ZoneSnapshot &zone, int sensorPin, int pumpPin, const FilterConfig &filter)
+{
+  TraceZone out = {};
+  out.id = (uint16_t)zone.id;
+  out.sensorPin = (uint8_t)sensorPin;
+  out.pumpPin = (uint8_t)pumpPin;
+  out.medianWindow = filter.medianWindow;
+  out.emaShift = filter.emaShift;
+  out.maxStep = filter.maxStep;
+  out.hysteresis = filter.hysteresis;
+  out.settings.version = SETTINGS_VERSION;
+  out.settings.wetThreshold = (uint8_t)zone.wetThreshold;
+  out.settings.dryThreshold = (uint8_t)zone.dryThreshold;
+  out.settings.mode = zone.dosingMode ? ZONE_MODE_DOSING : ZONE_MODE_THRESHOLD;
+  out.settings.airValue = (uint16_t)zone.airValue;
+  out.settings.dryValue = (uint16_t)zone.dryValue;
+  out.settings.waterValue = (uint16_t)zone.waterValue;
+  out.settings.maxRuntimeSec = (uint16_t)zone.maxRuntimeSec;
+  out.settings.cooldownSec = (uint16_t)zone.cooldownSec;
+  out.settings.crc = SettingsStore::checksum(out.settings);
+  if (zone.inCooldown)
+  {
+    // The snapshot rounds down to seconds, take the middle of that second
+    out.state |= TRACE_ZONE_COOLDOWN;
+    out.cooldownLeftMs = zone.cooldownRemainingSec * 1000 + 500;
+  }
+  if (zone.stoppedByTimeout)
+  {
+    out.state |= TRACE_ZONE_TIMEOUT;
+  }
+  return out;
+}
+
+FilterConfig traceFilter(const TraceZone &zone)
+{
+  FilterConfig filter = {zone.medianWindow, zone.emaShift, zone.maxStep, zone.hysteresis};
+  return filter;
+}
+
+void TraceEncoder::reset(uint32_t startMs)
+{
+  lastMs = startMs;
+  memset(lastRaw, 0, sizeof(lastRaw));
+}
+
+size_t TraceEncoder::encode(uint8_t type, int zone, uint32_t timeMs, int32_t value, uint8_t *out)
+{
+  size_t length = 0;
+  out[length++] = (uint8_t)(type << 6 | (zone & 0x3F));
+  length += putVarint(out + length, timeMs - lastMs);
+  lastMs = timeMs;
+  if (type == TRACE_SAMPLE)
+  {
+    length += putVarint(out + length, zigzag(value - lastRaw[zone]));
+    lastRaw[zone] = value;
+  }
+  else if (type == TRACE_GAP)
+  {
+    length += putVarint(out + length, (uint32_t)value);
+  }
+  return length;
+}
+
+TraceRecorder::TraceRecorder()
+    : inner(nullptr), active(false), fill(0), lost(0), lostTotal(0)
+{
+  memset(sensorZone, -1, sizeof(sensorZone));
+  memset(pumpZone, -1, sizeof(pumpZone));
+}
+
+bool TraceRecorder::start(const TraceHeader &header, const TraceZone *zones, int count)
+{
+  size_t size = sizeof(header) + count * sizeof(TraceZone);
+  if (count < 0 || count > MAX_ZONES || header.zoneCount != count || size > sizeof(buffer))
+  {
+    return false;
+  }
+
+  std::lock_guard<std::mutex> lock(mutex);
+  memset(sensorZone, -1, sizeof(sensorZone));
+  memset(pumpZone, -1, sizeof(pumpZone));
+  for (int i = 0; i < count; i++)
+  {
+    if (zones[i].sensorPin < TRACE_MAX_PIN)
+    {
+      sensorZone[zones[i].sensorPin] = (int8_t)i;
+    }
+    if (zones[i].pumpPin < TRACE_MAX_PIN)
+    {
+      pumpZone[zones[i].pumpPin] = (int8_t)i;
+    }
+  }
+  memcpy(buffer, &header, sizeof(header));
+  memcpy(buffer + sizeof(header), zones, count * sizeof(TraceZone));
+  fill = size;
+  lost = 0;
+  encoder.reset(header.startMs);
+  active = true;
+  return true;
+}
+
+void TraceRecorder::stop()
+{
+  std::lock_guard<std::mutex> lock(mutex);
+  active = false;
+}
+
+void TraceRecorder::sample(int pin, int raw, unsigned long now)
+{
+  if (!active || pin < 0 || pin >= TRACE_MAX_PIN || sensorZone[pin] < 0)
+  {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(mutex);
+  append(TRACE_SAMPLE, sensorZone[pin], now, raw);
+}
+
+void TraceRecorder::write(int pin, bool high)
+{
+  inner->write(pin, high);
+  if (!active || pin < 0 || pin >= TRACE_MAX_PIN || pumpZone[pin] < 0)
+  {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(mutex);
+  append(high ? TRACE_PUMP_ON : TRACE_PUMP_OFF, pumpZone[pin], halMillis(), 0);
+}
+
+void TraceRecorder::append(uint8_t type, int zone, unsigned long now, int32_t value)
+{
+  if (!active)
+  {
+    return; // Stopped while waiting for the lock
+  }
+  // A pending GAP needs room for itself and the record
+  size_t needed = (lost ? 2 : 1) * TRACE_RECORD_MAX;
+  if (fill + needed > sizeof(buffer))
+  {
+    lost++;
+    lostTotal++;
+    return;
+  }
+  if (lost)
+  {
+    fill += encoder.encode(TRACE_GAP, 0, (uint32_t)now, (int32_t)lost, buffer + fill);
+    lost = 0;
+  }
+  fill += encoder.encode(type, zone, (uint32_t)now, value, buffer + fill);
+}
+
+size_t TraceRecorder::drain(uint8_t *out, size_t size)
+{
+  std::lock_guard<std::mutex> lock(mutex);
+  size_t length = fill;
+  if (length > size)
+  {
+    // Only whole records: the header or a cut record would break the file
+    return 0;
+  }
+  memcpy(out, buffer, length);
+  fill = 0;
+  return length;
+}
+
+size_t TraceRecorder::pending() const
+{
+  std::lock_guard<std::mutex> lock(mutex);
+  return fill;
+}
+
+bool TraceReader::varint(uint32_t &out)
+{
+  out = 0;
+  for (int shift = 0; shift < 35; shift += 7)
+  {
+    if (offset >= length)
+    {
+      bad = true;
+      return false;
+    }
+    uint8_t byte = data[offset++];
+    out |= (uint32_t)(byte & 0x7F) << shift;
+    if (!(byte & 0x80))
+    {
+      return true;
+    }
+  }
+  bad = true;
+  return false;
+}
+
+bool TraceReader::header(TraceHeader &header, TraceZone *zones)
+{
+  if (length < sizeof(header))
+  {
+    bad = true;
+    return false;
+  }
+  memcpy(&header, data, sizeof(header));
+  size_t size = sizeof(header) + header.zoneCount * sizeof(TraceZone);
+  if (header.magic != TRACE_MAGIC || header.version != TRACE_VERSION || header.zoneCount > MAX_ZONES ||
+      length < size)
+  {
+    bad = true;
+    return false;
+  }
+  memcpy(zones, data + sizeof(header), header.zoneCount * sizeof(TraceZone));
+  zoneCount = header.zoneCount;
+  offset = size;
+  lastMs = header.startMs;
+  return true;
+}
+
+bool TraceReader::next(TraceEvent &event)
+{
+  if (bad || offset >= length)
+  {
+    return false;
+  }
+  uint8_t tag = data[offset++];
+  event.type = tag >> 6;
+  event.zone = tag & 0x3F;
+  event.value = 0;
+  uint32_t dt;
+  if (!varint(dt))
+  {
+    return false;
+  }
+  lastMs += dt;
+  event.timeMs = lastMs;
+
+  if (event.type == TRACE_GAP)
+  {
+    uint32_t count;
+    if (!varint(count))
+    {
+      return false;
+    }
+    event.value = (int32_t)count;
+    return true;
+  }
+  if (event.zone >= zoneCount)
+  {
+    bad = true;
+    return false;
+  }
+  if (event.type == TRACE_SAMPLE)
+  {
+    uint32_t delta;
+    if (!varint(delta))
+    {
+      return false;
+    }
+    lastRaw[event.zone] += unzigzag(delta);
+    event.value = lastRaw[event.zone];
+  }
+  return true;
+}
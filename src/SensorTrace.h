@@ -0,0 +1,163 @@
+#ifndef SENSOR_TRACE_H
+#define SENSOR_TRACE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <mutex>
+#include "Hal.h"
+#include "MoistureFilter.h"
+#include "SensorBackend.h"
+#include "SettingsStore.h"
+#include "ZoneSnapshot.h"
+
+// Raw sensor samples and pump decisions of all zones, recorded on the
+// device and replayed through the zone logic on the host (bench/TraceReplay.h).
+// Little-endian: a TraceHeader, one TraceZone per zone, then records
+//
+//   tag      u8, type << 6 | zone (index of its TraceZone entry)
+//   dt       varint, ms since the previous record (the first: since startMs)
+//   SAMPLE   zigzag varint, raw ADC change against the zone's previous sample
+//   PUMP_ON  -
+//   PUMP_OFF -
+//   GAP      varint, records lost to a full buffer just before this one
+//
+// Sample times are the sampler's own now, so a replay samples exactly when
+// the device did. A zone sampled at 1 Hz costs 3-4 bytes per second.
+
+const uint32_t TRACE_MAGIC = 0x31525457; // "WTR1"
+const uint8_t TRACE_VERSION = 1;
+const size_t TRACE_BUFFER_SIZE = 2048; // Records waiting for drain()
+const size_t TRACE_RECORD_MAX = 11;    // tag + two 5-byte varints
+const int TRACE_MAX_PIN = SENSOR_ADDRESS_END; // Sensor addresses of backends included
+
+// TraceZone::state
+const uint8_t TRACE_ZONE_COOLDOWN = 0x01;
+const uint8_t TRACE_ZONE_TIMEOUT = 0x02; // Last run hit the pump timeout
+
+enum TraceRecordType : uint8_t
+{
+  TRACE_SAMPLE = 0,
+  TRACE_PUMP_ON = 1,
+  TRACE_PUMP_OFF = 2,
+  TRACE_GAP = 3
+};
+
+struct __attribute__((packed)) TraceHeader
+{
+  uint32_t magic;
+  uint8_t version;
+  uint8_t zoneCount;
+  uint16_t sampleIntervalMs;
+  uint32_t startMs;   // millis() the first record's dt counts from
+  uint32_t wallClock; // Local wall time at startMs for the planner, 0: unknown
+};
+
+// A zone as it was when the recording started (never with its pump on)
+struct __attribute__((packed)) TraceZone
+{
+  uint16_t id;
+  uint8_t sensorPin;
+  uint8_t pumpPin;
+  uint8_t medianWindow; // FilterConfig, field by field to stay packed
+  uint8_t emaShift;
+  uint16_t maxStep;
+  uint8_t hysteresis;
+  ZoneSettings settings; // With version and crc, as stored in NVS
+  uint8_t state;         // TRACE_ZONE_*
+  uint32_t cooldownLeftMs;
+};
+
+// zone from a snapshot taken at the trace's startMs
+TraceZone traceZone(const ZoneSnapshot &zone, int sensorPin, int pumpPin, const FilterConfig &filter);
+FilterConfig traceFilter(const TraceZone &zone);
+
+struct TraceEvent
+{
+  uint8_t type; // TraceRecordType
+  uint8_t zone;
+  uint32_t timeMs;
+  int32_t value; // Raw ADC (SAMPLE) or lost records (GAP)
+};
+
+// Delta and varint encoding of records, one instance per recording
+class TraceEncoder
+{
+public:
+  void reset(uint32_t startMs);
+  // Writes one record to out (room for TRACE_RECORD_MAX) and returns its length
+  size_t encode(uint8_t type, int zone, uint32_t timeMs, int32_t value, uint8_t *out);
+
+private:
+  uint32_t lastMs = 0;
+  int32_t lastRaw[MAX_ZONES] = {};
+};
+
+// Records from the control task into a RAM buffer that another task
+// drains to flash. Samples come from WateringZone::setSampleObserver(),
+// pump decisions from the GPIO writes this class passes on to the real HAL.
+// A full buffer drops records and leaves a GAP record behind.
+class TraceRecorder : public HalGpio
+{
+public:
+  TraceRecorder();
+
+  void wrap(HalGpio *gpio) { inner = gpio; }
+  // Queues the header and zones, then takes records until stop()
+  bool start(const TraceHeader &header, const TraceZone *zones, int count);
+  void stop();
+  bool recording() const { return active; }
+
+  void sample(int pin, int raw, unsigned long now);
+  // Moves everything buffered to out (TRACE_BUFFER_SIZE bytes), from the
+  // task that writes the file; the first drain after start() is the header
+  size_t drain(uint8_t *out, size_t size);
+  size_t pending() const;
+  uint32_t lostRecords() const { return lostTotal; }
+
+  // HalGpio
+  void setInput(int pin) override { inner->setInput(pin); }
+  void setOutput(int pin) override { inner->setOutput(pin); }
+  void write(int pin, bool high) override;
+
+private:
+  mutable std::mutex mutex;
+  HalGpio *inner;
+  volatile bool active;
+  int8_t sensorZone[TRACE_MAX_PIN]; // Zone index by pin, -1: not traced
+  int8_t pumpZone[TRACE_MAX_PIN];
+  TraceEncoder encoder;
+  uint8_t buffer[TRACE_BUFFER_SIZE];
+  size_t fill;
+  uint32_t lost;      // Since the last GAP record
+  uint32_t lostTotal;
+
+  // Caller holds mutex
+  void append(uint8_t type, int zone, unsigned long now, int32_t value);
+};
+
+// Bounds-checked parser; ok() tells a clean end from a damaged trace
+class TraceReader
+{
+public:
+  TraceReader(const uint8_t *data, size_t length) : data(data), length(length), offset(0), zoneCount(0), bad(false) {}
+
+  // Checks magic and version, zones needs room for MAX_ZONES entries
+  bool header(TraceHeader &header, TraceZone *zones);
+  bool next(TraceEvent &event);
+
+  bool ok() const { return !bad; }
+  size_t position() const { return offset; }
+
+private:
+  const uint8_t *data;
+  size_t length;
+  size_t offset;
+  int zoneCount;
+  bool bad;
+  uint32_t lastMs = 0;
+  int32_t lastRaw[MAX_ZONES] = {};
+
+  bool varint(uint32_t &out);
+};
+
+#endif // SENSOR_TRACE_H
@@ -0,0 +1,304 @@
+#include "SettingsStore.h"
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include "Metrics.h"
+
+SettingsStore::SettingsStore(KeyValueStore *store, unsigned long debounceMs)
+    : explicitStore(store), debounceMs(debounceMs)
+{
+}
+
+uint32_t crc32Update(uint32_t crc, const void *data, size_t length)
+{
+  const uint8_t *bytes = static_cast<const uint8_t *>(data);
+  crc = ~crc;
+  for (size_t i = 0; i < length; i++)
+  {
+    crc ^= bytes[i];
+    for (int bit = 0; bit < 8; bit++)
+    {
+      crc = (crc >> 1) ^ (0xEDB88320 & (0 - (crc & 1)));
+    }
+  }
+  return ~crc;
+}
+
+uint32_t crc32(const void *data, size_t length)
+{
+  return crc32Update(0, data, length);
+}
+
+uint32_t SettingsStore::checksum(const ZoneSettings &settings)
+{
+  // Only runs on load and on an actual write
+  return crc32(&settings, offsetof(ZoneSettings, crc));
+}
+
+SettingsStore::Entry &SettingsStore::entryFor(int zoneId)
+{
+  for (auto &entry : entries)
+  {
+    if (entry.zoneId == zoneId)
+    {
+      return entry;
+    }
+  }
+  Entry entry = {};
+  entry.zoneId = zoneId;
+  entry.key = settingsKeyFor(zoneId);
+  entries.push_back(entry);
+  return entries.back();
+}
+
+SettingsStore::ModelEntry &SettingsStore::modelFor(int zoneId)
+{
+  for (auto &model : models)
+  {
+    if (model.zoneId == zoneId)
+    {
+      return model;
+    }
+  }
+  ModelEntry model = {};
+  model.zoneId = zoneId;
+  model.key = settingsKeyFor(zoneId, 'd');
+  models.push_back(model);
+  return models.back();
+}
+
+bool SettingsStore::load(int zoneId, ZoneSettings &out)
+{
+  const SettingsKey key = settingsKeyFor(zoneId);
+
+  ZoneSettings stored = out; // Defaults for settings missing from legacy storage
+  store().begin(SETTINGS_NAMESPACE, true);
+  size_t length = store().getBytes(key.text, &stored, sizeof(stored));
+  bool blobValid = length == sizeof(stored) && stored.version == SETTINGS_VERSION &&
+                   stored.crc == checksum(stored);
+  bool valid = blobValid;
+  if (!valid)
+  {
+    // Devices flashed before the blob format still have one int per setting
+    stored = out;
+    valid = loadLegacy(zoneId, stored);
+  }
+  store().end();
+
+  if (!valid)
+  {
+    return false;
+  }
+
+  Entry &entry = entryFor(zoneId);
+  // Legacy values were never written as a blob, let the first flush migrate them
+  entry.persistedValid = blobValid;
+  entry.persisted = stored;
+  entry.staged = stored;
+  out = stored;
+  return true;
+}
+
+bool SettingsStore::loadLegacy(int zoneId, ZoneSettings &out)
+{
+  static const int MISSING = -1;
+  char key[24];
+  bool found = false;
+
+  // Older firmware wrote the keys one by one, any of them may be missing
+  auto read = [&](const char *name, int defaultValue) -> int
+  {
+    snprintf(key, sizeof(key), "zone%d_%s", zoneId, name);
+    int value = store().getInt(key, MISSING);
+    if (value == MISSING)
+    {
+      return defaultValue;
+    }
+    found = true;
+    return value;
+  };
+
+  ZoneSettings legacy = {};
+  legacy.version = SETTINGS_VERSION;
+  legacy.wetThreshold = (uint8_t)read("wet", out.wetThreshold);
+  legacy.dryThreshold = (uint8_t)read("dry", out.dryThreshold);
+  legacy.airValue = (uint16_t)read("air", out.airValue);
+  legacy.dryValue = (uint16_t)read("dryVal", out.dryValue);
+  legacy.waterValue = (uint16_t)read("water", out.waterValue);
+  legacy.maxRuntimeSec = (uint16_t)read("maxRun", out.maxRuntimeSec);
+  legacy.cooldownSec = (uint16_t)read("cooldown", out.cooldownSec);
+  if (!found)
+  {
+    return false;
+  }
+  legacy.mode = out.mode;
+  legacy.crc = checksum(legacy);
+  out = legacy;
+  return true;
+}
+
+bool SettingsStore::loadModel(int zoneId, DosingModel &out)
+{
+  ModelEntry &model = modelFor(zoneId);
+  DosingModel stored;
+  store().begin(SETTINGS_NAMESPACE, true);
+  size_t length = store().getBytes(model.key.text, &stored, sizeof(stored));
+  store().end();
+  if (length != sizeof(stored) || stored.version != MODEL_VERSION ||
+      stored.crc != crc32(&stored, offsetof(DosingModel, crc)))
+  {
+    return false;
+  }
+  model.persisted = stored;
+  model.persistedValid = true;
+  model.staged = stored;
+  out = stored;
+  return true;
+}
+
+void SettingsStore::stageModel(int zoneId, int32_t gain, uint32_t soakMs, unsigned long now)
+{
+  ModelEntry &model = modelFor(zoneId);
+  if ((model.dirty || model.persistedValid) && model.staged.gain == gain && model.staged.soakMs == soakMs)
+  {
+    return; // Restarting the debounce would only delay the write
+  }
+  model.staged.version = MODEL_VERSION;
+  model.staged.gain = gain;
+  model.staged.soakMs = soakMs;
+  model.staged.crc = crc32(&model.staged, offsetof(DosingModel, crc));
+  model.dirty = true;
+  model.changedAt = now;
+}
+
+void SettingsStore::stage(int zoneId, const ZoneSettings &settings, unsigned long now)
+{
+  Entry &entry = entryFor(zoneId);
+  entry.staged = settings;
+  entry.staged.version = SETTINGS_VERSION;
+  entry.staged.crc = checksum(entry.staged);
+  entry.dirty = true;
+  entry.changedAt = now; // Restart the debounce window
+}
+
+bool SettingsStore::hasPending() const
+{
+  for (const auto &entry : entries)
+  {
+    if (entry.dirty)
+    {
+      return true;
+    }
+  }
+  for (const auto &model : models)
+  {
+    if (model.dirty)
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool SettingsStore::nextFlushTime(unsigned long &deadline) const
+{
+  bool found = false;
+  for (const auto &entry : entries)
+  {
+    unsigned long due = entry.changedAt + debounceMs;
+    if (entry.dirty && (!found || (long)(due - deadline) < 0))
+    {
+      deadline = due;
+      found = true;
+    }
+  }
+  for (const auto &model : models)
+  {
+    unsigned long due = model.changedAt + MODEL_DEBOUNCE_MS;
+    if (model.dirty && (!found || (long)(due - deadline) < 0))
+    {
+      deadline = due;
+      found = true;
+    }
+  }
+  return found;
+}
+
+int SettingsStore::flush(unsigned long now, bool force)
+{
+  int written = 0;
+  bool open = false;
+
+  for (auto &entry : entries)
+  {
+    if (!entry.dirty || (!force && now - entry.changedAt < debounceMs))
+    {
+      continue;
+    }
+    entry.dirty = false;
+
+    // Changes that were undone before the debounce expired cost nothing
+    if (entry.persistedValid && memcmp(&entry.persisted, &entry.staged, sizeof(ZoneSettings)) == 0)
+    {
+      continue;
+    }
+
+    METRIC_TIME(SECTION_SETTINGS_FLUSH);
+    if (!open)
+    {
+      store().begin(SETTINGS_NAMESPACE, false);
+      open = true;
+    }
+    if (store().putBytes(entry.key.text, &entry.staged, sizeof(ZoneSettings)) == sizeof(ZoneSettings))
+    {
+      entry.persisted = entry.staged;
+      entry.persistedValid = true;
+      written++;
+      METRIC_COUNT(COUNTER_SETTINGS_WRITES);
+    }
+    else
+    {
+      // Retry after another debounce window, not on every wakeup of the control task
+      entry.dirty = true;
+      entry.changedAt = now;
+    }
+  }
+
+  for (auto &model : models)
+  {
+    if (!model.dirty || (!force && now - model.changedAt < MODEL_DEBOUNCE_MS))
+    {
+      continue;
+    }
+    model.dirty = false;
+    if (model.persistedValid && memcmp(&model.persisted, &model.staged, sizeof(DosingModel)) == 0)
+    {
+      continue;
+    }
+
+    METRIC_TIME(SECTION_SETTINGS_FLUSH);
+    if (!open)
+    {
+      store().begin(SETTINGS_NAMESPACE, false);
+      open = true;
+    }
+    if (store().putBytes(model.key.text, &model.staged, sizeof(DosingModel)) == sizeof(DosingModel))
+    {
+      model.persisted = model.staged;
+      model.persistedValid = true;
+      written++;
+      METRIC_COUNT(COUNTER_SETTINGS_WRITES);
+    }
+    else
+    {
+      model.dirty = true;
+      model.changedAt = now;
+    }
+  }
+
+  if (open)
+  {
+    store().end();
+  }
+  return written;
+}
@@ -0,0 +1,132 @@
+#ifndef SETTINGS_STORE_H
+#define SETTINGS_STORE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+#include "Hal.h"
+
+const char *const SETTINGS_NAMESPACE = "watering";
+const uint8_t SETTINGS_VERSION = 1;
+const unsigned long SETTINGS_DEBOUNCE_MS = 2000; // Quiet time before a change is written to flash
+const unsigned long MODEL_DEBOUNCE_MS = 600000;  // Learned models: the pulses of one dose share a write
+
+// ZoneSettings::mode
+const uint8_t ZONE_MODE_THRESHOLD = 0; // Pump from dry to wet threshold
+const uint8_t ZONE_MODE_DOSING = 1;    // Learned pulses with soak intervals
+
+// Persisted configuration of one zone, stored as a single NVS blob "z<id>"
+struct __attribute__((packed)) ZoneSettings
+{
+  uint8_t version;
+  uint8_t wetThreshold;  // %
+  uint8_t dryThreshold;  // %
+  uint8_t mode;          // ZONE_MODE_*, reserved (0) in older blobs
+  uint16_t airValue;     // Raw ADC
+  uint16_t dryValue;     // Raw ADC
+  uint16_t waterValue;   // Raw ADC
+  uint16_t maxRuntimeSec;
+  uint16_t cooldownSec;
+  uint32_t crc;          // CRC32 of all bytes above
+};
+
+// Learned dosing response of a zone (DosingController), stored as its own
+// blob "d<id>" so the settings blob keeps its layout
+const uint8_t MODEL_VERSION = 1;
+
+struct __attribute__((packed)) DosingModel
+{
+  uint8_t version;
+  int32_t gain;    // Milli-percent per pump second
+  uint32_t soakMs;
+  uint32_t crc;    // CRC32 of all bytes above
+};
+
+// Bitwise CRC32 (IEEE)
+uint32_t crc32(const void *data, size_t length);
+// Continues a CRC32 over more data, start with 0
+uint32_t crc32Update(uint32_t crc, const void *data, size_t length);
+
+// NVS key of a zone's settings blob, "z<id>" (other per-zone blobs pass their
+// own prefix). constexpr so that a fixed zone table gets its keys at compile
+// time (see ZoneTable.h).
+struct SettingsKey
+{
+  char text[8];
+};
+
+constexpr SettingsKey settingsKeyFor(int zoneId, char prefix = 'z')
+{
+  SettingsKey key = {};
+  key.text[0] = prefix;
+  int digits = 1;
+  for (int rest = zoneId / 10; rest > 0 && digits < 6; rest /= 10)
+  {
+    digits++;
+  }
+  for (int i = digits, rest = zoneId < 0 ? 0 : zoneId; i > 0; i--, rest /= 10)
+  {
+    key.text[i] = (char)('0' + rest % 10);
+  }
+  return key;
+}
+
+// Batched, debounced zone settings persistence.
+// stage() records the complete settings of a zone (one call per config
+// request); flush() writes every zone whose last change is older than the
+// debounce time, in one open/close of the namespace, and only if the blob
+// differs from what is already in flash. Dosing models go the same way
+// with MODEL_DEBOUNCE_MS.
+class SettingsStore
+{
+public:
+  // Without an explicit store the one installed in the HAL is used
+  explicit SettingsStore(KeyValueStore *store = nullptr, unsigned long debounceMs = SETTINGS_DEBOUNCE_MS);
+
+  // out holds the defaults on entry; returns false if nothing valid was stored
+  bool load(int zoneId, ZoneSettings &out);
+  void stage(int zoneId, const ZoneSettings &settings, unsigned long now);
+  int flush(unsigned long now, bool force = false);
+  // False if no valid model is stored; stageModel() ignores an unchanged model
+  bool loadModel(int zoneId, DosingModel &out);
+  void stageModel(int zoneId, int32_t gain, uint32_t soakMs, unsigned long now);
+  bool hasPending() const;
+  bool nextFlushTime(unsigned long &deadline) const;
+
+  static uint32_t checksum(const ZoneSettings &settings);
+
+private:
+  struct Entry
+  {
+    int zoneId;
+    SettingsKey key;
+    ZoneSettings staged;
+    ZoneSettings persisted;
+    bool persistedValid;
+    bool dirty;
+    unsigned long changedAt;
+  };
+
+  struct ModelEntry
+  {
+    int zoneId;
+    SettingsKey key;
+    DosingModel staged;
+    DosingModel persisted;
+    bool persistedValid;
+    bool dirty;
+    unsigned long changedAt;
+  };
+
+  KeyValueStore *explicitStore;
+  unsigned long debounceMs;
+  std::vector<Entry> entries;
+  std::vector<ModelEntry> models;
+
+  KeyValueStore &store() { return explicitStore ? *explicitStore : *hal().store; }
+  Entry &entryFor(int zoneId);
+  ModelEntry &modelFor(int zoneId);
+  bool loadLegacy(int zoneId, ZoneSettings &out);
+};
+
+#endif // SETTINGS_STORE_H
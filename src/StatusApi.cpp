@@ -0,0 +1,120 @@
+#include "StatusApi.h"
+#include <stdarg.h>
+#include <stdio.h>
+#include "WateringPlanner.h"
+#include "WateringZone.h"
+
+// snprintf-style append that never writes past the end of the buffer
+static void append(char *buffer, size_t size, size_t &length, const char *format, ...)
+    __attribute__((format(printf, 4, 5)));
+
+static void append(char *buffer, size_t size, size_t &length, const char *format, ...)
+{
+  if (length >= size)
+  {
+    return;
+  }
+  va_list args;
+  va_start(args, format);
+  int written = vsnprintf(buffer + length, size - length, format, args);
+  va_end(args);
+  if (written > 0)
+  {
+    length += (size_t)written;
+  }
+}
+
+static void appendEscaped(char *buffer, size_t size, size_t &length, const char *text)
+{
+  for (; *text; text++)
+  {
+    if (*text == '"' || *text == '\\')
+    {
+      append(buffer, size, length, "\\%c", *text);
+    }
+    else if ((unsigned char)*text < 0x20)
+    {
+      append(buffer, size, length, "\\u%04x", *text);
+    }
+    else
+    {
+      append(buffer, size, length, "%c", *text);
+    }
+  }
+}
+
+size_t writeZoneStatusJson(const SystemSnapshot &snapshot, char *buffer, size_t size,
+                           const bool *include)
+{
+  size_t length = 0;
+  bool first = true;
+  append(buffer, size, length, "{\"v\":%u,\"zones\":[", (unsigned)snapshot.version);
+  for (int i = 0; i < snapshot.zoneCount; i++)
+  {
+    if (include && !include[i])
+    {
+      continue;
+    }
+    const ZoneSnapshot &zone = snapshot.zones[i];
+    append(buffer, size, length, "%s{\"id\":%d,\"m\":%d,\"r\":%d,\"p\":%d,\"c\":%lu,\"a\":%d,\"s\":%d}",
+           first ? "" : ",", zone.id, zone.moisturePercent, zone.moistureRaw, zone.pumpState ? 1 : 0,
+           zone.inCooldown ? zone.cooldownRemainingSec : 0UL, zone.sensorInAir ? 1 : 0, zone.sensorStale ? 1 : 0);
+    first = false;
+  }
+  append(buffer, size, length, "]}");
+  return length < size ? length : 0;
+}
+
+size_t writeZoneInfoJson(const SystemSnapshot &snapshot, char *buffer, size_t size)
+{
+  size_t length = 0;
+  append(buffer, size, length, "{\"zones\":[");
+  for (int i = 0; i < snapshot.zoneCount; i++)
+  {
+    append(buffer, size, length, "%s{\"id\":%d,\"name\":\"", i ? "," : "", snapshot.zones[i].id);
+    appendEscaped(buffer, size, length, snapshot.zones[i].name);
+    append(buffer, size, length, "\"}");
+  }
+  append(buffer, size, length, "]}");
+  return length < size ? length : 0;
+}
+
+size_t writePlanJson(const SystemSnapshot &snapshot, char *buffer, size_t size)
+{
+  static const char *const kinds[] = {"none", "crossing", "early", "deferred", "off-window"};
+  size_t length = 0;
+  append(buffer, size, length, "{\"synced\":%d,\"zones\":[", snapshot.planSynced ? 1 : 0);
+  for (int i = 0; i < snapshot.zoneCount; i++)
+  {
+    const ZoneSnapshot &zone = snapshot.zones[i];
+    int kind = zone.planKind >= PLAN_NONE && zone.planKind <= PLAN_OFF_WINDOW ? zone.planKind : PLAN_NONE;
+    append(buffer, size, length, "%s{\"id\":%d,\"rate\":%ld,\"plan\":\"%s\",\"in\":%ld}", i ? "," : "",
+           zone.id, zone.dryingRate, kinds[kind], zone.planInSec);
+  }
+  append(buffer, size, length, "]}");
+  return length < size ? length : 0;
+}
+
+size_t writeConfigJson(const SystemSnapshot &snapshot, char *buffer, size_t size)
+{
+  size_t length = 0;
+  append(buffer, size, length, "{\"version\":%d,\"zones\":[", CONFIG_JSON_VERSION);
+  for (int i = 0; i < snapshot.zoneCount; i++)
+  {
+    const ZoneSnapshot &zone = snapshot.zones[i];
+    append(buffer, size, length, "%s{\"id\":%d,\"name\":\"", i == 0 ? "" : ",", zone.id);
+    appendEscaped(buffer, size, length, zone.name);
+    append(buffer, size, length,
+           "\",\"wetThreshold\":%d,\"dryThreshold\":%d,\"airValue\":%d,\"dryValue\":%d,"
+           "\"waterValue\":%d,\"maxRuntime\":%lu,\"cooldown\":%lu,\"mode\":%d}",
+           zone.wetThreshold, zone.dryThreshold, zone.airValue, zone.dryValue, zone.waterValue,
+           zone.maxRuntimeSec, zone.cooldownSec, zone.dosingMode ? ZONE_MODE_DOSING : ZONE_MODE_THRESHOLD);
+  }
+  append(buffer, size, length, "],\"weather\":[");
+  for (int hour = 0; hour < 24; hour++)
+  {
+    append(buffer, size, length, "%s%u", hour == 0 ? "" : ",", (unsigned)snapshot.weather[hour]);
+  }
+  append(buffer, size, length, "]}");
+  return length < size ? length : 0;
+}
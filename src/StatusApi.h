@@ -0,0 +1,33 @@
+#ifndef STATUS_API_H
+#define STATUS_API_H
+
+#include <stddef.h>
+#include "ZoneSnapshot.h"
+
+// Upper bound for the JSON documents below (all zones, worst-case numbers)
+const size_t STATUS_JSON_MAX = 64 + MAX_ZONES * 64;
+const size_t INFO_JSON_MAX = 16 + MAX_ZONES * (ZONE_NAME_LEN * 2 + 24);
+const size_t PLAN_JSON_MAX = 32 + MAX_ZONES * 72;
+const size_t CONFIG_JSON_MAX = 160 + MAX_ZONES * (ZONE_NAME_LEN * 2 + 180);
+const int CONFIG_JSON_VERSION = 1;
+
+// Changing state only, as consumed by the dashboard:
+// {"v":42,"zones":[{"id":1,"m":37,"r":2710,"p":0,"c":120,"a":0}]}
+// m = moisture %, r = raw ADC, p = pump on, c = cooldown seconds left, a = sensor in air
+// If include is given, only zones whose entry is true are written (used for event deltas).
+size_t writeZoneStatusJson(const SystemSnapshot &snapshot, char *buffer, size_t size,
+                           const bool *include = nullptr);
+
+// Static zone metadata, fetched once per page load: {"zones":[{"id":1,"name":"Garden Bed 1"}]}
+size_t writeZoneInfoJson(const SystemSnapshot &snapshot, char *buffer, size_t size);
+
+// Planner forecast per zone:
+// {"synced":1,"zones":[{"id":1,"rate":850,"plan":"early","in":5400}]}
+// rate = drying in milli-percent per hour, in = seconds until the planned run
+size_t writePlanJson(const SystemSnapshot &snapshot, char *buffer, size_t size);
+
+// Complete configuration for export, in the format parseConfigJson() reads
+// back (ConfigDocument.h)
+size_t writeConfigJson(const SystemSnapshot &snapshot, char *buffer, size_t size);
+
+#endif // STATUS_API_H
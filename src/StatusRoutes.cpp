@@ -0,0 +1,143 @@
+#ifdef ARDUINO
+#include "WebRoutes.h"
+
+#include <WiFi.h>
+#include <esp_pm.h>
+
+#include "EventLog.h"
+#include "Metrics.h"
+
+static const unsigned long IDLE_SAMPLE_MS = 60000; // Window of the idle share in /api/power
+
+unsigned long webReadyMs = 0;
+
+// Share of time spent in the idle task, which includes light sleep, over the
+// last IDLE_SAMPLE_MS. Needs FreeRTOS run time stats, negative without them.
+static volatile float idlePct = -1;
+
+void sampleIdle()
+{
+#if configGENERATE_RUN_TIME_STATS
+  static unsigned long lastSample = 0;
+  static uint32_t lastIdle = 0;
+  static uint32_t lastTotal = 0;
+  if (lastSample && millis() - lastSample < IDLE_SAMPLE_MS)
+  {
+    return;
+  }
+  // 32-bit counters, the differences stay right across a wrap
+  uint32_t idle = (uint32_t)ulTaskGetIdleRunTimeCounter();
+  uint32_t total = (uint32_t)portGET_RUN_TIME_COUNTER_VALUE();
+  if (total != lastTotal)
+  {
+    idlePct = 100.0f * (idle - lastIdle) / (total - lastTotal);
+  }
+  lastIdle = idle;
+  lastTotal = total;
+  lastSample = millis();
+#endif
+}
+
+// Dynamic frequency scaling plus automatic light sleep while all tasks are
+// blocked. Light sleep needs a station connection with modem sleep; in AP
+// mode the radio has to stay on, so only frequency scaling is used there.
+static const char *powerMode = "none";
+
+void setupPowerSaving()
+{
+#if CONFIG_PM_ENABLE
+#if ESP_IDF_VERSION_MAJOR >= 5
+  esp_pm_config_t config = {};
+#else
+  esp_pm_config_esp32c3_t config = {};
+#endif
+  config.max_freq_mhz = 160;
+  config.min_freq_mhz = 40;
+#ifdef USE_WIFI_MANAGER
+  WiFi.setSleep(true);
+  config.light_sleep_enable = true;
+#else
+  config.light_sleep_enable = false;
+#endif
+  esp_err_t result = esp_pm_configure(&config);
+  if (result == ESP_OK)
+  {
+    powerMode = config.light_sleep_enable ? "light-sleep" : "dfs";
+  }
+  else if (config.light_sleep_enable)
+  {
+    // Tickless idle not compiled into this core: fall back to frequency scaling
+    config.light_sleep_enable = false;
+    powerMode = esp_pm_configure(&config) == ESP_OK ? "dfs" : "none";
+  }
+  Serial.printf("Power management: %s\n", powerMode);
+#else
+  Serial.println("Power management not available in this build");
+#endif
+}
+
+// Control task activity since boot, from the latest snapshot
+static void handlePowerReport(AsyncWebServerRequest *request)
+{
+  if (!readSnapshot(request))
+  {
+    return;
+  }
+  // Counters as of the snapshot, which is only published when zone state changes
+  unsigned long uptimeMs = webSnapshot.takenAtMs > 0 ? webSnapshot.takenAtMs : 1;
+  char idle[12] = "null";
+  if (idlePct >= 0)
+  {
+    snprintf(idle, sizeof(idle), "%.1f", idlePct);
+  }
+  snprintf(jsonBuffer, sizeof(jsonBuffer),
+           "{\"uptimeMs\":%lu,\"wakeups\":%lu,\"wakeupsPerMin\":%.1f,\"busyUs\":%lu,\"controlBusyPct\":%.3f,"
+           "\"idlePct\":%s,\"pm\":\"%s\",\"cpuMHz\":%u,\"firstTickMs\":%.3f,\"webReadyMs\":%lu,"
+           "\"pumpCutoffs\":%lu,\"cutoffMaxOverrunUs\":%lu,\"controlMaxLateMs\":%.1f}",
+           uptimeMs, webSnapshot.controlWakeups, webSnapshot.controlWakeups * 60000.0 / uptimeMs,
+           webSnapshot.controlBusyUs, webSnapshot.controlBusyUs / (uptimeMs * 10.0), idle,
+           powerMode, (unsigned)getCpuFrequencyMhz(), webSnapshot.firstTickUs / 1000.0, webReadyMs,
+           webSnapshot.pumpCutoffs, webSnapshot.cutoffMaxOverrunUs, webSnapshot.controlMaxLateUs / 1000.0);
+  request->send(200, "application/json", jsonBuffer);
+}
+
+void setupStatusRoutes(AsyncWebServer &server)
+{
+  server.on("/api/power", HTTP_GET, handlePowerReport);
+
+  // Recent log lines as "<sequence> <line>"; poll with ?since=<X-Log-Next of the previous answer>
+  server.on("/api/log", HTTP_GET, [](AsyncWebServerRequest *request)
+            {
+    std::shared_ptr<RenderSlot> slot = renderSlot(request);
+    if (!slot) {
+      return;
+    }
+    uint32_t until = eventLog.nextSequence();
+    uint32_t since = request->hasParam("since") ? strtoul(request->getParam("since")->value().c_str(), nullptr, 10) : 0;
+    std::shared_ptr<LogHistoryWriter> writer = std::make_shared<LogHistoryWriter>(eventLog, since, until);
+    AsyncWebServerResponse* response = request->beginChunkedResponse("text/plain",
+        [writer, slot](uint8_t *buffer, size_t maxLen, size_t index) -> size_t {
+          return writer->fill(reinterpret_cast<char*>(buffer), maxLen);
+        });
+    response->addHeader("X-Log-Next", String(until));
+    response->addHeader("X-Log-Dropped", String(eventLog.dropped()));
+    response->addHeader("Cache-Control", "no-cache");
+    request->send(response); });
+
+#ifdef ENABLE_METRICS
+  // Prometheus text exposition, streamed so no full copy is ever built
+  server.on("/metrics", HTTP_GET, [](AsyncWebServerRequest *request)
+            {
+    std::shared_ptr<RenderSlot> slot = renderSlot(request);
+    if (!slot) {
+      return;
+    }
+    std::shared_ptr<MetricsWriter> writer = std::make_shared<MetricsWriter>();
+    AsyncWebServerResponse* response = request->beginChunkedResponse("text/plain; version=0.0.4",
+        [writer, slot](uint8_t *buffer, size_t maxLen, size_t index) -> size_t {
+          return writer->fill(reinterpret_cast<char*>(buffer), maxLen);
+        });
+    request->send(response); });
+#endif
+}
+#endif
@@ -0,0 +1,84 @@
+#include "TemplateRenderer.h"
+#include <string.h>
+
+static bool isNameChar(char c)
+{
+  return (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_';
+}
+
+TemplateRenderer::TemplateRenderer(const char *source, TemplateResolver resolver, void *context)
+    : cursor(source), resolver(resolver), context(context), pendingLength(0), pendingOffset(0)
+{
+}
+
+size_t TemplateRenderer::fill(char *buffer, size_t size)
+{
+  size_t length = 0;
+  while (length < size)
+  {
+    // Finish a value that did not fit into the previous chunk
+    if (pendingOffset < pendingLength)
+    {
+      size_t count = pendingLength - pendingOffset;
+      if (count > size - length)
+      {
+        count = size - length;
+      }
+      memcpy(buffer + length, pending + pendingOffset, count);
+      pendingOffset += count;
+      length += count;
+      continue;
+    }
+
+    if (*cursor == '\0')
+    {
+      break;
+    }
+
+    if (*cursor == '%' && expandPlaceholder())
+    {
+      continue;
+    }
+
+    // Copy literal text up to the next possible placeholder
+    const char *next = strchr(cursor + 1, '%');
+    size_t count = next ? (size_t)(next - cursor) : strlen(cursor);
+    if (count > size - length)
+    {
+      count = size - length;
+    }
+    memcpy(buffer + length, cursor, count);
+    cursor += count;
+    length += count;
+  }
+  return length;
+}
+
+bool TemplateRenderer::expandPlaceholder()
+{
+  // cursor is on '%'; a placeholder is %NAME% with NAME in [A-Z0-9_]
+  char name[TEMPLATE_NAME_MAX + 1];
+  size_t nameLength = 0;
+  const char *p = cursor + 1;
+  while (isNameChar(*p) && nameLength < TEMPLATE_NAME_MAX)
+  {
+    name[nameLength++] = *p++;
+  }
+  if (nameLength == 0 || *p != '%')
+  {
+    return false; // A literal percent sign
+  }
+  name[nameLength] = '\0';
+
+  size_t written = 0;
+  if (!resolver(name, pending, TEMPLATE_VALUE_MAX, written, context))
+  {
+    // Keep unknown placeholders visible instead of silently dropping them
+    written = nameLength + 2;
+    memcpy(pending, cursor, written);
+  }
+  pendingLength = written < sizeof(pending) ? written : sizeof(pending);
+  pendingOffset = 0;
+  cursor = p + 1;
+  return true;
+}
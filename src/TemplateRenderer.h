@@ -0,0 +1,39 @@
+#ifndef TEMPLATE_RENDERER_H
+#define TEMPLATE_RENDERER_H
+
+#include <stddef.h>
+
+const size_t TEMPLATE_NAME_MAX = 24;   // Longest placeholder name between the % signs
+const size_t TEMPLATE_VALUE_MAX = 96;  // Longest text a placeholder may expand to
+
+// Writes the value of placeholder `name` into out (at most size bytes) and
+// stores the length in written. Returns false for unknown names, which are
+// then copied to the output unchanged.
+typedef bool (*TemplateResolver)(const char *name, char *out, size_t size, size_t &written, void *context);
+
+// Single-pass %PLACEHOLDER% expansion into caller-provided chunks.
+// The template is walked once and never copied; the only buffer is the one
+// for the value currently being emitted, so a page of any size renders in
+// constant memory. Feed fill() from a chunked HTTP response.
+class TemplateRenderer
+{
+public:
+  TemplateRenderer(const char *source, TemplateResolver resolver, void *context);
+
+  // Fills up to size bytes, returns 0 once the whole template was written
+  size_t fill(char *buffer, size_t size);
+  bool done() const { return *cursor == '\0' && pendingOffset == pendingLength; }
+
+private:
+  const char *cursor;
+  TemplateResolver resolver;
+  void *context;
+
+  char pending[TEMPLATE_VALUE_MAX + TEMPLATE_NAME_MAX + 2];
+  size_t pendingLength;
+  size_t pendingOffset;
+
+  bool expandPlaceholder();
+};
+
+#endif // TEMPLATE_RENDERER_H
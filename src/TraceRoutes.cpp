@@ -0,0 +1,164 @@
+#if defined(ARDUINO) && defined(SENSOR_TRACE)
+#include "WebRoutes.h"
+
+#include <LittleFS.h>
+
+#include "SensorTrace.h"
+
+static const char *const TRACE_FILE = "/trace.bin";
+static const char *const TRACE_FILE_OLD = "/trace.old.bin"; // The recording before the last restart
+static const size_t TRACE_FILE_MAX = 524288;                // About two days of one zone
+static const unsigned long TRACE_FLUSH_MS = 5000;
+
+// Raw samples and pump decisions for replays on the host (SensorTrace.h).
+// The control task only appends to traceRecorder's buffer; the loop task
+// writes it to TRACE_FILE. A recording starts at boot and after POST
+// /api/trace, at the first snapshot without a running pump, and stops when
+// the file is full.
+static TraceRecorder traceRecorder;       // Wraps the GPIO HAL, see setupTrace()
+static volatile bool traceRestart = true; // A new recording starts at the next idle snapshot
+static bool traceFileReady = false;
+static const ZoneDefinition *traceZoneTable = nullptr; // Pins and filters by zone id
+static size_t traceZoneCount = 0;
+static uint32_t (*traceWallClock)() = nullptr;
+
+static void recordSample(int pin, int raw, unsigned long now)
+{
+  traceRecorder.sample(pin, raw, now);
+}
+
+void setupTrace(const ZoneDefinition *zones, size_t count, uint32_t (*wallClock)())
+{
+  traceZoneTable = zones;
+  traceZoneCount = count;
+  traceWallClock = wallClock;
+  Hal traced = hal();
+  traceRecorder.wrap(traced.gpio);
+  traced.gpio = &traceRecorder;
+  installHal(traced);
+  WateringZone::setSampleObserver(recordSample);
+  traceFileReady = LittleFS.begin(true);
+}
+
+static void appendTrace(const uint8_t *data, size_t length)
+{
+  File file = LittleFS.open(TRACE_FILE, "a");
+  if (!file)
+  {
+    return;
+  }
+  file.write(data, length);
+  if (file.size() >= TRACE_FILE_MAX)
+  {
+    traceRecorder.stop();
+    Serial.println("Trace file full, recording stopped");
+  }
+  file.close();
+}
+
+static bool anyPumpOn(const SystemSnapshot &snapshot)
+{
+  for (int i = 0; i < snapshot.zoneCount; i++)
+  {
+    if (snapshot.zones[i].pumpState)
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
+static bool startTrace(const SystemSnapshot &snapshot)
+{
+  TraceZone zones[MAX_ZONES];
+  int count = 0;
+  for (int i = 0; i < snapshot.zoneCount; i++)
+  {
+    const ZoneSnapshot &zone = snapshot.zones[i];
+    for (size_t j = 0; j < traceZoneCount; j++)
+    {
+      const ZoneDefinition &definition = traceZoneTable[j];
+      if (definition.id == zone.id)
+      {
+        zones[count++] = traceZone(zone, definition.sensorPin, definition.pumpPin,
+                                   definition.filter ? *definition.filter : DEFAULT_FILTER);
+      }
+    }
+  }
+
+  uint32_t wallClock = traceWallClock ? traceWallClock() : 0;
+  if (wallClock)
+  {
+    wallClock -= (millis() - snapshot.takenAtMs) / 1000;
+  }
+  TraceHeader header = {TRACE_MAGIC, TRACE_VERSION, (uint8_t)count, (uint16_t)SENSOR_SAMPLE_INTERVAL_MS,
+                        (uint32_t)snapshot.takenAtMs, wallClock};
+  LittleFS.remove(TRACE_FILE_OLD);
+  LittleFS.rename(TRACE_FILE, TRACE_FILE_OLD);
+  return traceRecorder.start(header, zones, count);
+}
+
+void drainTrace()
+{
+  static uint8_t chunk[TRACE_BUFFER_SIZE];
+  static SystemSnapshot traceSnapshot;
+  static unsigned long lastFlush = 0;
+  if (!traceFileReady)
+  {
+    return;
+  }
+
+  if (traceRestart)
+  {
+    // Replays cannot start in the middle of a pump run
+    if (controller.snapshotVersion() == 0 || !controller.readSnapshot(traceSnapshot) || anyPumpOn(traceSnapshot))
+    {
+      return;
+    }
+    traceRecorder.stop();
+    size_t length = traceRecorder.drain(chunk, sizeof(chunk));
+    if (length > 0)
+    {
+      appendTrace(chunk, length); // Tail of the previous recording
+    }
+    traceRestart = false;
+    if (!startTrace(traceSnapshot))
+    {
+      return;
+    }
+    lastFlush = millis();
+  }
+
+  if (traceRecorder.pending() < TRACE_BUFFER_SIZE / 2 && millis() - lastFlush < TRACE_FLUSH_MS)
+  {
+    return;
+  }
+  lastFlush = millis();
+  size_t length = traceRecorder.drain(chunk, sizeof(chunk));
+  if (length > 0)
+  {
+    appendTrace(chunk, length);
+  }
+}
+
+void setupTraceRoutes(AsyncWebServer &server)
+{
+  // Recording so far, replay it with the bench's replay suite (--trace FILE)
+  server.on("/api/trace", HTTP_GET, [](AsyncWebServerRequest *request)
+            {
+    if (!LittleFS.exists(TRACE_FILE)) {
+      request->send(404, "text/plain", "No trace recorded yet");
+      return;
+    }
+    AsyncWebServerResponse* response = request->beginResponse(LittleFS, TRACE_FILE, "application/octet-stream");
+    response->addHeader("Cache-Control", "no-store");
+    request->send(response); });
+
+  // Starts a new recording with the current settings, e.g. after changing them
+  server.on("/api/trace", HTTP_POST, [](AsyncWebServerRequest *request)
+            {
+    traceRestart = true;
+    wakeLoopTask();
+    request->send(202, "text/plain", "Recording restarts once no pump runs"); });
+}
+#endif
@@ -0,0 +1,255 @@
+#ifdef ARDUINO
+#include "WebRoutes.h"
+
+#include <LittleFS.h>
+#include <esp_ota_ops.h>
+
+#include "web_assets.h"
+#include "UpdateWriter.h"
+
+static const unsigned long UPDATE_RESTART_MS = SETTINGS_DEBOUNCE_MS + 1000; // Pending settings are saved first
+static const unsigned long BOOT_CONFIRM_MS = 60000;          // A new image must run this long before it is kept
+static const unsigned long BOOT_CONFIRM_TIMEOUT_MS = 300000; // Rolled back if it is not healthy by then
+static const char *const ASSET_NAMESPACE = "assets";
+
+// POST /update: one upload at a time, streamed to flash as it arrives
+static OtaFlashTarget firmwareTarget;
+static UpdateWriter updateWriter;
+static AsyncWebServerRequest *updateOwner = nullptr; // Request whose body feeds updateWriter
+static unsigned long restartAtMs = 0;                // Set after a firmware update, 0: none
+
+// A gzip page embedded in the firmware that POST /update?target=<name> can
+// replace without a firmware update. The override lives in LittleFS, its
+// ETag (CRC32 of the gzip data) in NVS.
+struct PageAsset
+{
+  const char *name; // Update target and NVS key
+  const char *path; // Served path, LittleFS holds path + ".gz"
+  const uint8_t *embedded;
+  size_t embeddedLength;
+  const char *embeddedEtag;
+  AssetFlashTarget target;
+  char etag[12]; // Of the override, empty: the embedded copy is served
+};
+
+static PageAsset pages[] = {
+    {"index", "/www/index.html", index_html_gz, index_html_gz_len, index_html_gz_etag, AssetFlashTarget("/www/index.html.gz"), ""},
+#ifdef MESH_AGGREGATOR
+    {"mesh", "/www/mesh.html", mesh_html_gz, mesh_html_gz_len, mesh_html_gz_etag, AssetFlashTarget("/www/mesh.html.gz"), ""},
+#endif
+};
+
+static PageAsset *findPage(const String &name)
+{
+  for (PageAsset &page : pages)
+  {
+    if (name == page.name)
+    {
+      return &page;
+    }
+  }
+  return nullptr;
+}
+
+// Picks up overrides uploaded by an earlier boot
+static void loadPageOverrides()
+{
+  KeyValueStore &store = *hal().store;
+  bool mounted = LittleFS.begin(true);
+  if (!store.begin(ASSET_NAMESPACE, true))
+  {
+    return;
+  }
+  for (PageAsset &page : pages)
+  {
+    uint32_t crc = 0;
+    if (mounted && store.getBytes(page.name, &crc, sizeof(crc)) == sizeof(crc) &&
+        LittleFS.exists(String(page.path) + ".gz"))
+    {
+      snprintf(page.etag, sizeof(page.etag), "\"%08lx\"", (unsigned long)crc);
+    }
+  }
+  store.end();
+}
+
+void sendPage(AsyncWebServerRequest *request, const char *name)
+{
+  const PageAsset *found = findPage(name);
+  if (!found)
+  {
+    request->send(404, "text/plain", "Not found");
+    return;
+  }
+  const PageAsset &page = *found;
+  const char *etag = page.etag[0] ? page.etag : page.embeddedEtag;
+  if (request->hasHeader("If-None-Match") &&
+      strcmp(request->getHeader("If-None-Match")->value().c_str(), etag) == 0)
+  {
+    request->send(304);
+    return;
+  }
+
+  AsyncWebServerResponse *response;
+  if (page.etag[0])
+  {
+    // Finds path + ".gz" and adds Content-Encoding itself
+    response = request->beginResponse(LittleFS, page.path, "text/html");
+  }
+  else
+  {
+    response = request->beginResponse(200, "text/html", page.embedded, page.embeddedLength);
+    response->addHeader("Content-Encoding", "gzip");
+  }
+  response->addHeader("Cache-Control", "max-age=86400");
+  response->addHeader("ETag", etag);
+  request->send(response);
+}
+
+// Body of POST /update, called once per received piece. Nothing is buffered
+// beyond the writer's one sector; the control task keeps running and only
+// waits for the flash cache while a sector is erased.
+static void receiveUpdate(AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total)
+{
+  if (index == 0)
+  {
+    if (updateWriter.active())
+    {
+      return; // Answered with 409 once the body is in
+    }
+    FlashTarget *target = &firmwareTarget;
+    bool haveCrc = request->hasParam("crc");
+    bool gzip = false;
+    if (request->hasParam("target") && request->getParam("target")->value() != "firmware")
+    {
+      // Pages have no image header or digest to fall back on: the CRC is required
+      PageAsset *page = findPage(request->getParam("target")->value());
+      if (!page || !haveCrc)
+      {
+        return;
+      }
+      target = &page->target;
+      gzip = true;
+    }
+    uint32_t crc = haveCrc ? strtoul(request->getParam("crc")->value().c_str(), nullptr, 16) : 0;
+    updateOwner = request;
+    request->onDisconnect([request]() {
+      if (updateOwner == request) {
+        updateWriter.abort();
+        updateOwner = nullptr;
+      }
+    });
+    if (!updateWriter.begin(*target, total, crc, haveCrc, gzip))
+    {
+      return;
+    }
+    Serial.printf("Update started: %u bytes\n", (unsigned)total);
+  }
+  if (updateOwner == request)
+  {
+    updateWriter.write(data, len);
+  }
+}
+
+static void finishUpdate(AsyncWebServerRequest *request)
+{
+  if (updateOwner != request)
+  {
+    if (updateWriter.active())
+    {
+      request->send(409, "text/plain", "Another update is running");
+    }
+    else if (request->hasParam("target") && findPage(request->getParam("target")->value()) &&
+             !request->hasParam("crc"))
+    {
+      request->send(400, "text/plain", "Page uploads need crc=<CRC32 of the file, hex>");
+    }
+    else
+    {
+      request->send(400, "text/plain", "Expected a body and target=firmware|index|mesh");
+    }
+    return;
+  }
+  updateOwner = nullptr;
+  if (!updateWriter.finish())
+  {
+    Serial.printf("Update failed: %s\n", UpdateWriter::errorText(updateWriter.error()));
+    request->send(422, "text/plain", UpdateWriter::errorText(updateWriter.error()));
+    return;
+  }
+
+  PageAsset *page = request->hasParam("target") ? findPage(request->getParam("target")->value()) : nullptr;
+  if (!page)
+  {
+    Serial.println("Firmware updated, restarting");
+    restartAtMs = millis();
+    request->send(200, "text/plain", "Updated, restarting");
+    return;
+  }
+  uint32_t crc = updateWriter.crc();
+  KeyValueStore &store = *hal().store;
+  if (store.begin(ASSET_NAMESPACE, false))
+  {
+    store.putBytes(page->name, &crc, sizeof(crc));
+    store.end();
+  }
+  snprintf(page->etag, sizeof(page->etag), "\"%08lx\"", (unsigned long)crc);
+  request->send(200, "text/plain", "Page updated");
+}
+
+// The core marks a freshly booted OTA image valid right away unless this
+// says otherwise; confirmBoot() decides instead. Needs a bootloader built
+// with rollback support, without it the image is always kept.
+extern "C" bool verifyRollbackLater()
+{
+  return true;
+}
+
+// Keeps a new image once it has been healthy (web server up, control task
+// running) at BOOT_CONFIRM_MS, otherwise boots the previous one again
+static void confirmBoot(bool healthy)
+{
+  static bool confirmed = false;
+  if (confirmed)
+  {
+    return;
+  }
+  esp_ota_img_states_t state;
+  if (esp_ota_get_state_partition(esp_ota_get_running_partition(), &state) != ESP_OK ||
+      state != ESP_OTA_IMG_PENDING_VERIFY)
+  {
+    confirmed = true;
+    return;
+  }
+  unsigned long now = millis();
+  if (healthy && now >= BOOT_CONFIRM_MS)
+  {
+    esp_ota_mark_app_valid_cancel_rollback();
+    Serial.println("New firmware confirmed");
+    confirmed = true;
+  }
+  else if (now >= BOOT_CONFIRM_TIMEOUT_MS)
+  {
+    Serial.println("New firmware not healthy, rolling back");
+    esp_ota_mark_app_invalid_rollback_and_reboot();
+  }
+}
+
+void pollUpdates(bool healthy)
+{
+  confirmBoot(healthy);
+  if (restartAtMs && millis() - restartAtMs >= UPDATE_RESTART_MS)
+  {
+    ESP.restart();
+  }
+}
+
+void setupUpdateRoutes(AsyncWebServer &server)
+{
+  loadPageOverrides();
+
+  // Firmware or page image as the raw body, e.g.
+  // curl --data-binary @firmware.bin "http://<device>/update?crc=$(crc32 firmware.bin)"
+  // curl --data-binary @index.html.gz "http://<device>/update?target=index&crc=$(crc32 index.html.gz)"
+  server.on("/update", HTTP_POST, finishUpdate, nullptr, receiveUpdate);
+}
+#endif
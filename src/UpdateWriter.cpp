@@ -0,0 +1,166 @@
+#include "UpdateWriter.h"
+#include <string.h>
+#include "SettingsStore.h"
+
+UpdateWriter::UpdateWriter()
+    : target(nullptr), chunkFill(0), flashed(0), total(0), expectedSize(0), expectedCrc(0), haveCrc(false),
+      gzip(false), runningCrc(0), lastError(UPDATE_OK)
+{
+}
+
+bool UpdateWriter::begin(FlashTarget &replacement, size_t size, uint32_t crc, bool checkCrc, bool gzipImage)
+{
+  if (target)
+  {
+    lastError = UPDATE_BUSY;
+    return false;
+  }
+  if (!replacement.begin(size))
+  {
+    replacement.abort();
+    lastError = UPDATE_NO_SPACE;
+    return false;
+  }
+  target = &replacement;
+  chunkFill = 0;
+  flashed = 0;
+  total = 0;
+  expectedSize = size;
+  expectedCrc = crc;
+  haveCrc = checkCrc;
+  gzip = gzipImage;
+  runningCrc = 0;
+  lastError = UPDATE_OK;
+  return true;
+}
+
+bool UpdateWriter::flushChunk()
+{
+  if (chunkFill == 0)
+  {
+    return true;
+  }
+  if (!target->write(flashed, chunk, chunkFill))
+  {
+    abort(UPDATE_WRITE_FAILED);
+    return false;
+  }
+  flashed += chunkFill;
+  chunkFill = 0;
+  return true;
+}
+
+bool UpdateWriter::write(const uint8_t *data, size_t length)
+{
+  if (!target)
+  {
+    return false;
+  }
+  if (expectedSize > 0 && total + length > expectedSize)
+  {
+    abort(UPDATE_SIZE_MISMATCH);
+    return false;
+  }
+  // The magic may arrive split across pieces
+  for (size_t i = 0; gzip && total + i < sizeof(GZIP_MAGIC) && i < length; i++)
+  {
+    if (data[i] != GZIP_MAGIC[total + i])
+    {
+      abort(UPDATE_NOT_GZIP);
+      return false;
+    }
+  }
+  runningCrc = crc32Update(runningCrc, data, length);
+  total += length;
+
+  while (length > 0)
+  {
+    size_t take = UPDATE_CHUNK_SIZE - chunkFill;
+    if (take > length)
+    {
+      take = length;
+    }
+    memcpy(chunk + chunkFill, data, take);
+    chunkFill += take;
+    data += take;
+    length -= take;
+    if (chunkFill == UPDATE_CHUNK_SIZE && !flushChunk())
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool UpdateWriter::finish()
+{
+  if (!target)
+  {
+    return false;
+  }
+  if (!flushChunk())
+  {
+    return false;
+  }
+  if (total == 0 || (expectedSize > 0 && total != expectedSize))
+  {
+    abort(UPDATE_SIZE_MISMATCH);
+    return false;
+  }
+  if (gzip && total < sizeof(GZIP_MAGIC))
+  {
+    abort(UPDATE_NOT_GZIP);
+    return false;
+  }
+  if (haveCrc && runningCrc != expectedCrc)
+  {
+    abort(UPDATE_CHECKSUM);
+    return false;
+  }
+  FlashTarget *done = target;
+  target = nullptr;
+  if (!done->commit())
+  {
+    done->abort();
+    lastError = UPDATE_COMMIT_FAILED;
+    return false;
+  }
+  lastError = UPDATE_OK;
+  return true;
+}
+
+void UpdateWriter::abort(UpdateError reason)
+{
+  if (target)
+  {
+    target->abort();
+    target = nullptr;
+  }
+  lastError = reason;
+}
+
+const char *UpdateWriter::errorText(UpdateError error)
+{
+  switch (error)
+  {
+  case UPDATE_OK:
+    return "ok";
+  case UPDATE_BUSY:
+    return "another update is running";
+  case UPDATE_NO_SPACE:
+    return "image does not fit";
+  case UPDATE_WRITE_FAILED:
+    return "flash write failed";
+  case UPDATE_SIZE_MISMATCH:
+    return "size does not match";
+  case UPDATE_CHECKSUM:
+    return "CRC32 mismatch";
+  case UPDATE_COMMIT_FAILED:
+    return "image rejected";
+  case UPDATE_NOT_GZIP:
+    return "not a gzip file";
+  case UPDATE_ABORTED:
+    return "aborted";
+  }
+  return "unknown";
+}
@@ -0,0 +1,68 @@
+#ifndef UPDATE_WRITER_H
+#define UPDATE_WRITER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "FlashTarget.h"
+
+const size_t UPDATE_CHUNK_SIZE = 4096; // One flash sector
+const uint8_t GZIP_MAGIC[2] = {0x1f, 0x8b};
+
+enum UpdateError
+{
+  UPDATE_OK,
+  UPDATE_BUSY,           // Another update is running
+  UPDATE_NO_SPACE,       // Target rejected the size
+  UPDATE_WRITE_FAILED,
+  UPDATE_SIZE_MISMATCH,  // Fewer or more bytes than announced
+  UPDATE_CHECKSUM,       // CRC32 of the received bytes differs
+  UPDATE_COMMIT_FAILED,  // Target refused the image (bad header, digest)
+  UPDATE_NOT_GZIP,       // A gzip image does not start with GZIP_MAGIC
+  UPDATE_ABORTED         // Connection dropped or cancelled
+};
+
+// Streams an update of any size into a FlashTarget through one sector-sized
+// buffer: the received pieces (TCP segments, multipart parts) are collected
+// until a full chunk is available and then written in one call, so the
+// target sees aligned UPDATE_CHUNK_SIZE writes and only the last one is
+// shorter. A CRC32 over all bytes is compared in finish() before the
+// target commits; any failure aborts the target and keeps the old image.
+// Gzip images (web assets) are aborted as soon as their first bytes are
+// not the gzip magic.
+//
+// Single user: the web server runs the upload on its one task.
+class UpdateWriter
+{
+public:
+  UpdateWriter();
+
+  // expectedSize 0: unknown; expectedCrc only checked if haveCrc
+  bool begin(FlashTarget &target, size_t expectedSize, uint32_t expectedCrc, bool haveCrc, bool gzip = false);
+  bool write(const uint8_t *data, size_t length);
+  // Flushes the last chunk, checks size and CRC, commits
+  bool finish();
+  void abort(UpdateError reason = UPDATE_ABORTED);
+
+  bool active() const { return target != nullptr; }
+  UpdateError error() const { return lastError; }
+  size_t received() const { return total; }
+  uint32_t crc() const { return runningCrc; }
+  static const char *errorText(UpdateError error);
+
+private:
+  FlashTarget *target;
+  uint8_t chunk[UPDATE_CHUNK_SIZE];
+  size_t chunkFill;
+  size_t flashed; // Bytes handed to the target
+  size_t total;   // Bytes received
+  size_t expectedSize;
+  uint32_t expectedCrc;
+  bool haveCrc;
+  bool gzip;
+  uint32_t runningCrc;
+  UpdateError lastError;
+
+  bool flushChunk();
+};
+
+#endif // UPDATE_WRITER_H
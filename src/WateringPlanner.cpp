@@ -0,0 +1,427 @@
+#include "WateringPlanner.h"
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include "SettingsStore.h"
+
+static const long PLAN_MAX_RATE = 100000; // 100 %/h, anything faster is a sensor fault
+
+void flatWeatherProfile(WeatherProfile &out)
+{
+  memset(out.etPercent, 100, sizeof(out.etPercent));
+  out.crc = crc32(out.etPercent, sizeof(out.etPercent));
+}
+
+bool parseWeatherProfile(const char *text, size_t length, WeatherProfile &out)
+{
+  flatWeatherProfile(out);
+  char line[32];
+  size_t pos = 0;
+  while (pos < length)
+  {
+    size_t end = pos;
+    while (end < length && text[end] != '\n')
+    {
+      end++;
+    }
+    size_t lineLength = end - pos;
+    if (lineLength >= sizeof(line))
+    {
+      return false;
+    }
+    memcpy(line, text + pos, lineLength);
+    line[lineLength] = '\0';
+    pos = end + 1;
+
+    char *comment = strchr(line, '#');
+    if (comment)
+    {
+      *comment = '\0';
+    }
+    char *cursor = line;
+    while (*cursor == ' ' || *cursor == '\t' || *cursor == '\r')
+    {
+      cursor++;
+    }
+    if (*cursor == '\0')
+    {
+      continue;
+    }
+
+    char *next;
+    long hour = strtol(cursor, &next, 10);
+    if (next == cursor || *next != ',' || hour < 0 || hour > 23)
+    {
+      return false;
+    }
+    cursor = next + 1;
+    long percent = strtol(cursor, &next, 10);
+    if (next == cursor || percent < 0 || percent > 255)
+    {
+      return false;
+    }
+    while (*next == ' ' || *next == '\t' || *next == '\r')
+    {
+      next++;
+    }
+    if (*next != '\0')
+    {
+      return false;
+    }
+    out.etPercent[hour] = (uint8_t)percent;
+  }
+  out.crc = crc32(out.etPercent, sizeof(out.etPercent));
+  return true;
+}
+
+WateringPlanner::WateringPlanner(ZoneRegistry &zones)
+    : zones(zones), wallClock(nullptr), wallBase(0), msBase(0)
+{
+  flatWeatherProfile(profile);
+}
+
+void WateringPlanner::resize(size_t count)
+{
+  ZonePlan empty = {};
+  state.assign(count, empty);
+  for (size_t i = 0; i < count; i++)
+  {
+    state[i].plan.zone = (uint16_t)i;
+    state[i].plan.kind = PLAN_NONE;
+  }
+  entries.clear();
+  entries.reserve(count);
+  laneEnds.reserve(count);
+}
+
+void WateringPlanner::setWeather(const WeatherProfile &replacement)
+{
+  profile = replacement;
+  profile.crc = crc32(profile.etPercent, sizeof(profile.etPercent));
+  for (ZonePlan &zone : state)
+  {
+    zone.dirty = true;
+  }
+}
+
+bool WateringPlanner::loadWeather()
+{
+  KeyValueStore &store = *hal().store;
+  WeatherProfile stored;
+  bool loaded = false;
+  if (store.begin(PLANNER_NAMESPACE, true))
+  {
+    loaded = store.getBytes("weather", &stored, sizeof(stored)) == sizeof(stored) &&
+             stored.crc == crc32(stored.etPercent, sizeof(stored.etPercent));
+    store.end();
+  }
+  if (loaded)
+  {
+    setWeather(stored);
+  }
+  return loaded;
+}
+
+void WateringPlanner::saveWeather()
+{
+  KeyValueStore &store = *hal().store;
+  if (store.begin(PLANNER_NAMESPACE, false))
+  {
+    store.putBytes("weather", &profile, sizeof(profile));
+    store.end();
+  }
+}
+
+void WateringPlanner::beginTick(unsigned long now)
+{
+  uint32_t wall = wallClock ? wallClock() : 0;
+  if (wall < PLAN_CLOCK_VALID)
+  {
+    wallBase = 0;
+    return;
+  }
+  if (wallBase == 0)
+  {
+    for (ZonePlan &zone : state)
+    {
+      zone.dirty = true;
+    }
+  }
+  wallBase = wall;
+  msBase = now;
+}
+
+void WateringPlanner::observe(size_t index, int percent, bool watering, unsigned long now)
+{
+  ZonePlan &zone = state[index];
+  zone.dirty = true;
+  if (watering)
+  {
+    zone.anchored = false;
+    return;
+  }
+  // Rising readings (water still spreading, rain) start a new span
+  if (!zone.anchored || percent > zone.anchorPercent + 1)
+  {
+    zone.anchorPercent = percent;
+    zone.anchorMs = now;
+    zone.anchored = true;
+    return;
+  }
+
+  unsigned long span = now - zone.anchorMs;
+  int drop = zone.anchorPercent - percent;
+  if (span < PLAN_RATE_MIN_SPAN_MS || (drop < PLAN_RATE_MIN_DROP && span < PLAN_RATE_MAX_SPAN_MS))
+  {
+    return;
+  }
+
+  // Normalize by the weather of the span's middle so rates of different hours compare
+  int et = synced() ? etAt(wallAt(now) - span / 2000) : 100;
+  long sample = (long)(drop > 0 ? drop : 0) * 1000L * 3600L / (long)(span / 1000);
+  sample = sample * 100 / (et < 10 ? 10 : et);
+  if (sample > PLAN_MAX_RATE)
+  {
+    sample = PLAN_MAX_RATE;
+  }
+  zone.rate = zone.samples == 0 ? sample : zone.rate + (sample - zone.rate) / 4;
+  if (zone.samples < 255)
+  {
+    zone.samples++;
+  }
+  zone.anchorPercent = percent;
+  zone.anchorMs = now;
+}
+
+uint32_t WateringPlanner::secondsUntil(int percent, int target, long rate, uint32_t wall) const
+{
+  long remaining = (long)(percent - target) * 1000L; // Milli-percent
+  uint32_t total = 0;
+  while (total < PLAN_HORIZON_HOURS * 3600UL)
+  {
+    uint32_t inHour = 3600 - wall % 3600;
+    long perHour = rate * etAt(wall) / 100;
+    long here = perHour * (long)inHour / 3600;
+    if (perHour > 0 && here >= remaining)
+    {
+      return total + (uint32_t)(remaining * 3600L / perHour) + 1;
+    }
+    remaining -= here;
+    total += inHour;
+    wall += inHour;
+  }
+  return 0;
+}
+
+int WateringPlanner::percentAfter(int percent, long rate, uint32_t wall, uint32_t seconds) const
+{
+  long value = (long)percent * 1000L;
+  while (seconds > 0 && value > 0)
+  {
+    uint32_t inHour = 3600 - wall % 3600;
+    if (inHour > seconds)
+    {
+      inHour = seconds;
+    }
+    value -= rate * etAt(wall) / 100 * (long)inHour / 3600;
+    seconds -= inHour;
+    wall += inHour;
+  }
+  return value > 0 ? (int)(value / 1000) : 0;
+}
+
+void WateringPlanner::planZone(size_t index, uint32_t wall)
+{
+  ZonePlan &plan = state[index];
+  const WateringZone &zone = zones.zone(index);
+  plan.plan.kind = PLAN_NONE;
+  plan.windowEnd = 0;
+  if (plan.samples < 2 || plan.rate <= 0 || zone.isPumpOn())
+  {
+    return;
+  }
+
+  int percent = zone.moisturePercent();
+  int dry = zone.moistureThresholdDry;
+  uint32_t until = percent <= dry ? 0 : secondsUntil(percent, dry, plan.rate, wall);
+  if (percent > dry && until == 0)
+  {
+    return; // Not within the horizon
+  }
+  uint32_t crossing = wall + until;
+
+  // Window instances in time order, from today on: the last one ending
+  // before the crossing and the first one starting after it
+  uint32_t dayStart = wall - wall % 86400;
+  bool haveEarly = false;
+  bool haveLater = false;
+  uint32_t earlyStart = 0, earlyEnd = 0, laterStart = 0, laterEnd = 0;
+  for (int day = 0; day < 3 && !haveLater; day++)
+  {
+    for (int w = 0; w < PLAN_WINDOW_COUNT && !haveLater; w++)
+    {
+      uint32_t start = dayStart + day * 86400UL + PLAN_WINDOWS[w].startMin * 60UL;
+      uint32_t end = dayStart + day * 86400UL + PLAN_WINDOWS[w].endMin * 60UL;
+      if (end <= wall)
+      {
+        continue;
+      }
+      if (start <= crossing && crossing < end)
+      {
+        plan.plan = {crossing, (uint16_t)index, PLAN_CROSSING};
+        plan.windowEnd = end;
+        return;
+      }
+      if (end <= crossing)
+      {
+        haveEarly = true;
+        earlyStart = start > wall ? start : wall;
+        earlyEnd = end;
+      }
+      else
+      {
+        haveLater = true;
+        laterStart = start;
+        laterEnd = end;
+      }
+    }
+  }
+
+  // Waiting a little past dry keeps the soil drier on average than watering
+  // early, so it is preferred; early only if the zone would be nearly dry by
+  // the end of that window anyway
+  if (haveLater && percentAfter(percent, plan.rate, wall, laterStart - wall) >= dry - PLAN_DEFER_MARGIN)
+  {
+    plan.plan = {laterStart, (uint16_t)index, PLAN_DEFERRED};
+    plan.windowEnd = laterEnd;
+  }
+  else if (haveEarly && percentAfter(percent, plan.rate, wall, earlyEnd - wall) <= dry + PLAN_EARLY_MARGIN)
+  {
+    plan.plan = {earlyStart, (uint16_t)index, PLAN_EARLY};
+    plan.windowEnd = earlyEnd;
+  }
+  else
+  {
+    plan.plan = {crossing, (uint16_t)index, PLAN_OFF_WINDOW};
+  }
+}
+
+void WateringPlanner::replan(int maxPumps)
+{
+  bool changed = false;
+  uint32_t wall = synced() ? wallAt(msBase) : 0;
+  for (size_t i = 0; i < state.size(); i++)
+  {
+    if (!state[i].dirty)
+    {
+      continue;
+    }
+    state[i].dirty = false;
+    changed = true;
+    if (synced())
+    {
+      planZone(i, wall);
+    }
+    else
+    {
+      state[i].plan.kind = PLAN_NONE;
+    }
+  }
+  if (!changed)
+  {
+    return;
+  }
+
+  // Spread runs that share a window over the pump slots: a run that would
+  // wait for a busy slot moves behind it, as long as it still ends in its window
+  entries.clear();
+  for (const ZonePlan &zone : state)
+  {
+    if (zone.plan.kind != PLAN_NONE)
+    {
+      entries.push_back(zone.plan);
+    }
+  }
+  std::sort(entries.begin(), entries.end(),
+            [](const PlanEntry &a, const PlanEntry &b) { return a.start < b.start; });
+
+  size_t lanes = maxPumps < 1 ? 1 : (size_t)maxPumps;
+  if (lanes > state.size())
+  {
+    lanes = state.size() > 0 ? state.size() : 1;
+  }
+  laneEnds.assign(lanes, 0);
+  for (PlanEntry &entry : entries)
+  {
+    size_t lane = 0;
+    for (size_t l = 1; l < laneEnds.size(); l++)
+    {
+      if (laneEnds[l] < laneEnds[lane])
+      {
+        lane = l;
+      }
+    }
+    const WateringZone &zone = zones.zone(entry.zone);
+    uint32_t runSec = zone.maxPumpRuntimeMs / 1000 + PLAN_RUN_GAP_SEC;
+    uint32_t windowEnd = state[entry.zone].windowEnd;
+    if (entry.kind != PLAN_OFF_WINDOW && entry.start < laneEnds[lane] && laneEnds[lane] + runSec <= windowEnd)
+    {
+      entry.start = laneEnds[lane];
+    }
+    laneEnds[lane] = (entry.start > laneEnds[lane] ? entry.start : laneEnds[lane]) + runSec;
+    state[entry.zone].start = entry.start;
+  }
+}
+
+bool WateringPlanner::inWindow(uint32_t wall)
+{
+  uint32_t minute = wall % 86400 / 60;
+  for (const PlanWindow &window : PLAN_WINDOWS)
+  {
+    if (minute >= window.startMin && minute < window.endMin)
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool WateringPlanner::holds(size_t index, unsigned long now) const
+{
+  if (!synced())
+  {
+    return false;
+  }
+  const WateringZone &zone = zones.zone(index);
+  uint32_t wall = wallAt(now);
+  // A zone that is not dry only asks to continue a timed-out run. With a
+  // slow sensor that run often reached the wet level after all, so the top-up
+  // waits until the zone is nearly dry and a window is open (doses in dosing
+  // mode are not interrupted).
+  if (!zone.isDry())
+  {
+    return !zone.dosingMode &&
+           (!inWindow(wall) || zone.moisturePercent() > zone.moistureThresholdDry + PLAN_EARLY_MARGIN);
+  }
+  return state[index].plan.kind == PLAN_DEFERRED && wall < state[index].start &&
+         zone.moisturePercent() >= zone.moistureThresholdDry - PLAN_DEFER_MARGIN;
+}
+
+bool WateringPlanner::due(size_t index, unsigned long now) const
+{
+  if (!synced() || state[index].plan.kind != PLAN_EARLY)
+  {
+    return false;
+  }
+  uint32_t wall = wallAt(now);
+  return wall >= state[index].start && wall < state[index].windowEnd;
+}
+
+long WateringPlanner::startsIn(size_t index, unsigned long now) const
+{
+  if (!synced() || index >= state.size() || state[index].plan.kind == PLAN_NONE)
+  {
+    return 0;
+  }
+  return (long)state[index].start - (long)wallAt(now);
+}
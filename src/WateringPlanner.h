@@ -0,0 +1,135 @@
+#ifndef WATERING_PLANNER_H
+#define WATERING_PLANNER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+#include "ZoneRegistry.h"
+
+const char *const PLANNER_NAMESPACE = "planner";
+
+const int PLAN_HORIZON_HOURS = 36;
+const unsigned long PLAN_RATE_MIN_SPAN_MS = 900000;  // Shortest span a drying rate is measured over
+const unsigned long PLAN_RATE_MAX_SPAN_MS = 10800000; // Longest, taken even if the reading barely moved
+const int PLAN_RATE_MIN_DROP = 2;                     // % a span must drop before it counts early
+const int PLAN_DEFER_MARGIN = 8;  // % below dry a zone may sink while it waits for its window
+const int PLAN_EARLY_MARGIN = 10; // % above dry at which a zone may be watered early in a window
+const unsigned long PLAN_RUN_GAP_SEC = 60; // Between two planned runs sharing a pump slot
+const uint32_t PLAN_CLOCK_VALID = 1700000000; // Wall clock values below this are not synced
+
+// Preferred watering windows, local minutes of the day: early morning and
+// evening, when less of the water evaporates
+struct PlanWindow
+{
+  uint16_t startMin;
+  uint16_t endMin;
+};
+const PlanWindow PLAN_WINDOWS[] = {{5 * 60, 9 * 60}, {19 * 60, 22 * 60}};
+const int PLAN_WINDOW_COUNT = sizeof(PLAN_WINDOWS) / sizeof(PLAN_WINDOWS[0]);
+
+// Relative drying per local hour (100 = the average), from an uploaded
+// weather/ET file. Without one every hour is 100.
+struct __attribute__((packed)) WeatherProfile
+{
+  uint8_t etPercent[24];
+  uint32_t crc;
+};
+
+// Parses "hour,percent" lines (0-23, 0-255); '#' starts a comment, hours not
+// listed stay at 100. False on a malformed line.
+bool parseWeatherProfile(const char *text, size_t length, WeatherProfile &out);
+void flatWeatherProfile(WeatherProfile &out);
+
+enum PlanKind
+{
+  PLAN_NONE,     // Not enough data or no wall clock: plain threshold control
+  PLAN_CROSSING, // The dry threshold is reached inside a window anyway
+  PLAN_EARLY,    // Watered in a window before it gets dry
+  PLAN_DEFERRED, // Allowed to get a little drier until the next window
+  PLAN_OFF_WINDOW // No window fits, watered when it gets dry
+};
+
+struct PlanEntry
+{
+  uint32_t start; // Local wall seconds
+  uint16_t zone;  // Slot in the registry
+  uint8_t kind;   // PlanKind
+};
+
+// Forecasts when each zone crosses its dry threshold and turns that into a
+// compact schedule of pump runs in the preferred windows.
+//
+// Each evaluation feeds the zone's reading (the one that goes into its
+// history) into a drying rate: the drop over spans of 15 minutes to 3
+// hours without pump activity, normalized by the weather profile and
+// smoothed. replan() only recomputes the forecast of zones that were
+// observed since the last call, at most PLAN_HORIZON_HOURS steps each, then
+// re-packs the schedule; no allocations after resize().
+//
+// The planner needs local wall time (NTP). Until the wall clock is valid it
+// plans nothing and the zones run on their thresholds as before.
+class WateringPlanner
+{
+public:
+  explicit WateringPlanner(ZoneRegistry &zones);
+
+  void resize(size_t count);
+  // Local seconds since the epoch, 0 while unknown
+  void setWallClock(uint32_t (*clock)()) { wallClock = clock; }
+  void setWeather(const WeatherProfile &profile);
+  const WeatherProfile &weather() const { return profile; }
+  bool loadWeather();
+  void saveWeather();
+
+  // Reads the wall clock once per control tick
+  void beginTick(unsigned long now);
+  void observe(size_t index, int percent, bool watering, unsigned long now);
+  void replan(int maxPumps);
+
+  // Zone that wants water but should wait for its planned window
+  bool holds(size_t index, unsigned long now) const;
+  // Zone whose early run is due
+  bool due(size_t index, unsigned long now) const;
+
+  bool synced() const { return wallBase != 0; }
+  // Smoothed drying rate at profile 100, milli-percent per hour (0: unknown)
+  long dryingRate(size_t index) const { return index < state.size() ? state[index].rate : 0; }
+  PlanKind kind(size_t index) const { return index < state.size() ? (PlanKind)state[index].plan.kind : PLAN_NONE; }
+  // Seconds from now to the planned start, negative once it passed
+  long startsIn(size_t index, unsigned long now) const;
+  const std::vector<PlanEntry> &schedule() const { return entries; }
+
+private:
+  struct ZonePlan
+  {
+    int anchorPercent;
+    unsigned long anchorMs;
+    bool anchored;
+    long rate;        // Milli-percent per hour at ET 100
+    uint8_t samples;
+    bool dirty;
+    PlanEntry plan;     // As forecast, before spreading
+    uint32_t start;     // Planned start after spreading
+    uint32_t windowEnd; // End of the window the plan sits in (0: none)
+  };
+
+  ZoneRegistry &zones;
+  std::vector<ZonePlan> state;
+  std::vector<PlanEntry> entries;  // Sorted by start, one per planned zone
+  std::vector<uint32_t> laneEnds;  // Scratch for spreading
+  WeatherProfile profile;
+  uint32_t (*wallClock)();
+  uint32_t wallBase;   // Wall seconds at msBase
+  unsigned long msBase;
+
+  uint32_t wallAt(unsigned long now) const { return wallBase + (now - msBase) / 1000; }
+  int etAt(uint32_t wall) const { return profile.etPercent[(wall / 3600) % 24]; }
+  // Seconds until percent drops to target, 0 if not within the horizon
+  uint32_t secondsUntil(int percent, int target, long rate, uint32_t wall) const;
+  // Forecast reading after the given seconds
+  int percentAfter(int percent, long rate, uint32_t wall, uint32_t seconds) const;
+  void planZone(size_t index, uint32_t wall);
+  static bool inWindow(uint32_t wall);
+};
+
+#endif // WATERING_PLANNER_H
@@ -1,19 +1,33 @@
 #include "WateringZone.h"
+#include <string.h>
+#include "EventLog.h"
+#include "Metrics.h"
 
-// Define the static member
-Preferences WateringZone::preferences;
+static int readAdc(int pin)
+{
+  return hal().adc->read(pin);
+}
+
+static int clampInt(int value, int low, int high)
+{
+  return value < low ? low : (value > high ? high : value);
+}
+
+// Define the static members
+SettingsStore WateringZone::settings;
+SensorSampler WateringZone::sampler(readAdc);
+RuntimeState WateringZone::runtime;
+PumpCutoff WateringZone::cutoff;
+std::mutex WateringZone::historyMutex;
 
 // Constructor implementation
-WateringZone::WateringZone(int zoneId, const String &zoneName, int sensorPin, int relayPin)
-    : id(zoneId), name(zoneName), moisturePin(sensorPin), pumpPin(relayPin)
+WateringZone::WateringZone(int zoneId, const char *zoneName, int sensorPin, int relayPin)
+    : id(zoneId), moisturePin(sensorPin), pumpPin(relayPin), sensorChannel(-1), filterConfig(DEFAULT_FILTER),
+      defaultWetThreshold(DEFAULT_WET_THRESHOLD), defaultDryThreshold(DEFAULT_DRY_THRESHOLD),
+      hot(nullptr), slot(-1)
 {
-  // Runtime state only
-  soilMoistureRaw = 0;
-  soilMoisturePercent = 0;
-  pumpState = false;
-  pumpStartTime = 0;
-  pumpStopTime = 0;
-  pumpStoppedByTimeout = false;
+  strncpy(name, zoneName, ZONE_NAME_LEN - 1);
+  name[ZONE_NAME_LEN - 1] = '\0';
 }
 
 void WateringZone::init()
@@ -21,170 +35,504 @@ void WateringZone::init()
   // Validate pin numbers
   if (moisturePin < 0 || pumpPin < 0)
   {
-    Serial.printf("Zone %d: Invalid pin configuration - Sensor: GPIO%d, Pump: GPIO%d\n",
-                  id, moisturePin, pumpPin);
+    LOG_ERROR(LOG_ZONE_INVALID_PINS, id, moisturePin, pumpPin);
     return;
   }
 
   // Load settings from NVS with defaults
   loadSettings();
+  DosingModel model;
+  if (settings.loadModel(id, model))
+  {
+    dosing.restore(model.gain, model.soakMs);
+  }
 
-  // Initialize hardware
-  pinMode(moisturePin, INPUT);
-  pinMode(pumpPin, OUTPUT);
-  digitalWrite(pumpPin, LOW);
-  Serial.printf("Zone %d (%s) initialized - Sensor: GPIO%d, Pump: GPIO%d\n",
-                id, name.c_str(), moisturePin, pumpPin);
+  // Initialize hardware; external sensors belong to their backend
+  if (!isExternalSensor(moisturePin))
+  {
+    hal().gpio->setInput(moisturePin);
+  }
+  hal().gpio->setOutput(pumpPin);
+  hal().gpio->write(pumpPin, false);
+
+  // Register with the background sampler and take one reading so the first
+  // update already has a valid value
+  sensorChannel = sampler.addChannel(moisturePin, filterConfig);
+  if (sensorChannel < 0)
+  {
+    // Its backend is not built in; the zone stays stale and never waters
+    LOG_ERROR(LOG_ZONE_INVALID_PINS, id, moisturePin, pumpPin);
+    return;
+  }
+  sampler.prime(sensorChannel, halMillis());
+  hot->channel[slot] = (int16_t)sensorChannel;
+
+  // A reset must not cut a cooldown short
+  restoreRuntime();
+
+  LOG_INFO(LOG_ZONE_INITIALIZED, id, moisturePin, pumpPin);
 }
 
 void WateringZone::loadSettings()
 {
-  String prefix = "zone" + String(id) + "_";
-  preferences.begin("watering", true);
-
-  // Load all settings with defaults
-  moistureThresholdWet = preferences.getInt((prefix + "wet").c_str(), DEFAULT_WET_THRESHOLD);
-  moistureThresholdDry = preferences.getInt((prefix + "dry").c_str(), DEFAULT_DRY_THRESHOLD);
-  airValue = preferences.getInt((prefix + "air").c_str(), DEFAULT_AIR_VALUE);
-  dryValue = preferences.getInt((prefix + "dryVal").c_str(), DEFAULT_DRY_VALUE);
-  waterValue = preferences.getInt((prefix + "water").c_str(), DEFAULT_WATER_VALUE);
+  ZoneSettings stored = {};
+  stored.wetThreshold = defaultWetThreshold;
+  stored.dryThreshold = defaultDryThreshold;
+  stored.airValue = DEFAULT_AIR_VALUE;
+  stored.dryValue = DEFAULT_DRY_VALUE;
+  stored.waterValue = DEFAULT_WATER_VALUE;
+  stored.maxRuntimeSec = MAX_PUMP_RUNTIME_SEC;
+  stored.cooldownSec = PUMP_COOLDOWN_SEC;
+  stored.mode = ZONE_MODE_THRESHOLD;
 
-  // Load timing values in seconds and convert to milliseconds
-  int runtimeSec = preferences.getInt((prefix + "maxRun").c_str(), MAX_PUMP_RUNTIME_SEC);
-  int cooldownSec = preferences.getInt((prefix + "cooldown").c_str(), PUMP_COOLDOWN_SEC);
-  maxPumpRuntimeMs = runtimeSec * 1000UL;
-  pumpCooldownMs = cooldownSec * 1000UL;
+  // Falls back to the defaults above if nothing valid is stored
+  settings.load(id, stored);
 
-  preferences.end();
+  moistureThresholdWet = stored.wetThreshold;
+  moistureThresholdDry = stored.dryThreshold;
+  airValue = stored.airValue;
+  dryValue = stored.dryValue;
+  waterValue = stored.waterValue;
+  maxPumpRuntimeMs = stored.maxRuntimeSec * 1000UL;
+  pumpCooldownMs = stored.cooldownSec * 1000UL;
+  dosingMode = stored.mode == ZONE_MODE_DOSING;
 
   // Simple validation - fix invalid threshold settings
   if (moistureThresholdWet <= moistureThresholdDry)
   {
-    moistureThresholdWet = DEFAULT_WET_THRESHOLD;
-    moistureThresholdDry = DEFAULT_DRY_THRESHOLD;
-    Serial.printf("Zone %d: Fixed invalid thresholds\n", id);
+    moistureThresholdWet = defaultWetThreshold;
+    moistureThresholdDry = defaultDryThreshold;
+    LOG_WARN(LOG_THRESHOLDS_FIXED, id, moistureThresholdWet, moistureThresholdDry);
+  }
+
+  LOG_INFO(LOG_SETTINGS_LOADED, id, moistureThresholdWet, moistureThresholdDry, maxPumpRuntimeMs / 1000,
+           pumpCooldownMs / 1000, dosingMode);
+  syncThresholds();
+}
+
+void WateringZone::syncThresholds()
+{
+  ZoneHotState &h = *hot;
+  h.airValue[slot] = (int16_t)airValue;
+  h.dryValue[slot] = (int16_t)dryValue;
+  h.waterValue[slot] = (int16_t)waterValue;
+  h.dryThreshold[slot] = (uint8_t)moistureThresholdDry;
+  h.hysteresis[slot] = filterConfig.hysteresis;
+}
+
+void WateringZone::restoreRuntime()
+{
+  unsigned long now = halMillis();
+  unsigned long remainingMs;
+  bool timedOut;
+  if (!runtime.restore(id, pumpCooldownMs, now, remainingMs, timedOut))
+  {
+    return;
   }
 
-  Serial.printf("Zone %d settings loaded: Wet=%d%%, Dry=%d%%, Runtime=%dms, Cooldown=%dms\n",
-                id, moistureThresholdWet, moistureThresholdDry, (int)maxPumpRuntimeMs, (int)pumpCooldownMs);
+  // Backdate the stop so the cooldown ends remainingMs from now (0 means never ran)
+  unsigned long stop = now + remainingMs - pumpCooldownMs;
+  hot->pumpStop[slot] = stop == 0 ? 1 : stop;
+  hot->set(slot, ZONE_STOPPED_BY_TIMEOUT, timedOut);
+  updateDeadline();
+  LOG_INFO(LOG_COOLDOWN_RESTORED, id, remainingMs / 1000, timedOut);
 }
 
-void WateringZone::saveSetting(const String &key, int value)
+void WateringZone::saveRuntime(bool pumpOn)
 {
-  String fullKey = "zone" + String(id) + "_" + key;
-  preferences.begin("watering", false);
-  int currentValue = preferences.getInt(fullKey.c_str(), -1);
-  if (currentValue != value)
+  runtime.save(id, pumpOn, hot->has(slot, ZONE_STOPPED_BY_TIMEOUT), !pumpOn && isPumpInCooldown(),
+               cooldownEndTime());
+}
+
+ZoneSettings WateringZone::currentSettings() const
+{
+  ZoneSettings current = {};
+  current.wetThreshold = moistureThresholdWet;
+  current.dryThreshold = moistureThresholdDry;
+  current.airValue = airValue;
+  current.dryValue = dryValue;
+  current.waterValue = waterValue;
+  current.maxRuntimeSec = maxPumpRuntimeMs / 1000;
+  current.cooldownSec = pumpCooldownMs / 1000;
+  current.mode = dosingMode ? ZONE_MODE_DOSING : ZONE_MODE_THRESHOLD;
+  return current;
+}
+
+void WateringZone::flushSettings(bool force)
+{
+  int written = settings.flush(halMillis(), force);
+  if (written > 0)
   {
-    preferences.putInt(fullKey.c_str(), value);
-    Serial.printf("Zone %d: %s updated: %d -> %d\n", id, key.c_str(), currentValue, value);
+    LOG_INFO(LOG_SETTINGS_SAVED, written);
   }
-  preferences.end();
 }
 
-void WateringZone::updateSoilMoisture()
+bool WateringZone::applyConfig(const ZoneConfigRequest &request)
 {
-  // Read sensor
-  readSensor();
+  bool settingsChanged = false;
 
-  // Safety check: Don't run pump if sensor is reading air (not in soil)
-  if (soilMoistureRaw >= airValue)
+  if (request.wetThreshold >= 0)
   {
-    if (pumpState)
+    int newValue = clampInt(request.wetThreshold, 0, 100);
+    if (moistureThresholdWet != newValue)
     {
-      turnPumpOff();
-      pumpStoppedByTimeout = false; // Reset timeout flag (safety stop)
-      Serial.printf("Zone %d: Pump stopped - sensor in air (raw: %d >= air: %d)\n",
-                    id, soilMoistureRaw, airValue);
+      moistureThresholdWet = newValue;
+      settingsChanged = true;
+    }
+  }
+
+  if (request.dryThreshold >= 0)
+  {
+    int newValue = clampInt(request.dryThreshold, 0, 100);
+    if (moistureThresholdDry != newValue)
+    {
+      moistureThresholdDry = newValue;
+      settingsChanged = true;
+    }
+  }
+
+  if (moistureThresholdWet <= moistureThresholdDry)
+  {
+    moistureThresholdWet = moistureThresholdDry + 10;
+    LOG_WARN(LOG_THRESHOLDS_FIXED, id, moistureThresholdWet, moistureThresholdDry);
+    settingsChanged = true;
+  }
+
+  if (request.airValue >= 0)
+  {
+    int newValue = clampInt(request.airValue, 0, CONFIG_ADC_MAX);
+    if (airValue != newValue)
+    {
+      airValue = newValue;
+      settingsChanged = true;
+    }
+  }
+
+  if (request.dryValue >= 0)
+  {
+    int newValue = clampInt(request.dryValue, 0, CONFIG_ADC_MAX);
+    if (dryValue != newValue)
+    {
+      dryValue = newValue;
+      settingsChanged = true;
+    }
+  }
+
+  if (request.waterValue >= 0)
+  {
+    int newValue = clampInt(request.waterValue, 0, CONFIG_ADC_MAX);
+    if (waterValue != newValue)
+    {
+      waterValue = newValue;
+      settingsChanged = true;
+    }
+  }
+
+  if (request.maxRuntimeSec >= 0)
+  {
+    int newValue = clampInt(request.maxRuntimeSec, 1, CONFIG_RUNTIME_SEC_MAX);
+    unsigned long newValueMs = newValue * 1000UL;
+    if (maxPumpRuntimeMs != newValueMs)
+    {
+      maxPumpRuntimeMs = newValueMs;
+      settingsChanged = true;
+    }
+  }
+
+  if (request.cooldownSec >= 0)
+  {
+    int newValue = clampInt(request.cooldownSec, 1, CONFIG_COOLDOWN_SEC_MAX);
+    unsigned long newValueMs = newValue * 1000UL;
+    if (pumpCooldownMs != newValueMs)
+    {
+      pumpCooldownMs = newValueMs;
+      settingsChanged = true;
+    }
+  }
+
+  if (request.mode >= 0)
+  {
+    bool newValue = request.mode == ZONE_MODE_DOSING;
+    if (dosingMode != newValue)
+    {
+      dosingMode = newValue;
+      dosing.abort();
+      settingsChanged = true;
+    }
+  }
+
+  // All changes of one request become a single staged write
+  if (settingsChanged)
+  {
+    settings.stage(id, currentSettings(), halMillis());
+    syncThresholds();
+    updateDeadline();
+  }
+  return settingsChanged;
+}
+
+void WateringZone::fillSnapshot(ZoneSnapshot &out) const
+{
+  out.id = id;
+  memcpy(out.name, name, ZONE_NAME_LEN);
+
+  out.moistureRaw = moistureRaw();
+  out.moisturePercent = moisturePercent();
+  out.pumpState = isPumpOn();
+  out.sensorInAir = isSensorInAir();
+  out.sensorStale = isSensorStale();
+  out.inCooldown = isPumpInCooldown();
+  out.cooldownRemainingSec = getRemainingCooldownSeconds();
+  out.stoppedByTimeout = hot->has(slot, ZONE_STOPPED_BY_TIMEOUT);
+
+  out.wetThreshold = moistureThresholdWet;
+  out.dryThreshold = moistureThresholdDry;
+  out.airValue = airValue;
+  out.dryValue = dryValue;
+  out.waterValue = waterValue;
+  out.maxRuntimeSec = maxPumpRuntimeMs / 1000;
+  out.cooldownSec = pumpCooldownMs / 1000;
+  out.dosingMode = dosingMode;
+  out.doseGain = dosing.gainMilliPercentPerSec();
+  out.doseSoakSec = dosing.hasModel() ? dosing.soakTimeMs() / 1000 : 0;
+}
+
+bool WateringZone::updateSoilMoisture()
+{
+  ZoneHotState &h = *hot;
+  bool wasOn = h.has(slot, ZONE_PUMP_ON);
+
+  LOG_DEBUG(LOG_SENSOR_READING, id, h.raw[slot], h.percent[slot]);
+  if (sensorChannel >= 0)
+  {
+    std::lock_guard<std::mutex> lock(historyMutex);
+    history.record(MoistureHistory::now(halMillis()), h.raw[slot]);
+  }
+  if (dosingMode && !h.has(slot, ZONE_PUMP_ON))
+  {
+    dosing.observe(h.percent[slot], moistureThresholdWet, halMillis());
+    if (dosing.hasModel())
+    {
+      settings.stageModel(id, (int32_t)dosing.gainMilliPercentPerSec(), (uint32_t)dosing.soakTimeMs(), halMillis());
     }
-    return; // Skip pump control logic
   }
 
-  // Simple state machine for pump control
-  if (pumpState)
+  bool inAir = h.has(slot, ZONE_IN_AIR);
+  bool stale = h.has(slot, ZONE_SENSOR_STALE);
+  bool wantsPump = false;
+  if (inAir || stale)
+  {
+    // Safety check: Don't run pump if sensor is reading air (not in soil) or no longer reads at all
+    if (h.has(slot, ZONE_PUMP_ON))
+    {
+      turnPumpOff();
+      dosing.abort();
+      h.set(slot, ZONE_STOPPED_BY_TIMEOUT, false); // Safety stop
+      if (stale)
+      {
+        LOG_WARN(LOG_PUMP_STALE_STOP, id, moisturePin);
+      }
+      else
+      {
+        LOG_WARN(LOG_PUMP_AIR_STOP, id, h.raw[slot], airValue);
+      }
+    }
+  }
+  else if (h.has(slot, ZONE_PUMP_ON))
   {
     // Pump is ON - check if we should turn it OFF
-    if (soilMoisturePercent >= moistureThresholdWet)
+    if (h.percent[slot] >= moistureThresholdWet)
     {
       // Reached wet threshold - normal completion
       turnPumpOff();
-      pumpStoppedByTimeout = false; // Reset timeout flag (successful completion)
+      h.set(slot, ZONE_STOPPED_BY_TIMEOUT, false);
     }
     else if (isPumpTimedOut())
     {
-      // Timed out before reaching wet threshold
+      // Timed out before reaching wet threshold (or end of a dosing pulse)
       turnPumpOff();
-      pumpStoppedByTimeout = true; // Set timeout flag
+      h.set(slot, ZONE_STOPPED_BY_TIMEOUT, !dosingMode);
+      if (!dosingMode)
+      {
+        METRIC_COUNT(COUNTER_PUMP_TIMEOUTS);
+      }
     }
   }
   else
   {
-    // Pump is OFF - check if we should turn it ON
-    bool shouldStart = false;
+    // Pump is OFF - the scheduler decides when it may start
+    wantsPump = wantsToStart();
+  }
+
+  if (wasOn && !h.has(slot, ZONE_PUMP_ON))
+  {
+    saveRuntime(false);
+  }
+  else if (!wasOn && runtime.savedCooldown(id) && !isPumpInCooldown())
+  {
+    // Cooldown over: a power-on must not start it again from the NVS byte
+    saveRuntime(false);
+  }
+  updateDeadline();
+  return wantsPump;
+}
 
-    if (pumpStoppedByTimeout)
+bool WateringZone::wantsToStart(bool planned) const
+{
+  if (isPumpOn() || isSensorInAir() || isSensorStale())
+  {
+    return false;
+  }
+
+  if (dosingMode)
+  {
+    // Pulses of one dose are spaced by the learned soak, not the cooldown
+    if (dosing.isSoaking())
     {
-      // Continue watering if still below wet threshold after timeout
-      shouldStart = (soilMoisturePercent < moistureThresholdWet) && !isPumpInCooldown();
+      return false;
     }
-    else
+    if (dosing.wantsMore())
     {
-      // Normal start condition: reached dry threshold
-      shouldStart = (soilMoisturePercent <= moistureThresholdDry) && !isPumpInCooldown();
+      return true;
     }
+  }
 
-    if (shouldStart)
-    {
-      turnPumpOn();
-    }
+  if (isPumpInCooldown())
+  {
+    return false;
+  }
+
+  if (hot->has(slot, ZONE_STOPPED_BY_TIMEOUT))
+  {
+    // Continue watering if still below wet threshold after timeout
+    return moisturePercent() < moistureThresholdWet;
   }
+
+  // Normal start condition: reached dry threshold
+  return hot->has(slot, ZONE_DRY) || (planned && moisturePercent() < moistureThresholdWet);
 }
 
-void WateringZone::readSensor()
+void WateringZone::updateDeadline()
 {
-  // Average multiple readings
-  int sum = 0;
-  for (int i = 0; i < SENSOR_SAMPLES; i++)
+  ZoneHotState &h = *hot;
+  if (h.has(slot, ZONE_PUMP_ON))
+  {
+    // isPumpTimedOut() needs strictly more than the run limit
+    h.deadline[slot] = h.pumpStart[slot] + pumpRunLimit() + 1;
+    h.set(slot, ZONE_HAS_DEADLINE, true);
+    cutoff.arm(slot, pumpPin, h.pumpStart[slot] + pumpRunLimit());
+  }
+  else if (dosingMode && dosing.isSoaking())
+  {
+    h.deadline[slot] = dosing.soakEndTime();
+    h.set(slot, ZONE_HAS_DEADLINE, true);
+  }
+  else if (isPumpInCooldown() && h.has(slot, ZONE_STOPPED_BY_TIMEOUT | ZONE_DRY))
   {
-    sum += analogRead(moisturePin);
-    delay(SENSOR_DELAY_MS);
+    h.deadline[slot] = cooldownEndTime();
+    h.set(slot, ZONE_HAS_DEADLINE, true);
   }
-  soilMoistureRaw = sum / SENSOR_SAMPLES;
+  else
+  {
+    h.set(slot, ZONE_HAS_DEADLINE, false);
+  }
+}
+
+bool WateringZone::startPump(bool planned)
+{
+  // Re-check, the request may have waited for a free slot
+  if (!wantsToStart(planned))
+  {
+    return false;
+  }
+  if (dosingMode)
+  {
+    unsigned long pulseMs = dosing.pulseLength(moisturePercent(), moistureThresholdWet, maxPumpRuntimeMs);
+    dosing.pulseStarted(moisturePercent(), halMillis(), pulseMs);
+    LOG_INFO(LOG_DOSING_PULSE, id, pulseMs, dosing.gainMilliPercentPerSec(), dosing.soakTimeMs() / 1000);
+  }
+  // Saved before the relay closes: pump inrush is the likeliest brownout
+  saveRuntime(true);
+  turnPumpOn();
+  updateDeadline();
+  return true;
+}
+
+unsigned long WateringZone::cooldownEndTime() const
+{
+  unsigned long stop = hot->pumpStop[slot];
+  return stop == 0 ? 0 : stop + pumpCooldownMs;
+}
 
-  // Convert to percentage
-  soilMoisturePercent = map(soilMoistureRaw, dryValue, waterValue, 0, 100);
-  soilMoisturePercent = constrain(soilMoisturePercent, 0, 100);
+void WateringZone::sampleSensors()
+{
+  sampler.tick(halMillis());
+}
+
+void WateringZone::collectReadings(ZoneHotState &state)
+{
+  unsigned long now = halMillis();
+  size_t count = state.size();
+  for (size_t i = 0; i < count; i++)
+  {
+    // Filter chain output maintained by the background sampler
+    int channel = state.channel[i];
+    if (channel >= 0 && sampler.hasSamples(channel))
+    {
+      state.raw[i] = sampler.filtered(channel);
+      state.flags[i] |= ZONE_HAS_READING;
+    }
+    state.set(i, ZONE_SENSOR_STALE, channel < 0 || sampler.isStale(channel, now));
+  }
 }
 
 void WateringZone::turnPumpOn()
 {
-  pumpState = true;
-  pumpStartTime = millis();
-  digitalWrite(pumpPin, HIGH);
-  Serial.printf("Zone %d pump ON - moisture: %d%%\n", id, soilMoisturePercent);
+  hot->set(slot, ZONE_PUMP_ON, true);
+  hot->pumpStart[slot] = halMillis();
+  hal().gpio->write(pumpPin, true);
+  METRIC_COUNT(COUNTER_PUMP_STARTS);
+  LOG_INFO(LOG_PUMP_ON, id, moisturePercent());
 }
 
 void WateringZone::turnPumpOff()
 {
-  pumpState = false;
-  pumpStopTime = millis();
-  pumpStartTime = 0;
-  digitalWrite(pumpPin, LOW);
-  Serial.printf("Zone %d pump OFF - moisture: %d%%\n", id, soilMoisturePercent);
+  // The cutoff timer may have opened the relay while this task was held up
+  unsigned long cutAtMs;
+  bool cut = cutoff.disarm(slot, cutAtMs);
+  unsigned long stop = cut ? cutAtMs : halMillis();
+  hot->set(slot, ZONE_PUMP_ON, false);
+  hot->pumpStop[slot] = stop;
+  hot->pumpStart[slot] = 0;
+  if (!cut)
+  {
+    hal().gpio->write(pumpPin, false);
+  }
+  if (dosingMode)
+  {
+    dosing.pulseStopped(stop);
+  }
+  LOG_INFO(LOG_PUMP_OFF, id, moisturePercent());
 }
 
 bool WateringZone::isPumpTimedOut() const
 {
-  return (millis() - pumpStartTime) > maxPumpRuntimeMs;
+  return (halMillis() - hot->pumpStart[slot]) > pumpRunLimit();
+}
+
+unsigned long WateringZone::pumpRunLimit() const
+{
+  return dosingMode ? dosing.pulseMs() : maxPumpRuntimeMs;
 }
 
 bool WateringZone::isPumpInCooldown() const
 {
-  if (pumpStopTime == 0)
+  unsigned long stop = hot->pumpStop[slot];
+  if (stop == 0)
   {
     return false; // Never ran
   }
-  return (millis() - pumpStopTime) < pumpCooldownMs;
+  return (halMillis() - stop) < pumpCooldownMs;
 }
 
 unsigned long WateringZone::getRemainingCooldownSeconds() const
@@ -193,11 +541,16 @@ unsigned long WateringZone::getRemainingCooldownSeconds() const
   {
     return 0;
   }
-  unsigned long remainingMs = pumpCooldownMs - (millis() - pumpStopTime);
+  unsigned long remainingMs = pumpCooldownMs - (halMillis() - hot->pumpStop[slot]);
   return remainingMs / 1000;
 }
 
 bool WateringZone::isSensorInAir() const
 {
-  return soilMoistureRaw >= airValue;
+  return hot->has(slot, ZONE_IN_AIR);
+}
+
+bool WateringZone::isSensorStale() const
+{
+  return hot->has(slot, ZONE_SENSOR_STALE);
 }
@@ -1,8 +1,17 @@
 #ifndef WATERING_ZONE_H
 #define WATERING_ZONE_H
 
-#include <Arduino.h>
-#include <Preferences.h>
+#include <mutex>
+#include "DosingController.h"
+#include "Hal.h"
+#include "MoistureFilter.h"
+#include "MoistureHistory.h"
+#include "PumpCutoff.h"
+#include "RuntimeState.h"
+#include "SensorSampler.h"
+#include "SettingsStore.h"
+#include "ZoneHotState.h"
+#include "ZoneSnapshot.h"
 
 // Default configuration values
 const int DEFAULT_WET_THRESHOLD = 80;
@@ -11,20 +20,45 @@ const int DEFAULT_AIR_VALUE = 3700;
 const int DEFAULT_DRY_VALUE = 3200;
 const int DEFAULT_WATER_VALUE = 1500;
 
-// Sensor reading constants
-const int SENSOR_SAMPLES = 5;
-const int SENSOR_DELAY_MS = 10;
+static_assert(DEFAULT_WET_THRESHOLD > DEFAULT_DRY_THRESHOLD, "pump would never stop before it starts again");
+static_assert(DEFAULT_AIR_VALUE > DEFAULT_DRY_VALUE && DEFAULT_DRY_VALUE > DEFAULT_WATER_VALUE,
+              "capacitive sensors read lower when wetter");
+
+// Pump timing constants
 const int MAX_PUMP_RUNTIME_SEC = 30; // 30 seconds max pump runtime
 const int PUMP_COOLDOWN_SEC = 300;   // 5 minutes (300 seconds) cooldown
 
+// Accepted setting ranges; applyConfig() clamps, configuration documents are rejected
+const int CONFIG_ADC_MAX = 4095;
+const int CONFIG_RUNTIME_SEC_MAX = 300;
+const int CONFIG_COOLDOWN_SEC_MAX = 3600;
+
+// Settings submitted from the web interface, -1 means "not submitted"
+struct ZoneConfigRequest
+{
+  int zoneId;
+  int wetThreshold;
+  int dryThreshold;
+  int airValue;
+  int dryValue;
+  int waterValue;
+  int maxRuntimeSec;
+  int cooldownSec;
+  int mode; // ZONE_MODE_*
+};
+
 class WateringZone
 {
 public:
   // Configuration
-  String name;
+  char name[ZONE_NAME_LEN];
   int id;
   int moisturePin;
   int pumpPin;
+  int sensorChannel; // Slot in the shared sensor sampler (-1 if not initialized)
+  FilterConfig filterConfig; // Sensor filter chain, applied by init()
+  int defaultWetThreshold;   // Used until settings are saved for this zone
+  int defaultDryThreshold;
 
   // Settings
   int moistureThresholdWet;
@@ -34,35 +68,88 @@ public:
   int waterValue;
   unsigned long maxPumpRuntimeMs; // Runtime in milliseconds (for efficient timing checks)
   unsigned long pumpCooldownMs;   // Cooldown in milliseconds (for efficient timing checks)
+  bool dosingMode;                // Learned pulses instead of running to the wet threshold
 
-  // Runtime state
-  int soilMoistureRaw;
-  int soilMoisturePercent;
-  bool pumpState;
-  unsigned long pumpStartTime;
-  unsigned long pumpStopTime;
-  bool pumpStoppedByTimeout; // Track if pump was stopped due to timeout
+  MoistureHistory history; // Raw readings of every evaluation, guarded by historyMutex
+  // Held by the control task only while it records one sample, so web
+  // readers never wait for pump switching or flash writes
+  static std::mutex historyMutex;
+  DosingController dosing; // Response model and dose state (dosing mode)
 
   // Constructor
-  WateringZone(int zoneId, const String &zoneName, int sensorPin, int relayPin);
+  WateringZone(int zoneId, const char *zoneName, int sensorPin, int relayPin);
 
   // Methods
   void init();
   void loadSettings();
-  void saveSetting(const String &key, int value);
-  void updateSoilMoisture();
+  // Acts on the zone's latest reading (see collectReadings()) and stops the
+  // pump when needed. Returns true if the zone wants its pump started; that
+  // is left to the scheduler.
+  bool updateSoilMoisture();
+  // planned: an early run from the WateringPlanner, the zone need not be dry yet
+  bool wantsToStart(bool planned = false) const;
+  bool startPump(bool planned = false);
+  unsigned long cooldownEndTime() const;
   bool isPumpInCooldown() const;
   unsigned long getRemainingCooldownSeconds() const;
   bool isSensorInAir() const;
+  // Failed reads in a row or no reading for a while; blocks the pump like air
+  bool isSensorStale() const;
+  bool applyConfig(const ZoneConfigRequest &request);
+  void fillSnapshot(ZoneSnapshot &out) const;
+
+  // Runtime state lives in the registry's hot arrays (see ZoneRegistry)
+  void bind(ZoneHotState *state, int index) { hot = state; slot = index; }
+  int moistureRaw() const { return hot->raw[slot]; }
+  int moisturePercent() const { return hot->percent[slot]; }
+  bool isPumpOn() const { return hot->has(slot, ZONE_PUMP_ON); }
+  bool isDry() const { return hot->has(slot, ZONE_DRY); }
+
+  // Collect pending ADC samples for all zones (non-blocking, call from loop())
+  static void sampleSensors();
+  // Copies the filtered value of every initialized zone into the hot arrays,
+  // for ZoneRegistry::evaluateThresholds(), and marks zones whose channel is
+  // stale or missing
+  static void collectReadings(ZoneHotState &state);
+  static unsigned long nextSampleTime(unsigned long now) { return sampler.nextDueTime(now); }
+  // Every raw conversion of all zones, for recording traces (SensorTrace.h)
+  static void setSampleObserver(SampleObserver observer) { sampler.setObserver(observer); }
+  // Forgets the channels and backends of earlier zones, before a host run builds new ones
+  static void resetSensors() { sampler.clear(); }
+  // Multiplexers and bus ADCs, before the zones' init(); returns the number for sensorAddress()
+  static int addSensorBackend(SensorBackend *backend) { return sampler.addBackend(backend); }
+  // Write debounced setting changes of all zones to flash
+  static void flushSettings(bool force = false);
+  static bool nextSettingsFlush(unsigned long &deadline) { return settings.nextFlushTime(deadline); }
+  // Relay cutoff at the run limit from timer context, one timer per zone slot
+  static bool attachCutoffTimer(int slot, CutoffTimer *timer) { return cutoff.attach(slot, timer); }
+  static CutoffStats cutoffStats() { return cutoff.stats(); }
+  static void resetCutoff() { cutoff.reset(); }
+  // Pump state kept across resets: begin before the zones' init(), touch every tick
+  static void beginRuntime() { runtime.begin(); }
+  static void touchRuntime(unsigned long now) { runtime.touch(now); }
 
 private:
-  static Preferences preferences; // Shared by all zones
+  ZoneHotState *hot;
+  int slot;
+
+  static SettingsStore settings;   // Shared by all zones
+  static SensorSampler sampler;   // Shared by all zones
+  static RuntimeState runtime;    // Shared by all zones
+  static PumpCutoff cutoff;       // Shared by all zones
 
   // Simple control methods
-  void readSensor();
+  void syncThresholds();
+  ZoneSettings currentSettings() const;
   void turnPumpOn();
   void turnPumpOff();
+  void restoreRuntime();
+  void saveRuntime(bool pumpOn);
   bool isPumpTimedOut() const;
+  unsigned long pumpRunLimit() const;
+  // Stores when this zone must be re-evaluated regardless of its schedule
+  // slot (pump timeout or end of a cooldown it is waiting for)
+  void updateDeadline();
 };
 
 #endif // WATERING_ZONE_H
@@ -0,0 +1,98 @@
+#ifdef ARDUINO
+#include "WebRoutes.h"
+
+SystemSnapshot webSnapshot;
+char jsonBuffer[WEB_BUFFER_SIZE];
+
+static uint32_t clientAddress(AsyncWebServerRequest *request)
+{
+  IPAddress ip = request->client()->remoteIP();
+  return ((uint32_t)ip[0] << 24) | ((uint32_t)ip[1] << 16) | ((uint32_t)ip[2] << 8) | ip[3];
+}
+
+void admitRequest(AsyncWebServerRequest *request, ArMiddlewareNext next)
+{
+  RequestClass kind = classifyRequest(request->url().c_str());
+  uint32_t client = clientAddress(request);
+  unsigned long now = millis();
+  switch (admission.admit(client, kind, now))
+  {
+  case ADMIT:
+    next();
+    return;
+  case REJECT_RATE:
+  {
+    AsyncWebServerResponse *response = request->beginResponse(429, "text/plain", "Too many requests");
+    response->addHeader("Retry-After", String(admission.retryAfterSec(client, kind, now)));
+    request->send(response);
+    return;
+  }
+  case REJECT_BUSY:
+  case REJECT_LOW_HEAP:
+  {
+    AsyncWebServerResponse *response = request->beginResponse(503, "text/plain", "Busy, try again");
+    response->addHeader("Retry-After", "1");
+    request->send(response);
+    return;
+  }
+  }
+}
+
+bool readSnapshot(AsyncWebServerRequest *request)
+{
+  if (!controller.readSnapshot(webSnapshot))
+  {
+    request->send(503, "text/plain", "Starting up, try again");
+    return false;
+  }
+  return true;
+}
+
+std::shared_ptr<RenderSlot> renderSlot(AsyncWebServerRequest *request)
+{
+  std::shared_ptr<RenderSlot> slot = admission.acquireRender();
+  if (!slot)
+  {
+    request->send(503, "text/plain", "Busy, try again");
+  }
+  return slot;
+}
+
+int paramOrUnset(AsyncWebServerRequest *request, const char *name)
+{
+  if (!request->hasParam(name))
+  {
+    return -1;
+  }
+  return request->getParam(name)->value().toInt();
+}
+
+void readConfigParams(AsyncWebServerRequest *request, ZoneConfigRequest &config)
+{
+  config.wetThreshold = paramOrUnset(request, "wetThreshold");
+  config.dryThreshold = paramOrUnset(request, "dryThreshold");
+  config.airValue = paramOrUnset(request, "airValue");
+  config.dryValue = paramOrUnset(request, "dryValue");
+  config.waterValue = paramOrUnset(request, "waterValue");
+  config.maxRuntimeSec = paramOrUnset(request, "maxRuntime");
+  config.cooldownSec = paramOrUnset(request, "cooldown");
+  config.mode = paramOrUnset(request, "mode");
+}
+
+void collectBody(AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total,
+                 size_t limit)
+{
+  if (total > limit)
+  {
+    return;
+  }
+  if (index == 0)
+  {
+    request->_tempObject = malloc(total);
+  }
+  if (request->_tempObject)
+  {
+    memcpy(static_cast<uint8_t *>(request->_tempObject) + index, data, len);
+  }
+}
+#endif
@@ -0,0 +1,86 @@
+#ifndef WEB_ROUTES_H
+#define WEB_ROUTES_H
+
+#ifdef ARDUINO
+#include <ESPAsyncWebServer.h>
+#include <memory>
+#include "RequestAdmission.h"
+#include "StatusApi.h"
+#include "ZoneController.h"
+#include "ZoneTable.h"
+
+// The web server's handlers, one file per feature. main.cpp owns the
+// server, the controller and the admission state and wires them together:
+//   ZoneRoutes.cpp    dashboard, zone status, history and pages, settings,
+//                     plan, weather and the configuration document
+//   StatusRoutes.cpp  power management, /api/power, /api/log, /metrics
+//   UpdateRoutes.cpp  POST /update, replaceable pages, boot confirmation
+//   TraceRoutes.cpp   sensor trace recording (-DSENSOR_TRACE)
+//   MeshRoutes.cpp    mesh node or aggregator (-DMESH_NODE, -DMESH_AGGREGATOR)
+// All handlers run on the AsyncTCP task.
+
+// main.cpp
+extern ZoneController controller;
+extern RequestAdmission admission;
+void wakeLoopTask();
+
+// WebRoutes.cpp: shared by all handlers, one copy is enough on one task
+const size_t WEB_JSON_MAX = STATUS_JSON_MAX > INFO_JSON_MAX ? STATUS_JSON_MAX : INFO_JSON_MAX;
+const size_t WEB_BUFFER_SIZE = WEB_JSON_MAX > CONFIG_JSON_MAX ? WEB_JSON_MAX : CONFIG_JSON_MAX;
+static_assert(WEB_BUFFER_SIZE >= PLAN_JSON_MAX, "jsonBuffer must hold every document");
+extern SystemSnapshot webSnapshot;
+extern char jsonBuffer[WEB_BUFFER_SIZE];
+
+// Runs before every handler, including onNotFound and /events. Refused
+// requests get a short fixed answer and never reach their handler.
+void admitRequest(AsyncWebServerRequest *request, ArMiddlewareNext next);
+// Fills webSnapshot, answers 503 while there is none yet
+bool readSnapshot(AsyncWebServerRequest *request);
+// Streamed responses capture the slot in their filler, it is released when
+// the response is destroyed (sent or connection dropped). Answers 503 when
+// all slots are taken.
+std::shared_ptr<RenderSlot> renderSlot(AsyncWebServerRequest *request);
+int paramOrUnset(AsyncWebServerRequest *request, const char *name);
+// The /zone/N/config query parameters, -1 where absent; zoneId is left alone
+void readConfigParams(AsyncWebServerRequest *request, ZoneConfigRequest &config);
+// Body handler of small uploads: collects the body in _tempObject, which
+// the request frees. Bodies over limit are dropped for the handler to refuse.
+void collectBody(AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total,
+                 size_t limit);
+
+// ZoneRoutes.cpp
+void setupZoneRoutes(AsyncWebServer &server);
+
+// StatusRoutes.cpp
+extern unsigned long webReadyMs; // Set by the network task
+void setupPowerSaving();
+void sampleIdle(); // Loop task
+void setupStatusRoutes(AsyncWebServer &server);
+
+// UpdateRoutes.cpp
+void setupUpdateRoutes(AsyncWebServer &server);
+// The embedded gzip page or its uploaded replacement: "index", "mesh"
+void sendPage(AsyncWebServerRequest *request, const char *name);
+// Loop task: restarts after a firmware update, and keeps a freshly booted
+// image once healthy has held long enough or rolls it back
+void pollUpdates(bool healthy);
+
+#ifdef SENSOR_TRACE
+// TraceRoutes.cpp. setupTrace() goes before the zones' init(), their pump
+// writes then pass the recorder; wallClock may be nullptr.
+void setupTrace(const ZoneDefinition *zones, size_t count, uint32_t (*wallClock)());
+void drainTrace(); // Loop task
+void setupTraceRoutes(AsyncWebServer &server);
+#endif
+
+#if defined(MESH_NODE) || defined(MESH_AGGREGATOR)
+// MeshRoutes.cpp, once WiFi is up
+void setupMesh();
+void pollMesh(); // Loop task
+#endif
+#ifdef MESH_AGGREGATOR
+void setupMeshRoutes(AsyncWebServer &server);
+#endif
+#endif // ARDUINO
+
+#endif // WEB_ROUTES_H
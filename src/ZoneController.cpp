@@ -0,0 +1,333 @@
+#include "ZoneController.h"
+#include <string.h>
+#include "EventLog.h"
+#include "Metrics.h"
+
+ZoneController::ZoneController()
+    : scheduler(zones), planner(zones), scratch(), publishedCrc(0), firstTick(true), firstTickUs(0), wakeHook(nullptr), publishHook(nullptr), wakeups(0), busyUs(0), queueHead(0), queueCount(0), pendingWeather(), weatherPending(false), pendingDocument(), documentPending(false), applyingDocument()
+{
+}
+
+void ZoneController::addZone(const WateringZone &zone)
+{
+  if (zones.add(zone) < 0)
+  {
+    LOG_ERROR(LOG_ZONE_SKIPPED, zone.id);
+  }
+}
+
+void ZoneController::addZones(const ZoneDefinition *table, size_t count)
+{
+  zones.reserve(zones.size() + count);
+  for (size_t i = 0; i < count; i++)
+  {
+    WateringZone zone(table[i].id, table[i].name, table[i].sensorPin, table[i].pumpPin);
+    if (table[i].filter)
+    {
+      zone.filterConfig = *table[i].filter;
+    }
+    if (table[i].wetThreshold)
+    {
+      zone.defaultWetThreshold = table[i].wetThreshold;
+    }
+    if (table[i].dryThreshold)
+    {
+      zone.defaultDryThreshold = table[i].dryThreshold;
+    }
+    addZone(zone);
+  }
+}
+
+void ZoneController::init()
+{
+  WateringZone::beginRuntime();
+  for (auto &zone : zones)
+  {
+    zone.init();
+  }
+  scheduler.init(halMillis());
+  planner.resize(zones.size());
+  if (planner.loadWeather())
+  {
+    LOG_INFO(LOG_WEATHER_LOADED);
+  }
+  scheduler.setPlanner(&planner);
+}
+
+// The id table is fixed after init(), safe to read from any task
+bool ZoneController::hasZone(int zoneId) const
+{
+  return zones.slotOf(zoneId) >= 0;
+}
+
+bool ZoneController::submitConfig(const ZoneConfigRequest &request)
+{
+  std::lock_guard<std::mutex> lock(queueMutex);
+  if (queueCount == CONFIG_QUEUE_SIZE)
+  {
+    return false;
+  }
+  queue[(queueHead + queueCount) % CONFIG_QUEUE_SIZE] = request;
+  queueCount++;
+  if (wakeHook)
+  {
+    wakeHook();
+  }
+  return true;
+}
+
+bool ZoneController::submitWeather(const WeatherProfile &profile)
+{
+  std::lock_guard<std::mutex> lock(queueMutex);
+  pendingWeather = profile;
+  weatherPending = true;
+  if (wakeHook)
+  {
+    wakeHook();
+  }
+  return true;
+}
+
+bool ZoneController::submitDocument(const ConfigDocument &document)
+{
+  std::lock_guard<std::mutex> lock(queueMutex);
+  if (documentPending)
+  {
+    return false;
+  }
+  pendingDocument = document;
+  documentPending = true;
+  if (wakeHook)
+  {
+    wakeHook();
+  }
+  return true;
+}
+
+void ZoneController::tick(unsigned long now)
+{
+  METRIC_TIME(SECTION_CONTROL_TICK);
+  unsigned long startUs = halMicros();
+  if (firstTick)
+  {
+    firstTickUs = startUs;
+    LOG_INFO(LOG_FIRST_TICK, startUs);
+  }
+  WateringZone::touchRuntime(now);
+  WateringZone::sampleSensors();
+  // Every zone's reading is current before any of them is evaluated
+  WateringZone::collectReadings(zones.hot());
+  zones.evaluateThresholds();
+
+  bool changed = applyPendingConfig();
+  if (applyPendingDocument())
+  {
+    changed = true;
+  }
+  else
+  {
+    WateringZone::flushSettings();
+  }
+
+  // Staggered: only the zones that are due this tick
+  planner.beginTick(now);
+  int evaluated = scheduler.tick(now) + scheduler.serviceDeadlines(now);
+  // Only zones evaluated above are forecast again
+  planner.replan(scheduler.maxConcurrentPumps());
+  if (evaluated > 0)
+  {
+    changed = true;
+  }
+
+  publishSnapshot(now, changed || firstTick);
+  firstTick = false;
+
+  wakeups++;
+  busyUs += halMicros() - startUs;
+}
+
+static void takeEarlier(unsigned long &earliest, unsigned long candidate)
+{
+  if ((long)(candidate - earliest) < 0)
+  {
+    earliest = candidate;
+  }
+}
+
+unsigned long ZoneController::nextWakeTime(unsigned long now) const
+{
+  unsigned long earliest = scheduler.nextDueTime();
+  takeEarlier(earliest, WateringZone::nextSampleTime(now));
+
+  unsigned long deadline;
+  if (scheduler.nextDeadline(deadline))
+  {
+    takeEarlier(earliest, deadline);
+  }
+  if (WateringZone::nextSettingsFlush(deadline))
+  {
+    takeEarlier(earliest, deadline);
+  }
+
+  // Never report a time in the past
+  return (long)(earliest - now) < 0 ? now : earliest;
+}
+
+bool ZoneController::applyPendingConfig()
+{
+  bool applied = false;
+  WeatherProfile weather;
+  bool weatherChanged = false;
+  {
+    std::lock_guard<std::mutex> lock(queueMutex);
+    if (weatherPending)
+    {
+      weather = pendingWeather;
+      weatherPending = false;
+      weatherChanged = true;
+    }
+  }
+  if (weatherChanged)
+  {
+    planner.setWeather(weather);
+    planner.saveWeather();
+    LOG_INFO(LOG_WEATHER_UPDATED);
+    applied = true;
+  }
+
+  while (true)
+  {
+    ZoneConfigRequest request;
+    {
+      std::lock_guard<std::mutex> lock(queueMutex);
+      if (queueCount == 0)
+      {
+        break;
+      }
+      request = queue[queueHead];
+      queueHead = (queueHead + 1) % CONFIG_QUEUE_SIZE;
+      queueCount--;
+    }
+
+    // Flash writes happen outside the lock so the web task never waits on NVS
+    WateringZone *zone = findZone(request.zoneId);
+    if (zone && zone->applyConfig(request))
+    {
+      LOG_INFO(LOG_SETTINGS_UPDATED, zone->id);
+    }
+    applied = true;
+  }
+  return applied;
+}
+
+bool ZoneController::applyPendingDocument()
+{
+  ConfigDocument &document = applyingDocument;
+  {
+    std::lock_guard<std::mutex> lock(queueMutex);
+    if (!documentPending)
+    {
+      return false;
+    }
+    document = pendingDocument;
+    documentPending = false;
+  }
+
+  // All zones change within this tick, the scheduler never sees half a document
+  int changed = 0;
+  for (int i = 0; i < document.zoneCount; i++)
+  {
+    WateringZone *zone = findZone(document.zones[i].zoneId);
+    if (zone && zone->applyConfig(document.zones[i]))
+    {
+      changed++;
+    }
+  }
+  if (document.hasWeather)
+  {
+    planner.setWeather(document.weather);
+    planner.saveWeather();
+  }
+  // Skips the debounce: one namespace open, then one blob write per changed
+  // zone. Each write is atomic on its own, the document as a whole is not.
+  WateringZone::flushSettings(true);
+  LOG_INFO(LOG_DOCUMENT_APPLIED, changed, document.zoneCount, document.hasWeather);
+  return true;
+}
+
+void ZoneController::publishSnapshot(unsigned long now, bool force)
+{
+  scratch.controlWakeups = wakeups;
+  scratch.controlBusyUs = busyUs;
+  scratch.firstTickUs = firstTickUs;
+  CutoffStats cutoff = WateringZone::cutoffStats();
+  scratch.pumpCutoffs = cutoff.cutoffs;
+  scratch.cutoffMaxOverrunUs = cutoff.maxOverrunUs;
+  scratch.controlMaxLateUs = cutoff.maxControlLateUs;
+  scratch.planSynced = planner.synced();
+  memcpy(scratch.weather, planner.weather().etPercent, sizeof(scratch.weather));
+  scratch.zoneCount = 0;
+  for (size_t i = 0; i < zones.size() && scratch.zoneCount < MAX_ZONES; i++)
+  {
+    ZoneSnapshot &out = scratch.zones[scratch.zoneCount++];
+    zones.zone(i).fillSnapshot(out);
+    out.dryingRate = planner.dryingRate(i);
+    out.planKind = planner.kind(i);
+    out.planInSec = planner.startsIn(i, now);
+  }
+
+  // Readers poll the version: it only moves when something they show changed,
+  // the activity counters alone do not count
+  uint32_t crc = crc32Update(0, scratch.zones, scratch.zoneCount * sizeof(ZoneSnapshot));
+  crc = crc32Update(crc, &scratch.pumpCutoffs, sizeof(scratch.pumpCutoffs));
+  crc = crc32Update(crc, &scratch.cutoffMaxOverrunUs, sizeof(scratch.cutoffMaxOverrunUs));
+  crc = crc32Update(crc, &scratch.controlMaxLateUs, sizeof(scratch.controlMaxLateUs));
+  crc = crc32Update(crc, &scratch.planSynced, sizeof(scratch.planSynced));
+  crc = crc32Update(crc, scratch.weather, sizeof(scratch.weather));
+  if (!force && crc == publishedCrc)
+  {
+    return;
+  }
+  scratch.takenAtMs = now;
+  snapshots.publish(scratch);
+  publishedCrc = crc;
+  if (publishHook)
+  {
+    publishHook();
+  }
+}
+
+size_t ZoneController::fillHistory(int zoneId, HistoryReader &reader, char *buffer, size_t size)
+{
+  std::lock_guard<std::mutex> lock(WateringZone::historyMutex);
+  WateringZone *zone = findZone(zoneId);
+  if (!zone)
+  {
+    return 0;
+  }
+  return reader.fill(zone->history, buffer, size);
+}
+
+bool ZoneController::copyHistory(size_t index, int &zoneId, MoistureHistory &out)
+{
+  std::lock_guard<std::mutex> lock(WateringZone::historyMutex);
+  if (index >= zones.size())
+  {
+    return false;
+  }
+  zoneId = zones.zone(index).id;
+  out = zones.zone(index).history;
+  return true;
+}
+
+bool ZoneController::restoreHistory(int zoneId, const MoistureHistory &in)
+{
+  std::lock_guard<std::mutex> lock(WateringZone::historyMutex);
+  WateringZone *zone = findZone(zoneId);
+  if (!zone)
+  {
+    return false;
+  }
+  zone->history = in;
+  return true;
+}
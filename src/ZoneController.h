@@ -0,0 +1,83 @@
+#ifndef ZONE_CONTROLLER_H
+#define ZONE_CONTROLLER_H
+
+#include <mutex>
+#include <vector>
+#include "ConfigDocument.h"
+#include "WateringPlanner.h"
+#include "WateringZone.h"
+#include "ZoneRegistry.h"
+#include "ZoneScheduler.h"
+#include "ZoneSnapshot.h"
+#include "ZoneTable.h"
+
+const int CONFIG_QUEUE_SIZE = 8;
+
+// Owns all zones. Only the control task calls tick(); other tasks talk to it
+// through the published snapshot and the config request queue.
+class ZoneController
+{
+public:
+  ZoneController();
+
+  void addZone(const WateringZone &zone);
+  void addZones(const ZoneDefinition *table, size_t count);
+  void init();
+  void tick(unsigned long now);
+  // Absolute millis() of the next moment tick() has work to do
+  unsigned long nextWakeTime(unsigned long now) const;
+  // Called after submitConfig() so an idle control task wakes up at once
+  void setWakeHook(void (*hook)()) { wakeHook = hook; }
+  // Called from the control task after a snapshot with new content is published
+  void setPublishHook(void (*hook)()) { publishHook = hook; }
+
+  // Thread-safe, may be called from the web server task
+  bool submitConfig(const ZoneConfigRequest &request);
+  bool readSnapshot(SystemSnapshot &out) const { return snapshots.read(out); }
+  uint32_t snapshotVersion() const { return snapshots.version(); }
+  bool hasZone(int zoneId) const;
+  // History access from other tasks; each call holds the history lock briefly
+  size_t fillHistory(int zoneId, HistoryReader &reader, char *buffer, size_t size);
+  bool copyHistory(size_t index, int &zoneId, MoistureHistory &out);
+  bool restoreHistory(int zoneId, const MoistureHistory &in);
+  void setMaxConcurrentPumps(int limit) { scheduler.setMaxConcurrentPumps(limit); }
+  // Local wall time for the planner (seconds, 0 while unknown); without it zones run on thresholds only
+  void setWallClock(uint32_t (*clock)()) { planner.setWallClock(clock); }
+  // Thread-safe; applied and stored in NVS by the control task
+  bool submitWeather(const WeatherProfile &profile);
+  // Thread-safe; a validated document is applied in one tick and saved
+  // right away, one NVS write per changed zone plus the weather. False
+  // while the previous document is still pending.
+  bool submitDocument(const ConfigDocument &document);
+
+private:
+  ZoneRegistry zones;
+  ZoneScheduler scheduler;
+  WateringPlanner planner;
+  SnapshotStore snapshots;
+  SystemSnapshot scratch; // Built here, then copied into the store
+  uint32_t publishedCrc; // Of the content of the last published snapshot
+  bool firstTick;
+  unsigned long firstTickUs; // halMicros() at the first tick, i.e. time from boot to control
+  void (*wakeHook)();
+  void (*publishHook)();
+  unsigned long wakeups;
+  unsigned long busyUs;
+
+  mutable std::mutex queueMutex;
+  ZoneConfigRequest queue[CONFIG_QUEUE_SIZE];
+  int queueHead;
+  int queueCount;
+  WeatherProfile pendingWeather;
+  bool weatherPending;
+  ConfigDocument pendingDocument;
+  bool documentPending;
+  ConfigDocument applyingDocument; // Control task copy, applied outside the lock
+
+  bool applyPendingConfig();
+  bool applyPendingDocument();
+  WateringZone *findZone(int zoneId) { return zones.find(zoneId); }
+  void publishSnapshot(unsigned long now, bool force);
+};
+
+#endif // ZONE_CONTROLLER_H
@@ -0,0 +1,53 @@
+#include "ZoneEventStream.h"
+#include "StatusApi.h"
+
+ZoneEventStream::ZoneEventStream() : sent()
+{
+}
+
+ZoneEventStream::MoistureBand ZoneEventStream::bandFor(const ZoneSnapshot &zone)
+{
+  if (zone.moisturePercent <= zone.dryThreshold)
+  {
+    return BAND_DRY;
+  }
+  if (zone.moisturePercent >= zone.wetThreshold)
+  {
+    return BAND_WET;
+  }
+  return BAND_NORMAL;
+}
+
+size_t ZoneEventStream::collectChanges(const SystemSnapshot &snapshot, char *buffer, size_t size)
+{
+  bool changed[MAX_ZONES] = {};
+  bool any = false;
+
+  for (int i = 0; i < snapshot.zoneCount; i++)
+  {
+    const ZoneSnapshot &zone = snapshot.zones[i];
+    SentState &last = sent[i];
+    MoistureBand band = bandFor(zone);
+
+    if (!last.valid || last.id != zone.id || last.pumpState != zone.pumpState ||
+        last.inCooldown != zone.inCooldown || last.sensorInAir != zone.sensorInAir ||
+        last.sensorStale != zone.sensorStale || last.band != band)
+    {
+      changed[i] = true;
+      any = true;
+      last.valid = true;
+      last.id = zone.id;
+      last.pumpState = zone.pumpState;
+      last.inCooldown = zone.inCooldown;
+      last.sensorInAir = zone.sensorInAir;
+      last.sensorStale = zone.sensorStale;
+      last.band = band;
+    }
+  }
+
+  if (!any)
+  {
+    return 0;
+  }
+  return writeZoneStatusJson(snapshot, buffer, size, changed);
+}
@@ -0,0 +1,47 @@
+#ifndef ZONE_EVENT_STREAM_H
+#define ZONE_EVENT_STREAM_H
+
+#include <stddef.h>
+#include "ZoneSnapshot.h"
+
+const unsigned long EVENT_BATCH_MS = 250; // Changes within this window go out as one event
+
+// Turns published snapshots into small "zones" events for the dashboard.
+// Only state a user would want to see immediately is tracked: pump on/off,
+// cooldown start/end, sensor in air and moisture crossing a threshold.
+// Changes are compared against what was last sent, so several snapshots
+// inside one batch window coalesce into a single delta.
+class ZoneEventStream
+{
+public:
+  ZoneEventStream();
+
+  // Writes a delta document (same shape as /api/zones) for the zones that
+  // changed since the last call. Returns 0 if nothing needs to be sent.
+  size_t collectChanges(const SystemSnapshot &snapshot, char *buffer, size_t size);
+
+private:
+  enum MoistureBand
+  {
+    BAND_DRY,    // At or below the dry threshold
+    BAND_NORMAL, // Between the thresholds
+    BAND_WET     // At or above the wet threshold
+  };
+
+  struct SentState
+  {
+    bool valid;
+    int id;
+    bool pumpState;
+    bool inCooldown;
+    bool sensorInAir;
+    bool sensorStale;
+    MoistureBand band;
+  };
+
+  SentState sent[MAX_ZONES];
+
+  static MoistureBand bandFor(const ZoneSnapshot &zone);
+};
+
+#endif // ZONE_EVENT_STREAM_H
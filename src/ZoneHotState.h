@@ -0,0 +1,83 @@
+#ifndef ZONE_HOT_STATE_H
+#define ZONE_HOT_STATE_H
+
+#include <stdint.h>
+#include <vector>
+
+// Bits in ZoneHotState::flags
+const uint8_t ZONE_PUMP_ON = 0x01;
+const uint8_t ZONE_STOPPED_BY_TIMEOUT = 0x02; // Last run hit maxPumpRuntime before the wet threshold
+const uint8_t ZONE_DRY = 0x04;                // Dry threshold latch (with hysteresis)
+const uint8_t ZONE_HAS_DEADLINE = 0x08;       // deadline[] is valid
+const uint8_t ZONE_IN_AIR = 0x10;             // Filtered reading at or above airValue
+const uint8_t ZONE_HAS_READING = 0x20;        // raw[] holds a sampler value
+const uint8_t ZONE_SENSOR_STALE = 0x40;       // Sensor channel stopped delivering (SensorSampler::isStale)
+
+// Runtime state of all zones, one array per field and indexed by the zone's
+// slot in the ZoneRegistry. Loops that touch every zone (deadline scans,
+// pump counting) walk a few small arrays instead of striding over whole
+// WateringZone objects with their names, settings and history.
+//
+// The threshold inputs are copies of the zone's settings, refreshed by
+// WateringZone whenever they change, so ZoneRegistry::evaluateThresholds()
+// never has to touch a zone object.
+struct ZoneHotState
+{
+  std::vector<int> raw;     // Filtered ADC value
+  std::vector<int> percent; // 0..100
+  std::vector<uint8_t> flags;
+  std::vector<unsigned long> pumpStart;
+  std::vector<unsigned long> pumpStop;
+  std::vector<unsigned long> deadline; // Pump timeout or cooldown end to re-evaluate at
+
+  // Threshold inputs
+  std::vector<int16_t> channel;    // Sensor sampler channel, -1 before init()
+  std::vector<int16_t> airValue;   // Raw ADC
+  std::vector<int16_t> dryValue;   // Raw ADC, 0 %
+  std::vector<int16_t> waterValue; // Raw ADC, 100 %
+  std::vector<uint8_t> dryThreshold;
+  std::vector<uint8_t> hysteresis; // ThresholdLatch band above dryThreshold
+
+  size_t size() const { return flags.size(); }
+
+  void add()
+  {
+    raw.push_back(0);
+    percent.push_back(0);
+    flags.push_back(0);
+    pumpStart.push_back(0);
+    pumpStop.push_back(0);
+    deadline.push_back(0);
+    channel.push_back(-1);
+    airValue.push_back(0);
+    dryValue.push_back(0);
+    waterValue.push_back(0);
+    dryThreshold.push_back(0);
+    hysteresis.push_back(0);
+  }
+
+  void reserve(size_t count)
+  {
+    raw.reserve(count);
+    percent.reserve(count);
+    flags.reserve(count);
+    pumpStart.reserve(count);
+    pumpStop.reserve(count);
+    deadline.reserve(count);
+    channel.reserve(count);
+    airValue.reserve(count);
+    dryValue.reserve(count);
+    waterValue.reserve(count);
+    dryThreshold.reserve(count);
+    hysteresis.reserve(count);
+  }
+
+  bool has(size_t slot, uint8_t flag) const { return (flags[slot] & flag) != 0; }
+
+  void set(size_t slot, uint8_t flag, bool on)
+  {
+    flags[slot] = on ? (flags[slot] | flag) : (flags[slot] & ~flag);
+  }
+};
+
+#endif // ZONE_HOT_STATE_H
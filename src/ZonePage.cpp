@@ -0,0 +1,76 @@
+#include "ZonePage.h"
+#include <stdio.h>
+#include <string.h>
+
+static size_t writeText(char *out, size_t size, const char *text)
+{
+  size_t length = strlen(text);
+  if (length > size)
+  {
+    length = size;
+  }
+  memcpy(out, text, length);
+  return length;
+}
+
+static size_t writeNumber(char *out, size_t size, long value)
+{
+  char digits[16];
+  snprintf(digits, sizeof(digits), "%ld", value);
+  return writeText(out, size, digits);
+}
+
+bool resolveZonePlaceholder(const char *name, char *out, size_t size, size_t &written, void *context)
+{
+  const ZoneSnapshot *zone = static_cast<const ZoneSnapshot *>(context);
+
+  if (strcmp(name, "ZONE_ID") == 0)
+    written = writeNumber(out, size, zone->id);
+  else if (strcmp(name, "ZONE_NAME") == 0)
+    written = writeText(out, size, zone->name);
+  else if (strcmp(name, "WET_THRESHOLD") == 0)
+    written = writeNumber(out, size, zone->wetThreshold);
+  else if (strcmp(name, "DRY_THRESHOLD") == 0)
+    written = writeNumber(out, size, zone->dryThreshold);
+  else if (strcmp(name, "MOISTURE_RAW") == 0)
+    written = writeNumber(out, size, zone->moistureRaw);
+  else if (strcmp(name, "MOISTURE_PERCENT") == 0)
+    written = writeNumber(out, size, zone->moisturePercent);
+  else if (strcmp(name, "PUMP_STATUS") == 0)
+    written = writeText(out, size, zone->pumpState ? "ON" : "OFF");
+  else if (strcmp(name, "PUMP_CLASS") == 0)
+    written = writeText(out, size, zone->pumpState ? "on" : "off");
+  else if (strcmp(name, "AIR_VALUE") == 0)
+    written = writeNumber(out, size, zone->airValue);
+  else if (strcmp(name, "DRY_VALUE") == 0)
+    written = writeNumber(out, size, zone->dryValue);
+  else if (strcmp(name, "WATER_VALUE") == 0)
+    written = writeNumber(out, size, zone->waterValue);
+  else if (strcmp(name, "MAX_RUNTIME_SEC") == 0)
+    written = writeNumber(out, size, (long)zone->maxRuntimeSec);
+  else if (strcmp(name, "COOLDOWN_SEC") == 0)
+    written = writeNumber(out, size, (long)zone->cooldownSec);
+  else if (strcmp(name, "MODE_THRESHOLD") == 0)
+    written = writeText(out, size, zone->dosingMode ? "" : "selected");
+  else if (strcmp(name, "MODE_DOSING") == 0)
+    written = writeText(out, size, zone->dosingMode ? "selected" : "");
+  else if (strcmp(name, "DOSE_GAIN") == 0)
+  {
+    char text[24];
+    snprintf(text, sizeof(text), "%ld.%02ld", zone->doseGain / 1000, zone->doseGain % 1000 / 10);
+    written = writeText(out, size, text);
+  }
+  else if (strcmp(name, "DOSE_SOAK_SEC") == 0)
+    written = writeNumber(out, size, (long)zone->doseSoakSec);
+  // Status lines are always present so the page script can toggle them
+  else if (strcmp(name, "AIR_HIDDEN") == 0)
+    written = writeText(out, size, zone->sensorInAir ? "" : "hidden");
+  else if (strcmp(name, "COOLDOWN_HIDDEN") == 0)
+    written = writeText(out, size, zone->inCooldown ? "" : "hidden");
+  else if (strcmp(name, "COOLDOWN_SEC_LEFT") == 0)
+    written = writeNumber(out, size, (long)zone->cooldownRemainingSec);
+  else
+    return false;
+
+  return true;
+}
@@ -0,0 +1,10 @@
+#ifndef ZONE_PAGE_H
+#define ZONE_PAGE_H
+
+#include <stddef.h>
+#include "ZoneSnapshot.h"
+
+// TemplateResolver for zone_config_html, context is a const ZoneSnapshot*
+bool resolveZonePlaceholder(const char *name, char *out, size_t size, size_t &written, void *context);
+
+#endif // ZONE_PAGE_H
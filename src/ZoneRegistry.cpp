@@ -0,0 +1,104 @@
+#include "ZoneRegistry.h"
+#include "Metrics.h"
+
+int ZoneRegistry::add(const WateringZone &zone)
+{
+  if (zone.id < 0 || zone.id > MAX_ZONE_ID || slotOf(zone.id) >= 0 || zones.size() >= INT16_MAX)
+  {
+    return -1;
+  }
+
+  int slot = (int)zones.size();
+  if ((int)slotById.size() <= zone.id)
+  {
+    slotById.resize(zone.id + 1, -1);
+  }
+  slotById[zone.id] = (int16_t)slot;
+
+  zones.push_back(zone);
+  state.add();
+  zones.back().bind(&state, slot);
+  return slot;
+}
+
+void ZoneRegistry::reserve(size_t count)
+{
+  zones.reserve(count);
+  state.reserve(count);
+}
+
+void ZoneRegistry::evaluateThresholds()
+{
+  const int *raw = state.raw.data();
+  int *percent = state.percent.data();
+  uint8_t *flags = state.flags.data();
+  const int16_t *air = state.airValue.data();
+  const int16_t *dry = state.dryValue.data();
+  const int16_t *water = state.waterValue.data();
+  const uint8_t *threshold = state.dryThreshold.data();
+  const uint8_t *band = state.hysteresis.data();
+  size_t count = state.size();
+  for (size_t i = 0; i < count; i++)
+  {
+    uint8_t f = flags[i];
+    if (!(f & ZONE_HAS_READING))
+    {
+      continue;
+    }
+    // Arduino map() from dry..water to 0..100, clamped
+    int span = water[i] - dry[i];
+    int p = span == 0 ? 0 : (raw[i] - dry[i]) * 100 / span;
+    p = p < 0 ? 0 : (p > 100 ? 100 : p);
+    percent[i] = p;
+
+    bool isDry = ThresholdLatch::next((f & ZONE_DRY) != 0, p, threshold[i], band[i]);
+    bool inAir = raw[i] >= air[i];
+    if (inAir && !(f & ZONE_IN_AIR))
+    {
+      METRIC_COUNT(COUNTER_AIR_DETECTIONS);
+    }
+    f = isDry ? (f | ZONE_DRY) : (f & ~ZONE_DRY);
+    flags[i] = inAir ? (f | ZONE_IN_AIR) : (f & ~ZONE_IN_AIR);
+  }
+}
+
+size_t ZoneRegistry::dueZones(unsigned long now, int *out, size_t max) const
+{
+  size_t found = 0;
+  const uint8_t *flags = state.flags.data();
+  const unsigned long *deadline = state.deadline.data();
+  size_t count = state.size();
+  for (size_t i = 0; i < count && found < max; i++)
+  {
+    if ((flags[i] & ZONE_HAS_DEADLINE) && (long)(now - deadline[i]) >= 0)
+    {
+      out[found++] = (int)i;
+    }
+  }
+  return found;
+}
+
+bool ZoneRegistry::nextDeadline(unsigned long &deadline) const
+{
+  bool found = false;
+  size_t count = state.size();
+  for (size_t i = 0; i < count; i++)
+  {
+    if ((state.flags[i] & ZONE_HAS_DEADLINE) && (!found || (long)(state.deadline[i] - deadline) < 0))
+    {
+      deadline = state.deadline[i];
+      found = true;
+    }
+  }
+  return found;
+}
+
+int ZoneRegistry::pumpsOn() const
+{
+  int on = 0;
+  for (uint8_t flags : state.flags)
+  {
+    on += (flags & ZONE_PUMP_ON) ? 1 : 0;
+  }
+  return on;
+}
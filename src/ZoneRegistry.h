@@ -0,0 +1,63 @@
+#ifndef ZONE_REGISTRY_H
+#define ZONE_REGISTRY_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+#include "WateringZone.h"
+#include "ZoneHotState.h"
+
+const int MAX_ZONE_ID = 1023; // Ids index a direct lookup table
+
+// All zones, split by access pattern:
+//   hot()      runtime state as parallel arrays (see ZoneHotState)
+//   zone(i)    WateringZone with names, settings, filter and history
+// plus an id -> slot table so lookups by id are O(1).
+//
+// Zones are added before init() and never removed, so slots are stable and
+// the lookup table may be read from other tasks afterwards.
+class ZoneRegistry
+{
+public:
+  ZoneRegistry() {}
+  ZoneRegistry(const ZoneRegistry &) = delete;
+  ZoneRegistry &operator=(const ZoneRegistry &) = delete;
+
+  // Returns the slot, or -1 if the id is invalid or already taken
+  int add(const WateringZone &zone);
+  void reserve(size_t count);
+
+  size_t size() const { return zones.size(); }
+  bool empty() const { return zones.empty(); }
+  WateringZone &zone(size_t slot) { return zones[slot]; }
+  const WateringZone &zone(size_t slot) const { return zones[slot]; }
+  ZoneHotState &hot() { return state; }
+  const ZoneHotState &hot() const { return state; }
+
+  int slotOf(int zoneId) const
+  {
+    return zoneId >= 0 && zoneId < (int)slotById.size() ? slotById[zoneId] : -1;
+  }
+  WateringZone *find(int zoneId)
+  {
+    int slot = slotOf(zoneId);
+    return slot < 0 ? nullptr : &zones[slot];
+  }
+
+  // Bulk scans over the hot arrays
+  // Percent, dry latch and air flag of every zone with a reading, from raw
+  void evaluateThresholds();
+  size_t dueZones(unsigned long now, int *out, size_t max) const;
+  bool nextDeadline(unsigned long &deadline) const;
+  int pumpsOn() const;
+
+  std::vector<WateringZone>::iterator begin() { return zones.begin(); }
+  std::vector<WateringZone>::iterator end() { return zones.end(); }
+
+private:
+  std::vector<WateringZone> zones;
+  ZoneHotState state;
+  std::vector<int16_t> slotById;
+};
+
+#endif // ZONE_REGISTRY_H
@@ -0,0 +1,248 @@
+#ifdef ARDUINO
+#include "WebRoutes.h"
+
+#include "html_content.h"
+#include "ConfigDocument.h"
+#include "Metrics.h"
+#include "TemplateRenderer.h"
+#include "ZonePage.h"
+
+static const size_t WEATHER_UPLOAD_MAX = 1024;
+static const size_t CONFIG_UPLOAD_MAX = 6144; // Room for a pretty-printed CONFIG_JSON_MAX document
+
+static ConfigDocument uploadedConfig;
+
+void setupZoneRoutes(AsyncWebServer &server)
+{
+  // Static dashboard, rendered in the browser from /api/zones
+  server.on("/", HTTP_GET, [](AsyncWebServerRequest *request)
+            { sendPage(request, "index"); });
+
+  // Registered before /api/zones, which would otherwise match this path as a prefix
+  server.on("/api/zones/info", HTTP_GET, [](AsyncWebServerRequest *request)
+            {
+    if (!readSnapshot(request)) {
+      return;
+    }
+    
+    if (writeZoneInfoJson(webSnapshot, jsonBuffer, sizeof(jsonBuffer)) == 0) {
+      request->send(500, "text/plain", "Zone info too large");
+      return;
+    }
+    request->send(200, "application/json", jsonBuffer); });
+
+  // Streamed as CSV straight out of the zone's history ring, e.g.
+  // /api/zones/1/history?res=minute&from=3600. Times are seconds on the
+  // history clock; X-History-Now tells the client the current value.
+  server.on("^/api/zones/([0-9]+)/history$", HTTP_GET, [](AsyncWebServerRequest *request)
+            {
+    int zoneId = request->pathArg(0).toInt();
+    if (!controller.hasZone(zoneId)) {
+      request->send(404, "text/plain", "Zone not found");
+      return;
+    }
+    
+    HistoryResolution resolution = HISTORY_MINUTE;
+    if (request->hasParam("res")) {
+      String res = request->getParam("res")->value();
+      if (res == "raw") {
+        resolution = HISTORY_RAW;
+      } else if (res == "hour") {
+        resolution = HISTORY_HOUR;
+      } else if (res != "minute") {
+        request->send(400, "text/plain", "res must be raw, minute or hour");
+        return;
+      }
+    }
+    uint32_t from = 0;
+    if (request->hasParam("from")) {
+      from = strtoul(request->getParam("from")->value().c_str(), nullptr, 10);
+    }
+    
+    std::shared_ptr<RenderSlot> slot = renderSlot(request);
+    if (!slot) {
+      return;
+    }
+    std::shared_ptr<HistoryReader> reader = std::make_shared<HistoryReader>(resolution, from);
+    AsyncWebServerResponse* response = request->beginChunkedResponse("text/csv",
+        [reader, zoneId, slot](uint8_t *buffer, size_t maxLen, size_t index) -> size_t {
+          METRIC_TIME(SECTION_HISTORY);
+          return controller.fillHistory(zoneId, *reader, reinterpret_cast<char*>(buffer), maxLen);
+        });
+    response->addHeader("Cache-Control", "no-cache");
+    response->addHeader("X-History-Now", String(MoistureHistory::now(millis())));
+    request->send(response); });
+
+  server.on("/api/zones", HTTP_GET, [](AsyncWebServerRequest *request)
+            {
+    if (!readSnapshot(request)) {
+      return;
+    }
+    
+    METRIC_TIME(SECTION_STATUS_JSON);
+    size_t length = writeZoneStatusJson(webSnapshot, jsonBuffer, sizeof(jsonBuffer));
+    if (length == 0) {
+      request->send(500, "text/plain", "Status too large");
+      return;
+    }
+    
+    // Weak ETag over the zones, not the version: unchanged zone state costs a 304
+    const char *zones = strchr(jsonBuffer, '[');
+    char etag[16];
+    snprintf(etag, sizeof(etag), "W/\"%08lx\"", (unsigned long)crc32(zones, length - (zones - jsonBuffer)));
+    if (request->hasHeader("If-None-Match") &&
+        strcmp(request->getHeader("If-None-Match")->value().c_str(), etag) == 0) {
+      request->send(304);
+      return;
+    }
+    AsyncWebServerResponse* response = request->beginResponse(200, "application/json", jsonBuffer);
+    response->addHeader("Cache-Control", "no-cache");
+    response->addHeader("ETag", etag);
+    request->send(response); });
+
+  server.on("^/zone/([0-9]+)$", HTTP_GET, [](AsyncWebServerRequest *request)
+            {
+    String zoneIdStr = request->pathArg(0);
+    int zoneId = zoneIdStr.toInt();
+    
+    if (!readSnapshot(request)) {
+      return;
+    }
+    
+    const ZoneSnapshot* zone = webSnapshot.findZone(zoneId);
+    if (!zone) {
+      request->send(404, "text/plain", "Zone not found");
+      return;
+    }
+    
+    // Render straight into the TCP send buffer. The renderer keeps its own copy
+    // of the zone because webSnapshot may be refreshed by the next request.
+    struct ZonePageState
+    {
+      ZoneSnapshot zone;
+      TemplateRenderer renderer;
+      explicit ZonePageState(const ZoneSnapshot &z)
+          : zone(z), renderer(zone_config_html, resolveZonePlaceholder, &zone) {}
+    };
+    std::shared_ptr<RenderSlot> slot = renderSlot(request);
+    if (!slot) {
+      return;
+    }
+    std::shared_ptr<ZonePageState> page = std::make_shared<ZonePageState>(*zone);
+    
+    AsyncWebServerResponse* response = request->beginChunkedResponse("text/html",
+        [page, slot](uint8_t *buffer, size_t maxLen, size_t index) -> size_t {
+          METRIC_TIME(SECTION_ZONE_PAGE);
+          return page->renderer.fill(reinterpret_cast<char*>(buffer), maxLen);
+        });
+    request->send(response); });
+
+  server.on("^/zone/([0-9]+)/config$", HTTP_GET, [](AsyncWebServerRequest *request)
+            {
+    String zoneIdStr = request->pathArg(0);
+    int zoneId = zoneIdStr.toInt();
+    
+    if (!controller.hasZone(zoneId)) {
+      request->send(404, "text/plain", "Zone not found");
+      return;
+    }
+    
+    // Validation and NVS writes happen on the control task
+    ZoneConfigRequest config;
+    config.zoneId = zoneId;
+    readConfigParams(request, config);
+    
+    if (!controller.submitConfig(config)) {
+      request->send(503, "text/plain", "Busy, try again");
+      return;
+    }
+    
+    request->redirect("/zone/" + String(zoneId)); });
+
+  server.on("/api/plan", HTTP_GET, [](AsyncWebServerRequest *request)
+            {
+    if (!readSnapshot(request)) {
+      return;
+    }
+    if (writePlanJson(webSnapshot, jsonBuffer, sizeof(jsonBuffer)) == 0) {
+      request->send(500, "text/plain", "Plan too large");
+      return;
+    }
+    request->send(200, "application/json", jsonBuffer); });
+
+  // Weather/ET profile for the planner as "hour,percent" lines, e.g.
+  // curl --data-binary @weather.csv http://<device>/api/weather
+  server.on("/api/weather", HTTP_GET, [](AsyncWebServerRequest *request)
+            {
+    if (!readSnapshot(request)) {
+      return;
+    }
+    AsyncResponseStream *response = request->beginResponseStream("text/csv");
+    response->print("hour,percent\n");
+    for (int hour = 0; hour < 24; hour++) {
+      response->printf("%d,%u\n", hour, (unsigned)webSnapshot.weather[hour]);
+    }
+    request->send(response); });
+
+  server.on("/api/weather", HTTP_POST, [](AsyncWebServerRequest *request)
+            {
+    const char *body = static_cast<const char *>(request->_tempObject);
+    WeatherProfile profile;
+    if (!body || request->contentLength() > WEATHER_UPLOAD_MAX) {
+      request->send(413, "text/plain", "Profile missing or too large");
+      return;
+    }
+    if (!parseWeatherProfile(body, request->contentLength(), profile)) {
+      request->send(400, "text/plain", "Expected hour,percent lines");
+      return;
+    }
+    controller.submitWeather(profile);
+    request->send(204); },
+            nullptr,
+            [](AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total)
+            { collectBody(request, data, len, index, total, WEATHER_UPLOAD_MAX); });
+
+  // Every zone's settings and the weather profile in one document; POST
+  // the same format back to change many zones with one request:
+  // curl http://<device>/api/config > config.json
+  // curl --data-binary @config.json http://<device>/api/config
+  server.on("/api/config", HTTP_GET, [](AsyncWebServerRequest *request)
+            {
+    if (!readSnapshot(request)) {
+      return;
+    }
+    if (writeConfigJson(webSnapshot, jsonBuffer, sizeof(jsonBuffer)) == 0) {
+      request->send(500, "text/plain", "Configuration too large");
+      return;
+    }
+    AsyncWebServerResponse* response = request->beginResponse(200, "application/json", jsonBuffer);
+    response->addHeader("Cache-Control", "no-store");
+    request->send(response); });
+
+  server.on("/api/config", HTTP_POST, [](AsyncWebServerRequest *request)
+            {
+    const char *body = static_cast<const char *>(request->_tempObject);
+    const char *error;
+    if (!body || request->contentLength() > CONFIG_UPLOAD_MAX) {
+      request->send(413, "text/plain", "Document missing or too large");
+      return;
+    }
+    // Nothing is applied unless the whole document passes
+    if (!readSnapshot(request)) {
+      return;
+    }
+    if (!parseConfigJson(body, request->contentLength(), uploadedConfig, error) ||
+        !validateConfig(uploadedConfig, webSnapshot, error)) {
+      request->send(400, "text/plain", error);
+      return;
+    }
+    if (!controller.submitDocument(uploadedConfig)) {
+      request->send(503, "text/plain", "Busy, try again");
+      return;
+    }
+    request->send(204); },
+            nullptr,
+            [](AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total)
+            { collectBody(request, data, len, index, total, CONFIG_UPLOAD_MAX); });
+}
+#endif
@@ -0,0 +1,123 @@
+#include "ZoneScheduler.h"
+#include "Metrics.h"
+
+ZoneScheduler::ZoneScheduler(ZoneRegistry &zones, unsigned long periodMs, int maxConcurrentPumps)
+    : zones(zones), periodMs(periodMs), maxPumps(maxConcurrentPumps), running(0), planner(nullptr), cursor(0), nextDue(0)
+{
+}
+
+void ZoneScheduler::init(unsigned long now)
+{
+  cursor = 0;
+  nextDue = now;
+  running = zones.pumpsOn();
+  queued.assign(zones.size(), false);
+  due.assign(zones.size(), 0);
+
+  // Reserve the queue's storage up front so ticks never allocate
+  std::vector<PumpRequest> storage;
+  storage.reserve(zones.size());
+  waiting = std::priority_queue<PumpRequest>(std::less<PumpRequest>(), std::move(storage));
+}
+
+int ZoneScheduler::tick(unsigned long now)
+{
+  if (zones.empty())
+  {
+    return 0;
+  }
+
+  // Zone i is due at start + i * period / n; the signed difference keeps
+  // this correct across millis() rollover
+  unsigned long step = periodMs / zones.size();
+  if (step == 0)
+  {
+    step = 1;
+  }
+
+  int evaluated = 0;
+  while ((long)(now - nextDue) >= 0 && evaluated < (int)zones.size())
+  {
+    evaluate(cursor, now);
+    cursor = (cursor + 1) % zones.size();
+    nextDue += step;
+    evaluated++;
+  }
+
+  // After a long stall, resume the rhythm from now instead of catching up
+  if ((long)(now - nextDue) >= 0)
+  {
+    nextDue = now + step;
+  }
+
+  if (evaluated > 0)
+  {
+    grantPumps();
+  }
+  return evaluated;
+}
+
+int ZoneScheduler::serviceDeadlines(unsigned long now)
+{
+  // One pass over the deadline arrays, then evaluate only the hits
+  size_t count = zones.dueZones(now, due.data(), due.size());
+  for (size_t i = 0; i < count; i++)
+  {
+    evaluate(due[i], now);
+  }
+  if (count > 0)
+  {
+    grantPumps();
+  }
+  return (int)count;
+}
+
+void ZoneScheduler::evaluate(size_t index, unsigned long now)
+{
+  METRIC_TIME(SECTION_ZONE_UPDATE);
+  WateringZone &zone = zones.zone(index);
+  bool wasRunning = zone.isPumpOn();
+  bool wantsPump = zone.updateSoilMoisture();
+
+  if (wasRunning && !zone.isPumpOn())
+  {
+    running--;
+  }
+
+  bool planned = false;
+  if (planner)
+  {
+    planner->observe(index, zone.moisturePercent(), zone.isPumpOn() || zone.isPumpInCooldown(), now);
+    if (wantsPump && planner->holds(index, now))
+    {
+      wantsPump = false;
+    }
+    else if (!wantsPump && planner->due(index, now) && zone.wantsToStart(true))
+    {
+      wantsPump = true;
+      planned = true;
+    }
+  }
+
+  if (wantsPump && !queued[index])
+  {
+    queued[index] = true;
+    waiting.push({zone.moisturePercent(), zone.cooldownEndTime(), (int)index, planned});
+  }
+}
+
+void ZoneScheduler::grantPumps()
+{
+  while (running < maxPumps && !waiting.empty())
+  {
+    PumpRequest request = waiting.top();
+    waiting.pop();
+    queued[request.index] = false;
+
+    // startPump() re-checks the zone, it may no longer need water
+    if (zones.zone(request.index).startPump(request.planned))
+    {
+      running++;
+    }
+  }
+}
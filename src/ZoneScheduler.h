@@ -0,0 +1,76 @@
+#ifndef ZONE_SCHEDULER_H
+#define ZONE_SCHEDULER_H
+
+#include <stddef.h>
+#include <queue>
+#include <vector>
+#include "WateringPlanner.h"
+#include "ZoneRegistry.h"
+
+const unsigned long ZONE_UPDATE_INTERVAL_MS = 10000; // Every zone is evaluated once per period
+const int MAX_CONCURRENT_PUMPS = 1;                  // Pumps allowed to run at the same time
+
+// Spreads zone evaluations evenly over ZONE_UPDATE_INTERVAL_MS and grants
+// pump starts without exceeding the concurrency limit.
+// Each tick only touches the zones that became due, so the cost per tick
+// stays flat as zones are added. Zones that want water while all pump
+// slots are busy wait in a priority queue: driest first, and among equally
+// dry zones the one whose cooldown ended first.
+class ZoneScheduler
+{
+public:
+  explicit ZoneScheduler(ZoneRegistry &zones,
+                         unsigned long periodMs = ZONE_UPDATE_INTERVAL_MS,
+                         int maxConcurrentPumps = MAX_CONCURRENT_PUMPS);
+
+  void init(unsigned long now);
+  // Returns the number of zones evaluated in this tick
+  int tick(unsigned long now);
+  // Evaluates zones whose pump timeout or cooldown deadline has passed
+  int serviceDeadlines(unsigned long now);
+  unsigned long nextDueTime() const { return nextDue; }
+  bool nextDeadline(unsigned long &deadline) const { return zones.nextDeadline(deadline); }
+
+  void setMaxConcurrentPumps(int limit) { maxPumps = limit; }
+  int maxConcurrentPumps() const { return maxPumps; }
+  // Optional: holds dry zones for their window and starts early runs
+  void setPlanner(WateringPlanner *replacement) { planner = replacement; }
+  int runningPumps() const { return running; }
+  size_t waitingZones() const { return waiting.size(); }
+
+private:
+  struct PumpRequest
+  {
+    int moisturePercent;
+    unsigned long cooldownEnd;
+    int index;
+    bool planned; // Early run from the planner, the zone is not dry yet
+
+    // std::priority_queue pops the "largest" element first
+    bool operator<(const PumpRequest &other) const
+    {
+      if (moisturePercent != other.moisturePercent)
+      {
+        return moisturePercent > other.moisturePercent;
+      }
+      return cooldownEnd > other.cooldownEnd;
+    }
+  };
+
+  ZoneRegistry &zones;
+  unsigned long periodMs;
+  int maxPumps;
+  int running;
+  WateringPlanner *planner;
+
+  size_t cursor;           // Next zone to evaluate
+  unsigned long nextDue;   // When zones[cursor] is due
+  std::vector<bool> queued;
+  std::vector<int> due;    // Scratch for serviceDeadlines(), sized in init()
+  std::priority_queue<PumpRequest> waiting;
+
+  void evaluate(size_t index, unsigned long now);
+  void grantPumps();
+};
+
+#endif // ZONE_SCHEDULER_H
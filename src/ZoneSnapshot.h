@@ -0,0 +1,127 @@
+#ifndef ZONE_SNAPSHOT_H
+#define ZONE_SNAPSHOT_H
+
+#include <stdint.h>
+#include <atomic>
+
+const int MAX_ZONES = 16;
+const int ZONE_NAME_LEN = 32;
+
+// Copy of everything the web pages show for one zone
+struct ZoneSnapshot
+{
+  int id;
+  char name[ZONE_NAME_LEN];
+
+  // Runtime state
+  int moistureRaw;
+  int moisturePercent;
+  bool pumpState;
+  bool sensorInAir;
+  bool sensorStale; // No good reading for a while (bus errors, backend gone)
+  bool inCooldown;
+  unsigned long cooldownRemainingSec;
+  bool stoppedByTimeout; // Runs again below the wet threshold once the cooldown is over
+
+  // Settings
+  int wetThreshold;
+  int dryThreshold;
+  int airValue;
+  int dryValue;
+  int waterValue;
+  unsigned long maxRuntimeSec;
+  unsigned long cooldownSec;
+  bool dosingMode;
+  long doseGain;             // Learned milli-percent per pump second, 0 until learned
+  unsigned long doseSoakSec; // Learned soak time, 0 until learned
+
+  // Planner (WateringPlanner)
+  long dryingRate;  // Milli-percent per hour at average weather, 0 until measured
+  int planKind;     // PlanKind
+  long planInSec;   // Planned start relative to takenAtMs
+};
+
+struct SystemSnapshot
+{
+  uint32_t version;         // Incremented on every publish
+  unsigned long takenAtMs;  // millis() when the control task built it
+  int zoneCount;
+  ZoneSnapshot zones[MAX_ZONES];
+
+  // Control task activity, for the power report
+  unsigned long controlWakeups;
+  unsigned long controlBusyUs;
+  unsigned long firstTickUs; // Boot to first control tick
+  unsigned long pumpCutoffs;        // Relays opened by the cutoff timer (PumpCutoff)
+  unsigned long cutoffMaxOverrunUs; // Worst relay over-run past a run limit with the timer
+  unsigned long controlMaxLateUs;   // Worst the control task alone would have had
+  bool planSynced;           // Planner has wall time
+  uint8_t weather[24];       // Planner's ET profile, % per local hour
+
+  const ZoneSnapshot *findZone(int zoneId) const
+  {
+    for (int i = 0; i < zoneCount; i++)
+    {
+      if (zones[i].id == zoneId)
+      {
+        return &zones[i];
+      }
+    }
+    return nullptr;
+  }
+};
+
+// Double-buffered seqlock. Publish k writes buffer k & 1: the writer (the
+// control task) makes the sequence odd (2k - 1), fills the buffer and then
+// makes it even (2k). A reader copies the last complete buffer, which the
+// writer only touches again two publishes later, and keeps the copy if the
+// sequence shows that has not started. The fences order the sequence
+// against the buffer contents. Readers never block the writer and a
+// writer paused halfway through a publish does not stall readers.
+class SnapshotStore
+{
+public:
+  SnapshotStore() : sequence(0), buffers() {}
+
+  void publish(const SystemSnapshot &snapshot)
+  {
+    uint32_t start = sequence.load(std::memory_order_relaxed) + 1;
+    uint32_t published = (start + 1) / 2;
+    sequence.store(start, std::memory_order_relaxed); // Odd: publish in progress
+    std::atomic_thread_fence(std::memory_order_release);
+    SystemSnapshot &target = buffers[published & 1];
+    target = snapshot;
+    target.version = published;
+    sequence.store(start + 1, std::memory_order_release);
+  }
+
+  bool read(SystemSnapshot &out) const
+  {
+    for (int attempt = 0; attempt < 4; attempt++)
+    {
+      uint32_t before = sequence.load(std::memory_order_acquire);
+      uint32_t complete = before / 2;
+      if (complete == 0)
+      {
+        return false; // Nothing published yet
+      }
+      out = buffers[complete & 1];
+      std::atomic_thread_fence(std::memory_order_acquire);
+      // Publish complete + 2 (sequence 2 * complete + 3) rewrites this buffer
+      if (sequence.load(std::memory_order_relaxed) - 2 * complete < 3)
+      {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  // Complete publishes so far
+  uint32_t version() const { return sequence.load(std::memory_order_acquire) / 2; }
+
+private:
+  std::atomic<uint32_t> sequence; // 2k - 1 while publish k writes, 2k after
+  SystemSnapshot buffers[2];
+};
+
+#endif // ZONE_SNAPSHOT_H
@@ -0,0 +1,140 @@
+#ifndef ZONE_TABLE_H
+#define ZONE_TABLE_H
+
+#include <stddef.h>
+#include "MoistureFilter.h"
+#include "SensorBackend.h"
+#include "WateringZone.h"
+#include "ZoneRegistry.h"
+#include "ZoneSnapshot.h"
+
+// Board limits (lolin_c3_mini, ESP32-C3)
+const int BOARD_GPIO_COUNT = 22;   // GPIO0..21
+const int BOARD_ADC_PIN_LAST = 4;  // ADC1 is GPIO0..4; ADC2 stops working once WiFi is up
+const int BOARD_USB_PIN_FIRST = 18; // GPIO18/19 carry USB serial/JTAG
+
+// One row of the zone configuration table. Fields left out of an
+// initializer are zero, which means "use the default".
+struct ZoneDefinition
+{
+  int id;
+  const char *name;
+  int sensorPin;
+  int pumpPin;
+  int wetThreshold;           // 0: DEFAULT_WET_THRESHOLD
+  int dryThreshold;           // 0: DEFAULT_DRY_THRESHOLD
+  const FilterConfig *filter; // nullptr: DEFAULT_FILTER
+};
+
+// Compile-time checks for a constexpr zone table:
+//
+//   constexpr ZoneDefinition ZONES[] = {{1, "Bed", 0, 5}, {2, "Pots", 1, 6, 70, 40},
+//                                       {3, "Herbs", sensorAddress(0, 3), 7}};
+//   static_assert(zoneTableValid(ZONES), "see the individual checks");
+//
+// The individual checks give a more specific compiler message.
+
+template <size_t N>
+constexpr bool zoneIdsValid(const ZoneDefinition (&table)[N])
+{
+  for (size_t i = 0; i < N; i++)
+  {
+    if (table[i].id < 0 || table[i].id > MAX_ZONE_ID)
+    {
+      return false;
+    }
+    for (size_t j = i + 1; j < N; j++)
+    {
+      if (table[i].id == table[j].id)
+      {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+template <size_t N>
+constexpr bool zonePinsValid(const ZoneDefinition (&table)[N])
+{
+  for (size_t i = 0; i < N; i++)
+  {
+    const ZoneDefinition &zone = table[i];
+    bool nativeSensor = zone.sensorPin >= 0 && zone.sensorPin <= BOARD_ADC_PIN_LAST;
+    bool externalSensor = zone.sensorPin >= SENSOR_EXTERNAL && zone.sensorPin < SENSOR_ADDRESS_END;
+    if (!nativeSensor && !externalSensor)
+    {
+      return false;
+    }
+    if (zone.pumpPin < 0 || zone.pumpPin >= BOARD_GPIO_COUNT ||
+        zone.pumpPin == BOARD_USB_PIN_FIRST || zone.pumpPin == BOARD_USB_PIN_FIRST + 1)
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+// No GPIO may serve two purposes anywhere in the table
+template <size_t N>
+constexpr bool zonePinsDistinct(const ZoneDefinition (&table)[N])
+{
+  for (size_t i = 0; i < N; i++)
+  {
+    if (table[i].sensorPin == table[i].pumpPin)
+    {
+      return false;
+    }
+    for (size_t j = i + 1; j < N; j++)
+    {
+      if (table[i].sensorPin == table[j].sensorPin || table[i].sensorPin == table[j].pumpPin ||
+          table[i].pumpPin == table[j].sensorPin || table[i].pumpPin == table[j].pumpPin)
+      {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+// GPIOs a sensor backend drives (mux select and ADC lines, I2C) must not
+// also be a native sensor or a pump in the table
+template <size_t N, size_t M>
+constexpr bool zonePinsAvoid(const ZoneDefinition (&table)[N], const int (&pins)[M])
+{
+  for (size_t i = 0; i < N; i++)
+  {
+    for (size_t j = 0; j < M; j++)
+    {
+      if (table[i].sensorPin == pins[j] || table[i].pumpPin == pins[j])
+      {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+template <size_t N>
+constexpr bool zoneThresholdsOrdered(const ZoneDefinition (&table)[N])
+{
+  for (size_t i = 0; i < N; i++)
+  {
+    int wet = table[i].wetThreshold ? table[i].wetThreshold : DEFAULT_WET_THRESHOLD;
+    int dry = table[i].dryThreshold ? table[i].dryThreshold : DEFAULT_DRY_THRESHOLD;
+    if (wet > 100 || dry < 0 || wet <= dry)
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+template <size_t N>
+constexpr bool zoneTableValid(const ZoneDefinition (&table)[N])
+{
+  return N > 0 && N <= (size_t)MAX_ZONES && zoneIdsValid(table) && zonePinsValid(table) &&
+         zonePinsDistinct(table) && zoneThresholdsOrdered(table);
+}
+
+#endif // ZONE_TABLE_H
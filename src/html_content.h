@@ -1,32 +1,10 @@
 #ifndef HTML_CONTENT_H
 #define HTML_CONTENT_H
+#ifdef ARDUINO
 #include <Arduino.h>
-
-// Simple mobile overview page
-const char overview_html[] PROGMEM = R"rawliteral(
-<!DOCTYPE HTML><html><head>
-  <title>Watering System</title>
-  <meta name="viewport" content="width=device-width, initial-scale=1">
-  <style>
-    body { margin: 10px; font-size: 18px; }
-    div { border: 1px solid #ccc; padding: 10px; margin: 5px 0; }
-    .on { background: #90EE90; }
-    .off { background: #FFB6C1; }
-    .cooldown { background: #FFA500; }
-    .error { background: #FF6B6B; color: white; font-weight: bold; }
-    a { display: block; text-decoration: none; background: #87CEEB; padding: 8px; margin: 5px 0; text-align: center; }
-  </style>
-  <script>
-    function refreshPage() {
-      location.reload();
-    }
-    setInterval(refreshPage, 15000); // Auto-refresh every 15 seconds
-  </script>
-</head><body>
-  <h2>Watering System</h2>
-  <a href="/">Refresh</a>
-  %ZONE_LIST%
-</body></html>)rawliteral";
+#else
+#define PROGMEM // Host builds (benchmarks) keep the templates in normal memory
+#endif
 
 // Simple mobile zone config page
 const char zone_config_html[] PROGMEM = R"rawliteral(
@@ -46,10 +24,42 @@ const char zone_config_html[] PROGMEM = R"rawliteral(
     small { color: #666; font-size: 14px; display: block; margin: 5px 0; }
   </style>
   <script>
-    function refreshPage() {
-      location.reload();
+    // Only the live status is refreshed, the form keeps what the user typed
+    function showStatus(zone) {
+      document.getElementById('moisture').textContent = zone.m;
+      document.getElementById('raw').textContent = zone.r;
+      var pump = document.getElementById('pump');
+      pump.className = zone.p ? 'on' : 'off';
+      pump.textContent = 'Pump: ' + (zone.p ? 'ON' : 'OFF');
+      document.getElementById('air').hidden = !zone.a;
+      var cooldown = document.getElementById('cooldown');
+      cooldown.hidden = !(zone.c > 0);
+      cooldown.textContent = 'Cooldown: ' + zone.c + ' seconds';
+    }
+
+    function applyZones(data) {
+      var zone = data.zones.find(function (z) { return z.id == %ZONE_ID%; });
+      if (zone) showStatus(zone);
+    }
+
+    function refreshStatus() {
+      fetch('/api/zones', { cache: 'no-cache' })
+        .then(function (r) { return r.json(); })
+        .then(applyZones)
+        .catch(function () {});
+    }
+
+    // Pushed events carry pump and threshold changes, polling covers the rest
+    var pollInterval = 5000;
+    if (window.EventSource) {
+      var source = new EventSource('/events');
+      source.addEventListener('zones', function (e) { applyZones(JSON.parse(e.data)); });
+      source.onopen = function () { pollInterval = 30000; };
+      source.onerror = function () { pollInterval = 5000; };
     }
-    setInterval(refreshPage, 10000); // Auto-refresh every 10 seconds
+    (function schedule() {
+      setTimeout(function () { refreshStatus(); schedule(); }, pollInterval);
+    })();
   </script>
 </head><body>
   <a href="/">Back to Overview</a>
@@ -57,11 +67,11 @@ const char zone_config_html[] PROGMEM = R"rawliteral(
   <h3>%ZONE_NAME%</h3>
   
   <div>
-    <p>Moisture: %MOISTURE_PERCENT%%</p>
-    <p>Raw Reading: %MOISTURE_RAW%</p>
-    <p class="%PUMP_CLASS%">Pump: %PUMP_STATUS%</p>
-    %SENSOR_STATUS%
-    %COOLDOWN_INFO%
+    <p>Moisture: <span id="moisture">%MOISTURE_PERCENT%</span>%</p>
+    <p>Raw Reading: <span id="raw">%MOISTURE_RAW%</span></p>
+    <p id="pump" class="%PUMP_CLASS%">Pump: %PUMP_STATUS%</p>
+    <p id="air" class="error" %AIR_HIDDEN%>WARNING: SENSOR IN AIR - Check sensor placement!</p>
+    <p id="cooldown" class="cooldown" %COOLDOWN_HIDDEN%>Cooldown: %COOLDOWN_SEC_LEFT% seconds</p>
   </div>
   
   <form action="/zone/%ZONE_ID%/config" method="GET">
@@ -100,6 +110,15 @@ const char zone_config_html[] PROGMEM = R"rawliteral(
       <input type="number" name="cooldown" value="%COOLDOWN_SEC%" min="1" max="3600" required>
     </div>
     
+    <div class="section">
+      <h4>Watering Mode</h4>
+      <select name="mode">
+        <option value="0" %MODE_THRESHOLD%>Threshold (run until wet)</option>
+        <option value="1" %MODE_DOSING%>Dosing (learned pulses with soak)</option>
+      </select>
+      <small>Learned response: %DOSE_GAIN% %/s per pump second, soak %DOSE_SOAK_SEC% s</small>
+    </div>
+    
     <input type="submit" value="Save All Settings">
   </form>
 </body></html>)rawliteral";
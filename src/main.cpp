@@ -1,17 +1,32 @@
 #include <Arduino.h>
 #include <WiFi.h>
-#include <vector>
 #ifdef USE_WIFI_MANAGER
 #include <WiFiManager.h>
+#include <time.h>
 #else
 #include <DNSServer.h>
 #endif
 
+#ifdef HISTORY_LITTLEFS
+#include <LittleFS.h>
+#endif
+
 #include <AsyncTCP.h>
 #include <ESPAsyncWebServer.h>
 
-#include "html_content.h"
+#include "EventLog.h"
+#include "Metrics.h"
+#include "RequestAdmission.h"
+#include "WebRoutes.h"
+#include "ZoneEventStream.h"
 #include "WateringZone.h"
+#include "ZoneController.h"
+#ifdef SENSOR_MUX
+#include "MuxSensorBackend.h"
+#endif
+#ifdef SENSOR_ADS1115
+#include "Ads1115Backend.h"
+#endif
 
 #ifndef USE_WIFI_MANAGER
 DNSServer dnsServer;
@@ -20,16 +35,137 @@ const char *WIFI_PASSWORD = "123456789";
 #endif
 
 AsyncWebServer server(80);
+AsyncEventSource events("/events");
+ZoneEventStream zoneEvents;
+
+ZoneController controller;
+RequestAdmission admission;
+
+TaskHandle_t controlTaskHandle = nullptr;
+TaskHandle_t loopTaskHandle = nullptr;
+volatile bool networkReady = false; // Set by the network task once the web server runs
 
-std::vector<WateringZone> zones;
+const unsigned long MAX_CONTROL_SLEEP_MS = 60000; // Upper bound, deadlines normally come much sooner
+const unsigned long WIFI_RETRY_MS = 30000;       // Wait before another setup attempt after a failure
+#ifdef USE_WIFI_MANAGER
+const char *TIME_ZONE = "CET-1CEST,M3.5.0,M10.5.0/3"; // POSIX TZ, the planner's windows are local time
+#endif
+#ifdef HISTORY_LITTLEFS
+const unsigned long HISTORY_FLUSH_MS = 3600000; // Hourly, the minute tier covers the gap
+#endif
+
+// External sensors, registered in this order by setupSensorBackends()
+#ifdef SENSOR_MUX
+// 74HC4051s sharing their select lines, one common output per ADC pin
+constexpr int MUX_SELECT_PINS[MUX_SELECT_BITS] = {6, 7, 21};
+constexpr int MUX_ADC_PINS[] = {1, 2};
+const int SENSOR_MUX_BACKEND = 0; // Zones use sensorAddress(SENSOR_MUX_BACKEND, 0..15)
+MuxSensorBackend sensorMux(MUX_SELECT_PINS, MUX_ADC_PINS, sizeof(MUX_ADC_PINS) / sizeof(MUX_ADC_PINS[0]));
+#endif
+#ifdef SENSOR_ADS1115
+const int I2C_SDA_PIN = 8;
+const int I2C_SCL_PIN = 10;
+constexpr int I2C_PINS[] = {I2C_SDA_PIN, I2C_SCL_PIN};
+const uint32_t I2C_FREQUENCY = 400000;
+const uint8_t ADS_ADDRESSES[] = {0x48, 0x49};
+#ifdef SENSOR_MUX
+const int SENSOR_ADS_BACKEND = 1; // Zones use sensorAddress(SENSOR_ADS_BACKEND, 0..7)
+#else
+const int SENSOR_ADS_BACKEND = 0;
+#endif
+WireI2cBus i2cBus;
+Ads1115Backend sensorAds(i2cBus, ADS_ADDRESSES, sizeof(ADS_ADDRESSES));
+#endif
+
+// Zone configuration: id, name, sensor pin or sensorAddress(), pump relay pin
+constexpr ZoneDefinition ZONE_TABLE[] = {
+    {1, "Garden Bed 1", 0, 5},
+    // {2, "Planter", sensorAddress(SENSOR_MUX_BACKEND, 0), 20}, // With -DSENSOR_MUX
+};
+
+static_assert(zoneIdsValid(ZONE_TABLE), "zone ids must be unique and within 0..MAX_ZONE_ID");
+static_assert(zonePinsValid(ZONE_TABLE), "sensors need an ADC1 pin (GPIO0-4) or a sensorAddress(), pumps a GPIO other than USB");
+static_assert(zonePinsDistinct(ZONE_TABLE), "a GPIO is used twice in ZONE_TABLE");
+static_assert(zoneThresholdsOrdered(ZONE_TABLE), "wet threshold must be above dry threshold");
+static_assert(zoneTableValid(ZONE_TABLE), "ZONE_TABLE must have 1..MAX_ZONES zones");
+#ifdef SENSOR_MUX
+static_assert(zonePinsAvoid(ZONE_TABLE, MUX_SELECT_PINS), "a mux select pin is also used in ZONE_TABLE");
+static_assert(zonePinsAvoid(ZONE_TABLE, MUX_ADC_PINS), "a mux ADC pin is also used in ZONE_TABLE");
+#endif
+#ifdef SENSOR_ADS1115
+static_assert(zonePinsAvoid(ZONE_TABLE, I2C_PINS), "an I2C pin is also used in ZONE_TABLE");
+#endif
+
+const size_t ZONE_COUNT = sizeof(ZONE_TABLE) / sizeof(ZONE_TABLE[0]);
+EspCutoffTimer cutoffTimers[ZONE_COUNT]; // Open each relay at its run limit, see PumpCutoff
+
+#if defined(SENSOR_MUX) || defined(SENSOR_ADS1115)
+void setupSensorBackends()
+{
+#ifdef SENSOR_MUX
+  sensorMux.begin();
+  WateringZone::addSensorBackend(&sensorMux);
+#endif
+#ifdef SENSOR_ADS1115
+  if (!i2cBus.begin(I2C_SDA_PIN, I2C_SCL_PIN, I2C_FREQUENCY) || !sensorAds.begin())
+  {
+    Serial.println("ADS1115: not all devices answer, their zones go stale and keep their pumps off");
+  }
+  WateringZone::addSensorBackend(&sensorAds);
+#endif
+}
+#endif
 
 void initializeZones()
 {
-  zones.push_back(WateringZone(1, "Garden Bed 1", 0, 5));
+  for (size_t i = 0; i < ZONE_COUNT; i++)
+  {
+    if (!WateringZone::attachCutoffTimer(i, &cutoffTimers[i]))
+    {
+      Serial.printf("Zone %d: no cutoff timer, pump runtime relies on the control task\n", ZONE_TABLE[i].id);
+    }
+  }
+  controller.addZones(ZONE_TABLE, ZONE_COUNT);
+  controller.init();
+}
+
+// The control task is the only code that touches zones and hardware.
+// It sleeps until the next sample, schedule slot, pump timeout, cooldown
+// expiry or settings flush, or until a config request notifies it.
+void controlTask(void *)
+{
+  for (;;)
+  {
+    unsigned long now = millis();
+    controller.tick(now);
+
+    unsigned long waitMs = controller.nextWakeTime(now) - millis();
+    if ((long)waitMs < 0)
+    {
+      waitMs = 0;
+    }
+    else if (waitMs > MAX_CONTROL_SLEEP_MS)
+    {
+      waitMs = MAX_CONTROL_SLEEP_MS;
+    }
+    ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(waitMs));
+  }
+}
+
+void wakeControlTask()
+{
+  if (controlTaskHandle)
+  {
+    xTaskNotifyGive(controlTaskHandle);
+  }
+}
 
-  for (auto &zone : zones)
+// A new snapshot: loop() pushes it to event clients and mesh peers
+void wakeLoopTask()
+{
+  if (loopTaskHandle)
   {
-    zone.init();
+    xTaskNotifyGive(loopTaskHandle);
   }
 }
 
@@ -53,9 +189,67 @@ bool setupWiFi()
   Serial.print("IP address: ");
   Serial.println(WiFi.localIP());
   Serial.println("Access the system at: http://" + WiFi.localIP().toString());
+
+  // SNTP runs in the background; the planner starts once the clock is set
+  configTzTime(TIME_ZONE, "pool.ntp.org", "time.nist.gov");
+  return true;
+}
+
+// Local time as seconds since the epoch, 0 until SNTP has set the clock
+uint32_t localWallClock()
+{
+  time_t now = time(nullptr);
+  if (now < (time_t)PLAN_CLOCK_VALID)
+  {
+    return 0;
+  }
+  struct tm local;
+  localtime_r(&now, &local);
+  long offset = (long)(local.tm_hour * 3600 + local.tm_min * 60 + local.tm_sec) - (long)(now % 86400);
+  if (offset > 14 * 3600)
+  {
+    offset -= 86400;
+  }
+  else if (offset < -12 * 3600)
+  {
+    offset += 86400;
+  }
+  return (uint32_t)(now + offset);
+}
+
+// Station mode has nothing to poll, loop() runs on snapshot publishes
+const unsigned long LOOP_WAIT_MS = 1000;
+
+void handleNetworkLoop()
+{
+}
+
+#elif defined(MESH_NODE)
+// Nodes join the aggregator's access point; their own pages stay reachable on the station IP
+bool setupWiFi()
+{
+  Serial.println("Joining mesh aggregator " + String(WIFI_SSID) + "...");
+
+  WiFi.mode(WIFI_STA);
+  WiFi.begin(WIFI_SSID, WIFI_PASSWORD);
+  for (int attempt = 0; attempt < 40 && WiFi.status() != WL_CONNECTED; attempt++)
+  {
+    vTaskDelay(pdMS_TO_TICKS(500));
+  }
+  if (WiFi.status() != WL_CONNECTED)
+  {
+    Serial.println("Aggregator not reachable");
+    return false;
+  }
+
+  Serial.print("IP address: ");
+  Serial.println(WiFi.localIP());
   return true;
 }
 
+// Config frames from the aggregator arrive on the UDP socket, polled by loop()
+const unsigned long LOOP_WAIT_MS = 250;
+
 void handleNetworkLoop()
 {
 }
@@ -91,245 +285,215 @@ bool setupWiFi()
   return true;
 }
 
+// The captive DNS server is polled from loop()
+const unsigned long LOOP_WAIT_MS = 50;
+
 void handleNetworkLoop()
 {
   dnsServer.processNextRequest();
 }
 #endif
 
+// The handlers live in the per-feature route files, see WebRoutes.h
 void setupWebServer()
 {
-  server.on("/", HTTP_GET, [](AsyncWebServerRequest *request)
-            {
-    for (auto& zone : zones) {
-      zone.updateSoilMoisture();
-    }
-    
-    String html = String(overview_html);
-    String zoneList = "";
-      for (auto& zone : zones) {
-      zoneList += "<div>";
-      zoneList += "<h4>" + zone.name + "</h4>";
-      zoneList += "<p>Moisture: " + String(zone.soilMoisturePercent) + "%</p>";
-      
-      if (zone.isSensorInAir()) {
-        zoneList += "<p class='error'>WARNING: SENSOR IN AIR</p>";
-      }
-      
-      String pumpClass = "off";
-      String pumpStatus = "OFF";
-      if (zone.pumpState) {
-        pumpClass = "on";
-        pumpStatus = "ON";
-      } else if (zone.isPumpInCooldown()) {
-        pumpClass = "cooldown";
-        pumpStatus = "COOLDOWN (" + String(zone.getRemainingCooldownSeconds()) + "s)";
-      }
-      
-      zoneList += "<p class='" + pumpClass + "'>Pump: " + pumpStatus + "</p>";
-      zoneList += "<a href='/zone/" + String(zone.id) + "'>Configure</a>";
-      zoneList += "</div>";
-    }
-    
-    html.replace("%ZONE_LIST%", zoneList);
-    request->send(200, "text/html", html); });
-
-  server.on("^/zone/([0-9]+)$", HTTP_GET, [](AsyncWebServerRequest *request)
-            {
-    String zoneIdStr = request->pathArg(0);
-    int zoneId = zoneIdStr.toInt();
-    
-    WateringZone* zone = nullptr;
-    for (auto& z : zones) {
-      if (z.id == zoneId) {
-        zone = &z;
-        break;
-      }
-    }
-    
-    if (!zone) {
-      request->send(404, "text/plain", "Zone not found");
-      return;
-    }
-    
-    zone->updateSoilMoisture();
-    
-    String html = String(zone_config_html);
-    html.replace("%ZONE_ID%", String(zone->id));
-    html.replace("%ZONE_NAME%", zone->name);
-    html.replace("%WET_THRESHOLD%", String(zone->moistureThresholdWet));
-    html.replace("%DRY_THRESHOLD%", String(zone->moistureThresholdDry));
-    html.replace("%MOISTURE_RAW%", String(zone->soilMoistureRaw));
-    html.replace("%MOISTURE_PERCENT%", String(zone->soilMoisturePercent));
-    html.replace("%PUMP_STATUS%", zone->pumpState ? "ON" : "OFF");
-    html.replace("%PUMP_CLASS%", zone->pumpState ? "on" : "off");
-    html.replace("%AIR_VALUE%", String(zone->airValue));
-    html.replace("%DRY_VALUE%", String(zone->dryValue));
-    html.replace("%WATER_VALUE%", String(zone->waterValue));
-    html.replace("%MAX_RUNTIME_SEC%", String(zone->maxPumpRuntimeMs / 1000));
-    html.replace("%COOLDOWN_SEC%", String(zone->pumpCooldownMs / 1000));
-    
-    String sensorStatus = "";
-    if (zone->isSensorInAir()) {
-      sensorStatus = "<p class='error'>WARNING: SENSOR IN AIR - Check sensor placement!</p>";
-    }
-    html.replace("%SENSOR_STATUS%", sensorStatus);
-    
-    String cooldownInfo = "";
-    if (zone->isPumpInCooldown()) {
-      cooldownInfo = "<p class='cooldown'>Cooldown: " + String(zone->getRemainingCooldownSeconds()) + " seconds</p>";
-    }
-    html.replace("%COOLDOWN_INFO%", cooldownInfo);
-    
-    request->send(200, "text/html", html); });
-
-  server.on("^/zone/([0-9]+)/config$", HTTP_GET, [](AsyncWebServerRequest *request)
-            {
-    String zoneIdStr = request->pathArg(0);
-    int zoneId = zoneIdStr.toInt();
-    
-    WateringZone* zone = nullptr;
-    for (auto& z : zones) {
-      if (z.id == zoneId) {
-        zone = &z;
-        break;
-      }
-    }
-    
-    if (!zone) {
-      request->send(404, "text/plain", "Zone not found");
-      return;
-    }
-    
-    bool settingsChanged = false;
-    
-    if (request->hasParam("wetThreshold")) {
-      int newValue = request->getParam("wetThreshold")->value().toInt();
-      newValue = constrain(newValue, 0, 100);
-      if (zone->moistureThresholdWet != newValue) {
-        zone->moistureThresholdWet = newValue;
-        zone->saveSetting("wet", newValue);
-        settingsChanged = true;
-      }
-    }
-    
-    if (request->hasParam("dryThreshold")) {
-      int newValue = request->getParam("dryThreshold")->value().toInt();
-      newValue = constrain(newValue, 0, 100);
-      if (zone->moistureThresholdDry != newValue) {
-        zone->moistureThresholdDry = newValue;
-        zone->saveSetting("dry", newValue);
-        settingsChanged = true;
-      }
-    }
-    
-    if (zone->moistureThresholdWet <= zone->moistureThresholdDry) {
-      Serial.printf("Zone %d: Invalid thresholds (wet=%d, dry=%d), fixing...\n", 
-                    zoneId, zone->moistureThresholdWet, zone->moistureThresholdDry);
-      zone->moistureThresholdWet = zone->moistureThresholdDry + 10;
-      zone->saveSetting("wet", zone->moistureThresholdWet);
-      settingsChanged = true;
-    }
-    
-    if (request->hasParam("airValue")) {
-      int newValue = request->getParam("airValue")->value().toInt();
-      newValue = constrain(newValue, 0, 4095);
-      if (zone->airValue != newValue) {
-        zone->airValue = newValue;
-        zone->saveSetting("air", newValue);
-        settingsChanged = true;
-      }
-    }
-    
-    if (request->hasParam("dryValue")) {
-      int newValue = request->getParam("dryValue")->value().toInt();
-      newValue = constrain(newValue, 0, 4095);
-      if (zone->dryValue != newValue) {
-        zone->dryValue = newValue;
-        zone->saveSetting("dryVal", newValue);
-        settingsChanged = true;
-      }
-    }
-    
-    if (request->hasParam("waterValue")) {
-      int newValue = request->getParam("waterValue")->value().toInt();
-      newValue = constrain(newValue, 0, 4095);
-      if (zone->waterValue != newValue) {
-        zone->waterValue = newValue;
-        zone->saveSetting("water", newValue);
-        settingsChanged = true;
-      }
-    }
-    
-    if (request->hasParam("maxRuntime")) {
-      int newValue = request->getParam("maxRuntime")->value().toInt();
-      newValue = constrain(newValue, 1, 300);
-      unsigned long newValueMs = newValue * 1000UL;
-      if (zone->maxPumpRuntimeMs != newValueMs) {
-        zone->maxPumpRuntimeMs = newValueMs;
-        zone->saveSetting("maxRun", newValue);
-        settingsChanged = true;
-      }
-    }
-    
-    if (request->hasParam("cooldown")) {
-      int newValue = request->getParam("cooldown")->value().toInt();
-      newValue = constrain(newValue, 1, 3600);
-      unsigned long newValueMs = newValue * 1000UL;
-      if (zone->pumpCooldownMs != newValueMs) {
-        zone->pumpCooldownMs = newValueMs;
-        zone->saveSetting("cooldown", newValue);
-        settingsChanged = true;
-      }
-    }
-    
-    if (settingsChanged) {
-      Serial.printf("Zone %d settings updated via web interface\n", zoneId);
-    }
-    
-    request->redirect("/zone/" + String(zoneId)); });
+  server.addMiddleware(admitRequest);
+  setupZoneRoutes(server);
+  setupStatusRoutes(server);
+  setupUpdateRoutes(server);
+#ifdef SENSOR_TRACE
+  setupTraceRoutes(server);
+#endif
+#ifdef MESH_AGGREGATOR
+  setupMeshRoutes(server);
+#endif
+  server.addHandler(&events);
 
+  // Connectivity checks of phones and laptops get a fixed redirect to the
+  // portal, which makes them open the dashboard; anything else goes to /
   server.onNotFound([](AsyncWebServerRequest *request)
-                    { request->redirect("/"); });
+                    {
+    if (isCaptiveProbe(request->url().c_str())) {
+      AsyncWebServerResponse* response = request->beginResponse(302, "text/plain", "");
+      response->addHeader("Location", "http://192.168.4.1/");
+      response->addHeader("Cache-Control", "no-store");
+      request->send(response);
+      return;
+    }
+    request->redirect("/"); });
 
   server.begin();
   Serial.println("HTTP server started");
 }
 
-void setup()
+// Push pump, cooldown, air and threshold changes to connected dashboards.
+// Runs on the Arduino loop task, batching everything published within
+// EVENT_BATCH_MS into one event.
+// True while a change waits for the end of the batch window
+bool pushZoneEvents()
 {
-  Serial.begin(115200);
-  delay(2000);
-  Serial.println("Setting up multi-zone watering system...");
+  static SystemSnapshot eventSnapshot;
+  static char eventBuffer[STATUS_JSON_MAX];
+  static uint32_t lastVersion = 0;
+  static unsigned long lastPush = 0;
 
-  initializeZones();
-  analogReadResolution(12);
+  unsigned long now = millis();
+  if (controller.snapshotVersion() == lastVersion)
+  {
+    return false;
+  }
+  if (now - lastPush < EVENT_BATCH_MS)
+  {
+    return true;
+  }
+  if (!controller.readSnapshot(eventSnapshot))
+  {
+    return false;
+  }
+  lastVersion = eventSnapshot.version;
 
-  if (!setupWiFi())
+  // Keep tracking changes even without clients so a new client isn't sent stale deltas
+  size_t length = zoneEvents.collectChanges(eventSnapshot, eventBuffer, sizeof(eventBuffer));
+  if (length > 0 && events.count() > 0)
   {
-    Serial.println("WiFi setup failed! Restarting...");
-    delay(3000);
-    ESP.restart();
+    events.send(eventBuffer, "zones", eventSnapshot.version);
+    lastPush = now;
   }
+  return false;
+}
 
-  delay(500);
+#ifdef HISTORY_LITTLEFS
+// Optional persistence of the moisture history (build with -DHISTORY_LITTLEFS)
+static MoistureHistory historyScratch; // Only used by setup() and the loop task
 
+void saveHistory()
+{
+  int zoneId;
+  for (size_t i = 0; controller.copyHistory(i, zoneId, historyScratch); i++)
+  {
+    saveHistoryFile(zoneId, historyScratch);
+  }
+}
+
+void loadHistory()
+{
+  if (!LittleFS.begin(true))
+  {
+    Serial.println("LittleFS not available, history starts empty");
+    return;
+  }
+
+  uint32_t latest = 0;
+  for (const ZoneDefinition &definition : ZONE_TABLE)
+  {
+    if (loadHistoryFile(definition.id, historyScratch) && controller.restoreHistory(definition.id, historyScratch))
+    {
+      latest = historyScratch.latestTime() > latest ? historyScratch.latestTime() : latest;
+    }
+  }
+
+  // Continue the timeline after the restored samples (downtime is not visible)
+  MoistureHistory::clockOffset = latest + 1;
+}
+#endif
+
+// Brings up WiFi and the web server without holding up the zones. The
+// WiFiManager portal can block for minutes; a failed attempt is retried
+// here instead of restarting, which would interrupt watering.
+void networkTask(void *)
+{
+  while (!setupWiFi())
+  {
+    Serial.printf("WiFi setup failed, retrying in %lus\n", WIFI_RETRY_MS / 1000);
+    vTaskDelay(pdMS_TO_TICKS(WIFI_RETRY_MS));
+  }
+
+  setupPowerSaving();
   setupWebServer();
+#if defined(MESH_NODE) || defined(MESH_AGGREGATOR)
+  setupMesh();
+#endif
+  webReadyMs = millis();
+  networkReady = true;
 
-  Serial.println("Multi-zone watering system ready!");
+  Serial.printf("Multi-zone watering system ready! (web %lums after boot)\n", webReadyMs);
+  vTaskDelete(nullptr);
 }
 
-void loop()
+void setup()
 {
-  handleNetworkLoop();
+  Serial.begin(115200);
+  Serial.println("Setting up multi-zone watering system...");
+  beginLogFile();
 
-  static unsigned long lastCheck = 0;
-  if (millis() - lastCheck > 10000)
+  // Zones first: control runs before the filesystem and network are up
+  analogReadResolution(12);
+#ifdef SENSOR_TRACE
+#ifdef USE_WIFI_MANAGER
+  setupTrace(ZONE_TABLE, ZONE_COUNT, localWallClock);
+#else
+  setupTrace(ZONE_TABLE, ZONE_COUNT, nullptr);
+#endif
+#endif
+#if defined(SENSOR_MUX) || defined(SENSOR_ADS1115)
+  setupSensorBackends();
+#endif
+  initializeZones();
+  controller.setWakeHook(wakeControlTask);
+  loopTaskHandle = xTaskGetCurrentTaskHandle(); // setup() runs on the loop task
+  controller.setPublishHook(wakeLoopTask);
+#ifdef USE_WIFI_MANAGER
+  controller.setWallClock(localWallClock);
+#endif
+#ifdef HISTORY_LITTLEFS
+  // Before the control task records anything: restoring replaces the
+  // zones' history and sets the clock offset new samples are stamped with
+  loadHistory();
+#endif
+  xTaskCreate(controlTask, "control", 4096, nullptr, 2, &controlTaskHandle);
+  xTaskCreate(networkTask, "network", 8192, nullptr, 1, nullptr);
+}
+
+void loop()
+{
+  drainLog();
+#ifdef SENSOR_TRACE
+  drainTrace();
+#endif
+  pollUpdates(networkReady && controller.snapshotVersion() > 0);
+  sampleIdle();
+  unsigned long waitMs = LOOP_WAIT_MS;
+  if (networkReady)
   {
-    for (auto &zone : zones)
+    handleNetworkLoop();
+    if (pushZoneEvents() && waitMs > EVENT_BATCH_MS)
     {
-      zone.updateSoilMoisture();
+      waitMs = EVENT_BATCH_MS;
     }
-    lastCheck = millis();
+#if defined(MESH_NODE) || defined(MESH_AGGREGATOR)
+    pollMesh();
+#endif
   }
-}
\ No newline at end of file
+
+#ifdef ENABLE_METRICS
+  static unsigned long lastHeapSample = 0;
+  if (millis() - lastHeapSample >= 1000)
+  {
+    METRIC_SAMPLE_HEAP();
+    lastHeapSample = millis();
+  }
+#endif
+
+#ifdef HISTORY_LITTLEFS
+  static unsigned long lastHistoryFlush = 0;
+  if (millis() - lastHistoryFlush >= HISTORY_FLUSH_MS)
+  {
+    saveHistory();
+    lastHistoryFlush = millis();
+  }
+#endif
+
+  // Nothing here needs to spin: sleep until a snapshot is published or the
+  // next housekeeping round, and let the idle task (and light sleep) run
+  ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(waitMs));
+}
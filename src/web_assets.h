@@ -0,0 +1,184 @@
+// Generated by tools/embed_assets.py from web/ - do not edit
+#ifndef WEB_ASSETS_H
+#define WEB_ASSETS_H
+#include <Arduino.h>
+
+// index.html: 3338 bytes, 1320 gzipped
+const uint8_t index_html_gz[] PROGMEM = {
+  0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0x8d, 0x57, 0x5b, 0x73, 0x1a, 0x37,
+  0x14, 0x7e, 0xcf, 0xaf, 0x38, 0x26, 0xd3, 0xb0, 0x9e, 0xda, 0x0b, 0x69, 0x1d, 0x37, 0xe1, 0xd6,
+  0x89, 0x09, 0x6e, 0xdd, 0x49, 0x20, 0x63, 0x67, 0x26, 0xd3, 0x76, 0xfa, 0x20, 0x4b, 0x5a, 0x56,
+  0x8d, 0x90, 0xb6, 0x92, 0x80, 0x10, 0x87, 0xff, 0xde, 0x23, 0xed, 0x85, 0x65, 0x71, 0x1c, 0xbf,
+  0x60, 0x38, 0x97, 0x4f, 0xe7, 0xf2, 0xe9, 0x1c, 0x79, 0x70, 0xf4, 0x66, 0x36, 0xfe, 0xf0, 0xe7,
+  0xfb, 0x09, 0xfc, 0xfe, 0xe1, 0xdd, 0xdb, 0xd1, 0x20, 0x75, 0x0b, 0x89, 0x9f, 0x9c, 0xb0, 0xd1,
+  0x13, 0x80, 0x81, 0x13, 0x4e, 0xf2, 0xd1, 0x47, 0xe2, 0xb8, 0x11, 0x6a, 0x0e, 0x37, 0x1b, 0xeb,
+  0xf8, 0x62, 0xd0, 0xc9, 0xc5, 0xde, 0x60, 0xc1, 0x1d, 0x01, 0x45, 0x16, 0x7c, 0xd8, 0x5a, 0x09,
+  0xbe, 0xce, 0xb4, 0x71, 0x2d, 0xa0, 0x5a, 0x39, 0xae, 0xdc, 0xb0, 0xb5, 0x16, 0xcc, 0xa5, 0x43,
+  0xc6, 0x57, 0x82, 0xf2, 0xd3, 0xf0, 0xe3, 0x04, 0x84, 0x12, 0x4e, 0x10, 0x79, 0x6a, 0x29, 0x91,
+  0x7c, 0xf8, 0xbc, 0x15, 0x60, 0xac, 0xdb, 0xe4, 0x80, 0x00, 0xb7, 0x9a, 0x6d, 0xe0, 0x0e, 0x16,
+  0xc4, 0xcc, 0x85, 0xea, 0xc1, 0xf3, 0x6e, 0xf6, 0xb9, 0x0f, 0x09, 0x22, 0x9e, 0x5a, 0xf1, 0x85,
+  0xa3, 0xe0, 0xa5, 0x17, 0x6c, 0x83, 0x2d, 0x13, 0x2b, 0x34, 0xbd, 0xd5, 0x86, 0x71, 0x83, 0x9a,
+  0xec, 0x33, 0x58, 0x2d, 0x05, 0x83, 0xa7, 0x94, 0xd2, 0x3e, 0x64, 0x84, 0x31, 0x8c, 0xba, 0xc4,
+  0x28, 0x11, 0x5f, 0xa0, 0x59, 0xb7, 0x44, 0x88, 0xb5, 0xf2, 0x08, 0x84, 0x7e, 0x9a, 0x1b, 0xbd,
+  0x54, 0xac, 0x07, 0x4f, 0x5f, 0x75, 0x27, 0x93, 0x57, 0x35, 0x83, 0x24, 0x69, 0x5a, 0x5c, 0x5e,
+  0x5e, 0x9c, 0x8f, 0x9f, 0x57, 0x16, 0x54, 0x6b, 0xc9, 0xf4, 0x5a, 0x1d, 0x9a, 0xbd, 0x7e, 0xd1,
+  0xdd, 0x01, 0x71, 0x63, 0xb4, 0x39, 0xb4, 0x39, 0xbf, 0x38, 0xbf, 0xe8, 0x63, 0xc9, 0xa4, 0xc6,
+  0x14, 0xd6, 0xa9, 0x70, 0xbc, 0x48, 0x77, 0xcd, 0xc5, 0x3c, 0x75, 0x3d, 0x4c, 0x4f, 0xb2, 0x12,
+  0x84, 0xa0, 0x3f, 0x13, 0x36, 0x93, 0x64, 0x83, 0x0a, 0xa9, 0xe9, 0xa7, 0x3e, 0x38, 0xfe, 0xd9,
+  0x9d, 0x32, 0x4e, 0xb5, 0x21, 0x4e, 0x68, 0x4c, 0x50, 0x69, 0x85, 0x18, 0x7b, 0xc7, 0xbc, 0xfc,
+  0x65, 0x3c, 0x99, 0x5c, 0xd4, 0x4a, 0xf2, 0xf2, 0x9e, 0x8a, 0x04, 0x20, 0x22, 0xc5, 0x1c, 0x45,
+  0x14, 0xfb, 0xc7, 0x4d, 0x7e, 0xec, 0xa0, 0x53, 0xb4, 0x67, 0xd0, 0x09, 0xc4, 0x18, 0xf8, 0x16,
+  0x85, 0xb6, 0xa5, 0x3f, 0x1d, 0x72, 0x03, 0x65, 0x5e, 0x45, 0x20, 0x35, 0x3c, 0x19, 0xb6, 0x9e,
+  0xb6, 0x40, 0x2b, 0x2a, 0x05, 0xfd, 0x34, 0x6c, 0xa1, 0xc0, 0x70, 0x9b, 0x46, 0xc7, 0x7d, 0x30,
+  0xdc, 0x2d, 0x8d, 0x82, 0x84, 0x48, 0xcb, 0xfb, 0xad, 0xd1, 0x75, 0xae, 0x19, 0x74, 0x48, 0x4e,
+  0x07, 0x4e, 0x7d, 0x2a, 0x20, 0xd8, 0xb0, 0xf5, 0x05, 0xb3, 0xb1, 0xad, 0x11, 0x06, 0x91, 0x0b,
+  0x73, 0x03, 0x6a, 0x44, 0xe6, 0x72, 0xc2, 0x74, 0x3a, 0xf0, 0x17, 0xda, 0x04, 0x16, 0x5a, 0x50,
+  0x7c, 0xc5, 0x0d, 0xd0, 0x94, 0xa8, 0x39, 0x07, 0xe2, 0xc0, 0x2c, 0x95, 0x13, 0x0b, 0x7e, 0x82,
+  0x51, 0xc8, 0x0d, 0xb8, 0x94, 0x83, 0x75, 0x18, 0x32, 0x08, 0x0b, 0x99, 0x96, 0x92, 0xb3, 0x80,
+  0xb1, 0x22, 0xa6, 0xf0, 0x1f, 0xc2, 0xdd, 0xb6, 0x5f, 0xc9, 0x10, 0xcb, 0xfa, 0x40, 0x86, 0x58,
+  0x9f, 0x27, 0x41, 0x9a, 0x2c, 0x55, 0x1e, 0x9b, 0x8f, 0x6b, 0x4c, 0x0c, 0x8b, 0xfc, 0x97, 0x63,
+  0xb8, 0x0b, 0xda, 0xdc, 0x8b, 0xa2, 0x18, 0x5d, 0x98, 0xa6, 0xcb, 0x05, 0xd6, 0x31, 0x9e, 0x73,
+  0x37, 0x91, 0xdc, 0x7f, 0xbd, 0xd8, 0x5c, 0xb1, 0xa8, 0xed, 0x3d, 0x4e, 0xdb, 0xf0, 0x63, 0xc0,
+  0x88, 0x05, 0x3b, 0xee, 0x17, 0xce, 0x22, 0x81, 0xe8, 0xc8, 0x7b, 0xef, 0xf0, 0xe0, 0x00, 0x8d,
+  0x1a, 0x8e, 0x09, 0x14, 0x80, 0x51, 0x1b, 0xef, 0x40, 0xbb, 0x02, 0xc8, 0xad, 0x11, 0x12, 0x1d,
+  0x0e, 0x8e, 0x69, 0x1a, 0x29, 0xc5, 0x8d, 0xbf, 0xf5, 0xde, 0x76, 0x90, 0x9e, 0x61, 0x89, 0xfd,
+  0x47, 0x06, 0x54, 0x12, 0x6b, 0x87, 0xad, 0x85, 0x16, 0x16, 0x9b, 0xc4, 0x7d, 0xed, 0xb3, 0x9a,
+  0x3c, 0xf0, 0xb8, 0x05, 0xa9, 0x60, 0x8c, 0xab, 0xd1, 0xc7, 0xd7, 0xd7, 0xd3, 0xab, 0xe9, 0x6f,
+  0x3d, 0xb8, 0x99, 0x4c, 0x6f, 0x66, 0xd7, 0x70, 0x35, 0x85, 0xd7, 0x57, 0xd7, 0xde, 0x03, 0x4f,
+  0xae, 0x0e, 0x04, 0x3c, 0xa1, 0x02, 0xc8, 0x96, 0x8b, 0xac, 0x00, 0x2d, 0x59, 0xd2, 0xf1, 0x21,
+  0x76, 0x6a, 0xb1, 0xe2, 0xb7, 0x76, 0x6b, 0x34, 0xd6, 0x2a, 0x11, 0x73, 0x8c, 0xc1, 0x13, 0xa3,
+  0xdd, 0x88, 0xff, 0xbf, 0x25, 0x37, 0x9b, 0x1b, 0x2e, 0x91, 0x16, 0xda, 0x44, 0xed, 0xf4, 0xac,
+  0x7d, 0x1c, 0x7b, 0x0a, 0x8f, 0xf3, 0xe9, 0x83, 0x59, 0x85, 0x8e, 0xfe, 0x5d, 0x20, 0xfe, 0x03,
+  0x5f, 0xbf, 0x42, 0xd4, 0x0e, 0x54, 0xb9, 0xaf, 0xf6, 0xf0, 0x70, 0xbf, 0x2c, 0xa2, 0x93, 0x2c,
+  0xe3, 0x8a, 0x8d, 0x53, 0x21, 0x59, 0x14, 0xba, 0x54, 0xfa, 0x6e, 0x8b, 0xbf, 0x05, 0xab, 0xbd,
+  0x2e, 0x57, 0x6d, 0x1b, 0xa4, 0x31, 0xe8, 0xcf, 0x4d, 0xc4, 0x88, 0x23, 0xbb, 0x16, 0xfb, 0x5f,
+  0x71, 0x38, 0x23, 0x4e, 0xb4, 0x99, 0x10, 0x9a, 0x46, 0x95, 0x43, 0x83, 0x5d, 0x7b, 0xfc, 0xda,
+  0x67, 0xe0, 0xc3, 0xd5, 0x89, 0xcb, 0x6e, 0x1e, 0x14, 0xa9, 0xfd, 0xae, 0xd0, 0xf4, 0x76, 0x65,
+  0x59, 0xf8, 0xf2, 0xff, 0xf0, 0x9d, 0x82, 0xe7, 0x03, 0x0d, 0xf1, 0x72, 0x26, 0x20, 0xd4, 0x51,
+  0x70, 0x26, 0xfd, 0xbd, 0x60, 0x7d, 0xb7, 0x51, 0x77, 0x2f, 0x82, 0xd7, 0xd5, 0xc9, 0xeb, 0xf9,
+  0x1f, 0x30, 0xb2, 0x7a, 0xca, 0x10, 0x30, 0xe2, 0xc0, 0x9e, 0x29, 0xb6, 0xd4, 0x07, 0x1d, 0x50,
+  0xb5, 0xaa, 0x85, 0x58, 0x58, 0x35, 0x92, 0x7b, 0x8f, 0xb2, 0x1e, 0xcc, 0xa6, 0x35, 0xc3, 0x2d,
+  0x70, 0x1c, 0x3a, 0xbb, 0xb3, 0x28, 0x8c, 0xa0, 0xfb, 0xa8, 0xf3, 0xca, 0x41, 0xff, 0xc8, 0x53,
+  0xc7, 0xb3, 0xd9, 0xdb, 0x37, 0xb3, 0x8f, 0x53, 0x64, 0x5d, 0x59, 0x58, 0xea, 0x0b, 0x6b, 0x8f,
+  0x0f, 0xa3, 0x79, 0x4c, 0xb6, 0x49, 0xf2, 0xd8, 0x74, 0x2f, 0x2f, 0xeb, 0x27, 0x94, 0x24, 0x3d,
+  0xfe, 0x16, 0x27, 0x8b, 0xa9, 0x5c, 0x05, 0x91, 0x70, 0x87, 0x1c, 0x6c, 0x77, 0x48, 0x26, 0x3a,
+  0x39, 0xf7, 0x4f, 0x70, 0xef, 0x50, 0x24, 0xa6, 0x27, 0x89, 0xd2, 0xa7, 0xe1, 0x6b, 0x1b, 0x11,
+  0xab, 0x43, 0x62, 0x9c, 0xac, 0xaa, 0x46, 0x5b, 0x83, 0x68, 0xe5, 0x75, 0x30, 0xb1, 0x1f, 0xb9,
+  0x4b, 0x9c, 0xad, 0x43, 0xf8, 0xb9, 0x7b, 0x06, 0xbf, 0x82, 0x5a, 0x4a, 0x09, 0x3d, 0x54, 0xfc,
+  0x6b, 0xb5, 0xf2, 0xeb, 0xe0, 0x01, 0xa4, 0xfd, 0xbb, 0x52, 0xb2, 0xc4, 0x4b, 0xe1, 0xd9, 0xb3,
+  0xfc, 0xee, 0xac, 0xe0, 0x68, 0x58, 0x8e, 0xea, 0x7d, 0x53, 0xa8, 0x4d, 0xf0, 0xdc, 0xb4, 0xbf,
+  0xa7, 0xad, 0xdf, 0xc7, 0xba, 0x66, 0xbb, 0xab, 0x5e, 0x2d, 0x32, 0x4a, 0xdc, 0xde, 0xdd, 0xc4,
+  0xb3, 0x1a, 0x45, 0xc5, 0x5d, 0xe4, 0x5b, 0x00, 0x44, 0x31, 0xdc, 0x35, 0xbe, 0xac, 0xc8, 0x98,
+  0x62, 0x1b, 0x59, 0x20, 0x86, 0x63, 0xd7, 0x6c, 0xca, 0x71, 0x9f, 0xfb, 0xe5, 0xe3, 0xd7, 0x66,
+  0x58, 0x4b, 0x19, 0xae, 0x47, 0x0b, 0xcb, 0x0c, 0xac, 0xd4, 0x6b, 0x28, 0xaf, 0x2a, 0x30, 0x23,
+  0x12, 0x57, 0xed, 0x22, 0xef, 0xf1, 0x01, 0x57, 0x99, 0xf1, 0x93, 0x0d, 0x0b, 0xd8, 0xdf, 0x6f,
+  0xa3, 0x57, 0x47, 0xc2, 0x6f, 0xed, 0x15, 0x91, 0xef, 0xec, 0xae, 0x0e, 0x54, 0x72, 0x62, 0xae,
+  0x0a, 0x45, 0x54, 0xa1, 0x54, 0xf9, 0xd6, 0x71, 0x2d, 0x77, 0x95, 0x65, 0xc1, 0x0b, 0xff, 0x62,
+  0xab, 0x40, 0xef, 0x67, 0x90, 0x5d, 0xde, 0xfa, 0x85, 0x7c, 0xcb, 0x6b, 0x1c, 0x0a, 0xab, 0x6c,
+  0x2d, 0x14, 0xde, 0x97, 0x78, 0xb2, 0x42, 0x7a, 0xde, 0xe8, 0xa5, 0xa1, 0x7b, 0xa3, 0x2c, 0x44,
+  0x8c, 0x2f, 0xa4, 0x6e, 0xad, 0xf4, 0x39, 0x65, 0x9a, 0x73, 0xd5, 0xa7, 0x6f, 0x83, 0xbf, 0xcf,
+  0x9d, 0xaf, 0xa1, 0x86, 0x88, 0x3c, 0xe5, 0xfe, 0x97, 0xdd, 0x0d, 0x92, 0xdc, 0x34, 0xc6, 0xb7,
+  0x4e, 0xb0, 0x7b, 0x8b, 0xe5, 0xe4, 0xb8, 0xeb, 0xca, 0x41, 0x7e, 0xb2, 0x8b, 0x3c, 0x3a, 0x98,
+  0xad, 0x81, 0x58, 0x43, 0xf8, 0xe3, 0x66, 0x36, 0x8d, 0x33, 0x62, 0x2c, 0x8f, 0x78, 0xdc, 0xa0,
+  0xc7, 0xb7, 0x29, 0x75, 0x1f, 0x9d, 0xb6, 0xcd, 0xb0, 0xb4, 0xd2, 0x59, 0x18, 0x97, 0x7b, 0x44,
+  0xca, 0xab, 0x71, 0xde, 0x0d, 0xe5, 0x80, 0xda, 0x4b, 0x69, 0x7b, 0xe0, 0x9e, 0x3f, 0x24, 0xef,
+  0xf5, 0xcf, 0xab, 0x59, 0xfa, 0x94, 0x7d, 0x6a, 0x5e, 0xe7, 0x8e, 0x50, 0x89, 0x6e, 0x97, 0xc4,
+  0x7e, 0xf8, 0xea, 0x1e, 0xdc, 0xd0, 0xa6, 0xb9, 0xc7, 0xaa, 0x17, 0xd1, 0xff, 0xfe, 0xde, 0x36,
+  0x6b, 0x6e, 0xe6, 0x7c, 0x97, 0xc5, 0x5e, 0xda, 0xaf, 0x15, 0x6c, 0x77, 0x66, 0x22, 0x14, 0x91,
+  0x72, 0xb3, 0x7f, 0xf7, 0x6a, 0x65, 0x2f, 0xab, 0x55, 0x89, 0x6a, 0x94, 0xdc, 0x6f, 0x04, 0xbe,
+  0x23, 0x8b, 0xb7, 0xe3, 0xa0, 0x13, 0xde, 0xb1, 0xf8, 0xea, 0xf1, 0xff, 0xf3, 0x3c, 0xf9, 0x1f,
+  0x09, 0xc3, 0x55, 0xb0, 0x0a, 0x0d, 0x00, 0x00,
+};
+const size_t index_html_gz_len = 1320;
+const char index_html_gz_etag[] = "\"b055c309\"";
+
+// mesh.html: 3237 bytes, 1324 gzipped
+const uint8_t mesh_html_gz[] PROGMEM = {
+  0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0x95, 0x57, 0x6d, 0x73, 0xda, 0x38,
+  0x10, 0xfe, 0x9e, 0x5f, 0xb1, 0x71, 0xa7, 0xb5, 0x99, 0x26, 0x86, 0xdc, 0x34, 0xbd, 0x16, 0x30,
+  0x9d, 0x86, 0x90, 0xbb, 0xcc, 0x34, 0xd0, 0x69, 0x32, 0x93, 0xb9, 0xeb, 0xf4, 0x83, 0xb0, 0x16,
+  0xac, 0xab, 0x6d, 0xf9, 0x64, 0x19, 0x42, 0xdb, 0xfc, 0xf7, 0x5b, 0xc9, 0x18, 0x8c, 0xe1, 0xae,
+  0x39, 0x3e, 0x80, 0xb5, 0xbb, 0x7a, 0xf6, 0xed, 0xd1, 0x5a, 0xf4, 0x8f, 0x2f, 0x27, 0xc3, 0xbb,
+  0x3f, 0x3e, 0x8e, 0xe0, 0xf7, 0xbb, 0x9b, 0x0f, 0x83, 0x7e, 0xa4, 0x93, 0x98, 0xbe, 0x91, 0xf1,
+  0xc1, 0x11, 0x40, 0x5f, 0x0b, 0x1d, 0xe3, 0xe0, 0x9e, 0x69, 0x54, 0x22, 0x9d, 0xc3, 0x0d, 0xe6,
+  0x51, 0xbf, 0x5d, 0x0a, 0x8d, 0x3a, 0x41, 0xcd, 0x20, 0x65, 0x09, 0x06, 0xce, 0x42, 0xe0, 0x32,
+  0x93, 0x4a, 0x3b, 0x10, 0xca, 0x54, 0x63, 0xaa, 0x03, 0x67, 0x29, 0xb8, 0x8e, 0x02, 0x8e, 0x0b,
+  0x11, 0xe2, 0xa9, 0x5d, 0x9c, 0x80, 0x48, 0x85, 0x16, 0x2c, 0x3e, 0xcd, 0x43, 0x16, 0x63, 0x70,
+  0xe6, 0x58, 0x98, 0x5c, 0xaf, 0x4a, 0x40, 0x80, 0xa9, 0xe4, 0x2b, 0xf8, 0x0e, 0x09, 0x53, 0x73,
+  0x91, 0x76, 0xe1, 0xac, 0x93, 0x3d, 0xf4, 0x60, 0x46, 0x88, 0xa7, 0xb9, 0xf8, 0x86, 0x24, 0x78,
+  0x63, 0x04, 0x8f, 0xd6, 0x96, 0x8b, 0x05, 0x99, 0x4e, 0xa5, 0xe2, 0xa8, 0x48, 0x93, 0x3d, 0x40,
+  0x2e, 0x63, 0xc1, 0xe1, 0x59, 0x18, 0x86, 0x3d, 0xc8, 0x18, 0xe7, 0x14, 0x73, 0x85, 0x51, 0x21,
+  0x9e, 0x93, 0x59, 0xa7, 0x42, 0xf0, 0x65, 0x6a, 0x10, 0x58, 0xf8, 0x75, 0xae, 0x64, 0x91, 0xf2,
+  0x2e, 0x3c, 0x7b, 0xdb, 0x19, 0x8d, 0xde, 0xd6, 0x0c, 0x66, 0xb3, 0xa6, 0xc5, 0xd5, 0xd5, 0xc5,
+  0xeb, 0xe1, 0xd9, 0xc6, 0x22, 0x94, 0x32, 0xe6, 0x72, 0x99, 0xee, 0x9b, 0xbd, 0x3f, 0xef, 0x6c,
+  0x81, 0x50, 0x29, 0xa9, 0xf6, 0x6d, 0x5e, 0x5f, 0xbc, 0xbe, 0xe8, 0x51, 0xc9, 0x62, 0x49, 0x29,
+  0x2c, 0x23, 0xa1, 0x71, 0x9d, 0xee, 0x12, 0xc5, 0x3c, 0xd2, 0x5d, 0x4a, 0x2f, 0xe6, 0xf5, 0x68,
+  0x62, 0x91, 0x22, 0xc1, 0xc8, 0x8c, 0x85, 0x42, 0xaf, 0xba, 0xd0, 0xf1, 0xcf, 0x2b, 0xb5, 0x48,
+  0xb3, 0x42, 0x93, 0xce, 0x96, 0xba, 0x0b, 0xaf, 0x30, 0xa9, 0x34, 0x8c, 0xa4, 0x5c, 0xe4, 0x59,
+  0xcc, 0x68, 0xc7, 0x34, 0x96, 0xe1, 0xd7, 0x1e, 0x68, 0x7c, 0xd0, 0xa7, 0x1c, 0x43, 0xa9, 0x98,
+  0x16, 0x92, 0x2a, 0x93, 0xca, 0x94, 0x9c, 0xef, 0xc4, 0xf7, 0xe6, 0xd7, 0xe1, 0x68, 0x74, 0x51,
+  0xab, 0xe5, 0x9b, 0x03, 0xa5, 0xb4, 0x40, 0x2c, 0x16, 0x73, 0x12, 0x85, 0xd4, 0x78, 0x54, 0xa5,
+  0xdb, 0x7e, 0x7b, 0xdd, 0xd7, 0x7e, 0xdb, 0xf2, 0xa9, 0x6f, 0x7a, 0x6b, 0xfb, 0x1d, 0xfd, 0xd2,
+  0xa4, 0x14, 0x49, 0x8c, 0x82, 0x41, 0xa4, 0x70, 0x16, 0x38, 0x6d, 0x67, 0x70, 0x17, 0x89, 0x9c,
+  0x42, 0xe2, 0xd8, 0x6f, 0xb3, 0x92, 0x24, 0x18, 0x9a, 0x38, 0x41, 0xf0, 0xc0, 0x31, 0xf2, 0xdc,
+  0x19, 0x90, 0x87, 0x52, 0x58, 0x1a, 0x84, 0x4a, 0x64, 0xba, 0xa4, 0x51, 0xbb, 0x0d, 0x13, 0xaa,
+  0x53, 0xc8, 0x14, 0x87, 0x0c, 0x15, 0x28, 0x4c, 0xa4, 0x46, 0xf8, 0x46, 0x29, 0x9e, 0x80, 0x49,
+  0x2f, 0x43, 0x0e, 0xd3, 0x95, 0x75, 0x40, 0x19, 0x90, 0xd7, 0x3c, 0xa2, 0x42, 0xe7, 0xc0, 0x14,
+  0x52, 0xfd, 0xd5, 0x92, 0x36, 0x92, 0x05, 0x29, 0x64, 0x31, 0x8f, 0xe8, 0x17, 0x81, 0xcd, 0xe7,
+  0x0a, 0xe7, 0x4c, 0x4b, 0x65, 0x3d, 0xcc, 0x8a, 0xb4, 0x8c, 0xc7, 0x60, 0x0e, 0xc9, 0xdc, 0x33,
+  0x58, 0x27, 0x76, 0xd9, 0x82, 0xef, 0xd6, 0x06, 0x60, 0xc1, 0x14, 0x05, 0x0c, 0x01, 0xb8, 0x46,
+  0x7e, 0xea, 0xc2, 0x4b, 0xeb, 0xd2, 0x27, 0xd9, 0x4b, 0x70, 0xed, 0xda, 0x28, 0x68, 0xdd, 0xab,
+  0xed, 0xb0, 0x61, 0x07, 0xc0, 0x65, 0x58, 0x24, 0x54, 0x50, 0x7f, 0x8e, 0x7a, 0x14, 0xa3, 0x79,
+  0xbc, 0x58, 0x5d, 0x73, 0x4f, 0xf0, 0x56, 0x65, 0x2d, 0x66, 0xe0, 0x1d, 0x1b, 0xf3, 0xad, 0x4b,
+  0xd8, 0xdb, 0x1e, 0x2a, 0xa4, 0x6a, 0xaf, 0x11, 0x3c, 0x97, 0x8e, 0x8d, 0xbb, 0x01, 0x28, 0xad,
+  0x7d, 0x1b, 0xe3, 0x36, 0x88, 0x4a, 0x9a, 0xa6, 0xa8, 0xcc, 0x5c, 0x30, 0x09, 0xf4, 0xa3, 0x57,
+  0x54, 0x70, 0xf3, 0x95, 0x41, 0x18, 0xb3, 0x3c, 0x0f, 0x9c, 0x44, 0x8a, 0x5c, 0x17, 0x0a, 0x4d,
+  0x27, 0xb2, 0x9a, 0xdc, 0x72, 0xdd, 0x81, 0x48, 0x70, 0x8e, 0xe9, 0xe0, 0xfe, 0xfd, 0xa7, 0xf1,
+  0xf5, 0xf8, 0xb7, 0x2e, 0xdc, 0x8e, 0xc6, 0xb7, 0x93, 0x4f, 0x70, 0x3d, 0x86, 0xf7, 0xd7, 0x9f,
+  0xcc, 0x0e, 0x4a, 0x7f, 0xe3, 0x10, 0xc8, 0xc3, 0x06, 0x20, 0x2b, 0x92, 0x6c, 0x0d, 0x4a, 0xcd,
+  0x48, 0x06, 0xf7, 0xa8, 0xa1, 0x5f, 0xd2, 0xbb, 0x9c, 0x36, 0x4b, 0xd4, 0x77, 0x55, 0xd3, 0x1c,
+  0xd0, 0xab, 0x8c, 0x64, 0x69, 0x91, 0x4c, 0x91, 0xdc, 0x26, 0x22, 0x0d, 0x9c, 0x0e, 0xfd, 0xb2,
+  0x87, 0xc0, 0x39, 0xeb, 0x74, 0x9c, 0xc1, 0x73, 0x68, 0x78, 0xba, 0x54, 0xab, 0x5d, 0x3c, 0xae,
+  0x56, 0xff, 0x0b, 0xaf, 0x3f, 0x2d, 0xb4, 0x26, 0xde, 0xdd, 0xb2, 0x05, 0x11, 0x74, 0xbd, 0xe8,
+  0xb7, 0x6d, 0xb0, 0x6e, 0xa3, 0x8a, 0x7f, 0x17, 0xa8, 0x56, 0xb7, 0x18, 0x13, 0x55, 0xa5, 0xf2,
+  0x5c, 0x63, 0xe3, 0xb6, 0x68, 0xf2, 0xe4, 0xc5, 0x34, 0x11, 0x9a, 0x4a, 0xbb, 0xa1, 0x92, 0x87,
+  0xf5, 0x36, 0x02, 0xa0, 0x9f, 0x29, 0x5c, 0x50, 0xd3, 0x2e, 0x71, 0xc6, 0x8a, 0x58, 0x7b, 0xb5,
+  0xb6, 0x95, 0x4c, 0xb1, 0xd8, 0xa6, 0x3b, 0x86, 0x55, 0x41, 0x83, 0x5e, 0x2f, 0x0c, 0xb5, 0x82,
+  0x03, 0x1c, 0x33, 0x9f, 0xcf, 0x6e, 0xbd, 0x86, 0xee, 0x09, 0xb8, 0xf5, 0x1a, 0xb8, 0x5f, 0x7c,
+  0x8a, 0x73, 0xc4, 0xc2, 0xc8, 0xdb, 0x46, 0x67, 0x4a, 0xb5, 0x1b, 0x60, 0x19, 0xc4, 0x82, 0xc5,
+  0x05, 0x52, 0x10, 0xe8, 0x6b, 0x9a, 0x0c, 0xa8, 0x7d, 0x2c, 0xa9, 0x96, 0x7f, 0x36, 0x3b, 0xbe,
+  0xf8, 0x56, 0xdf, 0xdb, 0xd9, 0x66, 0x78, 0x5b, 0x6e, 0x3b, 0x0e, 0x28, 0x7a, 0xb7, 0x09, 0x0b,
+  0xeb, 0xcc, 0x5e, 0x92, 0xf2, 0x85, 0x4d, 0x8b, 0x90, 0x4c, 0x4e, 0x36, 0x9d, 0x03, 0x80, 0x8f,
+  0xb5, 0xd5, 0xe3, 0x4e, 0x99, 0x66, 0xa8, 0x29, 0x0b, 0xb7, 0x9d, 0x50, 0x66, 0x6d, 0x7a, 0x37,
+  0xcd, 0xc4, 0xfc, 0x9d, 0x01, 0xb1, 0x0e, 0x5a, 0x3e, 0x1d, 0xed, 0xb4, 0x96, 0xa3, 0xa2, 0x48,
+  0x68, 0x5a, 0x10, 0xab, 0x53, 0x50, 0xbe, 0x19, 0x6d, 0x54, 0x74, 0x42, 0x2c, 0xed, 0xe8, 0x9d,
+  0xa5, 0x74, 0x0d, 0xfd, 0x71, 0xfb, 0xf8, 0x6f, 0x87, 0xd5, 0x76, 0x26, 0xa7, 0x86, 0xb3, 0x2c,
+  0xc3, 0x94, 0x0f, 0x23, 0x11, 0x73, 0xcf, 0x9e, 0xd8, 0x6a, 0x6f, 0x15, 0xfa, 0xda, 0xab, 0xd1,
+  0x95, 0xaa, 0xc7, 0xa3, 0xdd, 0x49, 0xa3, 0x68, 0x3f, 0x2a, 0x8f, 0x33, 0xcd, 0xb6, 0xf5, 0x32,
+  0x2b, 0xdf, 0xfa, 0x38, 0xd4, 0x31, 0x92, 0xd7, 0x4b, 0x6b, 0xc9, 0x61, 0xc8, 0x70, 0xc8, 0x78,
+  0x77, 0x72, 0x35, 0x66, 0xd1, 0xa1, 0x29, 0x57, 0xaf, 0xb2, 0x65, 0xba, 0x3d, 0xbd, 0x63, 0xd3,
+  0xa9, 0xa0, 0x74, 0x25, 0x53, 0xfb, 0xba, 0x7a, 0x47, 0x1d, 0x86, 0x2e, 0xb8, 0xeb, 0xd7, 0x97,
+  0xbb, 0xb7, 0xb1, 0x71, 0x44, 0xa2, 0x57, 0x54, 0x2f, 0x53, 0xfb, 0x61, 0x79, 0x95, 0x30, 0x04,
+  0x1f, 0x13, 0x1e, 0x34, 0x08, 0xde, 0xb5, 0x02, 0x1b, 0xb8, 0x6f, 0x09, 0xf2, 0xe3, 0x07, 0x78,
+  0xee, 0x9f, 0xb4, 0x84, 0x1a, 0xeb, 0x5b, 0xad, 0x9d, 0xc3, 0x0f, 0x65, 0x59, 0x9a, 0xb1, 0x81,
+  0x57, 0xbd, 0x5c, 0x37, 0x4e, 0xd8, 0xdc, 0x52, 0x2e, 0x6f, 0xb9, 0xad, 0x9f, 0x45, 0xec, 0x57,
+  0xa3, 0x70, 0x3f, 0xf0, 0x9b, 0xb5, 0xa6, 0xbb, 0x8d, 0x29, 0x31, 0xb0, 0xcf, 0xc1, 0xa3, 0x13,
+  0xb8, 0x15, 0x2e, 0xad, 0xf0, 0x04, 0xe8, 0x18, 0x6e, 0x85, 0x36, 0xcd, 0xe7, 0xad, 0x9f, 0x56,
+  0xac, 0xbc, 0x5e, 0x90, 0xf3, 0x72, 0xe6, 0x92, 0xdf, 0x63, 0xbb, 0x9f, 0x35, 0x07, 0x86, 0x99,
+  0xac, 0xa4, 0x3d, 0x88, 0x61, 0x74, 0xbb, 0xa9, 0x9a, 0x63, 0x6a, 0x71, 0xb2, 0xe6, 0x01, 0x35,
+  0xb6, 0x3b, 0xfd, 0x76, 0x2d, 0xb2, 0x4c, 0xdd, 0xde, 0xbe, 0x5d, 0xa3, 0x22, 0x1f, 0x49, 0xd6,
+  0x85, 0xc9, 0x78, 0xc7, 0xf4, 0x11, 0x30, 0xce, 0x71, 0xeb, 0x31, 0x84, 0x01, 0x74, 0x9e, 0xe8,
+  0xb5, 0xba, 0x82, 0x3d, 0xd9, 0xf7, 0x70, 0x32, 0xf9, 0x70, 0x39, 0xb9, 0x1f, 0x13, 0x5b, 0xaa,
+  0x4a, 0x87, 0xeb, 0x56, 0x1f, 0x88, 0xe9, 0x69, 0x99, 0xcf, 0x66, 0x4f, 0x4f, 0xfd, 0xea, 0x6a,
+  0xd7, 0xcf, 0xd1, 0xfe, 0xe8, 0xaa, 0x9e, 0xf6, 0x87, 0xc0, 0xcc, 0xcc, 0x68, 0x6f, 0x5b, 0x9a,
+  0x6a, 0xc0, 0xb1, 0x4c, 0xd8, 0x21, 0x47, 0xb3, 0xfc, 0x3b, 0x35, 0x38, 0x8c, 0x0c, 0xe5, 0x52,
+  0x79, 0x6a, 0x1f, 0x5d, 0x02, 0xdc, 0x78, 0xf9, 0xef, 0xa1, 0xf7, 0x57, 0x2e, 0xd3, 0x72, 0xe8,
+  0x35, 0x36, 0x94, 0xf3, 0xa7, 0x26, 0x0d, 0x99, 0xde, 0x99, 0x20, 0x04, 0xd3, 0x08, 0x7b, 0x13,
+  0x6d, 0x29, 0xcd, 0x51, 0x5f, 0x9b, 0x0b, 0x22, 0x0d, 0x70, 0x6f, 0xad, 0x3a, 0x01, 0xba, 0x25,
+  0x77, 0xac, 0x9e, 0xae, 0x73, 0xeb, 0x2b, 0x1c, 0xbd, 0x52, 0xcd, 0x5d, 0x91, 0xae, 0x1b, 0xe6,
+  0xef, 0xc8, 0xd1, 0x3f, 0xcb, 0xf8, 0x09, 0x14, 0xa5, 0x0c, 0x00, 0x00,
+};
+const size_t mesh_html_gz_len = 1324;
+const char mesh_html_gz_etag[] = "\"1409f8cb\"";
+
+#endif // WEB_ASSETS_H
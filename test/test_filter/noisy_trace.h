@@ -0,0 +1,40 @@
+#ifndef NOISY_TRACE_H
+#define NOISY_TRACE_H
+
+// Raw readings of one zone, one per second, with the default calibration
+// (dry 3200, water 1500). Fixed so the assertions in test_main.cpp are exact.
+//   0..59    moist soil around 2550 +-20, pump motor bursts at 15-16 and 40
+//   60..209  drying from 2560 to 2780 +-30, across the 30 % dry threshold
+//   210..217 watering, 110 counts per sample down to 1900
+//   218..257 settled at 1900 +-10
+const int DRYING_START = 60;
+const int WATERING_START = 210;
+const int SETTLED_START = 218;
+
+const int NOISY_TRACE[] = {
+    2558, 2565, 2559, 2558, 2562, 2567, 2542, 2541, 2562, 2560, 2570, 2569,
+    2541, 2536, 2558, 3600, 3550, 2535, 2564, 2570, 2532, 2568, 2555, 2558,
+    2569, 2540, 2569, 2530, 2563, 2534, 2533, 2532, 2542, 2545, 2568, 2531,
+    2559, 2550, 2558, 2567, 900, 2563, 2544, 2570, 2548, 2561, 2530, 2535,
+    2559, 2547, 2556, 2565, 2535, 2546, 2550, 2544, 2562, 2548, 2531, 2534,
+    2566, 2580, 2538, 2559, 2541, 2591, 2556, 2564, 2545, 2544, 2598, 2589,
+    2547, 2562, 2563, 2611, 2611, 2557, 2586, 2581, 2604, 2585, 2588, 2567,
+    2601, 2606, 2580, 2618, 2614, 2589, 2595, 2580, 2595, 2599, 2579, 2607,
+    2630, 2643, 2592, 2595, 2603, 2635, 2597, 2593, 2597, 2625, 2648, 2629,
+    2611, 2644, 2638, 2616, 2634, 2639, 2621, 2656, 2661, 2621, 2641, 2657,
+    2642, 2626, 2645, 2648, 2636, 2625, 2643, 2683, 2680, 2668, 2651, 2690,
+    2636, 2650, 2649, 2665, 2695, 2680, 2685, 2681, 2653, 2650, 2659, 2664,
+    2681, 2670, 2656, 2706, 2698, 2681, 2715, 2681, 2688, 2670, 2671, 2674,
+    2683, 2709, 2713, 2690, 2676, 2716, 2702, 2704, 2721, 2713, 2693, 2723,
+    2718, 2742, 2727, 2700, 2749, 2719, 2708, 2738, 2709, 2720, 2761, 2718,
+    2758, 2746, 2723, 2756, 2723, 2723, 2761, 2756, 2777, 2754, 2732, 2765,
+    2783, 2749, 2782, 2758, 2767, 2735, 2758, 2736, 2741, 2742, 2740, 2771,
+    2757, 2757, 2791, 2790, 2772, 2764, 2673, 2569, 2455, 2339, 2236, 2115,
+    2002, 1894, 1897, 1905, 1907, 1910, 1909, 1909, 1892, 1898, 1896, 1896,
+    1890, 1892, 1898, 1903, 1904, 1897, 1891, 1891, 1895, 1899, 1901, 1906,
+    1908, 1894, 1892, 1901, 1894, 1904, 1900, 1906, 1908, 1894, 1908, 1891,
+    1890, 1905, 1901, 1899, 1891, 1890,
+};
+const int NOISY_TRACE_LENGTH = sizeof(NOISY_TRACE) / sizeof(NOISY_TRACE[0]);
+
+#endif // NOISY_TRACE_H
@@ -0,0 +1,119 @@
+// MoistureFilter and ThresholdLatch replaying the noisy trace in
+// noisy_trace.h. Run with: pio test -e native
+
+#include <unity.h>
+#include <stdlib.h>
+#include "MoistureFilter.h"
+#include "WateringZone.h"
+#include "noisy_trace.h"
+
+namespace
+{
+int toPercent(int raw)
+{
+  long percent = (long)(raw - DEFAULT_DRY_VALUE) * 100 / (DEFAULT_WATER_VALUE - DEFAULT_DRY_VALUE);
+  return percent < 0 ? 0 : (percent > 100 ? 100 : (int)percent);
+}
+
+// Filtered value after every sample of the trace
+int filtered[NOISY_TRACE_LENGTH];
+
+void replay(MoistureFilter &filter, int from, int to)
+{
+  for (int i = from; i < to; i++)
+  {
+    filtered[i] = filter.update(NOISY_TRACE[i]);
+  }
+}
+
+// Rising and falling edges of "dry" over a stretch of values
+struct Edges
+{
+  int rises = 0;
+  int falls = 0;
+  int firstRise = -1;
+  int firstFall = -1;
+};
+
+Edges latchEdges(const int *values, int count, int band)
+{
+  Edges edges;
+  ThresholdLatch latch;
+  for (int i = 0; i < count; i++)
+  {
+    bool was = latch.isActive();
+    bool now = latch.update(toPercent(values[i]), DEFAULT_DRY_THRESHOLD, band);
+    if (now && !was)
+    {
+      edges.firstRise = edges.rises++ == 0 ? i : edges.firstRise;
+    }
+    else if (!now && was)
+    {
+      edges.firstFall = edges.falls++ == 0 ? i : edges.firstFall;
+    }
+  }
+  return edges;
+}
+} // namespace
+
+void setUp() {}
+void tearDown() {}
+
+void test_spikes_are_rejected()
+{
+  MoistureFilter filter;
+  replay(filter, 0, DRYING_START);
+  TEST_ASSERT_EQUAL(3, filter.rejectedSamples());
+  for (int i = 0; i < DRYING_START; i++)
+  {
+    TEST_ASSERT_INT_WITHIN(25, 2550, filtered[i]);
+  }
+}
+
+void test_raw_trace_chatters_at_threshold()
+{
+  // Without the filter and the band the drying stretch toggles dry many times
+  Edges edges = latchEdges(NOISY_TRACE + DRYING_START, WATERING_START - DRYING_START, 0);
+  TEST_ASSERT_GREATER_THAN(5, edges.rises);
+}
+
+void test_latch_holds_hysteresis()
+{
+  MoistureFilter filter;
+  replay(filter, 0, NOISY_TRACE_LENGTH);
+  Edges edges = latchEdges(filtered, NOISY_TRACE_LENGTH, DEFAULT_FILTER.hysteresis);
+  TEST_ASSERT_EQUAL(1, edges.rises);
+  TEST_ASSERT_EQUAL(1, edges.falls);
+  // Dry while drying, released by the watering and not before
+  TEST_ASSERT_TRUE(edges.firstRise > DRYING_START && edges.firstRise < WATERING_START);
+  TEST_ASSERT_TRUE(edges.firstFall >= WATERING_START && edges.firstFall < SETTLED_START);
+  TEST_ASSERT_TRUE(toPercent(filtered[edges.firstFall]) > DEFAULT_DRY_THRESHOLD + DEFAULT_FILTER.hysteresis);
+}
+
+void test_ema_settles_after_watering()
+{
+  MoistureFilter filter;
+  replay(filter, 0, NOISY_TRACE_LENGTH);
+  // Follows the watering without overshoot
+  for (int i = WATERING_START; i < NOISY_TRACE_LENGTH; i++)
+  {
+    TEST_ASSERT_TRUE(filtered[i] <= filtered[i - 1] + 5);
+    TEST_ASSERT_TRUE(filtered[i] >= 1890);
+  }
+  // Median and EMA lag: 15 samples after the last step it is inside the noise
+  for (int i = SETTLED_START + 15; i < NOISY_TRACE_LENGTH; i++)
+  {
+    TEST_ASSERT_INT_WITHIN(5, 1900, filtered[i]);
+  }
+  TEST_ASSERT_EQUAL(3, filter.rejectedSamples()); // Watering is no outlier
+}
+
+int main(int, char **)
+{
+  UNITY_BEGIN();
+  RUN_TEST(test_spikes_are_rejected);
+  RUN_TEST(test_raw_trace_chatters_at_threshold);
+  RUN_TEST(test_latch_holds_hysteresis);
+  RUN_TEST(test_ema_settles_after_watering);
+  return UNITY_END();
+}
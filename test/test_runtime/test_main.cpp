@@ -0,0 +1,84 @@
+// RuntimeState across simulated resets: the host's retained memory
+// survives a new RuntimeState like RTC memory survives a reset.
+// Run with: pio test -e native
+
+#include <unity.h>
+#include "RuntimeState.h"
+#include "SettingsStore.h"
+
+namespace
+{
+const unsigned long COOLDOWN_MS = 60000;
+
+uint8_t storedByte(MemoryKeyValueStore &memory, int zoneId)
+{
+  const SettingsKey key = settingsKeyFor(zoneId, 'r');
+  uint8_t flags = 0xEE;
+  memory.begin(RUNTIME_NAMESPACE, true);
+  memory.getBytes(key.text, &flags, sizeof(flags));
+  return flags;
+}
+} // namespace
+
+void setUp() {}
+void tearDown() {}
+
+void test_boot_without_cooldown_keeps_retained_copy_valid()
+{
+  MemoryKeyValueStore memory;
+  RuntimeState boot(&memory);
+  boot.begin();
+  unsigned long remainingMs = 0;
+  bool timedOut = false;
+  TEST_ASSERT_FALSE(boot.restore(1, COOLDOWN_MS, 0, remainingMs, timedOut));
+  boot.touch(2000);
+
+  // Brownout before the first pump event
+  RuntimeState next(&memory);
+  next.begin();
+  TEST_ASSERT_TRUE(next.retainedValid());
+}
+
+void test_cooldown_survives_reset()
+{
+  MemoryKeyValueStore memory;
+  RuntimeState boot(&memory);
+  boot.begin();
+  boot.save(2, false, true, true, 50000);
+  boot.touch(20000);
+
+  RuntimeState next(&memory);
+  next.begin();
+  unsigned long remainingMs = 0;
+  bool timedOut = false;
+  TEST_ASSERT_TRUE(next.restore(2, COOLDOWN_MS, 100, remainingMs, timedOut));
+  TEST_ASSERT_EQUAL(30000, remainingMs);
+  TEST_ASSERT_TRUE(timedOut);
+}
+
+void test_ended_cooldown_clears_nvs_byte()
+{
+  MemoryKeyValueStore memory;
+  RuntimeState boot(&memory);
+  boot.begin();
+  boot.save(3, false, false, true, 10000);
+  TEST_ASSERT_EQUAL(0x04, storedByte(memory, 3)); // RUNTIME_COOLDOWN
+  boot.touch(15000); // Reset after the cooldown ended, before the zone saved again
+
+  RuntimeState next(&memory);
+  next.begin();
+  unsigned long remainingMs = 0;
+  bool timedOut = false;
+  TEST_ASSERT_TRUE(next.retainedValid());
+  TEST_ASSERT_FALSE(next.restore(3, COOLDOWN_MS, 0, remainingMs, timedOut));
+  TEST_ASSERT_EQUAL(0, storedByte(memory, 3));
+}
+
+int main(int, char **)
+{
+  UNITY_BEGIN();
+  RUN_TEST(test_boot_without_cooldown_keeps_retained_copy_valid);
+  RUN_TEST(test_cooldown_survives_reset);
+  RUN_TEST(test_ended_cooldown_clears_nvs_byte);
+  return UNITY_END();
+}
@@ -0,0 +1,253 @@
+// SensorSampler against a scripted ADC: sample spacing, wakeup times, the
+// filtered output, stale external channels and unregistered backends.
+// Run with: pio test -e native
+
+#include <unity.h>
+#include <vector>
+#include "SensorSampler.h"
+
+namespace
+{
+// Raw value per pin, changed by the tests; every read is counted
+int rawByPin[8];
+int readsByPin[8];
+
+int scriptedRead(int pin)
+{
+  readsByPin[pin]++;
+  return rawByPin[pin];
+}
+
+// External backend that answers every request with result, or not at all
+class ScriptedBackend : public SensorBackend
+{
+public:
+  int result = 2000;
+  bool answers = true;
+
+  int channelCount() const override { return SENSOR_BACKEND_CHANNELS; }
+  void request(int channel) override { queued.push_back(channel); }
+  void poll(unsigned long, SensorResultFn done, void *context) override
+  {
+    if (!answers)
+    {
+      return;
+    }
+    for (int channel : queued)
+    {
+      done(context, channel, result);
+    }
+    queued.clear();
+  }
+  bool nextPollTime(unsigned long now, unsigned long &at) const override
+  {
+    at = now;
+    return !queued.empty();
+  }
+
+private:
+  std::vector<int> queued;
+};
+} // namespace
+
+void setUp()
+{
+  for (int pin = 0; pin < 8; pin++)
+  {
+    rawByPin[pin] = 2000;
+    readsByPin[pin] = 0;
+  }
+}
+
+void tearDown() {}
+
+void test_prime_takes_one_sample()
+{
+  SensorSampler sampler(scriptedRead);
+  int channel = sampler.addChannel(1);
+  TEST_ASSERT_FALSE(sampler.hasSamples(channel));
+  sampler.prime(channel, 50);
+  TEST_ASSERT_TRUE(sampler.hasSamples(channel));
+  TEST_ASSERT_EQUAL(1, readsByPin[1]);
+  TEST_ASSERT_EQUAL(50, sampler.lastSampleTime(channel));
+  TEST_ASSERT_EQUAL(2000, sampler.filtered(channel));
+}
+
+void test_one_sample_per_interval()
+{
+  SensorSampler sampler(scriptedRead, 1000);
+  int channel = sampler.addChannel(2);
+  sampler.prime(channel, 0);
+
+  // Ticking every millisecond for 10 s reads once per second
+  for (unsigned long now = 1; now <= 10000; now++)
+  {
+    sampler.tick(now);
+  }
+  TEST_ASSERT_EQUAL(11, readsByPin[2]);
+  TEST_ASSERT_EQUAL(10000, sampler.lastSampleTime(channel));
+  TEST_ASSERT_EQUAL(11, sampler.totalSamples());
+}
+
+void test_late_tick_restarts_spacing()
+{
+  SensorSampler sampler(scriptedRead, 1000);
+  int channel = sampler.addChannel(2);
+  sampler.prime(channel, 0);
+  sampler.tick(999);
+  TEST_ASSERT_EQUAL(1, readsByPin[2]);
+  sampler.tick(1700); // Woken late: sample now, the next one an interval later
+  TEST_ASSERT_EQUAL(2, readsByPin[2]);
+  sampler.tick(2600);
+  TEST_ASSERT_EQUAL(2, readsByPin[2]);
+  sampler.tick(2700);
+  TEST_ASSERT_EQUAL(3, readsByPin[2]);
+}
+
+void test_next_due_time_is_earliest_channel()
+{
+  SensorSampler sampler(scriptedRead, 1000);
+  int first = sampler.addChannel(1);
+  int second = sampler.addChannel(3);
+  sampler.prime(first, 0);
+  sampler.prime(second, 400);
+  TEST_ASSERT_EQUAL(1000, sampler.nextDueTime(500));
+  sampler.tick(1000);
+  TEST_ASSERT_EQUAL(1, readsByPin[3]); // Not due before 1400
+  TEST_ASSERT_EQUAL(1400, sampler.nextDueTime(1000));
+  // Without channels the sampler asks for nothing sooner than an interval
+  SensorSampler empty(scriptedRead, 1000);
+  TEST_ASSERT_EQUAL(1250, empty.nextDueTime(250));
+}
+
+void test_spacing_across_millis_rollover()
+{
+  SensorSampler sampler(scriptedRead, 1000);
+  int channel = sampler.addChannel(4);
+  unsigned long start = (unsigned long)-500;
+  sampler.prime(channel, start);
+  sampler.tick(start + 999);
+  TEST_ASSERT_EQUAL(1, readsByPin[4]);
+  sampler.tick(start + 1000); // 500 after the wrap
+  TEST_ASSERT_EQUAL(2, readsByPin[4]);
+  TEST_ASSERT_EQUAL(start + 2000, sampler.nextDueTime(start + 1000));
+}
+
+void test_filter_rejects_single_spike()
+{
+  SensorSampler sampler(scriptedRead, 1000);
+  int channel = sampler.addChannel(5);
+  sampler.prime(channel, 0);
+  for (unsigned long now = 1000; now <= 5000; now += 1000)
+  {
+    sampler.tick(now);
+  }
+  rawByPin[5] = 3500; // Pump motor spike, far beyond maxStep
+  sampler.tick(6000);
+  TEST_ASSERT_EQUAL(3500, sampler.latest(channel));
+  TEST_ASSERT_EQUAL(2000, sampler.filtered(channel));
+  TEST_ASSERT_EQUAL(1, sampler.rejectedSamples(channel));
+}
+
+void test_filter_follows_real_change()
+{
+  SensorSampler sampler(scriptedRead, 1000);
+  int channel = sampler.addChannel(6);
+  sampler.prime(channel, 0);
+  rawByPin[6] = 1800; // Watering: a step within maxStep
+  unsigned long now = 0;
+  for (int i = 0; i < 20; i++)
+  {
+    now += 1000;
+    sampler.tick(now);
+  }
+  TEST_ASSERT_INT_WITHIN(2, 1800, sampler.filtered(channel));
+}
+
+void test_channels_are_independent()
+{
+  SensorSampler sampler(scriptedRead, 1000);
+  int dry = sampler.addChannel(1);
+  int wet = sampler.addChannel(2);
+  rawByPin[1] = 3100;
+  rawByPin[2] = 1600;
+  sampler.prime(dry, 0);
+  sampler.prime(wet, 0);
+  TEST_ASSERT_EQUAL(3100, sampler.filtered(dry));
+  TEST_ASSERT_EQUAL(1600, sampler.filtered(wet));
+  TEST_ASSERT_EQUAL(0, sampler.filtered(7)); // No such channel
+}
+
+void test_failed_reads_make_channel_stale()
+{
+  SensorSampler sampler(scriptedRead, 1000);
+  ScriptedBackend backend;
+  int channel = sampler.addChannel(sensorAddress(sampler.addBackend(&backend), 3));
+  sampler.prime(channel, 0);
+  TEST_ASSERT_FALSE(sampler.isStale(channel, 0));
+
+  backend.result = SENSOR_READ_FAILED;
+  unsigned long now = 0;
+  for (int i = 1; i < SENSOR_STALE_FAILURES; i++)
+  {
+    now += 1000;
+    sampler.tick(now);
+  }
+  TEST_ASSERT_FALSE(sampler.isStale(channel, now));
+  now += 1000;
+  sampler.tick(now);
+  TEST_ASSERT_TRUE(sampler.isStale(channel, now));
+  TEST_ASSERT_EQUAL(2000, sampler.filtered(channel)); // The filter keeps its last value
+
+  backend.result = 2100; // One good read clears it
+  now += 1000;
+  sampler.tick(now);
+  TEST_ASSERT_FALSE(sampler.isStale(channel, now));
+}
+
+void test_silent_backend_goes_stale()
+{
+  SensorSampler sampler(scriptedRead, 1000);
+  ScriptedBackend backend;
+  int channel = sampler.addChannel(sensorAddress(sampler.addBackend(&backend), 0));
+  backend.answers = false; // Never a result, not even a failure
+  sampler.prime(channel, 500);
+  TEST_ASSERT_FALSE(sampler.hasSamples(channel));
+  TEST_ASSERT_FALSE(sampler.isStale(channel, 500 + SENSOR_STALE_MS - 1));
+  TEST_ASSERT_TRUE(sampler.isStale(channel, 500 + SENSOR_STALE_MS));
+  // Native channels read on every interval and never go stale
+  int native = sampler.addChannel(1);
+  sampler.prime(native, 500);
+  sampler.tick(500 + SENSOR_STALE_MS);
+  TEST_ASSERT_FALSE(sampler.isStale(native, 500 + SENSOR_STALE_MS));
+}
+
+void test_unregistered_backend_is_refused()
+{
+  SensorSampler sampler(scriptedRead, 1000);
+  TEST_ASSERT_EQUAL(-1, sampler.addChannel(sensorAddress(0, 0)));
+  ScriptedBackend backend;
+  int backendNumber = sampler.addBackend(&backend);
+  TEST_ASSERT_EQUAL(-1, sampler.addChannel(sensorAddress(backendNumber + 1, 0)));
+  int channel = sampler.addChannel(sensorAddress(backendNumber, 0));
+  TEST_ASSERT_EQUAL(0, channel); // The refused addresses took no channel
+  sampler.prime(channel, 0);
+  TEST_ASSERT_EQUAL(2000, sampler.filtered(channel));
+}
+
+int main(int, char **)
+{
+  UNITY_BEGIN();
+  RUN_TEST(test_prime_takes_one_sample);
+  RUN_TEST(test_one_sample_per_interval);
+  RUN_TEST(test_late_tick_restarts_spacing);
+  RUN_TEST(test_next_due_time_is_earliest_channel);
+  RUN_TEST(test_spacing_across_millis_rollover);
+  RUN_TEST(test_filter_rejects_single_spike);
+  RUN_TEST(test_filter_follows_real_change);
+  RUN_TEST(test_channels_are_independent);
+  RUN_TEST(test_failed_reads_make_channel_stale);
+  RUN_TEST(test_silent_backend_goes_stale);
+  RUN_TEST(test_unregistered_backend_is_refused);
+  return UNITY_END();
+}
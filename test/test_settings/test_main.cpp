@@ -0,0 +1,191 @@
+// SettingsStore migrating the one-int-per-setting keys of older firmware,
+// and keeping learned dosing models. Run with: pio test -e native
+
+#include <unity.h>
+#include "SettingsStore.h"
+
+namespace
+{
+ZoneSettings defaults()
+{
+  ZoneSettings settings = {};
+  settings.wetThreshold = 60;
+  settings.dryThreshold = 30;
+  settings.airValue = 3200;
+  settings.dryValue = 2600;
+  settings.waterValue = 1400;
+  settings.maxRuntimeSec = 30;
+  settings.cooldownSec = 300;
+  return settings;
+}
+
+// NVS partition full: every write fails until there is room again
+class FullStore : public MemoryKeyValueStore
+{
+public:
+  bool full = true;
+  unsigned long attempts = 0;
+
+  size_t putBytes(const char *key, const void *data, size_t size) override
+  {
+    attempts++;
+    return full ? 0 : MemoryKeyValueStore::putBytes(key, data, size);
+  }
+};
+} // namespace
+
+void setUp() {}
+void tearDown() {}
+
+void test_nothing_stored_keeps_defaults()
+{
+  MemoryKeyValueStore memory;
+  SettingsStore store(&memory);
+  ZoneSettings settings = defaults();
+  TEST_ASSERT_FALSE(store.load(1, settings));
+  TEST_ASSERT_EQUAL(60, settings.wetThreshold);
+}
+
+void test_all_legacy_keys_migrate()
+{
+  MemoryKeyValueStore memory;
+  memory.begin(SETTINGS_NAMESPACE, false);
+  memory.putInt("zone2_wet", 70);
+  memory.putInt("zone2_dry", 40);
+  memory.putInt("zone2_air", 3100);
+  memory.putInt("zone2_dryVal", 2500);
+  memory.putInt("zone2_water", 1300);
+  memory.putInt("zone2_maxRun", 45);
+  memory.putInt("zone2_cooldown", 600);
+  SettingsStore store(&memory);
+  ZoneSettings settings = defaults();
+  TEST_ASSERT_TRUE(store.load(2, settings));
+  TEST_ASSERT_EQUAL(70, settings.wetThreshold);
+  TEST_ASSERT_EQUAL(40, settings.dryThreshold);
+  TEST_ASSERT_EQUAL(3100, settings.airValue);
+  TEST_ASSERT_EQUAL(2500, settings.dryValue);
+  TEST_ASSERT_EQUAL(1300, settings.waterValue);
+  TEST_ASSERT_EQUAL(45, settings.maxRuntimeSec);
+  TEST_ASSERT_EQUAL(600, settings.cooldownSec);
+}
+
+void test_legacy_keys_migrate_without_wet()
+{
+  // A device that only ever had its calibration saved
+  MemoryKeyValueStore memory;
+  memory.begin(SETTINGS_NAMESPACE, false);
+  memory.putInt("zone3_air", 3050);
+  memory.putInt("zone3_water", 1250);
+  SettingsStore store(&memory);
+  ZoneSettings settings = defaults();
+  TEST_ASSERT_TRUE(store.load(3, settings));
+  TEST_ASSERT_EQUAL(3050, settings.airValue);
+  TEST_ASSERT_EQUAL(1250, settings.waterValue);
+  TEST_ASSERT_EQUAL(60, settings.wetThreshold);
+  TEST_ASSERT_EQUAL(2600, settings.dryValue);
+  TEST_ASSERT_EQUAL(300, settings.cooldownSec);
+}
+
+void test_migrated_settings_are_written_as_blob()
+{
+  MemoryKeyValueStore memory;
+  memory.begin(SETTINGS_NAMESPACE, false);
+  memory.putInt("zone4_dry", 35);
+  SettingsStore store(&memory, 0);
+  ZoneSettings settings = defaults();
+  TEST_ASSERT_TRUE(store.load(4, settings));
+  store.stage(4, settings, 0); // As the zone does on its first change
+  TEST_ASSERT_EQUAL(1, store.flush(0, true));
+
+  SettingsStore reloaded(&memory);
+  ZoneSettings again = defaults();
+  again.dryThreshold = 0;
+  TEST_ASSERT_TRUE(reloaded.load(4, again));
+  TEST_ASSERT_EQUAL(35, again.dryThreshold);
+  TEST_ASSERT_EQUAL(60, again.wetThreshold);
+}
+
+void test_dosing_model_survives_restart()
+{
+  MemoryKeyValueStore memory;
+  SettingsStore store(&memory);
+  DosingModel model;
+  TEST_ASSERT_FALSE(store.loadModel(5, model));
+  store.stageModel(5, 2500, 120000, 1000);
+  TEST_ASSERT_EQUAL(0, store.flush(1000 + MODEL_DEBOUNCE_MS - 1));
+  TEST_ASSERT_EQUAL(1, store.flush(1000 + MODEL_DEBOUNCE_MS));
+
+  SettingsStore reloaded(&memory);
+  TEST_ASSERT_TRUE(reloaded.loadModel(5, model));
+  TEST_ASSERT_EQUAL(2500, model.gain);
+  TEST_ASSERT_EQUAL(120000, model.soakMs);
+}
+
+void test_unchanged_dosing_model_is_not_written()
+{
+  MemoryKeyValueStore memory;
+  SettingsStore store(&memory);
+  store.stageModel(6, 2500, 120000, 0);
+  store.stageModel(6, 2500, 120000, 500000); // Every evaluation stages, the window stays
+  unsigned long deadline = 0;
+  TEST_ASSERT_TRUE(store.nextFlushTime(deadline));
+  TEST_ASSERT_EQUAL(MODEL_DEBOUNCE_MS, deadline);
+  TEST_ASSERT_EQUAL(1, store.flush(MODEL_DEBOUNCE_MS));
+  store.stageModel(6, 2500, 120000, MODEL_DEBOUNCE_MS + 1);
+  TEST_ASSERT_FALSE(store.hasPending());
+  unsigned long writes = memory.writeCount;
+  TEST_ASSERT_EQUAL(0, store.flush(3 * MODEL_DEBOUNCE_MS, true));
+  TEST_ASSERT_EQUAL(writes, memory.writeCount);
+}
+
+void test_corrupt_dosing_model_is_ignored()
+{
+  MemoryKeyValueStore memory;
+  DosingModel bad = {MODEL_VERSION, 2500, 120000, 0};
+  memory.begin(SETTINGS_NAMESPACE, false);
+  memory.putBytes("d7", &bad, sizeof(bad));
+  SettingsStore store(&memory);
+  DosingModel model;
+  TEST_ASSERT_FALSE(store.loadModel(7, model));
+}
+
+void test_failed_write_waits_another_window()
+{
+  FullStore memory;
+  SettingsStore store(&memory, 1000);
+  ZoneSettings settings = defaults();
+  settings.wetThreshold = 65;
+  store.stage(8, settings, 0);
+  TEST_ASSERT_EQUAL(0, store.flush(1000));
+  TEST_ASSERT_EQUAL(1, memory.attempts);
+  TEST_ASSERT_TRUE(store.hasPending());
+
+  // The next attempt is a debounce window later, not due right away
+  unsigned long deadline = 0;
+  TEST_ASSERT_TRUE(store.nextFlushTime(deadline));
+  TEST_ASSERT_EQUAL(2000, deadline);
+  TEST_ASSERT_EQUAL(0, store.flush(1500));
+  TEST_ASSERT_EQUAL(1, memory.attempts);
+
+  memory.full = false;
+  TEST_ASSERT_EQUAL(1, store.flush(2000));
+  TEST_ASSERT_FALSE(store.hasPending());
+  SettingsStore reloaded(&memory);
+  ZoneSettings again = defaults();
+  TEST_ASSERT_TRUE(reloaded.load(8, again));
+  TEST_ASSERT_EQUAL(65, again.wetThreshold);
+}
+
+int main(int, char **)
+{
+  UNITY_BEGIN();
+  RUN_TEST(test_nothing_stored_keeps_defaults);
+  RUN_TEST(test_all_legacy_keys_migrate);
+  RUN_TEST(test_legacy_keys_migrate_without_wet);
+  RUN_TEST(test_migrated_settings_are_written_as_blob);
+  RUN_TEST(test_dosing_model_survives_restart);
+  RUN_TEST(test_unchanged_dosing_model_is_not_written);
+  RUN_TEST(test_corrupt_dosing_model_is_ignored);
+  RUN_TEST(test_failed_write_waits_another_window);
+  return UNITY_END();
+}
@@ -0,0 +1,123 @@
+// SnapshotStore under a writer that publishes as fast as it can: readers
+// must only ever see whole snapshots. Run with: pio test -e native
+
+#include <unity.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include "ZoneSnapshot.h"
+
+namespace
+{
+// Every field that a reader checks carries the same stamp
+void stamp(SystemSnapshot &snapshot, int value)
+{
+  snapshot.takenAtMs = (unsigned long)value;
+  snapshot.zoneCount = MAX_ZONES;
+  for (int i = 0; i < MAX_ZONES; i++)
+  {
+    snapshot.zones[i].id = value;
+    snapshot.zones[i].moistureRaw = value;
+    snapshot.zones[i].cooldownSec = (unsigned long)value;
+  }
+}
+
+bool consistent(const SystemSnapshot &snapshot)
+{
+  int value = (int)snapshot.takenAtMs;
+  for (int i = 0; i < MAX_ZONES; i++)
+  {
+    if (snapshot.zones[i].id != value || snapshot.zones[i].moistureRaw != value ||
+        snapshot.zones[i].cooldownSec != (unsigned long)value)
+    {
+      return false;
+    }
+  }
+  return true;
+}
+} // namespace
+
+void setUp() {}
+void tearDown() {}
+
+void test_empty_store_reads_nothing()
+{
+  SnapshotStore store;
+  SystemSnapshot out;
+  TEST_ASSERT_FALSE(store.read(out));
+  TEST_ASSERT_EQUAL(0, store.version());
+}
+
+void test_versions_count_publishes()
+{
+  static SnapshotStore store;
+  static SystemSnapshot in;
+  static SystemSnapshot out;
+  for (int i = 1; i <= 3; i++)
+  {
+    stamp(in, i);
+    store.publish(in);
+    TEST_ASSERT_EQUAL(i, store.version());
+    TEST_ASSERT_TRUE(store.read(out));
+    TEST_ASSERT_EQUAL(i, out.version);
+    TEST_ASSERT_EQUAL(i, (int)out.takenAtMs);
+  }
+}
+
+void test_readers_never_see_torn_snapshots()
+{
+  static SnapshotStore store;
+  std::atomic<bool> done(false);
+  std::atomic<long> reads(0);
+  std::atomic<long> torn(0);
+  std::atomic<long> backwards(0);
+
+  std::thread writer([&]
+                     {
+    static SystemSnapshot in;
+    for (int i = 1; i <= 200000; i++) {
+      stamp(in, i);
+      store.publish(in);
+    }
+    done = true; });
+
+  std::vector<std::thread> readers;
+  for (int r = 0; r < 3; r++)
+  {
+    readers.emplace_back([&]
+                         {
+      SystemSnapshot *out = new SystemSnapshot();
+      uint32_t last = 0;
+      while (!done) {
+        if (!store.read(*out)) {
+          continue;
+        }
+        reads++;
+        if (!consistent(*out) || out->version != out->takenAtMs) {
+          torn++;
+        }
+        if (out->version < last) {
+          backwards++;
+        }
+        last = out->version;
+      }
+      delete out; });
+  }
+  writer.join();
+  for (std::thread &reader : readers)
+  {
+    reader.join();
+  }
+  TEST_ASSERT_GREATER_THAN(0, reads.load());
+  TEST_ASSERT_EQUAL(0, torn.load());
+  TEST_ASSERT_EQUAL(0, backwards.load());
+}
+
+int main(int, char **)
+{
+  UNITY_BEGIN();
+  RUN_TEST(test_empty_store_reads_nothing);
+  RUN_TEST(test_versions_count_publishes);
+  RUN_TEST(test_readers_never_see_torn_snapshots);
+  return UNITY_END();
+}
@@ -0,0 +1,72 @@
+"""Embed the static web UI as gzip-compressed byte arrays.
+
+Runs as a PlatformIO pre-build script (extra_scripts = pre:tools/embed_assets.py)
+and can also be run by hand: python tools/embed_assets.py
+Every file in web/ becomes <name>_<ext>_gz[] in src/web_assets.h together with
+its length and an ETag derived from the content.
+"""
+
+import gzip
+import os
+import zlib
+
+try:
+    Import("env")  # noqa: F821 - provided by PlatformIO/SCons
+    PROJECT_DIR = env.subst("$PROJECT_DIR")  # noqa: F821
+except NameError:
+    PROJECT_DIR = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+
+WEB_DIR = os.path.join(PROJECT_DIR, "web")
+OUTPUT = os.path.join(PROJECT_DIR, "src", "web_assets.h")
+
+
+def symbol_for(filename):
+    return filename.replace(".", "_").replace("-", "_") + "_gz"
+
+
+def c_array(data):
+    lines = []
+    for i in range(0, len(data), 16):
+        lines.append("  " + ", ".join("0x%02x" % b for b in data[i:i + 16]) + ",")
+    return "\n".join(lines)
+
+
+def render():
+    parts = [
+        "// Generated by tools/embed_assets.py from web/ - do not edit",
+        "#ifndef WEB_ASSETS_H",
+        "#define WEB_ASSETS_H",
+        "#include <Arduino.h>",
+        "",
+    ]
+    for filename in sorted(os.listdir(WEB_DIR)):
+        with open(os.path.join(WEB_DIR, filename), "rb") as f:
+            raw = f.read()
+        # mtime=0 keeps the output reproducible so unchanged assets don't trigger rebuilds
+        packed = gzip.compress(raw, compresslevel=9, mtime=0)
+        symbol = symbol_for(filename)
+        parts += [
+            "// %s: %d bytes, %d gzipped" % (filename, len(raw), len(packed)),
+            "const uint8_t %s[] PROGMEM = {" % symbol,
+            c_array(packed),
+            "};",
+            "const size_t %s_len = %d;" % (symbol, len(packed)),
+            'const char %s_etag[] = "\\"%08x\\"";' % (symbol, zlib.crc32(raw)),
+            "",
+        ]
+    parts += ["#endif // WEB_ASSETS_H", ""]
+    return "\n".join(parts)
+
+
+def main():
+    content = render()
+    if os.path.exists(OUTPUT):
+        with open(OUTPUT) as f:
+            if f.read() == content:
+                return
+    with open(OUTPUT, "w") as f:
+        f.write(content)
+    print("embed_assets: wrote " + os.path.relpath(OUTPUT, PROJECT_DIR))
+
+
+main()